@@ -0,0 +1,136 @@
+/**
+ * @file policy_analyzer_bench.cpp
+ * @brief Cost of shadowing and conflict analysis on large generated policies
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * The synthetic policy mixes what generated policies contain: per-user
+ * command rules with literal arguments, argument patterns, catch-all
+ * commands, duplicates and late deny rules. The conflict benchmark uses
+ * argument patterns only, so every pair in a command's partition is
+ * intersected. The range argument is the number of rules; the policy is
+ * parsed once outside the timed loop.
+ *
+ *   cmake -B build -DVOIX_BUILD_BENCHMARKS=ON && cmake --build build
+ *   ./build/bench/policy_analyzer_bench
+ */
+
+#include "config.hpp"
+#include "logger.hpp"
+#include "policy_analyzer.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <unistd.h>
+
+namespace {
+
+std::filesystem::path write_policy(std::int64_t rules) {
+    auto path = std::filesystem::temp_directory_path() /
+                std::format("voix_bench_analyzer_{}_{}", getpid(), rules);
+    std::ofstream out(path);
+    out << "acl:\n  user:\n";
+    constexpr std::int64_t k_users = 64;
+    for (std::int64_t user = 0; user < k_users; ++user) {
+        out << "    " << 10000 + user << ":\n";
+        for (std::int64_t i = user; i < rules; i += k_users) {
+            const std::int64_t cmd = i % 997;
+            switch (i % 8) {
+                case 0:
+                    out << "      - {action: permit, command: /usr/bin/tool-" << cmd << "}\n";
+                    break;
+                case 1:
+                    out << "      - {action: permit, command: /usr/bin/tool-" << cmd
+                        << ", args: ['*', /srv/" << i % 13 << "]}\n";
+                    break;
+                case 2:
+                    out << "      - {action: deny, command: /usr/bin/tool-" << cmd << ", args: [--force]}\n";
+                    break;
+                default:
+                    out << "      - {action: permit, command: /usr/bin/tool-" << cmd << ", target: " << i % 5
+                        << ", args: [--job, '" << i << "']}\n";
+                    break;
+            }
+        }
+    }
+    return path;
+}
+
+// Permit and deny argument patterns over a few hundred commands per user.
+std::filesystem::path write_pattern_policy(std::int64_t rules) {
+    auto path = std::filesystem::temp_directory_path() /
+                std::format("voix_bench_patterns_{}_{}", getpid(), rules);
+    std::ofstream out(path);
+    out << "acl:\n  user:\n";
+    constexpr std::int64_t k_users = 16;
+    for (std::int64_t user = 0; user < k_users; ++user) {
+        out << "    " << 10000 + user << ":\n";
+        for (std::int64_t i = user; i < rules; i += k_users) {
+            const std::int64_t cmd = i % 251;
+            out << "      - {action: " << (i % 3 ? "permit" : "deny") << ", command: /usr/bin/tool-" << cmd;
+            switch ((i / k_users) % 4) {
+                case 0:
+                    out << ", args: ['/srv/" << i % 17 << "/*', '*.log']}\n";
+                    break;
+                case 1:
+                    out << ", args: ['/srv/*/cache-?', '--level=" << i % 5 << "*']}\n";
+                    break;
+                case 2:
+                    out << ", args: ['*/secret*', '*']}\n";
+                    break;
+                default:
+                    out << ", args: ['--job=" << i << "*']}\n";
+                    break;
+            }
+        }
+    }
+    return path;
+}
+
+void BM_ConflictAnalysis(benchmark::State& state) {
+    auto path = write_pattern_policy(state.range(0));
+    Voix::Logger::suppress_stderr = true;
+    Voix::Config config;
+    config.load(path.string(), false);
+    std::filesystem::remove(path);
+    Voix::PolicyAnalyzer analyzer(config);
+
+    size_t conflicts = 0;
+    for (auto _ : state) {
+        auto result = analyzer.find_conflicting_rules();
+        conflicts = result.size();
+        benchmark::DoNotOptimize(result);
+    }
+    state.counters["rules"] = static_cast<double>(config.getRules().size());
+    state.counters["conflicts"] = static_cast<double>(conflicts);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ShadowAnalysis(benchmark::State& state) {
+    auto path = write_policy(state.range(0));
+    // The generated users do not exist; keep the lookup errors off the terminal.
+    Voix::Logger::suppress_stderr = true;
+    Voix::Config config;
+    config.load(path.string(), false);
+    std::filesystem::remove(path);
+    Voix::PolicyAnalyzer analyzer(config);
+
+    size_t shadowed = 0;
+    for (auto _ : state) {
+        auto result = analyzer.find_shadowed_rules();
+        shadowed = result.size();
+        benchmark::DoNotOptimize(result);
+    }
+    state.counters["rules"] = static_cast<double>(config.getRules().size());
+    state.counters["shadowed"] = static_cast<double>(shadowed);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+BENCHMARK(BM_ShadowAnalysis)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ConflictAnalysis)->Arg(1000)->Arg(5000)->Arg(20000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
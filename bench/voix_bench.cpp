@@ -0,0 +1,289 @@
+/**
+ * @file voix_bench.cpp
+ * @brief Microbenchmarks of the paths every voix invocation takes
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ *
+ * Policies are generated for the calling user so rule identities resolve as
+ * they do in production; range arguments are rule counts. Results carry the
+ * Voix version in their context, and the `voix_bench_json` target writes
+ * them to `voix_bench.json` in the build directory for regression tracking:
+ *
+ *   cmake -B build -DVOIX_BUILD_BENCHMARKS=ON && cmake --build build
+ *   cmake --build build --target voix_bench_json
+ *   ./build/bench/voix_bench --benchmark_filter=Permit --benchmark_format=json
+ *
+ * Every result also reports allocs_per_iter, the heap allocations made
+ * inside the timed loop as counted by tests/alloc_counter.cpp.
+ *
+ * BM_Pipeline runs Voix::execute() end to end over the mocks in
+ * tests/mocks.hpp, so it measures everything but NSS, PAM and exec.
+ *
+ * BM_LoggerLog appends to /var/log/voix.log (syslog when that cannot be
+ * opened); run it on a test machine or filter it out.
+ */
+
+#include "alloc_counter.hpp"
+#include "command_resolver.hpp"
+#include "config.hpp"
+#include "env_policy.hpp"
+#include "glob.hpp"
+#include "logger.hpp"
+#include "mocks.hpp"
+#include "permission_checker.hpp"
+#include "security.hpp"
+#include "system_utils.hpp"
+#include "voix.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+std::filesystem::path bench_path(std::string_view name, std::int64_t rules) {
+    return std::filesystem::temp_directory_path() /
+           std::format("voix_bench_{}_{}_{}", name, getpid(), rules);
+}
+
+std::string self_name() {
+    auto self = Voix::lookup_passwd_by_uid(getuid());
+    return self ? self->name : "root";
+}
+
+// `rules` command rules for the calling user, every fourth with literal
+// arguments and every fourth with an argument pattern. When `hit` is set the
+// middle rule permits /usr/bin/true; otherwise nothing does.
+std::filesystem::path write_policy(std::int64_t rules, bool hit) {
+    auto path = bench_path(hit ? "hit" : "miss", rules);
+    std::ofstream out(path);
+    out << "core:\n  paths: [/bin, /usr/bin]\n"
+        << "acl:\n  user:\n    " << self_name() << ":\n";
+    for (std::int64_t i = 0; i < rules; ++i) {
+        if (hit && i == rules / 2) {
+            out << "      - {action: permit, command: /usr/bin/true}\n";
+            continue;
+        }
+        out << "      - {action: permit, command: /usr/bin/bench-" << i;
+        switch (i % 4) {
+            case 1:
+                out << ", args: [--job, '" << i << "']}\n";
+                break;
+            case 2:
+                out << ", args: ['/srv/*/" << i << "/*.log']}\n";
+                break;
+            default:
+                out << "}\n";
+                break;
+        }
+    }
+    return path;
+}
+
+struct LoadedPolicy {
+    std::shared_ptr<Voix::Config> config = std::make_shared<Voix::Config>();
+    std::shared_ptr<Voix::Security> security = std::make_shared<Voix::Security>();
+};
+
+// Allocations made inside the timed loop, per iteration, as allocs_per_iter.
+void report_allocations(benchmark::State& state, const alloc_counter::Phase& allocations) {
+    state.counters["allocs_per_iter"] =
+        benchmark::Counter(static_cast<double>(allocations.now().allocations), benchmark::Counter::kAvgIterations);
+}
+
+LoadedPolicy load_policy(std::int64_t rules, bool hit) {
+    auto path = write_policy(rules, hit);
+    LoadedPolicy policy;
+    policy.config->load(path.string(), false);
+    std::filesystem::remove(path);
+    return policy;
+}
+
+void BM_ConfigLoad(benchmark::State& state) {
+    auto path = write_policy(state.range(0), true);
+    alloc_counter::Phase allocations;
+    for (auto _ : state) {
+        Voix::Config config;
+        benchmark::DoNotOptimize(config.load(path.string(), false));
+    }
+    report_allocations(state, allocations);
+    std::filesystem::remove(path);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ConfigLoad)->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kMillisecond);
+
+void BM_PermitHit(benchmark::State& state) {
+    auto policy = load_policy(state.range(0), true);
+    Voix::PermissionChecker checker(policy.security, policy.config);
+    alloc_counter::Phase allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(checker.permit("/usr/bin/true", {}, 0));
+    }
+    report_allocations(state, allocations);
+}
+BENCHMARK(BM_PermitHit)->RangeMultiplier(10)->Range(10, 10000);
+
+void BM_PermitMiss(benchmark::State& state) {
+    auto policy = load_policy(state.range(0), false);
+    Voix::PermissionChecker checker(policy.security, policy.config);
+    alloc_counter::Phase allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(checker.permit("/usr/bin/true", {}, 0));
+    }
+    report_allocations(state, allocations);
+}
+BENCHMARK(BM_PermitMiss)->RangeMultiplier(10)->Range(10, 10000);
+
+// PermissionChecker::match_pattern() is private; a single PATTERN rule makes
+// permit() cost one identity check and one pattern match per argument.
+void BM_MatchPattern(benchmark::State& state) {
+    auto path = bench_path("pattern", 1);
+    {
+        std::ofstream out(path);
+        out << "acl:\n  user:\n    " << self_name() << ":\n"
+            << "      - {action: permit, command: /usr/bin/tail, args: ['/srv/*/logs/*.log']}\n";
+    }
+    LoadedPolicy policy;
+    policy.config->load(path.string(), false);
+    std::filesystem::remove(path);
+    Voix::PermissionChecker checker(policy.security, policy.config);
+    const std::vector<std::string> args{"/srv/web-frontend/logs/access-2026-10-18.log"};
+    alloc_counter::Phase allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(checker.permit("/usr/bin/tail", args, 0));
+    }
+    report_allocations(state, allocations);
+}
+BENCHMARK(BM_MatchPattern);
+
+void BM_GlobMatch(benchmark::State& state) {
+    alloc_counter::Phase allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            Voix::glob_match("/srv/*/logs/*.log", "/srv/web-frontend/logs/access-2026-10-18.log"));
+    }
+    report_allocations(state, allocations);
+}
+BENCHMARK(BM_GlobMatch);
+
+void BM_IsCatastrophicCommand(benchmark::State& state) {
+    Voix::Security security;
+    Voix::Config config;
+    const bool dangerous = state.range(0) != 0;
+    const std::string command = dangerous ? "/usr/bin/rm" : "/usr/bin/ls";
+    const std::vector<std::string> args = dangerous ? std::vector<std::string>{"-rf", "/"}
+                                                    : std::vector<std::string>{"-l", "/srv"};
+    alloc_counter::Phase allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(security.isCatastrophicCommand(command, args, config, "/"));
+    }
+    report_allocations(state, allocations);
+    state.SetLabel(dangerous ? "rm -rf /" : "ls -l /srv");
+}
+BENCHMARK(BM_IsCatastrophicCommand)->Arg(0)->Arg(1);
+
+// Arg 0: a fresh resolver per lookup, as one voix invocation does.
+// Arg 1: repeat lookups through one resolver's cache, as voixd does.
+void BM_ResolveCommand(benchmark::State& state) {
+    constexpr std::string_view path = "/usr/local/sbin:/usr/local/bin:/usr/sbin:/usr/bin:/bin";
+    const bool cached = state.range(0) != 0;
+    Voix::CommandResolver resident(path);
+    alloc_counter::Phase allocations;
+    for (auto _ : state) {
+        if (cached) {
+            benchmark::DoNotOptimize(resident.resolve("true"));
+        } else {
+            Voix::CommandResolver resolver(path);
+            benchmark::DoNotOptimize(resolver.resolve("true"));
+        }
+    }
+    report_allocations(state, allocations);
+    state.SetLabel(cached ? "cached" : "cold");
+}
+BENCHMARK(BM_ResolveCommand)->Arg(0)->Arg(1);
+
+// A desktop-sized caller environment of `range` variables.
+void BM_EnvCollect(benchmark::State& state) {
+    std::vector<std::string> storage{"HOME=/home/bench", "TERM=xterm-256color", "LANG=en_US.UTF-8",
+                                     "PATH=/usr/bin:/bin", "LD_PRELOAD=/tmp/x.so", "DISPLAY=:0"};
+    for (std::int64_t i = static_cast<std::int64_t>(storage.size()); i < state.range(0); ++i) {
+        storage.push_back(std::format("BENCH_VAR_{}=value-{}", i, i));
+    }
+    std::vector<const char*> envp;
+    for (const auto& entry : storage) envp.push_back(entry.c_str());
+    envp.push_back(nullptr);
+
+    const std::vector<std::string> assignments{"HOME=/root", "USER=root", "LOGNAME=root", "SHELL=/bin/sh",
+                                               "PATH=/usr/sbin:/usr/bin:/sbin:/bin"};
+    const std::vector<std::string> rule_env{"EDITOR=vi", "-TERM"};
+    const auto& policy = Voix::EnvPolicy::defaults();
+    alloc_counter::Phase allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(policy.apply(envp.data(), Voix::EnvPolicy::Mode::SCRUB, assignments, rule_env));
+    }
+    report_allocations(state, allocations);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EnvCollect)->Arg(16)->Arg(64)->Arg(256);
+
+// The whole request pipeline for uid 1000 with `range` rules, the middle
+// one a nopass permit of /usr/bin/true.
+void BM_Pipeline(benchmark::State& state) {
+    std::string policy = "core:\n  paths: [/usr/bin]\n  audit_sinks: []\n  audit_dir: \"\"\nacl:\n  user:\n    1000:\n";
+    for (std::int64_t i = 0; i < state.range(0); ++i) {
+        policy += i == state.range(0) / 2 ? "      - {action: permit, command: /usr/bin/true, options: [nopass]}\n"
+                                          : std::format("      - {{action: permit, command: /usr/bin/bench-{}}}\n", i);
+    }
+    auto config = std::make_shared<Voix::Config>();
+    if (!config->load_from_string(policy)) {
+        state.SkipWithError("policy failed to load");
+        return;
+    }
+    auto identity = std::make_shared<MockIdentity>();
+    identity->users = {{"bench", 1000, 1000, {1000}}, {"root", 0, 0, {0}}};
+    identity->current_user = "bench";
+    identity->current_uid = 1000;
+    auto resolver = std::make_unique<MockResolver>();
+    resolver->path = {"/usr/bin"};
+    resolver->files = {"/usr/bin/true"};
+    Voix::Voix voix({config, identity, std::make_unique<MockAuthenticator>(), std::move(resolver),
+                     std::make_unique<MockExecutor>()});
+
+    const std::vector<std::string> args;
+    const Voix::CommandOptions options;
+    alloc_counter::Phase allocations;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(voix.execute("true", args, options));
+    }
+    report_allocations(state, allocations);
+}
+BENCHMARK(BM_Pipeline)->RangeMultiplier(10)->Range(10, 10000);
+
+void BM_LoggerLog(benchmark::State& state) {
+    Voix::Logger::suppress_stderr = true;
+    Voix::Logger logger;
+    alloc_counter::Phase allocations;
+    for (auto _ : state) {
+        logger.log("INFO", "bench: alice ran /usr/bin/true as root in /home/alice");
+    }
+    report_allocations(state, allocations);
+}
+BENCHMARK(BM_LoggerLog);
+
+} // namespace
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::AddCustomContext("voix_version", VOIX_VERSION);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,379 @@
+/**
+ * @file voix_e2e.cpp
+ * @brief End-to-end latency of `voix true`, from fork to the final wait
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ *
+ * Runs the voix binary of a VOIX_ENABLE_HARNESS build as an installed setuid
+ * binary would run, without installing it: the harness runs as root, and each
+ * child takes the caller's real UID, GID and groups while keeping effective
+ * UID 0 (what exec of a setuid-root file gives) before executing voix.
+ *
+ * voix reads a generated policy through -C that lets the caller run `true`
+ * as an unprivileged target (nobody by default), authenticates (with --auth)
+ * against a PAM service that always succeeds, and writes no audit records.
+ * Every subject (voix, `true` itself, and `sudo -n`/`doas -n` when present)
+ * is timed warm, and cold with its binary and configuration evicted from
+ * the page cache; page faults and context switches come from wait4().
+ * Syscalls are counted in a separate pass under ptrace, which would
+ * otherwise distort the timings.
+ *
+ *   cmake -B build-e2e -DVOIX_ENABLE_HARNESS=ON && cmake --build build-e2e
+ *   ./build-e2e/voix_e2e --runs 5000 --caller alice --json > e2e.json
+ */
+
+#include "harness.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <getopt.h>
+#include <optional>
+#include <print>
+#include <string>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#ifndef VOIX_BINARY
+#define VOIX_BINARY "voix"
+#endif
+
+namespace {
+
+using harness::Caller;
+
+// One command to compare, and the files a cold run evicts first.
+struct Subject {
+    std::string name;
+    std::vector<std::string> argv;
+    std::vector<std::string> files;
+};
+
+struct Sample {
+    std::uint64_t ns;
+    long minflt;
+    long majflt;
+    long nvcsw;
+    long nivcsw;
+    bool ok;
+};
+
+struct Options {
+    std::string voix = VOIX_BINARY;
+    std::string caller;
+    std::string target = "nobody";
+    unsigned runs = 2000;
+    unsigned cold_runs = 200;
+    unsigned syscall_runs = 50;
+    bool auth = false;
+    bool compare = true;
+    bool json = false;
+};
+
+bool write_file(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream out(path);
+    out << content;
+    return static_cast<bool>(out);
+}
+
+void evict(const std::vector<std::string>& files) {
+    for (const auto& file : files) {
+        int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1) continue;
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+}
+
+Sample run_once(const Subject& subject, const Caller& caller, const std::vector<char*>& envp) {
+    std::vector<std::string> args = subject.argv;
+    auto argv = harness::c_strings(args);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pid_t pid = fork();
+    if (pid == 0) harness::exec_as_caller(caller, argv, envp);
+    int status = 0;
+    struct rusage usage{};
+    if (pid == -1 || wait4(pid, &status, 0, &usage) != pid) return {0, 0, 0, 0, 0, false};
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    const std::uint64_t ns = static_cast<std::uint64_t>(end.tv_sec - start.tv_sec) * 1'000'000'000ULL +
+                             static_cast<std::uint64_t>(end.tv_nsec) - static_cast<std::uint64_t>(start.tv_nsec);
+    return {ns, usage.ru_minflt, usage.ru_majflt, usage.ru_nvcsw, usage.ru_nivcsw,
+            WIFEXITED(status) && WEXITSTATUS(status) == 0};
+}
+
+struct SyscallCount {
+    std::uint64_t total = 0;
+    std::uint64_t before_target_exec = 0;  // Up to the exec of the command voix runs.
+};
+
+// Counts syscall entries of the subject and every process it starts.
+std::optional<SyscallCount> count_syscalls(const Subject& subject, const Caller& caller,
+                                           const std::vector<char*>& envp) {
+    std::vector<std::string> args = subject.argv;
+    auto argv = harness::c_strings(args);
+
+    SyscallCount count;
+    std::vector<pid_t> in_syscall;
+    unsigned execs = 0;
+    auto on_stop = [&](pid_t pid, unsigned event) {
+        if (event == 0) {
+            // Entry and exit stops alternate per thread; count entries.
+            auto it = std::ranges::find(in_syscall, pid);
+            if (it == in_syscall.end()) {
+                in_syscall.push_back(pid);
+                ++count.total;
+                if (execs < 2) ++count.before_target_exec;
+            } else {
+                in_syscall.erase(it);
+            }
+        } else if (event == PTRACE_EVENT_EXEC) {
+            // The first exec is the subject itself, the second its command.
+            ++execs;
+            std::erase(in_syscall, pid);
+        }
+    };
+    if (!harness::trace_tree(caller, argv, envp, on_stop, [&](pid_t pid) { std::erase(in_syscall, pid); })) {
+        return std::nullopt;
+    }
+    return count;
+}
+
+struct Summary {
+    std::string subject;
+    std::string mode;
+    size_t runs = 0;
+    size_t failures = 0;
+    double p50_us = 0, p90_us = 0, p99_us = 0, max_us = 0, mean_us = 0;
+    double minflt = 0, majflt = 0, ctxsw = 0;
+    std::optional<double> syscalls;
+    std::optional<double> syscalls_to_exec;
+};
+
+Summary summarize(const std::string& subject, const std::string& mode, std::vector<Sample> samples) {
+    Summary s;
+    s.subject = subject;
+    s.mode = mode;
+    s.runs = samples.size();
+    std::vector<std::uint64_t> ns;
+    for (const auto& sample : samples) {
+        if (!sample.ok) {
+            ++s.failures;
+            continue;
+        }
+        ns.push_back(sample.ns);
+        s.minflt += static_cast<double>(sample.minflt);
+        s.majflt += static_cast<double>(sample.majflt);
+        s.ctxsw += static_cast<double>(sample.nvcsw + sample.nivcsw);
+    }
+    if (ns.empty()) return s;
+    std::ranges::sort(ns);
+    auto rank = [&](double q) {
+        size_t index = static_cast<size_t>(q * static_cast<double>(ns.size()) + 0.999999);
+        return static_cast<double>(ns[std::clamp<size_t>(index, 1, ns.size()) - 1]) / 1000.0;
+    };
+    const double n = static_cast<double>(ns.size());
+    s.p50_us = rank(0.50);
+    s.p90_us = rank(0.90);
+    s.p99_us = rank(0.99);
+    s.max_us = static_cast<double>(ns.back()) / 1000.0;
+    double total = 0;
+    for (auto v : ns) total += static_cast<double>(v);
+    s.mean_us = total / n / 1000.0;
+    s.minflt /= n;
+    s.majflt /= n;
+    s.ctxsw /= n;
+    return s;
+}
+
+void print_table(const std::vector<Summary>& summaries) {
+    std::println("{:<10} {:<5} {:>6} {:>5} {:>9} {:>9} {:>9} {:>9} {:>8} {:>7} {:>7} {:>9} {:>9}", "subject",
+                 "mode", "runs", "fail", "p50 us", "p90 us", "p99 us", "max us", "minflt", "majflt", "ctxsw",
+                 "syscalls", "to exec");
+    for (const auto& s : summaries) {
+        auto opt = [](const std::optional<double>& v) { return v ? std::format("{:.0f}", *v) : std::string("-"); };
+        std::println("{:<10} {:<5} {:>6} {:>5} {:>9.1f} {:>9.1f} {:>9.1f} {:>9.1f} {:>8.1f} {:>7.2f} {:>7.1f} {:>9} {:>9}",
+                     s.subject, s.mode, s.runs, s.failures, s.p50_us, s.p90_us, s.p99_us, s.max_us, s.minflt,
+                     s.majflt, s.ctxsw, opt(s.syscalls), opt(s.syscalls_to_exec));
+    }
+}
+
+void print_json(const std::vector<Summary>& summaries, const Caller& caller, const std::string& target) {
+    auto opt = [](const std::optional<double>& v) { return v ? std::format("{:.1f}", *v) : std::string("null"); };
+    std::println("{{\"caller\": \"{}\", \"target\": \"{}\", \"results\": [", caller.name, target);
+    for (size_t i = 0; i < summaries.size(); ++i) {
+        const auto& s = summaries[i];
+        std::println("  {{\"subject\": \"{}\", \"mode\": \"{}\", \"runs\": {}, \"failures\": {}, "
+                     "\"p50_us\": {:.1f}, \"p90_us\": {:.1f}, \"p99_us\": {:.1f}, \"max_us\": {:.1f}, "
+                     "\"mean_us\": {:.1f}, \"minflt\": {:.1f}, \"majflt\": {:.2f}, \"ctxsw\": {:.1f}, "
+                     "\"syscalls\": {}, \"syscalls_to_exec\": {}}}{}",
+                     s.subject, s.mode, s.runs, s.failures, s.p50_us, s.p90_us, s.p99_us, s.max_us, s.mean_us,
+                     s.minflt, s.majflt, s.ctxsw, opt(s.syscalls), opt(s.syscalls_to_exec),
+                     i + 1 < summaries.size() ? "," : "");
+    }
+    std::println("]}}");
+}
+
+void usage() {
+    std::print("Usage: voix_e2e [options]\n\n"
+               "  --voix PATH          voix binary built with VOIX_ENABLE_HARNESS (default: this build's)\n"
+               "  --runs N             Warm runs per subject (default 2000)\n"
+               "  --cold-runs N        Runs with binary and configuration evicted (default 200)\n"
+               "  --syscall-runs N     Runs traced to count syscalls (default 50; 0 skips)\n"
+               "  --caller USER        Invoke voix as USER (default: root)\n"
+               "  --target USER        Run `true` as USER (default: nobody)\n"
+               "  --auth               Require authentication (through an always-succeeding PAM service)\n"
+               "  --no-compare         Do not run sudo and doas\n"
+               "  --json               Print JSON instead of a table\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    static struct option long_options[] = {
+        {"voix", required_argument, nullptr, 'v'},
+        {"runs", required_argument, nullptr, 'r'},
+        {"cold-runs", required_argument, nullptr, 'c'},
+        {"syscall-runs", required_argument, nullptr, 's'},
+        {"caller", required_argument, nullptr, 'u'},
+        {"target", required_argument, nullptr, 't'},
+        {"auth", no_argument, nullptr, 'a'},
+        {"no-compare", no_argument, nullptr, 'n'},
+        {"json", no_argument, nullptr, 'j'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int ch;
+    while ((ch = getopt_long(argc, argv, "h", long_options, nullptr)) != -1) {
+        switch (ch) {
+            case 'v': options.voix = optarg; break;
+            case 'r': options.runs = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'c': options.cold_runs = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 's': options.syscall_runs = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'u': options.caller = optarg; break;
+            case 't': options.target = optarg; break;
+            case 'a': options.auth = true; break;
+            case 'n': options.compare = false; break;
+            case 'j': options.json = true; break;
+            case 'h': usage(); return 0;
+            default: usage(); return 2;
+        }
+    }
+
+    if (getuid() != 0) {
+        std::println(stderr, "voix_e2e: must run as root to start voix as a setuid binary would run");
+        return 2;
+    }
+    auto caller = harness::lookup_caller(options.caller);
+    if (!caller) {
+        std::println(stderr, "voix_e2e: unknown caller '{}'", options.caller);
+        return 2;
+    }
+    const std::string true_path = harness::find_program("true");
+    const std::string voix_path = std::filesystem::absolute(options.voix).string();
+
+    char dir_template[] = "/tmp/voix-e2e-XXXXXX";
+    if (!mkdtemp(dir_template)) {
+        std::println(stderr, "voix_e2e: mkdtemp: {}", std::strerror(errno));
+        return 2;
+    }
+    const std::filesystem::path dir = dir_template;
+    const auto config = dir / "voix.conf";
+    const std::string pam_env = harness::write_pam_service(dir);
+    write_file(config, std::format("core:\n"
+                                   "  paths: [{5}]\n"
+                                   "  sanctuary: {0}\n"
+                                   "  persist_dir: {0}/persist\n"
+                                   "  audit_dir: \"\"\n"
+                                   "  audit_sinks: []\n"
+                                   "acl:\n  user:\n    {1}:\n"
+                                   "      - {{action: permit, target: {2}, command: {3}{4}}}\n",
+                                   dir.string(), caller->name, options.target, true_path,
+                                   options.auth ? "" : ", options: [nopass]",
+                                   std::filesystem::path(true_path).parent_path().string()));
+    chmod(config.c_str(), 0600);
+
+    std::vector<std::string> env_storage{"PATH=/usr/bin:/bin", "HOME=/", "LANG=C", pam_env};
+    const auto envp = harness::c_strings(env_storage);
+
+    std::vector<Subject> subjects;
+    std::vector<std::string> voix_argv{voix_path, "-C", config.string(), "-u", options.target};
+    if (!options.auth) voix_argv.push_back("-n");
+    voix_argv.push_back("true");
+    subjects.push_back({"voix", voix_argv, {voix_path, config.string(), true_path}});
+    subjects.push_back({"true", {true_path}, {true_path}});
+    if (options.compare) {
+        if (auto sudo = harness::find_program("sudo"); !sudo.empty()) {
+            subjects.push_back({"sudo", {sudo, "-n", "-u", options.target, true_path}, {sudo, "/etc/sudoers"}});
+        }
+        if (auto doas = harness::find_program("doas"); !doas.empty()) {
+            subjects.push_back({"doas", {doas, "-n", "-u", options.target, true_path}, {doas, "/etc/doas.conf"}});
+        }
+    }
+
+    // voix must work before its numbers mean anything.
+    if (!run_once(subjects.front(), *caller, envp).ok) {
+        std::println(stderr, "voix_e2e: `{} -C {} -u {} true` failed for {}; is it a VOIX_ENABLE_HARNESS build?",
+                     voix_path, config.string(), options.target, caller->name);
+        std::filesystem::remove_all(dir);
+        return 1;
+    }
+
+    std::vector<Summary> summaries;
+    for (const auto& subject : subjects) {
+        std::vector<Sample> cold;
+        for (unsigned i = 0; i < options.cold_runs; ++i) {
+            evict(subject.files);
+            cold.push_back(run_once(subject, *caller, envp));
+        }
+        std::vector<Sample> warm;
+        for (unsigned i = 0; i < options.runs; ++i) warm.push_back(run_once(subject, *caller, envp));
+
+        std::optional<double> syscalls, to_exec;
+        if (options.syscall_runs > 0) {
+            double total = 0, before = 0;
+            unsigned counted = 0;
+            for (unsigned i = 0; i < options.syscall_runs; ++i) {
+                auto count = count_syscalls(subject, *caller, envp);
+                if (!count) continue;
+                total += static_cast<double>(count->total);
+                before += static_cast<double>(count->before_target_exec);
+                ++counted;
+            }
+            if (counted > 0) {
+                syscalls = total / counted;
+                // `true` execs nothing further.
+                if (subject.name != "true") to_exec = before / counted;
+            }
+        }
+        auto warm_summary = summarize(subject.name, "warm", std::move(warm));
+        warm_summary.syscalls = syscalls;
+        warm_summary.syscalls_to_exec = to_exec;
+        summaries.push_back(std::move(warm_summary));
+        if (options.cold_runs > 0) summaries.push_back(summarize(subject.name, "cold", std::move(cold)));
+    }
+    std::filesystem::remove_all(dir);
+
+    if (options.json) {
+        print_json(summaries, *caller, options.target);
+    } else {
+        std::println("caller {} (uid {}) as {}, {} warm and {} cold runs per subject\n", caller->name,
+                     caller->uid, options.target, options.runs, options.cold_runs);
+        print_table(summaries);
+    }
+    return 0;
+}
@@ -0,0 +1,413 @@
+/**
+ * @file voix_stress.cpp
+ * @brief Concurrent invocations of voix against shared logs and counters
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ *
+ * Starts --invocations runs of the voix binary of a VOIX_ENABLE_HARNESS build,
+ * at most --concurrency at a time and, with --rate, no faster than that many
+ * per second, the way a CI fan-out hits an installed voix. Like voix_e2e it
+ * runs as root and starts each voix as exec of the setuid binary would (real
+ * IDs the caller's, effective UID 0).
+ *
+ * Every invocation runs `true stress-<n>` under one generated policy, so all
+ * of them share the policy file, the text log (moved off /var/log with
+ * VOIX_HARNESS_LOG), the indexed audit store and the rule hit counters in
+ * the sanctuary, and with --auth the persist timestamp cache. Latency is
+ * measured from fork to the reaping of voix (which has become `true`) and
+ * reported as p50/p99/p999 with the throughput. Afterwards the shared state
+ * is checked:
+ *
+ *   log       one permit record per invocation, no warnings or errors, and
+ *             no torn or spliced lines
+ *   store     one record per invocation, found by a full scan and through
+ *             the index, each naming its own stress-<n> exactly once
+ *   counters  the rule's hit count equals the number of invocations
+ *
+ * Exit status 1 means an invocation failed or a check did not hold; 77 means
+ * the check could not run here.
+ *
+ *   voix_stress --invocations 20000 --concurrency 256 --rate 2000
+ */
+
+#include "audit_store.hpp"
+#include "config.hpp"
+#include "harness.hpp"
+#include "rule_stats.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <getopt.h>
+#include <iterator>
+#include <optional>
+#include <print>
+#include <string>
+#include <string_view>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#ifndef VOIX_BINARY
+#define VOIX_BINARY "voix"
+#endif
+
+namespace {
+
+using harness::Caller;
+using harness::k_exit_skip;
+
+struct Options {
+    std::string voix = VOIX_BINARY;
+    std::string caller = "nobody";
+    std::string target = "nobody";
+    unsigned invocations = 2000;
+    unsigned concurrency = 64;
+    unsigned rate = 0;  // Starts per second; 0 starts whenever a slot is free.
+    bool auth = false;
+    bool json = false;
+};
+
+struct Run {
+    std::uint64_t ns;
+    bool ok;
+};
+
+// What the shared state looked like afterwards.
+struct Integrity {
+    size_t log_records = 0;
+    size_t log_other = 0;   // Other intact lines, such as INFO and authentication records.
+    size_t log_errors = 0;  // WARN and ERROR lines.
+    size_t log_torn = 0;    // Lines without a record prefix or with two, or an unterminated tail.
+    size_t store_records = 0;
+    size_t store_indexed = 0;
+    size_t store_bad = 0;   // Records that are not one JSON object naming one invocation.
+    size_t store_missing = 0;
+    size_t store_duplicate = 0;
+    std::optional<std::uint64_t> rule_hits;
+
+    bool holds(size_t invocations) const {
+        return log_records == invocations && log_errors == 0 && log_torn == 0 &&
+               store_records == invocations && store_indexed == invocations && store_bad == 0 &&
+               store_missing == 0 && store_duplicate == 0 && rule_hits == invocations;
+    }
+};
+
+std::uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1'000'000'000ULL + static_cast<std::uint64_t>(ts.tv_nsec);
+}
+
+// Starts the invocations on schedule and reaps them as they finish. SIGCHLD
+// stays blocked so the wait for the next exit or start time is a single
+// sigtimedwait().
+std::vector<Run> run_all(const Options& options, const Caller& caller, const std::vector<std::string>& base_argv,
+                         const std::vector<char*>& envp, std::uint64_t& wall_ns) {
+    sigset_t chld;
+    sigemptyset(&chld);
+    sigaddset(&chld, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &chld, nullptr);
+
+    std::vector<Run> runs;
+    runs.reserve(options.invocations);
+    std::unordered_map<pid_t, std::uint64_t> started;
+    const std::uint64_t interval = options.rate ? 1'000'000'000ULL / options.rate : 0;
+    const std::uint64_t begin = now_ns();
+    std::uint64_t next_start = begin;
+    unsigned launched = 0;
+
+    while (runs.size() < options.invocations) {
+        std::uint64_t now = now_ns();
+        while (launched < options.invocations && started.size() < options.concurrency && now >= next_start) {
+            std::vector<std::string> args = base_argv;
+            args.push_back(std::format("stress-{}", launched));
+            auto argv = harness::c_strings(args);
+
+            const std::uint64_t start = now_ns();
+            pid_t pid = fork();
+            if (pid == 0) harness::exec_as_caller(caller, argv, envp);
+            if (pid == -1) {
+                runs.push_back({0, false});
+            } else {
+                started.emplace(pid, start);
+            }
+            ++launched;
+            next_start += interval;
+            now = now_ns();
+        }
+
+        int status = 0;
+        pid_t pid;
+        bool reaped = false;
+        while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+            const std::uint64_t end = now_ns();
+            auto it = started.find(pid);
+            if (it == started.end()) continue;
+            runs.push_back({end - it->second, WIFEXITED(status) && WEXITSTATUS(status) == 0});
+            started.erase(it);
+            reaped = true;
+        }
+        if (reaped || runs.size() >= options.invocations) continue;
+
+        // Nothing finished: sleep until a child exits or the next start is due.
+        struct timespec timeout{1, 0};
+        if (launched < options.invocations && started.size() < options.concurrency) {
+            const std::uint64_t wait = next_start > now ? next_start - now : 0;
+            timeout = {static_cast<time_t>(wait / 1'000'000'000ULL), static_cast<long>(wait % 1'000'000'000ULL)};
+        }
+        if (timeout.tv_sec != 0 || timeout.tv_nsec != 0) sigtimedwait(&chld, nullptr, &timeout);
+    }
+    wall_ns = now_ns() - begin;
+    sigprocmask(SIG_UNBLOCK, &chld, nullptr);
+    return runs;
+}
+
+// The number in the only "stress-<n>" of a record, if there is exactly one.
+std::optional<unsigned> invocation_of(std::string_view record) {
+    constexpr std::string_view marker = "\"stress-";
+    auto pos = record.find(marker);
+    if (pos == std::string_view::npos || record.find(marker, pos + 1) != std::string_view::npos) return std::nullopt;
+    const char* first = record.data() + pos + marker.size();
+    const char* last = record.data() + record.size();
+    unsigned n = 0;
+    auto [ptr, ec] = std::from_chars(first, last, n);
+    if (ec != std::errc{} || ptr == last || *ptr != '"') return std::nullopt;
+    return n;
+}
+
+// Whether a "[YYYY-MM-DD HH:MM:SS] [" record prefix starts at @p pos.
+bool record_prefix_at(std::string_view line, size_t pos) {
+    if (line.size() < pos + 23 || line[pos] != '[' || line.substr(pos + 20, 3) != "] [") return false;
+    for (size_t i : {1, 2, 3, 4, 6, 7, 9, 10, 12, 13, 15, 16, 18, 19}) {
+        if (line[pos + i] < '0' || line[pos + i] > '9') return false;
+    }
+    return true;
+}
+
+void check_log(const std::filesystem::path& log, const std::string& prefix, Integrity& result) {
+    std::ifstream in(log, std::ios::binary);
+    const std::string text(std::istreambuf_iterator<char>(in), {});
+    if (!text.empty() && text.back() != '\n') ++result.log_torn;
+
+    // "[YYYY-MM-DD HH:MM:SS] [LEVEL] message", one record per line; a second
+    // prefix inside a line means two writes were spliced together.
+    size_t begin = 0;
+    while (begin < text.size()) {
+        size_t end = text.find('\n', begin);
+        if (end == std::string::npos) break;
+        std::string_view line(text.data() + begin, end - begin);
+        begin = end + 1;
+        const size_t level_end = record_prefix_at(line, 0) ? line.find("] ", 23) : std::string_view::npos;
+        bool spliced = false;
+        for (size_t pos = line.find('[', 1); pos != std::string_view::npos && !spliced; pos = line.find('[', pos + 1)) {
+            spliced = record_prefix_at(line, pos);
+        }
+        if (level_end == std::string_view::npos || spliced) {
+            ++result.log_torn;
+            continue;
+        }
+        const std::string_view level = line.substr(23, level_end - 23);
+        if (level == "WARN" || level == "ERROR") {
+            ++result.log_errors;
+        } else if (line.substr(22).starts_with(prefix)) {
+            ++result.log_records;
+        } else {
+            ++result.log_other;
+        }
+    }
+}
+
+void check_store(const std::filesystem::path& dir, const std::string& command, unsigned invocations,
+                 Integrity& result) {
+    Voix::AuditStore store(dir.string(), 64ULL << 20);
+    std::vector<unsigned> seen(invocations, 0);
+    auto scanned = store.query({}, [&](std::string_view record) {
+        ++result.store_records;
+        auto n = invocation_of(record);
+        if (!record.starts_with('{') || !record.ends_with('}') || !n || *n >= invocations) {
+            ++result.store_bad;
+            return;
+        }
+        ++seen[*n];
+    });
+    if (!scanned) return;
+    for (unsigned count : seen) {
+        if (count == 0) ++result.store_missing;
+        if (count > 1) ++result.store_duplicate;
+    }
+
+    Voix::AuditQuery by_command;
+    by_command.command = command;
+    store.query(by_command, [&](std::string_view) { ++result.store_indexed; });
+}
+
+void check_counters(const std::filesystem::path& policy, Integrity& result) {
+    Voix::Config config;
+    if (!config.load(policy.string(), false)) return;
+    auto counters = Voix::RuleHitCounters::open(config.get_rule_stats_path(), config.getRules(), false);
+    if (!counters) return;
+    auto counts = counters->counts();
+    if (!counts.empty()) result.rule_hits = counts.front();
+}
+
+double rank_us(const std::vector<std::uint64_t>& sorted, double q) {
+    if (sorted.empty()) return 0;
+    size_t index = static_cast<size_t>(q * static_cast<double>(sorted.size()) + 0.999999);
+    return static_cast<double>(sorted[std::clamp<size_t>(index, 1, sorted.size()) - 1]) / 1000.0;
+}
+
+void usage() {
+    std::print("Usage: voix_stress [options]\n\n"
+               "  --voix PATH          voix binary built with VOIX_ENABLE_HARNESS (default: this build's)\n"
+               "  --invocations N      Total invocations (default 2000)\n"
+               "  --concurrency N      Invocations running at once, at most (default 64)\n"
+               "  --rate N             Starts per second, at most (default: no limit)\n"
+               "  --caller USER        Invoke voix as USER (default: nobody)\n"
+               "  --target USER        Run `true` as USER (default: nobody)\n"
+               "  --auth               Authenticate with `persist` (always-succeeding PAM service)\n"
+               "  --json               Print JSON instead of a table\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    static struct option long_options[] = {
+        {"voix", required_argument, nullptr, 'v'},
+        {"invocations", required_argument, nullptr, 'i'},
+        {"concurrency", required_argument, nullptr, 'c'},
+        {"rate", required_argument, nullptr, 'r'},
+        {"caller", required_argument, nullptr, 'u'},
+        {"target", required_argument, nullptr, 't'},
+        {"auth", no_argument, nullptr, 'a'},
+        {"json", no_argument, nullptr, 'j'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int ch;
+    while ((ch = getopt_long(argc, argv, "h", long_options, nullptr)) != -1) {
+        switch (ch) {
+            case 'v': options.voix = optarg; break;
+            case 'i': options.invocations = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'c': options.concurrency = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'r': options.rate = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'u': options.caller = optarg; break;
+            case 't': options.target = optarg; break;
+            case 'a': options.auth = true; break;
+            case 'j': options.json = true; break;
+            case 'h': usage(); return 0;
+            default: usage(); return 2;
+        }
+    }
+
+    if (getuid() != 0) {
+        std::println(stderr, "voix_stress: skipped, must run as root to start voix as a setuid binary would run");
+        return k_exit_skip;
+    }
+    auto caller = harness::lookup_caller(options.caller);
+    if (!caller) {
+        std::println(stderr, "voix_stress: unknown caller '{}'", options.caller);
+        return 2;
+    }
+    const std::string true_path = harness::find_program("true");
+    const std::string voix_path = std::filesystem::absolute(options.voix).string();
+
+    char dir_template[] = "/tmp/voix-stress-XXXXXX";
+    if (!mkdtemp(dir_template)) {
+        std::println(stderr, "voix_stress: mkdtemp: {}", std::strerror(errno));
+        return 2;
+    }
+    const std::filesystem::path dir = dir_template;
+    const auto policy = dir / "voix.conf";
+    const auto log = dir / "voix.log";
+    const std::string pam_env = harness::write_pam_service(dir);
+    {
+        std::ofstream(policy) << std::format("core:\n"
+                                             "  paths: [{4}]\n"
+                                             "  sanctuary: {0}\n"
+                                             "  persist_dir: {0}/persist\n"
+                                             "  audit_dir: {0}/audit\n"
+                                             "  audit_sinks: [file]\n"
+                                             "acl:\n  user:\n    {1}:\n"
+                                             "      - {{action: permit, target: {2}, command: {3}, options: [{5}]}}\n",
+                                             dir.string(), caller->name, options.target, true_path,
+                                             std::filesystem::path(true_path).parent_path().string(),
+                                             options.auth ? "persist" : "nopass");
+    }
+    chmod(policy.c_str(), 0600);
+
+    const std::string log_env = std::format("VOIX_HARNESS_LOG={}", log.string());
+    std::vector<std::string> env_storage{"PATH=/usr/bin:/bin", "HOME=/", "LANG=C", pam_env, log_env};
+    const auto envp = harness::c_strings(env_storage);
+
+    std::vector<std::string> base_argv{voix_path, "-C", policy.string(), "-u", options.target};
+    if (!options.auth) base_argv.push_back("-n");
+    base_argv.push_back("true");
+
+    std::uint64_t wall_ns = 0;
+    auto runs = run_all(options, *caller, base_argv, envp, wall_ns);
+
+    Integrity integrity;
+    // The authentication method in the detail differs between the first
+    // persist run and the rest.
+    check_log(log, std::format("[SECURITY] [{}] Command permitted: {} as {} (auth=", caller->name, true_path,
+                               options.target), integrity);
+    check_store(dir / "audit", true_path, options.invocations, integrity);
+    check_counters(policy, integrity);
+    std::filesystem::remove_all(dir);
+
+    std::vector<std::uint64_t> ns;
+    size_t failures = 0;
+    for (const auto& run : runs) {
+        if (run.ok) ns.push_back(run.ns);
+        else ++failures;
+    }
+    std::ranges::sort(ns);
+    const double seconds = static_cast<double>(wall_ns) / 1e9;
+    const double throughput = seconds > 0 ? static_cast<double>(runs.size()) / seconds : 0;
+    const double max_us = ns.empty() ? 0 : static_cast<double>(ns.back()) / 1000.0;
+    const bool holds = integrity.holds(options.invocations);
+    const std::string hits = integrity.rule_hits ? std::to_string(*integrity.rule_hits) : "null";
+
+    if (options.json) {
+        std::println("{{\"invocations\": {}, \"concurrency\": {}, \"rate\": {}, \"failures\": {}, "
+                     "\"seconds\": {:.3f}, \"per_second\": {:.1f}, \"p50_us\": {:.1f}, \"p99_us\": {:.1f}, "
+                     "\"p999_us\": {:.1f}, \"max_us\": {:.1f}, \"log_records\": {}, \"log_other\": {}, "
+                     "\"log_errors\": {}, \"log_torn\": {}, \"store_records\": {}, \"store_indexed\": {}, "
+                     "\"store_bad\": {}, \"store_missing\": {}, \"store_duplicate\": {}, \"rule_hits\": {}, "
+                     "\"intact\": {}}}",
+                     options.invocations, options.concurrency, options.rate, failures, seconds, throughput,
+                     rank_us(ns, 0.50), rank_us(ns, 0.99), rank_us(ns, 0.999), max_us, integrity.log_records,
+                     integrity.log_other, integrity.log_errors, integrity.log_torn, integrity.store_records,
+                     integrity.store_indexed, integrity.store_bad, integrity.store_missing,
+                     integrity.store_duplicate, hits, holds);
+    } else {
+        std::println("{} invocations by {} as {}, {} at once, {}\n", options.invocations, caller->name,
+                     options.target, options.concurrency,
+                     options.rate ? std::format("at most {}/s", options.rate) : std::string("unthrottled"));
+        std::println("{:>5} {:>8} {:>9} {:>9} {:>9} {:>9} {:>10}", "fail", "seconds", "p50 us", "p99 us",
+                     "p999 us", "max us", "per second");
+        std::println("{:>5} {:>8.2f} {:>9.1f} {:>9.1f} {:>9.1f} {:>9.1f} {:>10.1f}\n", failures, seconds,
+                     rank_us(ns, 0.50), rank_us(ns, 0.99), rank_us(ns, 0.999), max_us, throughput);
+        std::println("log       {} records, {} other lines, {} errors, {} torn", integrity.log_records,
+                     integrity.log_other, integrity.log_errors, integrity.log_torn);
+        std::println("store     {} records ({} through the index), {} malformed, {} missing, {} duplicated",
+                     integrity.store_records, integrity.store_indexed, integrity.store_bad,
+                     integrity.store_missing, integrity.store_duplicate);
+        std::println("counters  {} rule hits", hits);
+        std::println("\n{}", holds ? "shared state intact" : "SHARED STATE DAMAGED");
+    }
+    return failures == 0 && holds ? 0 : 1;
+}
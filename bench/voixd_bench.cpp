@@ -0,0 +1,121 @@
+/**
+ * @file voixd_bench.cpp
+ * @brief Latency and throughput of standalone vs. voixd-brokered policy decisions
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ *
+ * Standalone mode pays the configuration parse and rule resolution on every
+ * invocation, as a fresh `voix` process does. Broker mode pays one socket
+ * round trip to an AuthorizationBroker that keeps the policy resident. The
+ * range argument is the number of rules in the synthetic policy; the matching
+ * rule is always last, the worst case for first-match evaluation.
+ *
+ *   cmake -B build -DVOIX_BUILD_BENCHMARKS=ON && cmake --build build
+ *   ./build/bench/voixd_bench --benchmark_counters_tabular=true
+ */
+
+#include "authorization.hpp"
+#include "broker.hpp"
+#include "command_resolver.hpp"
+#include "config.hpp"
+#include "permission_checker.hpp"
+#include "security.hpp"
+#include "system_utils.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+std::filesystem::path bench_path(std::string_view name, std::int64_t rules) {
+    return std::filesystem::temp_directory_path() /
+           std::format("voix_bench_{}_{}_{}", name, getpid(), rules);
+}
+
+// Writes a policy of `rules` permit rules for the calling user; only the last
+// one permits /usr/bin/true.
+std::filesystem::path write_policy(std::int64_t rules) {
+    auto path = bench_path("conf", rules);
+    auto self = Voix::lookup_passwd_by_uid(getuid());
+    std::ofstream out(path);
+    out << "core:\n  paths: [/bin, /usr/bin]\n"
+        << "acl:\n  user:\n    " << (self ? self->name : "root") << ":\n";
+    for (std::int64_t i = 0; i + 1 < rules; ++i) {
+        out << "      - action: permit\n        command: /usr/bin/bench-" << i << "\n";
+    }
+    out << "      - action: permit\n        command: /usr/bin/true\n";
+    return path;
+}
+
+const Voix::AuthorizationRequest k_request{"root", "/usr/bin/true", {}, "/"};
+
+void BM_StandaloneDecision(benchmark::State& state) {
+    auto path = write_policy(state.range(0));
+    for (auto _ : state) {
+        auto config = std::make_shared<Voix::Config>();
+        config->load(path.string(), false);
+        auto security = std::make_shared<Voix::Security>();
+        Voix::PermissionChecker checker(security, config);
+        Voix::CommandResolver resolver(config->getPath());
+        auto decision = Voix::authorize(*config, *security, checker, resolver, k_request);
+        benchmark::DoNotOptimize(decision);
+    }
+    state.SetItemsProcessed(state.iterations());
+    std::filesystem::remove(path);
+}
+
+// One broker per rule count, shared by all benchmark threads.
+struct BrokerFixture {
+    std::filesystem::path config_path;
+    std::filesystem::path socket_path;
+    std::unique_ptr<Voix::AuthorizationBroker> broker;
+    std::thread server;
+
+    explicit BrokerFixture(std::int64_t rules)
+        : config_path(write_policy(rules)), socket_path(bench_path("sock", rules)),
+          broker(std::make_unique<Voix::AuthorizationBroker>(config_path.string(), false)) {
+        broker->reload();
+        broker->listen(socket_path.string());
+        server = std::thread([this] { broker->serve(); });
+    }
+    ~BrokerFixture() {
+        broker->stop();
+        server.join();
+        broker.reset();
+        std::filesystem::remove(config_path);
+    }
+};
+
+void BM_BrokerDecision(benchmark::State& state) {
+    static std::unique_ptr<BrokerFixture> fixture;
+    if (state.thread_index() == 0) fixture = std::make_unique<BrokerFixture>(state.range(0));
+    // The benchmark threads synchronize at the start of the loop, after
+    // thread 0 has brought the broker up.
+    auto socket_path = bench_path("sock", state.range(0)).string();
+    for (auto _ : state) {
+        auto client = Voix::BrokerClient::connect(socket_path, getuid());
+        if (!client) {
+            state.SkipWithError("broker unreachable");
+            break;
+        }
+        auto decision = client->query(k_request);
+        benchmark::DoNotOptimize(decision);
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) fixture.reset();
+}
+
+} // namespace
+
+BENCHMARK(BM_StandaloneDecision)->Arg(10)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BrokerDecision)->Arg(10)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond)
+    ->ThreadRange(1, 8)->UseRealTime();
+
+BENCHMARK_MAIN();
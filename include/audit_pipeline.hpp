@@ -0,0 +1,123 @@
+/**
+ * @file audit_pipeline.h
+ * @brief Structured audit events routed to the configured sinks
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#ifndef AUDIT_PIPELINE_H
+#define AUDIT_PIPELINE_H
+
+#include "audit_store.hpp"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <vector>
+
+namespace Voix {
+
+/**
+ * @brief The stage of a request an audit event reports.
+ */
+enum class AuditStage : std::uint8_t {
+    DECISION,           /**< Policy verdict (permit only once authenticated). */
+    AUTHENTICATION,     /**< Authentication of a permitted request failed. */
+    SESSION,            /**< The PAM session could not be opened. */
+    FINISHED,           /**< A supervised command exited; detail holds its resource usage. */
+    TIMESTAMP_CLEARED   /**< The caller invalidated their persist timestamp (`-k`). */
+};
+
+/**
+ * @brief One audit event, built once per request stage.
+ */
+struct AuditEvent {
+    AuditStage stage = AuditStage::DECISION;  /**< Stage reported. */
+    std::string outcome;            /**< `permit`, `deny`, `auth-failed`, `catastrophic`, `invalid-target`, ... */
+    uid_t caller_uid = 0;           /**< Real UID of the invoking user. */
+    std::string caller;             /**< Name of the invoking user. */
+    std::string target;             /**< Target user name. */
+    std::string command;            /**< Resolved command path (or the typed name). */
+    std::vector<std::string> args;  /**< Command arguments. */
+    std::string cwd;                /**< Caller's working directory. */
+    std::string detail;             /**< Stage-specific detail (e.g. resource usage). */
+};
+
+/**
+ * @brief Formats audit events once and hands them to each configured sink.
+ *
+ * Sinks are the audit log file (through Logger), syslog, the journald native
+ * protocol and the indexed AuditStore (verdicts only). The journald sink
+ * sends one datagram with structured `VOIX_*` fields over a socket opened
+ * once per process; if the datagram cannot be delivered the event goes to
+ * syslog instead, unless syslog is already a sink.
+ */
+class AuditPipeline {
+public:
+    /**
+     * @brief Sinks an event can be routed to.
+     */
+    enum Sink : unsigned {
+        SINK_FILE = 0x1,      /**< /var/log/voix.log (syslog when it cannot be opened). */
+        SINK_SYSLOG = 0x2,    /**< syslog(3), LOG_AUTHPRIV. */
+        SINK_JOURNALD = 0x4   /**< journald native protocol. */
+    };
+
+    /**
+     * @brief Constructor for AuditPipeline.
+     * @param sinks Combination of Sink flags.
+     * @param store_dir Directory of the indexed audit store; empty for none.
+     * @param segment_size Segment size of the audit store.
+     * @param journal_socket Path of journald's native socket.
+     */
+    AuditPipeline(unsigned sinks, const std::string& store_dir, std::uint64_t segment_size,
+                  std::string journal_socket = "/run/systemd/journal/socket");
+    /**
+     * @brief Default destructor for AuditPipeline.
+     */
+    ~AuditPipeline() = default;
+
+    /**
+     * @brief Formats @p event and writes it to every sink.
+     * @param event The event.
+     */
+    void emit(const AuditEvent& event) const;
+
+    /**
+     * @brief Maps a sink name (`file`, `syslog`, `journald`) to its flag.
+     * @param name The name.
+     * @return The flag, or std::nullopt if unknown.
+     */
+    static std::optional<Sink> parse_sink(std::string_view name);
+    /**
+     * @brief Builds the human-readable message of an event.
+     * @param event The event.
+     * @return The message.
+     */
+    static std::string message(const AuditEvent& event);
+    /**
+     * @brief Encodes an event as a journald native protocol datagram.
+     * @param event The event.
+     * @param message The event's message (MESSAGE field).
+     * @return The datagram payload.
+     */
+    static std::string journal_entry(const AuditEvent& event, std::string_view message);
+
+private:
+    /**
+     * @brief Formats @p event once and writes it to the text sinks.
+     * @param event The event.
+     */
+    void emit_text(const AuditEvent& event) const;
+
+    unsigned sinks_;
+    std::optional<AuditStore> store_;
+    std::string journal_socket_;
+};
+
+} // namespace Voix
+
+#endif // AUDIT_PIPELINE_H
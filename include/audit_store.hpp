@@ -0,0 +1,135 @@
+/**
+ * @file audit_store.h
+ * @brief Indexed, segmented audit log
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#ifndef AUDIT_STORE_H
+#define AUDIT_STORE_H
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <vector>
+
+namespace Voix {
+
+/**
+ * @brief One authorization outcome, as stored in the audit log.
+ */
+struct AuditRecord {
+    std::int64_t time = 0;          /**< Unix seconds; 0 to stamp the record when it is appended. */
+    uid_t caller_uid = 0;           /**< Real UID of the invoking user. */
+    std::string caller;             /**< Name of the invoking user. */
+    std::string target;             /**< Target user name. */
+    std::string command;            /**< Resolved command path (or the typed name if unresolved). */
+    std::vector<std::string> args;  /**< Command arguments. */
+    std::string verdict;            /**< `permit`, `deny`, `auth-failed`, `catastrophic` or `invalid-target`. */
+    std::string cwd;                /**< Caller's working directory. */
+};
+
+/**
+ * @brief Filters for AuditStore::query(); unset fields match everything.
+ */
+struct AuditQuery {
+    std::optional<std::int64_t> since;      /**< Earliest time (inclusive, Unix seconds). */
+    std::optional<std::int64_t> until;      /**< End of the range (exclusive, Unix seconds). */
+    std::optional<uid_t> caller_uid;        /**< Invoking user. */
+    std::optional<std::string> target;      /**< Target user name. */
+    std::optional<std::string> command;     /**< Absolute path, or a bare name matching any directory. */
+};
+
+/**
+ * @brief Append-only audit log made of JSON-lines segments with binary sidecar indexes.
+ *
+ * Records go to `current.log`; a fixed-size entry (time, caller UID, hashes
+ * of the target and of the command's base name, offset, length) goes to
+ * `current.idx`. Appends are serialized with flock() on `.lock`. Once the
+ * active segment reaches the size limit it is renamed to `<seq>.log`, and
+ * seal_pending() later seals it: with VOIX_WITH_ZLIB the data is recompressed
+ * in independently inflatable blocks into `<seq>.seg` and the index gains a
+ * block table.
+ * Queries mmap the indexes, skip sealed segments outside the time range by
+ * their header and only read the records whose index entries match.
+ */
+class AuditStore {
+public:
+    /**
+     * @brief Constructor for AuditStore.
+     * @param directory Directory holding the segments (created 0700 if missing).
+     * @param segment_size Size at which the active segment is sealed.
+     * @param owner UID that must own the directory (root in production).
+     */
+    AuditStore(std::string directory, std::uint64_t segment_size, uid_t owner = 0);
+    /**
+     * @brief Default destructor for AuditStore.
+     */
+    ~AuditStore() = default;
+
+    /**
+     * @brief Appends a record, rolling the active segment over first when it is full.
+     * @param record The record.
+     * @return True if the record and its index entry were written.
+     */
+    bool append(const AuditRecord& record) const;
+    /**
+     * @brief Seals the segments append() has rolled over.
+     *
+     * Compression takes seconds for a full segment, so it is left to
+     * `--audit-query` rather than the request that fills the segment. Does
+     * nothing while another process is sealing.
+     *
+     * @return The number of segments sealed.
+     */
+    size_t seal_pending() const;
+    /**
+     * @brief Streams the records matching @p query, oldest segment first.
+     * @param query The filters.
+     * @param out Receives each matching record (one JSON object, no newline).
+     * @return The number of records passed to @p out, or std::nullopt if the directory cannot be read.
+     */
+    std::optional<size_t> query(const AuditQuery& query,
+                                const std::function<void(std::string_view)>& out) const;
+
+    /**
+     * @brief Serializes a record as a single JSON line (without the newline).
+     * @param record The record.
+     * @return The JSON object.
+     */
+    static std::string to_json(const AuditRecord& record);
+    /**
+     * @brief Parses a `--audit-query` expression.
+     *
+     * Space-separated `key=value` terms: `since` and `until` (`YYYY-MM-DD`,
+     * `YYYY-MM-DDTHH:MM:SS` in UTC, `@<unix seconds>`, or an age such as
+     * `90m`, `24h`, `7d`), `user` (name or UID), `target` and `command`.
+     *
+     * @param expression The expression; empty matches everything.
+     * @param now Current Unix time, for ages.
+     * @return The query, or std::nullopt with @p error set.
+     */
+    static std::optional<AuditQuery> parse_query(std::string_view expression, std::int64_t now,
+                                                 std::string& error);
+
+private:
+    /**
+     * @brief Opens the directory and verifies it is private to the owner.
+     * @param create Whether to create the directory when missing.
+     * @return A directory file descriptor, or -1 on failure.
+     */
+    int open_directory(bool create) const;
+
+    std::string directory_;
+    std::uint64_t segment_size_;
+    uid_t owner_;
+};
+
+} // namespace Voix
+
+#endif // AUDIT_STORE_H
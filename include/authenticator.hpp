@@ -12,6 +12,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 
 // Forward declaration of pam struct
 struct pam_handle;
@@ -20,6 +21,7 @@ namespace Voix {
 
 class Security;
 class Rule;
+class TimestampCache;
 
 /**
  * @brief Interface for user authentication.
@@ -42,6 +44,16 @@ public:
      * @brief Closes the current session.
      */
     virtual void closeSession() = 0;
+    /**
+     * @brief Reports whether closeSession() has work to do.
+     * @return True if a session is open that must be closed after the command exits.
+     */
+    virtual bool has_session() const = 0;
+    /**
+     * @brief Reports how the last successful authenticate() was satisfied.
+     * @return `nopass`, `root`, `persist` or `pam`; recorded in the permit audit event.
+     */
+    virtual std::string_view method() const = 0;
 };
 
 /**
@@ -53,8 +65,11 @@ public:
      * @brief Constructor for PamAuthenticator.
      * @param security Pointer to the security manager.
      * @param non_interactive Whether authentication should be non-interactive.
+     * @param timestamps Optional persist-mode timestamp cache, consulted only for
+     *                   rules carrying the `persist` option.
      */
-    PamAuthenticator(std::shared_ptr<Security> security, bool non_interactive);
+    PamAuthenticator(std::shared_ptr<Security> security, bool non_interactive,
+                     std::shared_ptr<TimestampCache> timestamps = nullptr);
     /**
      * @brief Destructor for PamAuthenticator.
      */
@@ -63,11 +78,15 @@ public:
     bool authenticate(const std::optional<Rule>& rule) override;
     bool openSession() override;
     void closeSession() override;
+    bool has_session() const override;
+    std::string_view method() const override;
 
 private:
     std::shared_ptr<Security> security_;
+    std::shared_ptr<TimestampCache> timestamps_;
     bool non_interactive_;
     struct pam_handle* pamh_ = nullptr;
+    std::string_view method_;
 };
 
 } // namespace Voix
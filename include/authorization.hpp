@@ -0,0 +1,96 @@
+/**
+ * @file authorization.h
+ * @brief Policy evaluation shared by the standalone client and the voixd broker
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#ifndef AUTHORIZATION_H
+#define AUTHORIZATION_H
+
+#include "command.hpp"
+#include "rule.hpp"
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Voix {
+
+class ICommandResolver;
+class Config;
+class Security;
+class PermissionChecker;
+
+/**
+ * @brief A single request to run a command as another user.
+ */
+struct AuthorizationRequest {
+    std::string target_user = "root";  /**< Name of the user to run the command as. */
+    std::string command;               /**< Command as typed by the caller. */
+    std::vector<std::string> args;     /**< Command arguments. */
+    std::string cwd;                   /**< Caller's working directory (for relative path arguments). */
+};
+
+/**
+ * @brief Outcome of evaluating an AuthorizationRequest against the policy.
+ *
+ * Carries everything the client needs after the decision, so a client served
+ * by voixd never has to parse the configuration itself.
+ */
+struct AuthorizationDecision {
+    /**
+     * @brief Result of the policy evaluation.
+     */
+    enum class Verdict : std::uint8_t {
+        PERMIT,          /**< A permit rule matched; see rule and context. */
+        DENY,            /**< No rule matched, or a deny rule matched first. */
+        CATASTROPHIC,    /**< The command is on the catastrophic blocklist. */
+        INVALID_TARGET   /**< The target user does not exist. */
+    };
+
+    Verdict verdict = Verdict::DENY;            /**< The decision. */
+    Rule rule;                                  /**< Matched rule (valid for PERMIT only). */
+    std::optional<size_t> rule_index;           /**< Position of the first matching rule, permit or deny. */
+    ExecutionContext context;                   /**< Resolved execution context (PERMIT only). */
+    std::string persist_dir;                    /**< core.persist_dir of the evaluated policy. */
+    std::chrono::seconds persist_timeout{0};    /**< core.persist_timeout of the evaluated policy. */
+    std::string audit_dir;                      /**< core.audit_dir of the evaluated policy. */
+    std::uint64_t audit_segment_size = 0;       /**< core.audit_segment_mb of the evaluated policy, in bytes. */
+    unsigned audit_sinks = 0;                   /**< core.audit_sinks of the evaluated policy (AuditPipeline::Sink flags). */
+    bool suppress_stderr = true;                /**< core.suppress_stderr of the evaluated policy. */
+    bool login_shell_default = false;           /**< core.login_shell of the evaluated policy. */
+    // Set by voixd, which leaves counting the hit to the voix process.
+    std::string rule_stats_path;                /**< Hit counter file of the evaluated policy. */
+    std::uint64_t rules_fingerprint = 0;        /**< RuleHitCounters::fingerprint() of the evaluated policy. */
+    std::uint64_t rule_count = 0;               /**< Number of rules in the evaluated policy. */
+};
+
+/**
+ * @brief Evaluates a request against the policy.
+ *
+ * Resolves the command to a file once, then performs the catastrophic-command
+ * check, target lookup, rule matching and profile resolution against both the
+ * typed name and the resolved path (and the blocklist against the file's
+ * identity). The resolved command travels in the decision's context so the
+ * same file is executed. The caller's identity comes from the Security
+ * instance behind @p checker, the target's from @p security's identity.
+ * Authentication is not part of the decision.
+ *
+ * @param config The loaded configuration.
+ * @param security Security instance used for the catastrophic-command check and target lookup.
+ * @param checker Permission checker bound to the caller's identity.
+ * @param resolver Resolver over the configuration's PATH.
+ * @param request The request to evaluate.
+ * @return The decision.
+ */
+AuthorizationDecision authorize(const Config& config, const Security& security,
+                                const PermissionChecker& checker, ICommandResolver& resolver,
+                                const AuthorizationRequest& request);
+
+} // namespace Voix
+
+#endif // AUTHORIZATION_H
@@ -0,0 +1,174 @@
+/**
+ * @file broker.h
+ * @brief voixd authorization broker and its client
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#ifndef BROKER_H
+#define BROKER_H
+
+#include "authorization.hpp"
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+
+struct ucred;
+
+namespace Voix {
+
+class Config;
+class CachingIdentity;
+class CommandResolver;
+
+/**
+ * @brief Default socket voixd listens on and voix tries first.
+ */
+inline constexpr std::string_view k_broker_socket_path = "/run/voixd.sock";
+
+/**
+ * @brief Whether a command is a path relative to the caller's directory.
+ *
+ * voixd would have to look it up as root in a directory the caller names, so
+ * such commands are always evaluated by voix itself.
+ */
+inline bool is_relative_command(std::string_view command) {
+    return !command.starts_with('/') && command.find('/') != std::string_view::npos;
+}
+
+/**
+ * @brief Resident policy evaluator behind a Unix stream socket.
+ *
+ * Keeps the parsed configuration and an identity cache warm across requests.
+ * Each connection carries exactly one request; the caller's identity is taken
+ * from SO_PEERCRED, never from the request itself. Requests for a relative
+ * command path are refused, and rule hits are counted by the client, since a
+ * query alone runs nothing. The configuration is
+ * re-read when its inode or mtime changes, so edits take effect on the next
+ * request without a restart.
+ *
+ * Connections are multiplexed on one thread with epoll: requests are buffered
+ * until complete and only then evaluated, and a peer that has not received its
+ * reply within a short deadline is dropped. A client that connects and goes
+ * quiet therefore delays no one else.
+ *
+ * Wire format: every frame is a native-endian u32 length followed by the
+ * payload; strings are u32 length + bytes. Both sides run on the same host.
+ */
+class AuthorizationBroker {
+public:
+    /**
+     * @brief Constructor for AuthorizationBroker.
+     * @param config_path Path to the configuration file.
+     * @param verify_security Whether to verify ownership/permissions of the configuration.
+     */
+    explicit AuthorizationBroker(std::string config_path, bool verify_security = true);
+    /**
+     * @brief Destructor; closes and unlinks the listening socket.
+     */
+    ~AuthorizationBroker();
+
+    AuthorizationBroker(const AuthorizationBroker&) = delete;
+    AuthorizationBroker& operator=(const AuthorizationBroker&) = delete;
+
+    /**
+     * @brief Loads the configuration if it changed since the last load.
+     * @return True if a valid configuration is available, false otherwise.
+     */
+    bool reload();
+
+    /**
+     * @brief Binds and listens on a Unix socket (mode 0666; access is decided per request).
+     * @param socket_path Filesystem path of the socket. A stale socket is replaced.
+     * @return True on success, false otherwise.
+     */
+    bool listen(std::string_view socket_path = k_broker_socket_path);
+
+    /**
+     * @brief Accepts and answers connections until stop() is called.
+     *
+     * Single-threaded; the policy state is never shared between threads.
+     */
+    void serve();
+
+    /**
+     * @brief Asks serve() to return. Async-signal-safe.
+     */
+    void stop();
+
+private:
+    /**
+     * @brief Evaluates one complete request frame.
+     * @param cred Peer credentials of the connection (SO_PEERCRED).
+     * @param payload Request payload without its length prefix.
+     * @return The encoded decision frame, or an empty string to close without a reply.
+     */
+    std::string answer(const struct ucred& cred, std::string_view payload);
+
+    std::string config_path_;
+    bool verify_security_;
+    std::shared_ptr<Config> config_;
+    std::unique_ptr<CommandResolver> resolver_;  // resident PATH lookup cache for config_
+    std::uint64_t rules_fingerprint_ = 0;        // RuleHitCounters::fingerprint of config_
+    std::shared_ptr<CachingIdentity> identity_;
+    dev_t config_dev_ = 0;
+    ino_t config_ino_ = 0;
+    struct timespec config_mtime_{};
+    std::string socket_path_;
+    int listen_fd_ = -1;
+    std::atomic<bool> stopping_{false};
+};
+
+/**
+ * @brief Client side of the voixd protocol, used by the setuid `voix` binary.
+ */
+class BrokerClient {
+public:
+    /**
+     * @brief Connects to a running broker.
+     *
+     * The socket must be owned by @p owner; the connection is made with the
+     * effective UID temporarily set to the real UID so that SO_PEERCRED on the
+     * broker side reports the invoking user.
+     *
+     * @param socket_path Filesystem path of the broker socket.
+     * @param owner UID that must own the socket (root in production).
+     * @return A connected client, or nullptr if no trustworthy broker is reachable.
+     */
+    static std::unique_ptr<BrokerClient> connect(std::string_view socket_path = k_broker_socket_path,
+                                                 uid_t owner = 0);
+    /**
+     * @brief Destructor; closes the connection.
+     */
+    ~BrokerClient();
+
+    BrokerClient(const BrokerClient&) = delete;
+    BrokerClient& operator=(const BrokerClient&) = delete;
+
+    /**
+     * @brief Sends a request and waits for the decision. Consumes the connection.
+     * @param request The request to evaluate.
+     * @return The decision, or std::nullopt on any transport or protocol error.
+     */
+    std::optional<AuthorizationDecision> query(const AuthorizationRequest& request);
+
+private:
+    /**
+     * @brief Constructor for BrokerClient.
+     * @param fd A connected socket.
+     */
+    explicit BrokerClient(int fd);
+
+    int fd_;
+};
+
+} // namespace Voix
+
+#endif // BROKER_H
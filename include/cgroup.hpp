@@ -0,0 +1,64 @@
+/**
+ * @file cgroup.h
+ * @brief cgroup v2 placement for security profiles
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#ifndef CGROUP_H
+#define CGROUP_H
+
+#include "file_utils.hpp"
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Voix {
+
+/**
+ * @brief The cgroup a profile's commands run in and the limits written to it.
+ */
+struct CgroupLimits {
+    std::string path;  /**< Absolute cgroup v2 directory (`<core.cgroup_root>/<profile>`); empty for none. */
+    std::vector<std::pair<std::string, std::string>> controls;  /**< Interface file and value, e.g. `memory.max`, `2G`. */
+
+    /**
+     * @brief Checks whether the profile asks for a cgroup.
+     * @return True if no cgroup is configured.
+     */
+    bool empty() const { return path.empty(); }
+};
+
+/**
+ * @brief Checks whether voix may write a cgroup interface file.
+ *
+ * Only the limits of the cpu, memory, io and pids controllers are accepted:
+ * `cpu.max`, `cpu.weight`, `memory.max`, `memory.high`, `memory.swap.max`,
+ * `io.max`, `io.weight` and `pids.max`.
+ *
+ * @param file The interface file name.
+ * @return True if the file is one of the accepted limits.
+ */
+bool is_cgroup_control(std::string_view file);
+
+/**
+ * @brief Creates or reuses the cgroup in @p limits and writes its limits.
+ *
+ * The parent directory is created when missing and must be on a cgroup2
+ * mount. Controllers the limits need are enabled in the parent's
+ * `cgroup.subtree_control` the first time their interface file is missing.
+ * The limits are rewritten on every call, so a reloaded configuration takes
+ * effect for the next command.
+ *
+ * @param limits The cgroup and its limits.
+ * @return A close-on-exec descriptor of the cgroup directory (for
+ *         CLONE_INTO_CGROUP or `cgroup.procs`), or an empty handle on failure.
+ */
+SharedFd prepare_cgroup(const CgroupLimits& limits);
+
+} // namespace Voix
+
+#endif // CGROUP_H
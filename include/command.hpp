@@ -9,8 +9,14 @@
 #ifndef COMMAND_H
 #define COMMAND_H
 
+#include "command_resolver.hpp"
 #include "config.hpp"
+#include "exec_plan.hpp"
 #include "rule.hpp"
+#include "supervisor.hpp"
+#include <expected>
+#include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -25,12 +31,57 @@ struct CommandOptions {
     bool login_shell = false;  /**< Whether to execute the command as a login shell. */
     bool list_commands = false; /**< Whether to list available commands. */
     bool check_config = false; /**< Whether to check configuration. */
+    bool exec_in_place = false; /**< Replace the current process instead of forking (see Command::use_exec_in_place). */
+};
+
+/**
+ * @brief Everything the child needs from the configuration for one request.
+ *
+ * Resolved once per request, either locally from the Config or by the voixd
+ * broker, so the execution path never has to consult the configuration.
+ */
+struct ExecutionContext {
+    SecurityProfile profile;      /**< Resolved security profile (see Command::resolve_profile). */
+    std::string path;             /**< Trusted PATH used for resolution and exported to the child. */
+    bool seccomp_enabled = true;  /**< Global seccomp switch from the configuration. */
+    std::shared_ptr<const EnvPolicy> env_policy;  /**< Compiled environment policy; null selects EnvPolicy::defaults(). */
+    std::vector<std::string> rule_env;            /**< The matched rule's `env:` entries. */
+    ResolvedCommand command;                      /**< The authorized file; nothing is executed if empty. */
+};
+
+/**
+ * @brief Interface for running an authorized command.
+ *
+ * Command switches credentials and executes the command for real; in-process
+ * simulations of the request pipeline substitute a fake.
+ */
+class IExecutor {
+public:
+    virtual ~IExecutor() = default;
+    /**
+     * @brief Executes a command with an already resolved execution context.
+     * @param command The command to execute.
+     * @param args The arguments for the command.
+     * @param context The resolved profile, PATH, seccomp switch, environment policy and command.
+     * @param options The options for command execution.
+     * @param rule The matched rule.
+     * @param user The user to execute the command as.
+     * @param report If non-null, receives the supervised child's status and resource usage.
+     * @return The return code of the command, or a non-zero value on failure.
+     */
+    virtual int execute(std::string_view command,
+                        const std::vector<std::string>& args,
+                        const ExecutionContext& context,
+                        const CommandOptions& options,
+                        const Rule& rule,
+                        std::string_view user,
+                        std::optional<ChildReport>* report) const = 0;
 };
 
 /**
  * @brief Handles the execution of commands with given options and configuration.
  */
-class Command {
+class Command : public IExecutor {
 public:
     /**
      * @brief Default constructor for Command.
@@ -39,7 +90,7 @@ public:
     /**
      * @brief Default destructor for Command.
      */
-    ~Command() = default;
+    ~Command() override = default;
 
     /**
      * @brief Executes a command with given arguments and options.
@@ -57,6 +108,41 @@ public:
                  const Rule& rule,
                  std::string_view user = "root") const;
 
+    /**
+     * @brief Executes a command with an already resolved execution context.
+     *
+     * Unless executing in place, voix supervises the child (see
+     * supervise_child()), enforcing the rule's timeout and kill_after.
+     *
+     * @param command The command to execute.
+     * @param args The arguments for the command.
+     * @param context The resolved profile, PATH and seccomp switch.
+     * @param options The options for command execution.
+     * @param rule The matched rule.
+     * @param user The user to execute the command as.
+     * @param report If non-null, receives the supervised child's status and resource usage
+     *        (left empty when the command replaced voix or never started).
+     * @return The return code of the command (124 after a timeout), or a non-zero value on failure.
+     */
+    int execute(std::string_view command,
+                 const std::vector<std::string>& args,
+                 const ExecutionContext& context,
+                 const CommandOptions& options,
+                 const Rule& rule,
+                 std::string_view user = "root",
+                 std::optional<ChildReport>* report = nullptr) const override;
+
+    /**
+     * @brief Resolves the execution context for a matched rule and target.
+     * @param config The configuration.
+     * @param rule The matched rule.
+     * @param target_user The target user name.
+     * @return The resolved ExecutionContext.
+     */
+    static ExecutionContext resolve_context(const Config& config,
+                                            const Rule& rule,
+                                            std::string_view target_user);
+
     /**
      * @brief Resolves the security profile to apply for a matched rule and target.
      *
@@ -78,6 +164,21 @@ public:
                                           const Rule& rule,
                                           std::string_view target_user);
 
+    /**
+     * @brief Decides whether the command can replace the voix process.
+     *
+     * voix only has to outlive the command when a PAM session must be closed
+     * afterwards, when a timeout must be enforced, or when the profile asks
+     * for the fork-and-wait path.
+     *
+     * @param profile The resolved security profile.
+     * @param session_open Whether the authenticator holds a session to close.
+     * @param timeout The matched rule's timeout (zero for none).
+     * @return True to execve() in place, false to fork and wait.
+     */
+    static bool use_exec_in_place(const SecurityProfile& profile, bool session_open,
+                                  std::chrono::seconds timeout = std::chrono::seconds::zero());
+
     /**
      * @brief Builds a command string for logging or debugging.
      * @param command The command.
@@ -89,11 +190,25 @@ public:
                                     const std::vector<std::string>& args,
                                     std::string_view user) const;
 
-private:
     /**
-     * @brief Sets resource limits for the executed command.
+     * @brief Precomputes everything the child does before execve().
+     *
+     * Resolves the target's passwd entry and groups, the environment, the
+     * executable path, resource limits and the seccomp program, so that the
+     * child only has to issue system calls.
+     *
+     * @param command The command to execute.
+     * @param args The arguments for the command.
+     * @param context The resolved profile, PATH, seccomp switch, environment policy and command.
+     * @param options The options for command execution.
+     * @param user The user to execute the command as.
+     * @return The plan, or the exit status to report (127 if the command cannot be found, 1 otherwise).
      */
-    void setResourceLimits() const;
+    std::expected<ExecPlan, int> build_exec_plan(std::string_view command,
+                                                 const std::vector<std::string>& args,
+                                                 const ExecutionContext& context,
+                                                 const CommandOptions& options,
+                                                 std::string_view user) const;
 };
 
 } // namespace Voix
@@ -0,0 +1,137 @@
+/**
+ * @file command_resolver.h
+ * @brief Resolve-once command identity
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#ifndef COMMAND_RESOLVER_H
+#define COMMAND_RESOLVER_H
+
+#include "file_utils.hpp"
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <unordered_map>
+#include <vector>
+
+namespace Voix {
+
+/**
+ * @brief A command resolved to a verified file.
+ *
+ * Rule matching, the blocklist and execution all refer to this one file: the
+ * child executes @ref fd with execveat(), so the file that was checked is the
+ * file that runs.
+ */
+struct ResolvedCommand {
+    std::string path;  /**< Absolute path the command was found at. */
+    dev_t dev = 0;     /**< Device of the file. */
+    ino_t ino = 0;     /**< Inode of the file. */
+    SharedFd fd;       /**< O_PATH descriptor of the file (empty when received from voixd). */
+
+    /**
+     * @brief Checks whether a command was resolved.
+     * @return True if @ref path is set.
+     */
+    bool found() const { return !path.empty(); }
+};
+
+/**
+ * @brief Interface for resolving the command of a request.
+ *
+ * CommandResolver searches the filesystem; in-process simulations of the
+ * request pipeline substitute a fake.
+ */
+class ICommandResolver {
+public:
+    virtual ~ICommandResolver() = default;
+    /**
+     * @brief Resolves a command name or path.
+     * @param command The command as typed by the caller.
+     * @param cwd The caller's working directory, if not ours.
+     * @return The verified command, or std::nullopt if not found or unsafe.
+     */
+    virtual std::optional<ResolvedCommand> resolve(std::string_view command, std::string_view cwd = {}) = 0;
+};
+
+/**
+ * @brief Resolves commands against the trusted PATH through pre-opened directories.
+ *
+ * Each PATH directory is opened once with O_PATH; lookups are openat() + fstat()
+ * relative to those descriptors. Hits are cached by name together with the
+ * (dev, ino, mtime) of the file and of the directories searched, so a repeat
+ * lookup (voixd serves many) re-validates with fstat() calls and a single
+ * openat() instead of walking PATH again. Any change to a directory on the
+ * way (an entry added that could shadow the hit) or to the file falls back to
+ * a full walk.
+ *
+ * A file found through PATH or given as a relative path is accepted only if
+ * it is a regular file owned by root and not writable by group or others; an
+ * absolute path only has to name a regular file.
+ */
+class CommandResolver : public ICommandResolver {
+public:
+    /**
+     * @brief Opens the directories of a PATH list.
+     * @param path_list Colon-separated absolute directories (Config::getPath()).
+     */
+    explicit CommandResolver(std::string_view path_list);
+    /**
+     * @brief Closes the directory descriptors.
+     */
+    ~CommandResolver() override;
+    CommandResolver(const CommandResolver&) = delete;
+    CommandResolver& operator=(const CommandResolver&) = delete;
+
+    /**
+     * @brief Resolves a command name or path.
+     *
+     * Names without '/' are searched in the PATH directories; anything else is
+     * taken as a path, relative ones against @p cwd (or the current directory).
+     *
+     * @param command The command as typed by the caller.
+     * @param cwd The caller's working directory, if not ours.
+     * @return The verified command, or std::nullopt if not found or unsafe.
+     */
+    std::optional<ResolvedCommand> resolve(std::string_view command, std::string_view cwd = {}) override;
+
+    /**
+     * @brief Reopens a command resolved elsewhere (voixd) and checks it is unchanged.
+     * @param command The resolved command; @ref ResolvedCommand::fd is set on success.
+     * @return True if @p command.path still names the same safe file.
+     */
+    static bool reopen(ResolvedCommand& command);
+
+    /**
+     * @brief Gets the PATH list the resolver was built for.
+     * @return The colon-separated list.
+     */
+    const std::string& path_list() const { return path_list_; }
+
+private:
+    struct Directory {
+        std::string path;
+        int fd = -1;
+    };
+    struct CacheEntry {
+        size_t dir_index;
+        dev_t dev;
+        ino_t ino;
+        struct timespec mtime;
+        std::vector<struct timespec> dir_mtimes;  // directories 0..dir_index when cached
+    };
+
+    std::optional<ResolvedCommand> lookup_cached(const std::string& name) const;
+
+    std::string path_list_;
+    std::vector<Directory> dirs_;
+    std::unordered_map<std::string, CacheEntry> cache_;
+};
+
+} // namespace Voix
+
+#endif // COMMAND_RESOLVER_H
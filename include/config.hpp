@@ -10,6 +10,9 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include "cgroup.hpp"
+#include "env_policy.hpp"
+#include "process_tuning.hpp"
 #include "rule.hpp"
 #include <string>
 #include <string_view>
@@ -18,10 +21,22 @@
 #include <optional>
 #include <regex>
 #include <map>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <sys/types.h>
 #include <yaml-cpp/yaml.h>
 
 namespace Voix {
 
+/**
+ * @brief How the target command is started.
+ */
+enum class ExecMode : std::uint8_t {
+    AUTO,  /**< Replace voix with the command unless a PAM session must be closed afterwards. */
+    FORK   /**< Always fork and wait, keeping voix as the parent. */
+};
+
 struct SecurityProfile {
     bool retain_full_capabilities = false;
     bool enable_seccomp = true;
@@ -31,6 +46,11 @@ struct SecurityProfile {
     // loader/interpreted-language variables (LD_*, PYTHON*, etc.). Intended
     // only for confined system targets such as the package-manager user.
     bool preserve_full_environment = false;
+    ExecMode exec_mode = ExecMode::AUTO;
+    // cgroup v2 group the profile's commands start in, with its limits.
+    CgroupLimits cgroup{};
+    // Scheduling, I/O priority, CPU/NUMA placement and rlimit overrides.
+    ProcessTuning tuning{};
 };
 
 class Config {
@@ -51,6 +71,15 @@ public:
      * @return True if the configuration was loaded successfully, false otherwise.
      */
     bool load(std::string_view config_path, bool verify_security = true);
+    /**
+     * @brief Loads configuration from YAML text, as load() does after reading the file.
+     *
+     * Used by in-process simulations, which keep the policy in memory.
+     *
+     * @param content The YAML document.
+     * @return True if the configuration was parsed successfully, false otherwise.
+     */
+    bool load_from_string(const std::string& content);
     /**
      * @brief Gets the list of rules from the configuration.
      * @return A vector of Rule objects.
@@ -91,6 +120,17 @@ public:
      * @return A reference to the compiled blocklist vector.
      */
     const std::vector<std::regex>& get_compiled_blocklist() const { return compiled_blocklist_; }
+    /**
+     * @brief Checks whether a file is one named by an absolute blocklist entry.
+     *
+     * Absolute entries are stat()ed at load, so the file is blocked under any
+     * name (`sh`, `/bin/sh`, `/usr/bin/sh` on merged-/usr systems).
+     *
+     * @param dev Device of the file.
+     * @param ino Inode of the file.
+     * @return True if blocked, false otherwise.
+     */
+    bool is_blocked_file(dev_t dev, ino_t ino) const;
     /**
      * @brief Gets the security profile associated with a name.
      * @param name The profile name.
@@ -114,6 +154,46 @@ public:
      * @return A reference to the unconfined targets vector.
      */
     const std::vector<std::string>& get_unconfined_targets() const { return unconfined_targets_; }
+    /**
+     * @brief Gets the directory holding persist-mode authentication timestamps.
+     * @return The timestamp directory path.
+     */
+    const std::string& get_persist_dir() const { return persist_dir_; }
+    /**
+     * @brief Gets how long a persist-mode authentication is honored.
+     * @return The timestamp lifetime; zero disables persist.
+     */
+    std::chrono::seconds get_persist_timeout() const { return persist_timeout_; }
+    /**
+     * @brief Gets the cgroup v2 directory holding one cgroup per profile.
+     * @return The cgroup root path.
+     */
+    const std::string& get_cgroup_root() const { return cgroup_root_; }
+    /**
+     * @brief Gets the directory of the indexed audit store.
+     * @return The audit directory; empty when the store is disabled.
+     */
+    const std::string& get_audit_dir() const { return audit_dir_; }
+    /**
+     * @brief Gets the file holding the per-rule hit counters.
+     * @return `<sanctuary>/voix-rule-hits`.
+     */
+    std::string get_rule_stats_path() const { return sanctuary_ + "/voix-rule-hits"; }
+    /**
+     * @brief Gets the size at which the active audit segment is sealed.
+     * @return The segment size in bytes.
+     */
+    std::uint64_t get_audit_segment_size() const { return audit_segment_size_; }
+    /**
+     * @brief Gets the sinks audit events are routed to.
+     * @return A combination of AuditPipeline::Sink flags.
+     */
+    unsigned get_audit_sinks() const { return audit_sinks_; }
+    /**
+     * @brief Gets the compiled environment policy (`security.environment`).
+     * @return The shared, immutable policy.
+     */
+    const std::shared_ptr<const EnvPolicy>& get_env_policy() const { return env_policy_; }
     /**
      * @brief Validates the configuration schema and path permissions.
      * @return True if valid, false otherwise.
@@ -128,7 +208,15 @@ private:
     std::map<std::string, SecurityProfile> security_profiles_;
     std::vector<std::string> blocklist_;
     std::vector<std::regex> compiled_blocklist_;
+    std::vector<std::pair<dev_t, ino_t>> blocked_files_;
     std::vector<std::string> unconfined_targets_;
+    std::string persist_dir_ = "/run/voix";
+    std::chrono::seconds persist_timeout_{300};
+    std::string cgroup_root_ = "/sys/fs/cgroup/voix";
+    std::string audit_dir_ = "/var/log/voix";
+    std::uint64_t audit_segment_size_ = 64ULL << 20;
+    unsigned audit_sinks_ = 0x3;  // AuditPipeline::SINK_FILE | SINK_SYSLOG
+    std::shared_ptr<const EnvPolicy> env_policy_;
     bool seccomp_enabled_ = true;
     bool login_shell_default_ = false;
     bool suppress_stderr_ = true;
@@ -0,0 +1,140 @@
+/**
+ * @file env_policy.h
+ * @brief Compiled environment policy for the target command
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#ifndef ENV_POLICY_H
+#define ENV_POLICY_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace Voix {
+
+/**
+ * @brief Decides which inherited variables reach the target command.
+ *
+ * Three name lists drive the policy; an entry ending in `*` matches by prefix:
+ *   - keep:  passed through when the environment is scrubbed (the default).
+ *   - check: passed through when scrubbed if the value contains no `/` or `%`.
+ *   - deny:  removed even when the caller preserves the environment (-E, keepenv).
+ *
+ * The lists are compiled once into hash sets and per-first-byte prefix tables,
+ * so classifying a variable costs one hash lookup plus a scan of the prefixes
+ * sharing its first byte.
+ */
+class EnvPolicy {
+public:
+    /**
+     * @brief How much of the caller's environment the target receives.
+     */
+    enum class Mode : std::uint8_t {
+        SCRUB,     /**< Only keep-listed and valid check-listed variables. */
+        SANITIZE,  /**< Everything except deny-listed variables. */
+        FULL       /**< Everything (unconfined system targets). */
+    };
+
+    /**
+     * @brief Result of applying the policy.
+     *
+     * Inherited entries point into the caller's environ and are not copied.
+     */
+    struct Result {
+        std::vector<const char*> inherited;  /**< Caller entries passed through unchanged. */
+        std::vector<std::string> assigned;   /**< Entries set by voix or the rule, as NAME=value. */
+    };
+
+    /**
+     * @brief Constructs the built-in default policy.
+     */
+    EnvPolicy();
+    /**
+     * @brief Constructs a policy from explicit lists.
+     * @param keep Names kept when scrubbing.
+     * @param check Names kept when scrubbing if their value is safe.
+     * @param deny Names removed when sanitizing.
+     */
+    EnvPolicy(std::vector<std::string> keep, std::vector<std::string> check,
+              std::vector<std::string> deny);
+
+    /**
+     * @brief Computes the target environment in one pass over @p environ.
+     *
+     * Rule entries follow doas' setenv semantics: `VAR=value` sets a variable,
+     * `-VAR` removes an inherited one, and a bare `VAR` passes the caller's
+     * value through regardless of the mode. Rule assignments override
+     * @p assignments with the same name.
+     *
+     * @param environ The caller's null-terminated environment.
+     * @param mode How much of the environment to keep.
+     * @param assignments Variables voix sets itself (PATH, HOME, ...), as NAME=value.
+     * @param rule_env The matched rule's `env:` entries.
+     * @return The inherited and assigned entries forming the final envp.
+     */
+    Result apply(const char* const* environ, Mode mode,
+                 std::span<const std::string> assignments,
+                 std::span<const std::string> rule_env) const;
+
+    /**
+     * @brief Returns the shared built-in default policy.
+     * @return The default policy.
+     */
+    static const EnvPolicy& defaults();
+
+    /** @brief Source keep list. @return The list. */
+    const std::vector<std::string>& keep() const { return keep_.patterns(); }
+    /** @brief Source check list. @return The list. */
+    const std::vector<std::string>& check() const { return check_.patterns(); }
+    /** @brief Source deny list. @return The list. */
+    const std::vector<std::string>& deny() const { return deny_.patterns(); }
+
+private:
+    /**
+     * @brief Exact and prefix name matcher compiled from a pattern list.
+     */
+    class NameMatcher {
+    public:
+        /**
+         * @brief Compiles a pattern list.
+         * @param patterns Names, or prefixes ending in `*`.
+         */
+        explicit NameMatcher(std::vector<std::string> patterns);
+        /**
+         * @brief Tests a variable name.
+         * @param name The name.
+         * @return True if any pattern matches.
+         */
+        bool matches(std::string_view name) const;
+        /** @brief Source patterns. @return The list. */
+        const std::vector<std::string>& patterns() const { return patterns_; }
+
+    private:
+        struct Hash {
+            using is_transparent = void;
+            size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+        };
+
+        std::vector<std::string> patterns_;
+        std::unordered_set<std::string, Hash, std::equal_to<>> exact_;
+        std::array<std::vector<std::string>, 256> prefixes_;
+        bool match_all_ = false;
+    };
+
+    NameMatcher keep_;
+    NameMatcher check_;
+    NameMatcher deny_;
+};
+
+} // namespace Voix
+
+#endif // ENV_POLICY_H
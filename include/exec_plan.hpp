@@ -0,0 +1,122 @@
+/**
+ * @file exec_plan.h
+ * @brief Precomputed child setup for command execution
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#ifndef EXEC_PLAN_H
+#define EXEC_PLAN_H
+
+#include "file_utils.hpp"
+#include "process_tuning.hpp"
+#include <csignal>
+#include <cstdint>
+#include <linux/filter.h>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <vector>
+
+namespace Voix {
+
+/**
+ * @brief Step of the child setup that failed.
+ */
+enum class ExecStage : std::uint8_t {
+    NONE,              /**< No failure; the command was executed. */
+    SIGNALS,           /**< Resetting dispositions or restoring the signal mask. */
+    CGROUP,            /**< Joining the profile cgroup through cgroup.procs. */
+    PRIORITY,          /**< Nice value, scheduling policy or I/O priority. */
+    AFFINITY,          /**< CPU affinity or NUMA memory binding. */
+    GROUPS,            /**< setgroups(). */
+    GID,               /**< setresgid(). */
+    UID,               /**< setresuid(). */
+    CAPABILITIES,      /**< Dropping capabilities. */
+    NO_NEW_PRIVS,      /**< PR_SET_NO_NEW_PRIVS. */
+    SECCOMP,           /**< Installing the seccomp filter. */
+    EXEC               /**< execve(). */
+};
+
+/**
+ * @brief Failure reported by the child over the error pipe.
+ */
+struct ExecFailure {
+    ExecStage stage = ExecStage::NONE;  /**< The failing step. */
+    int error = 0;                      /**< errno of the failing call. */
+};
+
+/**
+ * @brief Everything the child does between clone and execve, decided by the parent.
+ *
+ * The parent resolves identities, the environment, the executable and the
+ * seccomp program up front. The child then only issues system calls: it does
+ * not allocate, take locks, consult NSS or log. Failures reach the parent as an
+ * ExecFailure over a close-on-exec pipe.
+ */
+struct ExecPlan {
+    bool change_identity = true;          /**< Apply groups, gid and uid (off only when running as the target already). */
+    uid_t uid = 0;                        /**< Target real/effective/saved UID. */
+    gid_t gid = 0;                        /**< Target real/effective/saved GID. */
+    std::vector<gid_t> groups;            /**< Supplementary groups (as initgroups would set). */
+    bool drop_capabilities = false;       /**< Clear every capability set after the UID change. */
+    std::vector<ResourceLimit> rlimits;   /**< Limits applied with setrlimit() (failures are not fatal). */
+    bool close_fds = false;               /**< Close inherited descriptors above stderr. */
+    int close_fds_fallback_max = 4096;    /**< Upper bound of the close loop when close_range() is unavailable. */
+    bool no_new_privs = false;            /**< Set PR_SET_NO_NEW_PRIVS. */
+    std::vector<sock_filter> seccomp_filter;  /**< Classic BPF program; empty for none. */
+    std::vector<int> ignored_signals;     /**< Signals ignored in the parent, reset to SIG_DFL in the child. */
+    SharedFd cgroup_fd;                   /**< cgroup v2 directory the command starts in; empty for voix's own. */
+    KernelTuning tuning;                  /**< Scheduling, I/O priority and CPU/memory placement. */
+    std::string path;                     /**< Absolute path; executed directly only if exec_fd cannot be (scripts). */
+    SharedFd exec_fd;                     /**< Verified O_PATH descriptor of the command, executed with execveat(). */
+    std::vector<std::string> argv;        /**< Argument vector, argv[0] included. */
+    std::vector<const char*> inherited_env;  /**< Caller environ entries passed through (not owned; environ must outlive the plan). */
+    std::vector<std::string> assigned_env;   /**< Entries set by voix or the rule, as NAME=value. */
+};
+
+/**
+ * @brief Returns a short human-readable name for a setup step.
+ * @param stage The step.
+ * @return The name.
+ */
+std::string_view exec_stage_name(ExecStage stage);
+
+/**
+ * @brief Starts a child that applies @p plan and executes it.
+ *
+ * Uses clone3(CLONE_VFORK | CLONE_CLEAR_SIGHAND), plus CLONE_INTO_CGROUP when
+ * the plan names a cgroup, and falls back to fork() where clone3 or the flags
+ * are unavailable; the forked child then joins the cgroup through
+ * `cgroup.procs`. Returns once the child has called execve() successfully or
+ * has exited after a failed setup step.
+ *
+ * @param plan The plan to apply.
+ * @param child_mask Signal mask to install in the child before execve().
+ * @param failure Set to the failing step when the child could not execute the command.
+ * @param pidfd If non-null, receives a close-on-exec pidfd for the child
+ *        (CLONE_PIDFD, or pidfd_open() after fork()), or -1 if unsupported.
+ * @return The child's pid (to be reaped by the caller), or -1 if no child was created.
+ */
+pid_t spawn_exec_plan(const ExecPlan& plan, const sigset_t& child_mask, ExecFailure& failure,
+                      int* pidfd = nullptr);
+
+/**
+ * @brief Applies @p plan to the calling process and replaces it with the command.
+ *
+ * Used when no PAM session has to be closed afterwards, so voix does not need
+ * to stay around as a parent. The process joins the plan's cgroup first.
+ * Inherited descriptors are marked close-on-exec rather than closed, so the
+ * log stays writable if a later step fails. Returns only on failure, possibly
+ * after the identity change has already happened; the caller must then exit.
+ *
+ * @param plan The plan to apply.
+ * @return The failing step.
+ */
+ExecFailure exec_plan_in_place(const ExecPlan& plan);
+
+} // namespace Voix
+
+#endif // EXEC_PLAN_H
@@ -15,11 +15,42 @@
 #include <filesystem>
 #include <system_error>
 #include <cstdint>
+#include <memory>
 
 namespace Voix {
 
 namespace fs = std::filesystem;
 
+/**
+ * @brief A file descriptor closed when the last copy is destroyed.
+ */
+class SharedFd {
+public:
+    /**
+     * @brief Constructs an empty handle.
+     */
+    SharedFd() = default;
+    /**
+     * @brief Takes ownership of a descriptor.
+     * @param fd The descriptor; -1 yields an empty handle.
+     */
+    explicit SharedFd(int fd);
+
+    /**
+     * @brief Gets the descriptor.
+     * @return The descriptor, or -1 if empty.
+     */
+    int get() const { return fd_ ? *fd_ : -1; }
+    /**
+     * @brief Checks whether a descriptor is held.
+     * @return True if non-empty.
+     */
+    explicit operator bool() const { return fd_ != nullptr; }
+
+private:
+    std::shared_ptr<const int> fd_;
+};
+
 enum class FileError : std::uint8_t {
     NotFound,
     PermissionDenied,
@@ -72,16 +103,6 @@ public:
      * @return A std::expected containing void on success, or a FileError on failure.
      */
     std::expected<void, FileError> writeFile(const fs::path& path, std::string_view content) const;
-    struct ResolveCommandParams {
-        std::string command;
-        std::string path_env;
-    };
-    /**
-     * @brief Resolves the absolute path of a command.
-     * @param params Parameters containing the command and the PATH environment string to search.
-     * @return The absolute path to the command, or an empty string if not found.
-     */
-    std::string resolve_command(const ResolveCommandParams& params) const;
 
 };
 
@@ -0,0 +1,59 @@
+/**
+ * @file glob.h
+ * @brief Wildcard patterns of PATTERN rule arguments
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#ifndef GLOB_H
+#define GLOB_H
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace Voix {
+
+/**
+ * @brief Matches @p text against a wildcard pattern.
+ *
+ * `*` matches any run of characters and `?` any single character, except
+ * '\n' and '\r'; every other character, backslash included, matches
+ * itself. PermissionChecker evaluates PATTERN rule arguments with this
+ * function. Runs in O(|pattern| * |text|) worst case without allocating.
+ *
+ * @param pattern The pattern.
+ * @param text The text.
+ * @return True if the whole of @p text matches.
+ */
+bool glob_match(std::string_view pattern, std::string_view text);
+
+/**
+ * @brief Finds a string two wildcard patterns both match.
+ *
+ * Breadth-first search over the product of the patterns' automata, whose
+ * states are pairs of pattern positions; a shortest witness (in automaton
+ * steps) is rebuilt from the search tree. Literal prefixes and suffixes are
+ * compared first, which rejects most disjoint pairs without allocating.
+ * O(|a| * |b|) time and space.
+ *
+ * @param a A pattern.
+ * @param b Another pattern.
+ * @return A string matching both, or std::nullopt if they are disjoint.
+ */
+std::optional<std::string> glob_intersect(std::string_view a, std::string_view b);
+
+/**
+ * @brief Checks whether a pattern contains wildcards.
+ * @param pattern The pattern.
+ * @return True if @p pattern contains `*` or `?`.
+ */
+inline bool has_wildcards(std::string_view pattern) {
+    return pattern.find_first_of("*?") != std::string_view::npos;
+}
+
+} // namespace Voix
+
+#endif // GLOB_H
@@ -12,12 +12,22 @@
 #include <string>
 #include <string_view>
 
-#define LOG_ERROR(msg) Voix::Logger().log("ERROR", msg)
-#define LOG_WARN(msg) Voix::Logger().log("WARN", msg)
-#define LOG_INFO(msg) Voix::Logger().log("INFO", msg)
+#define LOG_ERROR(msg) ::Voix::Logger().log("ERROR", msg)
+#define LOG_WARN(msg) ::Voix::Logger().log("WARN", msg)
+#define LOG_INFO(msg) ::Voix::Logger().log("INFO", msg)
 
 namespace Voix {
 
+/**
+ * @brief Writes audit records to /var/log/voix.log (syslog when it cannot be opened).
+ *
+ * Logger objects are free to construct: every instance shares one
+ * per-process descriptor, opened on first use with O_APPEND | O_CLOEXEC and
+ * kept across the privilege transition. Each record is assembled in a stack
+ * buffer behind a timestamp prefix that is reformatted at most once a second,
+ * and goes out with a single write(2), so records from concurrent voix
+ * processes never interleave.
+ */
 class Logger {
 public:
     /**
@@ -45,6 +55,13 @@ public:
      * @param message The message to log.
      */
     void log(std::string_view level, std::string_view message) const;
+    /**
+     * @brief Reopens the log file after rotation (voixd's SIGHUP).
+     *
+     * Only async-signal-safe calls are made: the new file is dup3()ed over
+     * the shared descriptor. Does nothing if the file was never opened.
+     */
+    static void reopen();
 };
 
 } // namespace Voix
@@ -13,6 +13,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 #include <sys/types.h>
 
@@ -21,6 +22,7 @@ namespace Voix {
 class Security;
 class Config;
 class Rule;
+class RuleHitCounters;
 
 /**
  * @brief Handles permission checks for command execution based on rules.
@@ -49,10 +51,13 @@ public:
      * @param command The command to check.
      * @param args The arguments for the command.
      * @param target_uid The target user ID.
+     * @param resolved_path Absolute path the command resolved to; a rule naming it matches too.
+     * @param matched If set, receives the position of the first matching rule, permit or deny.
      * @return The matching Rule if found, otherwise std::nullopt.
      */
     std::optional<Rule> permit(std::string_view command, const std::vector<std::string>& args,
-                uid_t target_uid) const;
+                uid_t target_uid, std::string_view resolved_path = {},
+                std::optional<size_t>* matched = nullptr) const;
 
     /**
      * @brief Returns all rules that permit actions for the current user.
@@ -60,9 +65,16 @@ public:
      */
     std::vector<Rule> list_permitted_rules() const;
 
+    /**
+     * @brief Counts each first match of permit() in @p counters.
+     * @param counters Hit counters for the configuration's rules; null to stop counting.
+     */
+    void set_hit_counters(std::shared_ptr<RuleHitCounters> counters) { hits_ = std::move(counters); }
+
 private:
     std::shared_ptr<Security> security_;
     std::shared_ptr<Config> config_;
+    std::shared_ptr<RuleHitCounters> hits_;
 
     struct MatchPatternParams {
         std::string pattern;
@@ -82,6 +94,14 @@ private:
      */
     std::string resolve_variables(const std::string& text) const;
 
+    /**
+     * @brief Compares a rule field with a request value after resolving variables.
+     * @param text The rule field, possibly containing variables.
+     * @param value The value from the request.
+     * @return True if they are equal; fields without variables are not copied.
+     */
+    bool equals_resolved(const std::string& text, std::string_view value) const;
+
     /**
      * @brief Internal method to check if a specific rule matches the given context.
      * @param rule The rule to check.
@@ -91,11 +111,13 @@ private:
      * @param command The command being executed.
      * @param target_uid The target user ID.
      * @param args The arguments for the command.
+     * @param resolved_path Absolute path the command resolved to, or empty.
      * @return True if the rule matches, false otherwise.
      */
     bool matchRule(const Rule& rule, uid_t uid, gid_t* groups, int ngroups,
                    std::string_view command, uid_t target_uid,
-                   const std::vector<std::string>& args) const;
+                   const std::vector<std::string>& args,
+                   std::string_view resolved_path = {}) const;
 };
 
 } // namespace Voix
@@ -1,32 +1,101 @@
 #pragma once
 
 #include "config.hpp"
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace Voix {
 
+class ThreadPool;
+
+// Rule predicates reduced to integers for partitioning. The identity key is
+// 0 for "any user", otherwise tagged with whether it is a UID or a GID; the
+// target key is the target UID. std::nullopt marks a rule that can never
+// match (an identity or target that did not resolve).
+std::optional<std::uint64_t> rule_identity_key(const Rule& rule);
+std::optional<std::uint64_t> rule_target_key(const Rule& rule);
+
 struct PolicyFinding {
     enum class Severity { WARNING, ERROR };
     Severity severity;
     std::string message;
 };
 
+// A rule that can never match because an earlier rule matches every request
+// it does (first match wins). Indices are 0-based positions in getRules().
+struct ShadowedRule {
+    size_t rule;
+    size_t shadowed_by;
+    bool redundant;  // Same match conditions and action: the rule is a duplicate.
+};
+
+// A permit and a deny rule that both match some request without either
+// covering the other: the earlier one decides those requests. witness is
+// one such request, e.g. "alice as root: /usr/bin/cat /etc/ssh/x".
+struct RuleConflict {
+    size_t earlier;
+    size_t later;
+    std::string witness;
+};
+
+// Moving `rule` up to just before `move_before` keeps every decision the same
+// (the rule shares no request with any rule it passes) and, going by the hit
+// counts, saves `saved` rule evaluations.
+struct RuleReordering {
+    size_t rule;
+    size_t move_before;
+    std::uint64_t saved;
+};
+
+// One analysis of a loaded policy. Checks share no state, so every
+// registered check of every configuration may run at the same time.
+class IPolicyCheck {
+public:
+    virtual ~IPolicyCheck() = default;
+    virtual std::string_view name() const = 0;
+    virtual void run(const Config& config, std::vector<PolicyFinding>& findings) const = 0;
+};
+
+// Adds a check after the built-in ones; findings are reported in
+// registration order.
+void register_policy_check(std::shared_ptr<const IPolicyCheck> check);
+std::vector<std::shared_ptr<const IPolicyCheck>> policy_checks();
+
 class PolicyAnalyzer {
 public:
     explicit PolicyAnalyzer(const Config& config);
 
+    // Runs every registered check, one after another.
     std::vector<PolicyFinding> analyze() const;
+    std::vector<ShadowedRule> find_shadowed_rules() const;
+    // Pairs of live rules with different actions whose identities, targets,
+    // commands and argument patterns intersect. Rules are partitioned by
+    // target and command name; argument patterns are intersected as
+    // automata. Ordered by the later rule, then the earlier one.
+    std::vector<RuleConflict> find_conflicting_rules() const;
+    // hits: first-match counts per rule (RuleHitCounters::counts()). Ordered
+    // by evaluations saved, largest first.
+    std::vector<RuleReordering> suggest_reorderings(const std::vector<std::uint64_t>& hits) const;
 
 private:
     const Config& config_;
+};
 
-    void check_empty_acl(std::vector<PolicyFinding>& findings) const;
-    void check_unconfined_targets(std::vector<PolicyFinding>& findings) const;
-    void check_redundant_rules(std::vector<PolicyFinding>& findings) const;
-    void check_open_permissions(std::vector<PolicyFinding>& findings) const;
-    void check_referenced_profiles(std::vector<PolicyFinding>& findings) const;
-    void check_blocklist_coverage(std::vector<PolicyFinding>& findings) const;
+// --check-config result for one file. findings is empty unless valid.
+struct ConfigReport {
+    std::string path;
+    bool valid;
+    std::vector<PolicyFinding> findings;
 };
 
+// Loads, validates and analyzes each file on @p pool: one task per file,
+// then one per (file, check) as soon as that file is loaded. Reports follow
+// the order of @p paths whatever order the tasks finish in.
+std::vector<ConfigReport> check_configs(const std::vector<std::string>& paths, ThreadPool& pool,
+                                        bool verify_security = true);
+
 } // namespace Voix
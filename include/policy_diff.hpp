@@ -0,0 +1,68 @@
+/**
+ * @file policy_diff.h
+ * @brief Semantic difference between the decisions of two policies
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#ifndef POLICY_DIFF_H
+#define POLICY_DIFF_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Voix {
+
+class Config;
+
+/**
+ * @brief One class of requests whose decision differs between two policies.
+ */
+struct PolicyChange {
+    /**
+     * @brief What changed for the requests.
+     */
+    enum class Kind : std::uint8_t {
+        ADDED_GRANT,     /**< Denied before, permitted now. */
+        REMOVED_GRANT,   /**< Permitted before, denied now. */
+        AUTH_CHANGED,    /**< Still permitted; `password`, `persist` or `nopass` changed. */
+        PROFILE_CHANGED  /**< Still permitted; the security profile changed. */
+    };
+
+    Kind kind;               /**< The change. */
+    std::string principal;   /**< User, `:group`, or `*` for users no rule names. */
+    std::string target;      /**< Target user. */
+    std::string command;     /**< Command, or `*` for commands no rule names. */
+    std::string args;        /**< Argument list; `*` for any, `<other>` for lists no rule names. */
+    std::string before;      /**< Authentication or profile before (grants: the removed permit's). */
+    std::string after;       /**< Authentication or profile after (grants: the added permit's). */
+    bool approximate;        /**< A rule for the command has pattern arguments, compared by their text. */
+};
+
+/**
+ * @brief Compares the decisions two policies make.
+ *
+ * The request space is partitioned by the rule predicates of both policies:
+ * first by (target, principal), then by the commands and argument lists the
+ * rules of that partition name, plus one "anything else" class at each
+ * level. A bare command name and an absolute path ending in it are the same
+ * command, as the name resolves to that path. Each class is evaluated with
+ * first-match semantics under both policies, and the (target, principal)
+ * partitions are evaluated in parallel. Group rules form principals of their
+ * own: a user's membership is not resolved, and pattern arguments are
+ * compared by their text rather than the arguments they match, so changes
+ * for such commands are marked approximate.
+ *
+ * @param before The current policy.
+ * @param after The candidate policy.
+ * @param threads Worker threads; 0 for one per CPU.
+ * @return The changes, ordered by target, principal, command and arguments.
+ */
+std::vector<PolicyChange> diff_policies(const Config& before, const Config& after, unsigned threads = 0);
+
+} // namespace Voix
+
+#endif // POLICY_DIFF_H
@@ -0,0 +1,91 @@
+/**
+ * @file probes.h
+ * @brief USDT probes for bpftrace and perf
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ *
+ * Release binaries are stripped and LTO'd, so uprobes on internal functions
+ * are unusable; these statically defined probes (provider `voix`) survive.
+ * Each probe site is a nop plus a check of the probe's semaphore, which the
+ * tracer raises while attached, so arguments such as durations are only
+ * computed while somebody listens. Probe arguments:
+ *
+ *   request_start(id, caller_uid, command)
+ *   request_done(id, status, ns)             not fired when voix execs in place
+ *   permit_done(id, rule, permitted, ns)     rule: 0-based index, -1 for none
+ *   auth_done(id, ok, pam, ns)               pam: 0 when no PAM call was needed
+ *   exec_start(id, path, in_place)
+ *   exec_done(id, exit_code, ns)             supervised (fork mode) runs only
+ *
+ * ids are unique per host while the process lives: the PID in the high
+ * 32 bits, a per-process counter below. Durations are CLOCK_MONOTONIC
+ * nanoseconds. See tools/bpftrace for latency histograms.
+ */
+
+#ifndef PROBES_H
+#define PROBES_H
+
+#include <cstdint>
+
+#ifdef VOIX_WITH_USDT
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#define VOIX_PROBE_SEMAPHORE(name) voix_##name##_semaphore
+
+extern "C" {
+extern volatile unsigned short VOIX_PROBE_SEMAPHORE(request_start);
+extern volatile unsigned short VOIX_PROBE_SEMAPHORE(request_done);
+extern volatile unsigned short VOIX_PROBE_SEMAPHORE(permit_done);
+extern volatile unsigned short VOIX_PROBE_SEMAPHORE(auth_done);
+extern volatile unsigned short VOIX_PROBE_SEMAPHORE(exec_start);
+extern volatile unsigned short VOIX_PROBE_SEMAPHORE(exec_done);
+}
+
+#define VOIX_PROBE_ENABLED(name) __builtin_expect(VOIX_PROBE_SEMAPHORE(name) != 0, 0)
+#define VOIX_PROBE3(name, a, b, c) \
+    do { if (VOIX_PROBE_ENABLED(name)) DTRACE_PROBE3(voix, name, a, b, c); } while (0)
+#define VOIX_PROBE4(name, a, b, c, d) \
+    do { if (VOIX_PROBE_ENABLED(name)) DTRACE_PROBE4(voix, name, a, b, c, d); } while (0)
+#else
+// Arguments stay type-checked but are never evaluated.
+#define VOIX_PROBE_ENABLED(name) false
+#define VOIX_PROBE3(name, a, b, c) \
+    do { if (false) { (void)(a); (void)(b); (void)(c); } } while (0)
+#define VOIX_PROBE4(name, a, b, c, d) \
+    do { if (false) { (void)(a); (void)(b); (void)(c); (void)(d); } } while (0)
+#endif
+
+namespace Voix::probes {
+
+/**
+ * @brief Starts a new request on the calling thread.
+ * @return The request id, also returned by current_request() from now on.
+ */
+std::uint64_t begin_request() noexcept;
+
+/**
+ * @brief Gets the id of the calling thread's request.
+ * @return The id from the last begin_request() on this thread, or 0.
+ */
+std::uint64_t current_request() noexcept;
+
+/**
+ * @brief Reads CLOCK_MONOTONIC for a probe that reports a duration.
+ * @param enabled Whether the probe is attached (VOIX_PROBE_ENABLED).
+ * @return Nanoseconds, or 0 when @p enabled is false.
+ */
+std::uint64_t start_clock(bool enabled) noexcept;
+
+/**
+ * @brief Gets the nanoseconds elapsed since start_clock().
+ * @param start Value from start_clock().
+ * @return The duration, or 0 if the clock was not started.
+ */
+std::uint64_t elapsed(std::uint64_t start) noexcept;
+
+} // namespace Voix::probes
+
+#endif // PROBES_H
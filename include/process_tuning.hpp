@@ -0,0 +1,108 @@
+/**
+ * @file process_tuning.h
+ * @brief Per-profile scheduling, I/O priority, CPU placement and resource limits
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#ifndef PROCESS_TUNING_H
+#define PROCESS_TUNING_H
+
+#include <cstdint>
+#include <optional>
+#include <sched.h>
+#include <string_view>
+#include <sys/resource.h>
+#include <vector>
+
+namespace Voix {
+
+/**
+ * @brief A resource limit to apply in the child.
+ */
+struct ResourceLimit {
+    decltype(RLIMIT_NOFILE) resource;  /**< RLIMIT_* constant. */
+    struct rlimit limit;  /**< Soft and hard limit. */
+};
+
+/**
+ * @brief CPU scheduling policy for a profile's commands.
+ */
+enum class SchedPolicy : std::uint8_t {
+    INHERIT,  /**< Keep voix's policy. */
+    OTHER,    /**< SCHED_OTHER. */
+    BATCH,    /**< SCHED_BATCH: CPU-bound, non-interactive work. */
+    IDLE      /**< SCHED_IDLE: runs only when nothing else wants the CPU. */
+};
+
+/**
+ * @brief I/O scheduling class (the IOPRIO_CLASS_* values).
+ */
+enum class IoClass : std::uint8_t {
+    INHERIT = 0,      /**< Keep voix's I/O priority. */
+    REALTIME = 1,     /**< IOPRIO_CLASS_RT. */
+    BEST_EFFORT = 2,  /**< IOPRIO_CLASS_BE. */
+    IDLE = 3          /**< IOPRIO_CLASS_IDLE: I/O only when the disk is otherwise idle. */
+};
+
+/**
+ * @brief How a profile's commands are scheduled and limited, as configured.
+ */
+struct ProcessTuning {
+    std::optional<int> nice;                          /**< Nice value (-20..19). */
+    SchedPolicy sched_policy = SchedPolicy::INHERIT;  /**< CPU scheduling policy. */
+    IoClass io_class = IoClass::INHERIT;              /**< I/O scheduling class. */
+    int io_level = 4;                                 /**< I/O priority level (0 highest .. 7). */
+    std::vector<unsigned> cpus;                       /**< CPU affinity; empty to inherit. */
+    std::optional<unsigned> numa_node;                /**< Memory (and, without cpus, CPU) binding. */
+    std::vector<ResourceLimit> rlimits;               /**< Replace or extend the restricted defaults. */
+};
+
+/**
+ * @brief Settings in the form the child applies them with system calls.
+ */
+struct KernelTuning {
+    std::optional<int> nice;            /**< setpriority() value. */
+    int sched_policy = -1;              /**< sched_setscheduler() policy; -1 to keep. */
+    int ioprio = -1;                    /**< Encoded ioprio_set() value; -1 to keep. */
+    std::optional<cpu_set_t> affinity;  /**< sched_setaffinity() mask. */
+    std::vector<unsigned long> nodemask;  /**< set_mempolicy(MPOL_BIND) mask; empty for none. */
+};
+
+/**
+ * @brief Parses a CPU list such as `0-3,8,10-11`.
+ * @param list The list, in the kernel's cpulist format.
+ * @return The CPUs in ascending order, or std::nullopt if malformed or beyond CPU_SETSIZE.
+ */
+std::optional<std::vector<unsigned>> parse_cpu_list(std::string_view list);
+
+/**
+ * @brief Maps an rlimit name (`nofile`, `nproc`, `core`, `as`, ...) to its RLIMIT_* constant.
+ * @param name The lower-case name without the `RLIMIT_` prefix.
+ * @return The resource, or std::nullopt if unknown.
+ */
+std::optional<decltype(RLIMIT_NOFILE)> parse_rlimit_resource(std::string_view name);
+
+/**
+ * @brief Parses a limit value: a non-negative number or `unlimited`.
+ * @param value The value.
+ * @return The limit, or std::nullopt if malformed.
+ */
+std::optional<rlim_t> parse_rlimit_value(std::string_view value);
+
+/**
+ * @brief Converts configured settings to the values the child applies.
+ *
+ * A NUMA node without explicit CPUs also pins the command to that node's
+ * CPUs, read from sysfs.
+ *
+ * @param tuning The configured settings.
+ * @return The kernel form, or std::nullopt if the NUMA node does not exist.
+ */
+std::optional<KernelTuning> compile_tuning(const ProcessTuning& tuning);
+
+} // namespace Voix
+
+#endif // PROCESS_TUNING_H
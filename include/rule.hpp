@@ -10,6 +10,7 @@
 #ifndef RULE_H
 #define RULE_H
 
+#include <chrono>
 #include <string>
 #include <vector>
 #include <optional>
@@ -49,6 +50,8 @@ public:
     std::vector<std::string> cmdargs;  /**< Arguments for the command. */
     std::vector<std::string> envlist;  /**< Environment variables to set. */
     std::string profile;                  /**< Security profile to apply. */
+    std::chrono::seconds timeout{0};   /**< Wall-clock limit for the command; zero for none. */
+    std::chrono::seconds kill_after{5}; /**< Grace period between SIGTERM and SIGKILL once timed out. */
     Action action;                     /**< Action to take on match. */
     int options;                       /**< Combined options flags. */
 
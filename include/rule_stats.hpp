@@ -0,0 +1,95 @@
+/**
+ * @file rule_stats.h
+ * @brief Per-rule hit counters shared through a memory-mapped file
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#ifndef RULE_STATS_H
+#define RULE_STATS_H
+
+#include "rule.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace Voix {
+
+/**
+ * @brief How often each rule of a policy was the first match.
+ *
+ * The counters live in a root-owned `0600` file (`<sanctuary>/voix-rule-hits`)
+ * mapped shared by every voix and voixd process, and are incremented with a
+ * relaxed atomic add: no lock and no system call per hit. The file header
+ * records a fingerprint of the rule list; when the policy changes the
+ * counters start again from zero, since positions no longer mean the same
+ * rules.
+ */
+class RuleHitCounters {
+public:
+    /**
+     * @brief Maps the counter file for a policy.
+     * @param path The counter file.
+     * @param rules The policy's rules (in evaluation order).
+     * @param create Whether to create the file, or reset it for a changed policy.
+     * @param owner UID that must own the file (root in production).
+     * @return The counters, or nullptr if the file cannot be used.
+     */
+    static std::unique_ptr<RuleHitCounters> open(const std::string& path, const std::vector<Rule>& rules,
+                                                 bool create = true, uid_t owner = 0);
+    /**
+     * @brief Maps the counter file for a policy known only by its fingerprint.
+     *
+     * Used by a voix process served by voixd, which never loads the rules.
+     *
+     * @param path The counter file.
+     * @param fingerprint fingerprint() of the policy's rules.
+     * @param count Number of rules in the policy.
+     * @param create Whether to create the file, or reset it for a changed policy.
+     * @param owner UID that must own the file (root in production).
+     * @return The counters, or nullptr if the file cannot be used.
+     */
+    static std::unique_ptr<RuleHitCounters> open(const std::string& path, std::uint64_t fingerprint, size_t count,
+                                                 bool create = true, uid_t owner = 0);
+    /**
+     * @brief Unmaps the counter file.
+     */
+    ~RuleHitCounters();
+
+    RuleHitCounters(const RuleHitCounters&) = delete;
+    RuleHitCounters& operator=(const RuleHitCounters&) = delete;
+
+    /**
+     * @brief Counts a first match of a rule.
+     * @param rule Position of the rule in the policy.
+     */
+    void hit(size_t rule) noexcept;
+    /**
+     * @brief Reads the counters.
+     * @return One count per rule, in policy order.
+     */
+    std::vector<std::uint64_t> counts() const;
+
+    /**
+     * @brief Computes the fingerprint identifying a rule list.
+     * @param rules The rules.
+     * @return A hash of every field that affects matching or the decision.
+     */
+    static std::uint64_t fingerprint(const std::vector<Rule>& rules);
+
+private:
+    RuleHitCounters(void* map, size_t map_size, size_t count);
+
+    void* map_;
+    size_t map_size_;
+    std::uint64_t* counters_;
+    size_t count_;
+};
+
+} // namespace Voix
+
+#endif // RULE_STATS_H
@@ -18,6 +18,9 @@
 #ifdef VOIX_WITH_CAP
 #include <sys/capability.h>
 #endif
+#ifdef VOIX_WITH_SECCOMP
+#include <linux/filter.h>
+#endif
 #include "config.hpp"
 #include "system_identity.hpp"
 
@@ -51,13 +54,6 @@ public:
      */
     bool isSafePath(std::string_view path) const;
 
-    /**
-     * @brief Logs a security-related event.
-     * @param event Description of the event.
-     * @param user Username associated with the event.
-     */
-    void logEvent(std::string_view event, std::string_view user) const;
-
     /**
      * @brief Gets the current username.
      * @return The current username.
@@ -74,9 +70,12 @@ public:
      * @param command Command to check.
      * @param args Command arguments.
      * @param config Configuration instance for the blocklist.
+     * @param cwd Working directory relative path arguments are resolved against.
+     *            Empty means the current process's working directory.
      * @return True if the command is catastrophic, false otherwise.
      */
-    bool isCatastrophicCommand(std::string_view command, const std::vector<std::string>& args, const Config& config) const;
+    bool isCatastrophicCommand(std::string_view command, const std::vector<std::string>& args,
+                               const Config& config, std::string_view cwd = {}) const;
 
 private:
     /**
@@ -104,6 +103,15 @@ public:
      * @brief Applies a Seccomp blacklist to restrict dangerous system calls.
      */
     void applySeccompBlacklist() const;
+
+    /**
+     * @brief Compiles the Seccomp blacklist into a classic BPF program.
+     *
+     * The program is built in the parent so the child only has to install it.
+     *
+     * @return The program, or an empty vector on failure.
+     */
+    std::vector<sock_filter> compileSeccompBlacklist() const;
 #endif
 
 
@@ -0,0 +1,71 @@
+/**
+ * @file supervisor.h
+ * @brief Supervision of the target command when voix stays its parent
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include <chrono>
+#include <string>
+#include <sys/resource.h>
+#include <sys/types.h>
+
+namespace Voix {
+
+/**
+ * @brief Time limits applied to a supervised child (see Rule::timeout).
+ */
+struct SupervisionLimits {
+    std::chrono::milliseconds timeout{0};     /**< Wall-clock limit; zero for none. */
+    std::chrono::milliseconds kill_after{0};  /**< Delay between SIGTERM and SIGKILL once timed out. */
+};
+
+/**
+ * @brief How a supervised child ended and what it consumed.
+ */
+struct ChildReport {
+    int status = 0;                          /**< Wait status from wait4(). */
+    bool timed_out = false;                  /**< The timeout expired and the child was signalled. */
+    struct rusage usage{};                   /**< Resource usage of the child and its reaped descendants. */
+    std::chrono::milliseconds wall_time{0};  /**< Time from supervision start to exit. */
+
+    /**
+     * @brief Exit code voix reports for the child.
+     * @return 124 after a timeout (as timeout(1)), the exit status, or -1 if killed by a signal.
+     */
+    int exit_code() const;
+    /**
+     * @brief Formats the record appended to the audit log.
+     * @return `status=... wall=...s user=...s sys=...s maxrss=...KiB inblock=... oublock=...`.
+     */
+    std::string describe() const;
+};
+
+/**
+ * @brief Waits for a child while enforcing limits and forwarding signals.
+ *
+ * Polls the child's pidfd and a signalfd. Signals sent to voix by another
+ * process (kill, a service manager) are forwarded to the child; signals the
+ * terminal driver generated already reached the child through its process
+ * group and are not sent twice. When the timeout expires the child receives
+ * SIGTERM, then SIGKILL after @p limits.kill_after. Without a pidfd (kernels
+ * before 5.3) SIGCHLD on the signalfd stands in for it.
+ *
+ * The caller must have SIGCHLD and the forwarded signals blocked, as
+ * Command::execute does for the whole spawn.
+ *
+ * @param pid The child.
+ * @param pidfd A pidfd for @p pid, or -1.
+ * @param limits Time limits.
+ * @return The exit status and resource usage.
+ */
+ChildReport supervise_child(pid_t pid, int pidfd, const SupervisionLimits& limits);
+
+} // namespace Voix
+
+#endif // SUPERVISOR_H
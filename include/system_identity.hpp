@@ -10,7 +10,11 @@
 #ifndef SYSTEM_IDENTITY_H
 #define SYSTEM_IDENTITY_H
 
+#include <chrono>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <sys/types.h>
 #include <optional>
@@ -62,6 +66,16 @@ public:
      * @return A vector of group IDs.
      */
     virtual std::vector<gid_t> get_current_groups() const = 0;
+    /**
+     * @brief Retrieves a user's UID without resolving their groups.
+     * @param username The username to look up.
+     * @return The UID if found, otherwise std::nullopt.
+     */
+    virtual std::optional<uid_t> get_uid_by_name(const std::string& username) const {
+        auto user = get_user_by_name(username);
+        if (!user) return std::nullopt;
+        return user->uid;
+    }
 };
 
 /**
@@ -74,6 +88,75 @@ public:
     std::string get_current_username() const override;
     uid_t get_current_uid() const override;
     std::vector<gid_t> get_current_groups() const override;
+    std::optional<uid_t> get_uid_by_name(const std::string& username) const override;
+};
+
+/**
+ * @brief IIdentity decorator that memoizes user lookups for a bounded time.
+ *
+ * Used by voixd so repeated requests do not go through NSS each time. Negative
+ * results are not cached, so a freshly created account is visible immediately.
+ * Thread-safe.
+ */
+class CachingIdentity : public IIdentity {
+public:
+    /**
+     * @brief Constructor for CachingIdentity.
+     * @param base The identity provider to consult on a miss.
+     * @param ttl How long a cached entry stays valid.
+     */
+    explicit CachingIdentity(std::shared_ptr<IIdentity> base,
+                             std::chrono::seconds ttl = std::chrono::seconds(30));
+
+    std::optional<UserIdentity> get_user_by_name(const std::string& username) const override;
+    std::optional<UserIdentity> get_user_by_uid(uid_t uid) const override;
+    std::string get_current_username() const override;
+    uid_t get_current_uid() const override;
+    std::vector<gid_t> get_current_groups() const override;
+
+    /**
+     * @brief Drops every cached entry (e.g. after a configuration reload).
+     */
+    void clear();
+
+private:
+    struct Entry {
+        UserIdentity identity;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    std::shared_ptr<IIdentity> base_;
+    std::chrono::seconds ttl_;
+    mutable std::mutex mutex_;
+    mutable std::unordered_map<std::string, Entry> by_name_;
+    mutable std::unordered_map<uid_t, Entry> by_uid_;
+};
+
+/**
+ * @brief IIdentity that answers "current user" questions for a peer process.
+ *
+ * voixd evaluates requests on behalf of the process at the other end of a
+ * Unix socket; the peer's UID comes from SO_PEERCRED and lookups are delegated
+ * to the base provider.
+ */
+class PeerIdentity : public IIdentity {
+public:
+    /**
+     * @brief Constructor for PeerIdentity.
+     * @param base The identity provider used for lookups.
+     * @param uid The peer's UID as reported by the kernel.
+     */
+    PeerIdentity(std::shared_ptr<IIdentity> base, uid_t uid);
+
+    std::optional<UserIdentity> get_user_by_name(const std::string& username) const override;
+    std::optional<UserIdentity> get_user_by_uid(uid_t uid) const override;
+    std::string get_current_username() const override;
+    uid_t get_current_uid() const override;
+    std::vector<gid_t> get_current_groups() const override;
+
+private:
+    std::shared_ptr<IIdentity> base_;
+    uid_t uid_;
 };
 
 } // namespace Voix
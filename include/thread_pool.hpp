@@ -0,0 +1,92 @@
+/**
+ * @file thread_pool.h
+ * @brief Work-stealing thread pool for batch analysis
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Voix {
+
+/**
+ * @brief Fixed set of worker threads, each with its own task deque.
+ *
+ * A worker runs its own newest task first and, when its deque is empty,
+ * steals the oldest task of another worker. Tasks submitted from a worker
+ * go to that worker's deque, so a task that fans out keeps its subtasks
+ * local until others run dry. Tasks must not block on futures of other
+ * tasks; chain them by submitting instead.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Starts the workers.
+     * @param threads Number of workers; 0 for one per CPU.
+     */
+    explicit ThreadPool(unsigned threads = 0);
+    /**
+     * @brief Runs every queued task, then joins the workers.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Queues a task.
+     * @param task Callable taking no arguments.
+     * @return The task's result; exceptions are rethrown from get().
+     */
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F&& task) {
+        std::packaged_task<std::invoke_result_t<F>()> packaged(std::forward<F>(task));
+        auto result = packaged.get_future();
+        push(Task(std::move(packaged)));
+        return result;
+    }
+
+    /**
+     * @brief Gets the number of workers.
+     * @return The worker count.
+     */
+    unsigned size() const { return static_cast<unsigned>(workers_.size()); }
+
+private:
+    using Task = std::move_only_function<void()>;
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void push(Task task);
+    bool take(size_t worker, Task& task);
+    void run(size_t worker);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::atomic<size_t> pending_{0};
+    std::atomic<size_t> next_queue_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::vector<std::jthread> workers_;
+};
+
+} // namespace Voix
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,92 @@
+/**
+ * @file timestamp_cache.h
+ * @brief Persist-mode authentication timestamp cache
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#ifndef TIMESTAMP_CACHE_H
+#define TIMESTAMP_CACHE_H
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <sys/types.h>
+
+namespace Voix {
+
+/**
+ * @brief Records successful authentications for rules carrying the `persist` option.
+ *
+ * A timestamp is scoped to the calling user, the controlling terminal, the
+ * session and the parent process (identified by pid and start time, so a
+ * recycled pid never inherits a stale record). Each record is an empty file in
+ * a root-owned 0700 directory whose name encodes that scope; the file times
+ * carry the authentication instant on both CLOCK_BOOTTIME (mtime) and
+ * CLOCK_REALTIME (atime), and both must agree for the record to be honored.
+ *
+ * Validation costs a fixed number of syscalls: one open/read/close of the
+ * parent's /proc stat entry, one open + fstat of the directory, one openat +
+ * fstat of the record and the closes.
+ */
+class TimestampCache {
+public:
+    /**
+     * @brief Constructor for TimestampCache.
+     * @param directory Directory holding the timestamp records (created 0700 if missing).
+     * @param lifetime How long a successful authentication is honored. Zero disables the cache.
+     * @param owner UID that must own the directory and its records (root in production).
+     */
+    TimestampCache(std::string directory, std::chrono::seconds lifetime, uid_t owner = 0);
+    /**
+     * @brief Default destructor for TimestampCache.
+     */
+    ~TimestampCache() = default;
+
+    /**
+     * @brief Checks whether the caller holds a fresh timestamp for the current session.
+     * @param uid The real UID of the caller.
+     * @return True if a valid, unexpired record exists, false otherwise.
+     */
+    bool is_valid(uid_t uid) const;
+    /**
+     * @brief Creates or refreshes the caller's timestamp for the current session.
+     * @param uid The real UID of the caller.
+     * @return True if the record was written, false otherwise.
+     */
+    bool update(uid_t uid) const;
+    /**
+     * @brief Removes the caller's timestamp for the current session (`-k`).
+     * @param uid The real UID of the caller.
+     * @return True if no record remains, false on error.
+     */
+    bool clear(uid_t uid) const;
+
+    /**
+     * @brief Builds the record name for the current session.
+     *
+     * Format: `<uid>-<tty>-<sid>-<ppid>-<parent start time>`.
+     *
+     * @param uid The real UID of the caller.
+     * @return The record name, or std::nullopt if the parent process cannot be inspected.
+     */
+    static std::optional<std::string> session_key(uid_t uid);
+
+private:
+    /**
+     * @brief Opens the timestamp directory and verifies it is private to the owner.
+     * @param create Whether to create the directory when missing.
+     * @return A directory file descriptor, or -1 on failure.
+     */
+    int open_directory(bool create) const;
+
+    std::string directory_;
+    std::chrono::seconds lifetime_;
+    uid_t owner_;
+};
+
+} // namespace Voix
+
+#endif // TIMESTAMP_CACHE_H
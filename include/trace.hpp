@@ -0,0 +1,110 @@
+/**
+ * @file trace.h
+ * @brief Per-invocation phase timing for voix --trace
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Voix {
+
+/**
+ * @brief Records how long each stage of one voix invocation takes.
+ *
+ * Disabled unless voix runs with --trace (or VOIX_TRACE for root); a
+ * disabled Span costs one branch. Stages are kept in memory and written to
+ * stderr once, by flush(), just before voix replaces itself with the command
+ * or when it exits. Timestamps are CLOCK_MONOTONIC. Not thread-safe: only
+ * the voix binary enables it.
+ */
+class Trace {
+public:
+    /**
+     * @brief Output formats.
+     */
+    enum class Format {
+        TABLE,  /**< Aligned columns, offsets from enable(). */
+        JSON    /**< Chrome/Perfetto trace-event JSON. */
+    };
+
+    /**
+     * @brief Times one stage from construction to destruction.
+     */
+    class Span {
+    public:
+        /**
+         * @brief Starts timing a stage.
+         * @param stage Stage name; must outlive the trace (a literal).
+         */
+        explicit Span(std::string_view stage) noexcept;
+        /**
+         * @brief Records the stage.
+         */
+        ~Span();
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+        /**
+         * @brief Attaches a detail (a user name, a rule index) to the stage.
+         * @param detail Text shown next to the stage.
+         */
+        void note(std::string_view detail);
+        /**
+         * @brief Records the stage now instead of at destruction.
+         */
+        void end();
+
+    private:
+        std::string_view stage_;
+        std::string detail_;
+        std::uint64_t start_ = 0;
+    };
+
+    /**
+     * @brief Starts recording; the table's offsets count from here.
+     * @param format How flush() writes the stages.
+     */
+    static void enable(Format format);
+    /**
+     * @brief Checks whether stages are being recorded.
+     * @return True after enable().
+     */
+    static bool enabled() noexcept { return enabled_; }
+    /**
+     * @brief Records an instant event, such as the exec that ends the trace.
+     * @param stage Event name; must outlive the trace (a literal).
+     * @param detail Text shown next to the event.
+     */
+    static void mark(std::string_view stage, std::string detail = {});
+    /**
+     * @brief Writes the recorded stages to stderr and stops recording.
+     *
+     * Later calls do nothing, so every exit path may call it.
+     */
+    static void flush();
+    /**
+     * @brief Parses a --trace or VOIX_TRACE value.
+     * @param value "table" (also empty or "1") or "json".
+     * @param format Receives the format.
+     * @return False for anything else.
+     */
+    static bool parse_format(std::string_view value, Format& format);
+
+private:
+    static void record(std::string_view stage, std::uint64_t start, std::uint64_t end, std::string detail);
+
+    static bool enabled_;
+};
+
+} // namespace Voix
+
+#endif // TRACE_H
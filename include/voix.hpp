@@ -10,6 +10,7 @@
 #ifndef VOIX_H
 #define VOIX_H
 
+#include <chrono>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -23,6 +24,23 @@ class Config;
 class Security;
 class IAuthenticator;
 class PermissionChecker;
+class TimestampCache;
+class BrokerClient;
+class IIdentity;
+
+/**
+ * @brief The replaceable parts of the request pipeline.
+ *
+ * Lets the whole of Voix::execute() run in-process against fakes: no policy
+ * file, NSS, PAM or exec is needed. Every member must be set.
+ */
+struct VoixBackends {
+    std::shared_ptr<Config> config;                 /**< Loaded configuration (see Config::load_from_string()). */
+    std::shared_ptr<IIdentity> identity;            /**< Caller and target lookups. */
+    std::unique_ptr<IAuthenticator> authenticator;  /**< Authentication and sessions. */
+    std::unique_ptr<ICommandResolver> resolver;     /**< Command resolution. */
+    std::unique_ptr<IExecutor> executor;            /**< Runs permitted commands. */
+};
 
 /**
  * @brief Main entry point for the Voix system.
@@ -33,10 +51,21 @@ public:
      * @brief Constructor for Voix.
      * @param config_path Path to the configuration file.
      * @param non_interactive Whether to run in non-interactive mode.
-     * @param clear_timestamp Whether to clear the timestamp.
+     * @param clear_timestamp Whether to clear the caller's persist timestamp (`-k`).
+     * @param use_broker Whether to ask a running voixd for the policy decision.
+     *                   When no broker answers, the configuration is loaded locally.
      */
     Voix(std::string_view config_path = "/etc/voix.conf",
-          bool non_interactive = false, bool clear_timestamp = false);
+          bool non_interactive = false, bool clear_timestamp = false,
+          bool use_broker = false);
+    /**
+     * @brief Constructor for Voix over the given backends instead of the system.
+     *
+     * Rule hit counting and the voixd broker are off.
+     *
+     * @param backends The configuration, identity, authenticator, resolver and executor.
+     */
+    explicit Voix(VoixBackends backends);
     /**
      * @brief Destructor for Voix.
      */
@@ -57,16 +86,36 @@ public:
 
     /**
      * @brief Lists all permitted commands for the current user.
+     *
+     * Requires the locally loaded configuration (construct with use_broker = false).
+     *
      * @return 0 on success, non-zero on failure.
      */
     int list_commands() const;
 
 private:
+    /**
+     * @brief Loads the configuration and the objects that depend on it.
+     * @throws std::runtime_error if the configuration cannot be loaded.
+     */
+    void load_config();
+    /**
+     * @brief Creates the authenticator once the persist settings are known.
+     * @param persist_dir Directory of the persist timestamp cache.
+     * @param persist_timeout Lifetime of a persist timestamp.
+     */
+    void init_authenticator(const std::string& persist_dir, std::chrono::seconds persist_timeout);
+
+    std::string config_path_;
     std::shared_ptr<Config> config_;
     std::shared_ptr<Security> security_;
+    std::shared_ptr<TimestampCache> timestamps_;
     std::unique_ptr<IAuthenticator> authenticator_;
     std::unique_ptr<PermissionChecker> permission_checker_;
-    std::unique_ptr<Command> command_;
+    std::unique_ptr<ICommandResolver> resolver_;
+    std::unique_ptr<IExecutor> executor_;
+    std::unique_ptr<BrokerClient> broker_;
+    bool non_interactive_;
     bool clear_timestamp_;
 };
 
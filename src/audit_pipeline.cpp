@@ -0,0 +1,182 @@
+/**
+ * @file audit_pipeline.cpp
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#include "audit_pipeline.hpp"
+#include "logger.hpp"
+#include <atomic>
+#include <cstring>
+#include <format>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <syslog.h>
+#include <unistd.h>
+
+namespace Voix {
+
+namespace {
+
+// syslog facility of LOG_AUTHPRIV, as journald expects it in SYSLOG_FACILITY.
+constexpr int k_authpriv_facility = LOG_AUTHPRIV >> 3;
+
+std::atomic<int> g_journal_fd{-1};
+
+// Opens the journald datagram socket once per process.
+int journal_fd() {
+    int fd = g_journal_fd.load(std::memory_order_acquire);
+    if (fd != -1) return fd;
+    fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) return -1;
+    int expected = -1;
+    if (!g_journal_fd.compare_exchange_strong(expected, fd, std::memory_order_acq_rel)) {
+        close(fd);
+        return expected;
+    }
+    return fd;
+}
+
+const char* stage_name(AuditStage stage) {
+    switch (stage) {
+        case AuditStage::DECISION: return "decision";
+        case AuditStage::AUTHENTICATION: return "authentication";
+        case AuditStage::SESSION: return "session";
+        case AuditStage::FINISHED: return "finished";
+        case AuditStage::TIMESTAMP_CLEARED: return "timestamp-cleared";
+    }
+    return "unknown";
+}
+
+int severity(const AuditEvent& event) {
+    if (event.outcome == "catastrophic") return LOG_ALERT;
+    if (event.outcome == "invalid-target" || event.stage == AuditStage::SESSION) return LOG_ERR;
+    if (event.outcome == "deny" || event.outcome == "auth-failed") return LOG_NOTICE;
+    return LOG_INFO;
+}
+
+// Appends a journal field; values containing a newline use the binary
+// form (name, newline, little-endian 64-bit length, value).
+void append_field(std::string& out, std::string_view name, std::string_view value) {
+    out += name;
+    if (value.find('\n') == std::string_view::npos) {
+        out += '=';
+        out += value;
+    } else {
+        out += '\n';
+        std::uint64_t size = value.size();
+        for (int i = 0; i < 8; ++i) out += static_cast<char>((size >> (8 * i)) & 0xff);
+        out += value;
+    }
+    out += '\n';
+}
+
+} // namespace
+
+AuditPipeline::AuditPipeline(unsigned sinks, const std::string& store_dir, std::uint64_t segment_size,
+                             std::string journal_socket)
+    : sinks_(sinks), journal_socket_(std::move(journal_socket)) {
+    if (!store_dir.empty()) store_.emplace(store_dir, segment_size);
+}
+
+std::optional<AuditPipeline::Sink> AuditPipeline::parse_sink(std::string_view name) {
+    if (name == "file") return SINK_FILE;
+    if (name == "syslog") return SINK_SYSLOG;
+    if (name == "journald") return SINK_JOURNALD;
+    return std::nullopt;
+}
+
+std::string AuditPipeline::message(const AuditEvent& event) {
+    const std::string& caller = event.caller;
+    switch (event.stage) {
+        case AuditStage::DECISION:
+            if (event.outcome == "permit") {
+                if (event.detail.empty()) {
+                    return std::format("[{}] Command permitted: {} as {}", caller, event.command, event.target);
+                }
+                return std::format("[{}] Command permitted: {} as {} ({})", caller, event.command, event.target,
+                                   event.detail);
+            }
+            if (event.outcome == "catastrophic") {
+                return std::format("[{}] Catastrophic command blocked: {}", caller, event.command);
+            }
+            if (event.outcome == "invalid-target") {
+                return std::format("[{}] Invalid target user: {}", caller, event.target);
+            }
+            return std::format("[{}] Command not permitted: {} as {}", caller, event.command, event.target);
+        case AuditStage::AUTHENTICATION:
+            return std::format("[{}] Authentication failed for command: {} as {}", caller, event.command,
+                               event.target);
+        case AuditStage::SESSION:
+            return std::format("[{}] Failed to open PAM session for command: {}", caller, event.command);
+        case AuditStage::FINISHED:
+            return std::format("[{}] Command finished: {} as {}: {}", caller, event.command, event.target,
+                               event.detail);
+        case AuditStage::TIMESTAMP_CLEARED:
+            return std::format("[{}] Timestamp cleared (persist authentication reset)", caller);
+    }
+    return {};
+}
+
+std::string AuditPipeline::journal_entry(const AuditEvent& event, std::string_view message) {
+    std::string out;
+    out.reserve(256 + message.size());
+    append_field(out, "MESSAGE", message);
+    append_field(out, "PRIORITY", std::to_string(severity(event)));
+    append_field(out, "SYSLOG_FACILITY", std::to_string(k_authpriv_facility));
+    append_field(out, "SYSLOG_IDENTIFIER", "voix");
+    append_field(out, "SYSLOG_PID", std::to_string(getpid()));
+    append_field(out, "VOIX_STAGE", stage_name(event.stage));
+    if (!event.outcome.empty()) append_field(out, "VOIX_OUTCOME", event.outcome);
+    append_field(out, "VOIX_CALLER", event.caller);
+    append_field(out, "VOIX_CALLER_UID", std::to_string(event.caller_uid));
+    if (!event.target.empty()) append_field(out, "VOIX_TARGET", event.target);
+    if (!event.command.empty()) append_field(out, "VOIX_COMMAND", event.command);
+    for (const auto& arg : event.args) append_field(out, "VOIX_ARG", arg);
+    if (!event.cwd.empty()) append_field(out, "VOIX_CWD", event.cwd);
+    if (!event.detail.empty()) append_field(out, "VOIX_DETAIL", event.detail);
+    return out;
+}
+
+void AuditPipeline::emit_text(const AuditEvent& event) const {
+    const std::string text = message(event);
+    const int priority = LOG_AUTHPRIV | severity(event);
+
+    bool to_syslog = sinks_ & SINK_SYSLOG;
+    if (sinks_ & SINK_JOURNALD) {
+        std::string entry = journal_entry(event, text);
+        struct sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        bool sent = false;
+        int fd = journal_fd();
+        if (fd != -1 && journal_socket_.size() < sizeof(addr.sun_path)) {
+            std::memcpy(addr.sun_path, journal_socket_.data(), journal_socket_.size());
+            sent = sendto(fd, entry.data(), entry.size(), MSG_NOSIGNAL,
+                          reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr)) ==
+                   static_cast<ssize_t>(entry.size());
+        }
+        to_syslog = to_syslog || !sent;
+    }
+    if (to_syslog) {
+        syslog(priority, "%s", text.c_str());
+    }
+    if (sinks_ & SINK_FILE) {
+        Logger().log("SECURITY", text);
+    }
+}
+
+void AuditPipeline::emit(const AuditEvent& event) const {
+    if (sinks_ != 0) emit_text(event);
+
+    if (store_ && (event.stage == AuditStage::DECISION || event.stage == AuditStage::AUTHENTICATION)) {
+        AuditRecord record{0, event.caller_uid, event.caller, event.target, event.command,
+                           event.args, event.outcome, event.cwd};
+        if (!store_->append(record)) {
+            LOG_WARN("Failed to append to the audit store");
+        }
+    }
+}
+
+} // namespace Voix
@@ -0,0 +1,652 @@
+/**
+ * @file audit_store.cpp
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#include "audit_store.hpp"
+#include "logger.hpp"
+#include "system_utils.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <format>
+#include <initializer_list>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+#ifdef VOIX_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+namespace Voix {
+
+namespace {
+
+constexpr char k_index_magic[8] = {'V', 'O', 'I', 'X', 'I', 'D', 'X', '1'};
+constexpr std::uint32_t k_flag_sealed = 1;
+constexpr std::uint32_t k_flag_compressed = 2;
+constexpr const char* k_active_log = "current.log";
+constexpr const char* k_active_index = "current.idx";
+
+struct IndexHeader {
+    char magic[8];
+    std::uint32_t flags;
+    std::uint32_t reserved;
+    std::int64_t min_time;      // sealed only
+    std::int64_t max_time;      // sealed only
+    std::uint64_t entry_count;  // sealed only; the active index is sized by the file
+    std::uint64_t block_count;  // compressed only; the block table follows the entries
+};
+
+struct IndexEntry {
+    std::int64_t time;
+    std::uint32_t caller_uid;
+    std::uint32_t length;  // record bytes including the newline
+    std::uint64_t target_hash;
+    std::uint64_t command_hash;
+    std::uint64_t offset;  // in the uncompressed segment
+};
+
+// A zlib stream covering whole records [raw_offset, raw_offset + raw_size).
+struct BlockEntry {
+    std::uint64_t raw_offset;
+    std::uint64_t file_offset;
+    std::uint32_t raw_size;
+    std::uint32_t file_size;
+};
+
+static_assert(sizeof(IndexHeader) == 48 && sizeof(IndexEntry) == 40 && sizeof(BlockEntry) == 24);
+
+class ScopedFd {
+public:
+    explicit ScopedFd(int fd = -1) : fd_(fd) {}
+    ~ScopedFd() { if (fd_ != -1) close(fd_); }
+    ScopedFd(const ScopedFd&) = delete;
+    ScopedFd& operator=(const ScopedFd&) = delete;
+    int get() const { return fd_; }
+    void reset(int fd) { if (fd_ != -1) close(fd_); fd_ = fd; }
+
+private:
+    int fd_;
+};
+
+// Read-only mapping of a whole file.
+class Mapping {
+public:
+    explicit Mapping(int fd) {
+        struct stat st;
+        if (fd == -1 || fstat(fd, &st) != 0 || st.st_size <= 0) return;
+        void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) return;
+        data_ = static_cast<const char*>(addr);
+        size_ = static_cast<size_t>(st.st_size);
+    }
+    ~Mapping() { if (data_) munmap(const_cast<char*>(data_), size_); }
+    Mapping(const Mapping&) = delete;
+    Mapping& operator=(const Mapping&) = delete;
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+std::uint64_t fnv1a(std::string_view s) {
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : s) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string_view base_name(std::string_view path) {
+    size_t slash = path.rfind('/');
+    return slash == std::string_view::npos ? path : path.substr(slash + 1);
+}
+
+void append_json_string(std::string& out, std::string_view s) {
+    out += '"';
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            out += std::format("\\u{:04x}", c);
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    out += '"';
+}
+
+// Returns the still-escaped value of a string field written by to_json().
+std::optional<std::string_view> json_field(std::string_view record, std::string_view key) {
+    std::string needle = std::format("\"{}\":\"", key);
+    size_t start = record.find(needle);
+    if (start == std::string_view::npos) return std::nullopt;
+    start += needle.size();
+    for (size_t i = start; i < record.size(); ++i) {
+        if (record[i] == '\\') ++i;
+        else if (record[i] == '"') return record.substr(start, i - start);
+    }
+    return std::nullopt;
+}
+
+std::string escaped(std::string_view s) {
+    std::string quoted;
+    append_json_string(quoted, s);
+    return quoted.substr(1, quoted.size() - 2);
+}
+
+bool write_all(int fd, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = write(fd, p, size);
+        if (n == -1 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+std::string segment_name(std::uint64_t seq, std::string_view suffix) {
+    return std::format("{:016}.{}", seq, suffix);
+}
+
+// Sequence numbers of the `<seq>.<suffix>` files for any of @p suffixes,
+// ascending and without duplicates.
+std::vector<std::uint64_t> segment_files(int dir_fd, std::initializer_list<std::string_view> suffixes) {
+    std::vector<std::uint64_t> seqs;
+    int fd = dup(dir_fd);
+    if (fd == -1) return seqs;
+    DIR* dir = fdopendir(fd);
+    if (!dir) {
+        close(fd);
+        return seqs;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        std::string_view name = entry->d_name;
+        auto dot = name.rfind('.');
+        if (dot == std::string_view::npos || std::ranges::find(suffixes, name.substr(dot + 1)) == suffixes.end()) {
+            continue;
+        }
+        name = name.substr(0, dot);
+        std::uint64_t seq = 0;
+        auto [ptr, ec] = std::from_chars(name.data(), name.data() + name.size(), seq);
+        if (ec == std::errc{} && ptr == name.data() + name.size()) seqs.push_back(seq);
+    }
+    closedir(dir);
+    std::ranges::sort(seqs);
+    auto [first, last] = std::ranges::unique(seqs);
+    seqs.erase(first, last);
+    return seqs;
+}
+
+// Sequence numbers of the rolled-over segments, sealed or not, ascending.
+std::vector<std::uint64_t> sealed_segments(int dir_fd) {
+    return segment_files(dir_fd, {"idx"});
+}
+
+const IndexHeader* index_header(const Mapping& index) {
+    if (index.size() < sizeof(IndexHeader)) return nullptr;
+    const auto* header = reinterpret_cast<const IndexHeader*>(index.data());
+    if (std::memcmp(header->magic, k_index_magic, sizeof(k_index_magic)) != 0) return nullptr;
+    return header;
+}
+
+// Writes @p parts to a temporary file and renames it over @p name.
+bool replace_file(int dir_fd, const std::string& name, const std::vector<std::pair<const void*, size_t>>& parts) {
+    std::string tmp = name + ".tmp";
+    ScopedFd fd(openat(dir_fd, tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC, 0600));
+    if (fd.get() == -1) return false;
+    for (const auto& [data, size] : parts) {
+        if (size > 0 && !write_all(fd.get(), data, size)) {
+            unlinkat(dir_fd, tmp.c_str(), 0);
+            return false;
+        }
+    }
+    if (fdatasync(fd.get()) != 0 || renameat(dir_fd, tmp.c_str(), dir_fd, name.c_str()) != 0) {
+        unlinkat(dir_fd, tmp.c_str(), 0);
+        return false;
+    }
+    return true;
+}
+
+// Turns the renamed `<seq>.log`/`<seq>.idx` pair into a sealed segment. The
+// index is rewritten with its time range and count; with zlib the data is
+// recompressed into `<seq>.seg` in blocks cut at record boundaries.
+void seal_segment(int dir_fd, std::uint64_t seq) {
+    std::string log_name = segment_name(seq, "log");
+    std::string index_name = segment_name(seq, "idx");
+    ScopedFd index_fd(openat(dir_fd, index_name.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC));
+    ScopedFd log_fd(openat(dir_fd, log_name.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC));
+    Mapping index(index_fd.get());
+    Mapping log(log_fd.get());
+    if (!index_header(index)) return;
+
+    const auto* entries = reinterpret_cast<const IndexEntry*>(index.data() + sizeof(IndexHeader));
+    size_t count = (index.size() - sizeof(IndexHeader)) / sizeof(IndexEntry);
+    IndexHeader header{};
+    std::memcpy(header.magic, k_index_magic, sizeof(k_index_magic));
+    header.flags = k_flag_sealed;
+    header.entry_count = count;
+    header.min_time = count ? entries[0].time : 0;
+    header.max_time = header.min_time;
+    for (size_t i = 0; i < count; ++i) {
+        header.min_time = std::min(header.min_time, entries[i].time);
+        header.max_time = std::max(header.max_time, entries[i].time);
+    }
+
+#ifdef VOIX_WITH_ZLIB
+    constexpr std::uint64_t k_block_size = 64 * 1024;
+    std::vector<BlockEntry> blocks;
+    std::string compressed;
+    std::uint64_t block_start = 0;
+    auto flush_block = [&](std::uint64_t end) {
+        if (end <= block_start) return true;
+        uLongf bound = compressBound(static_cast<uLong>(end - block_start));
+        size_t at = compressed.size();
+        compressed.resize(at + bound);
+        if (compress2(reinterpret_cast<Bytef*>(compressed.data() + at), &bound,
+                      reinterpret_cast<const Bytef*>(log.data() + block_start),
+                      static_cast<uLong>(end - block_start), Z_DEFAULT_COMPRESSION) != Z_OK) {
+            return false;
+        }
+        compressed.resize(at + bound);
+        blocks.push_back({block_start, at, static_cast<std::uint32_t>(end - block_start),
+                          static_cast<std::uint32_t>(bound)});
+        block_start = end;
+        return true;
+    };
+    bool ok = true;
+    for (size_t i = 0; i < count && ok; ++i) {
+        std::uint64_t end = entries[i].offset + entries[i].length;
+        if (end <= log.size() && end - block_start >= k_block_size) ok = flush_block(end);
+    }
+    ok = ok && flush_block(log.size());
+    if (ok) {
+        header.flags |= k_flag_compressed;
+        header.block_count = blocks.size();
+        ok = replace_file(dir_fd, segment_name(seq, "seg"), {{compressed.data(), compressed.size()}}) &&
+             replace_file(dir_fd, index_name, {{&header, sizeof(header)},
+                                               {entries, count * sizeof(IndexEntry)},
+                                               {blocks.data(), blocks.size() * sizeof(BlockEntry)}});
+    }
+    if (ok) {
+        unlinkat(dir_fd, log_name.c_str(), 0);
+        return;
+    }
+    LOG_WARN(std::format("Failed to compress audit segment {}; kept uncompressed", log_name));
+    header.flags = k_flag_sealed;
+    header.block_count = 0;
+#endif
+    replace_file(dir_fd, index_name, {{&header, sizeof(header)}, {entries, count * sizeof(IndexEntry)}});
+}
+
+// Parses a time term: @<unix>, <n>[smhd] (age), YYYY-MM-DD or YYYY-MM-DDTHH:MM:SS (UTC).
+std::optional<std::int64_t> parse_time(std::string_view value, std::int64_t now) {
+    auto number = [](std::string_view s, auto& out) {
+        auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+        return ec == std::errc{} && ptr == s.data() + s.size();
+    };
+    if (value.starts_with('@')) {
+        std::int64_t t = 0;
+        return number(value.substr(1), t) ? std::optional(t) : std::nullopt;
+    }
+    if (!value.empty() && std::string_view("smhd").find(value.back()) != std::string_view::npos) {
+        std::int64_t n = 0;
+        if (!number(value.substr(0, value.size() - 1), n) || n < 0) return std::nullopt;
+        constexpr std::int64_t k_units[] = {1, 60, 3600, 86400};
+        return now - n * k_units[std::string_view("smhd").find(value.back())];
+    }
+    int year = 0;
+    unsigned month = 0, day = 0, hour = 0, minute = 0, second = 0;
+    if (value.size() != 10 && value.size() != 19) return std::nullopt;
+    if (!number(value.substr(0, 4), year) || value[4] != '-' || !number(value.substr(5, 2), month) ||
+        value[7] != '-' || !number(value.substr(8, 2), day)) {
+        return std::nullopt;
+    }
+    if (value.size() == 19 &&
+        (value[10] != 'T' || !number(value.substr(11, 2), hour) || value[13] != ':' ||
+         !number(value.substr(14, 2), minute) || value[16] != ':' || !number(value.substr(17, 2), second) ||
+         hour > 23 || minute > 59 || second > 60)) {
+        return std::nullopt;
+    }
+    std::chrono::year_month_day date{std::chrono::year(year), std::chrono::month(month), std::chrono::day(day)};
+    if (!date.ok()) return std::nullopt;
+    auto days = std::chrono::sys_days(date).time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::seconds>(days).count() + hour * 3600 + minute * 60 + second;
+}
+
+} // namespace
+
+AuditStore::AuditStore(std::string directory, std::uint64_t segment_size, uid_t owner)
+    : directory_(std::move(directory)), segment_size_(segment_size), owner_(owner) {}
+
+int AuditStore::open_directory(bool create) const {
+    if (directory_.empty() || directory_[0] != '/') return -1;
+
+    if (create && mkdir(directory_.c_str(), 0700) != 0 && errno != EEXIST) {
+        LOG_WARN(std::format("Failed to create audit directory {}: {}",
+                 directory_, std::strerror(errno)));
+        return -1;
+    }
+
+    int dir_fd = open(directory_.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (dir_fd == -1) return -1;
+
+    struct stat st;
+    if (fstat(dir_fd, &st) != 0 || st.st_uid != owner_ ||
+        (st.st_mode & (S_IRWXG | S_IRWXO)) != 0) {
+        LOG_WARN(std::format("Audit directory {} is not private; audit store disabled", directory_));
+        close(dir_fd);
+        return -1;
+    }
+    return dir_fd;
+}
+
+std::string AuditStore::to_json(const AuditRecord& record) {
+    std::string out = std::format("{{\"time\":{},\"uid\":{},\"user\":", record.time, record.caller_uid);
+    append_json_string(out, record.caller);
+    out += ",\"target\":";
+    append_json_string(out, record.target);
+    out += ",\"command\":";
+    append_json_string(out, record.command);
+    out += ",\"args\":[";
+    for (size_t i = 0; i < record.args.size(); ++i) {
+        if (i) out += ',';
+        append_json_string(out, record.args[i]);
+    }
+    out += "],\"verdict\":";
+    append_json_string(out, record.verdict);
+    out += ",\"cwd\":";
+    append_json_string(out, record.cwd);
+    out += '}';
+    return out;
+}
+
+bool AuditStore::append(const AuditRecord& record) const {
+    ScopedFd dir(open_directory(/* create */ true));
+    if (dir.get() == -1) return false;
+
+    ScopedFd lock(openat(dir.get(), ".lock", O_RDWR | O_CREAT | O_NOFOLLOW | O_CLOEXEC, 0600));
+    if (lock.get() == -1) return false;
+    while (flock(lock.get(), LOCK_EX) != 0) {
+        if (errno != EINTR) return false;
+    }
+
+    constexpr int k_append_flags = O_WRONLY | O_APPEND | O_CREAT | O_NOFOLLOW | O_CLOEXEC;
+    ScopedFd log(openat(dir.get(), k_active_log, k_append_flags, 0600));
+    struct stat st;
+    if (log.get() == -1 || fstat(log.get(), &st) != 0) return false;
+
+    if (static_cast<std::uint64_t>(st.st_size) >= segment_size_) {
+        // Numbered past every segment file, so that a half-sealed or orphaned
+        // segment is never renamed over.
+        auto seqs = segment_files(dir.get(), {"idx", "log", "seg"});
+        std::uint64_t seq = seqs.empty() ? 1 : seqs.back() + 1;
+        const std::string index_name = segment_name(seq, "idx");
+        bool indexed = renameat(dir.get(), k_active_index, dir.get(), index_name.c_str()) == 0;
+        if (!indexed && errno != ENOENT) return false;
+        if (renameat(dir.get(), k_active_log, dir.get(), segment_name(seq, "log").c_str()) != 0) {
+            if (indexed) renameat(dir.get(), index_name.c_str(), dir.get(), k_active_index);
+            return false;
+        }
+        if (!indexed) LOG_WARN(std::format("Audit segment {} has no index; its records are not searchable", seq));
+        log.reset(openat(dir.get(), k_active_log, k_append_flags, 0600));
+        if (log.get() == -1) return false;
+        st.st_size = 0;
+    }
+
+    AuditRecord stamped = record;
+    if (stamped.time == 0) {
+        stamped.time = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+    std::string line = to_json(stamped);
+    line += '\n';
+    const auto offset = static_cast<std::uint64_t>(st.st_size);
+    if (!write_all(log.get(), line.data(), line.size())) return false;
+
+    ScopedFd index(openat(dir.get(), k_active_index, k_append_flags, 0600));
+    if (index.get() == -1 || fstat(index.get(), &st) != 0) return false;
+    const auto index_size = static_cast<std::uint64_t>(st.st_size);
+    if (index_size < sizeof(IndexHeader)) {
+        // Empty, or a header torn by a crash: start the index over.
+        if (index_size != 0 && ftruncate(index.get(), 0) != 0) return false;
+        IndexHeader header{};
+        std::memcpy(header.magic, k_index_magic, sizeof(k_index_magic));
+        if (!write_all(index.get(), &header, sizeof(header))) return false;
+    } else if ((index_size - sizeof(IndexHeader)) % sizeof(IndexEntry) != 0) {
+        // Drop an entry torn by a crash so the following ones stay aligned.
+        off_t aligned = static_cast<off_t>(sizeof(IndexHeader) +
+            (index_size - sizeof(IndexHeader)) / sizeof(IndexEntry) * sizeof(IndexEntry));
+        if (ftruncate(index.get(), aligned) != 0) return false;
+    }
+
+    IndexEntry entry{stamped.time, stamped.caller_uid, static_cast<std::uint32_t>(line.size()),
+                     fnv1a(stamped.target), fnv1a(base_name(stamped.command)), offset};
+    return write_all(index.get(), &entry, sizeof(entry));
+}
+
+size_t AuditStore::seal_pending() const {
+    ScopedFd dir(open_directory(/* create */ false));
+    if (dir.get() == -1) return 0;
+    // One sealer at a time; whoever holds the lock seals what is pending.
+    ScopedFd seal_lock(openat(dir.get(), ".seal", O_RDWR | O_CREAT | O_NOFOLLOW | O_CLOEXEC, 0600));
+    if (seal_lock.get() == -1 || flock(seal_lock.get(), LOCK_EX | LOCK_NB) != 0) return 0;
+
+    // append() renames the index and then the log under the append lock, so
+    // only pairs seen while holding it are complete.
+    std::vector<std::uint64_t> pending;
+    {
+        ScopedFd lock(openat(dir.get(), ".lock", O_RDONLY | O_NOFOLLOW | O_CLOEXEC));
+        if (lock.get() == -1) return 0;
+        while (flock(lock.get(), LOCK_SH) != 0) {
+            if (errno != EINTR) return 0;
+        }
+        for (std::uint64_t seq : sealed_segments(dir.get())) {
+            ScopedFd index_fd(openat(dir.get(), segment_name(seq, "idx").c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC));
+            IndexHeader header;
+            if (index_fd.get() == -1 || read(index_fd.get(), &header, sizeof(header)) != sizeof(header) ||
+                std::memcmp(header.magic, k_index_magic, sizeof(k_index_magic)) != 0 ||
+                (header.flags & k_flag_sealed)) {
+                continue;
+            }
+            if (faccessat(dir.get(), segment_name(seq, "log").c_str(), F_OK, AT_SYMLINK_NOFOLLOW) == 0) {
+                pending.push_back(seq);
+            }
+        }
+    }
+    for (std::uint64_t seq : pending) seal_segment(dir.get(), seq);
+    return pending.size();
+}
+
+std::optional<size_t> AuditStore::query(const AuditQuery& query,
+                                        const std::function<void(std::string_view)>& out) const {
+    ScopedFd dir(open_directory(/* create */ false));
+    if (dir.get() == -1) {
+        if (errno == ENOENT) return 0;
+        return std::nullopt;
+    }
+
+    const std::optional<std::uint64_t> target_hash =
+        query.target ? std::optional(fnv1a(*query.target)) : std::nullopt;
+    const std::optional<std::uint64_t> command_hash =
+        query.command ? std::optional(fnv1a(base_name(*query.command))) : std::nullopt;
+    const bool command_is_path = query.command && query.command->find('/') != std::string::npos;
+
+    size_t matches = 0;
+    auto scan = [&](const Mapping& index, const Mapping& data) {
+        const IndexHeader* header = index_header(index);
+        if (!header) return;
+        const bool sealed = header->flags & k_flag_sealed;
+        const bool compressed = header->flags & k_flag_compressed;
+        size_t count = (index.size() - sizeof(IndexHeader)) / sizeof(IndexEntry);
+        if (sealed) {
+            if (query.since && header->max_time < *query.since) return;
+            if (query.until && header->min_time >= *query.until) return;
+            if (header->entry_count > count) return;
+            count = header->entry_count;
+        }
+        const auto* entries = reinterpret_cast<const IndexEntry*>(index.data() + sizeof(IndexHeader));
+        const BlockEntry* blocks = nullptr;
+        size_t block_count = 0;
+        if (compressed) {
+            size_t table = sizeof(IndexHeader) + count * sizeof(IndexEntry);
+            if (header->block_count > (index.size() - table) / sizeof(BlockEntry)) return;
+            blocks = reinterpret_cast<const BlockEntry*>(index.data() + table);
+            block_count = header->block_count;
+        }
+
+        std::string inflated;
+        const BlockEntry* inflated_block = nullptr;
+        for (size_t i = 0; i < count; ++i) {
+            const IndexEntry& e = entries[i];
+            if (query.since && e.time < *query.since) continue;
+            if (query.until && e.time >= *query.until) continue;
+            if (query.caller_uid && e.caller_uid != *query.caller_uid) continue;
+            if (target_hash && e.target_hash != *target_hash) continue;
+            if (command_hash && e.command_hash != *command_hash) continue;
+            if (e.length == 0) continue;
+
+            std::string_view record;
+            if (!compressed) {
+                if (e.offset + e.length > data.size()) continue;
+                record = std::string_view(data.data() + e.offset, e.length - 1);
+            } else {
+#ifdef VOIX_WITH_ZLIB
+                const BlockEntry* block = std::upper_bound(blocks, blocks + block_count, e.offset,
+                    [](std::uint64_t offset, const BlockEntry& b) { return offset < b.raw_offset; });
+                if (block == blocks) continue;
+                --block;
+                if (block != inflated_block) {
+                    if (block->file_offset + block->file_size > data.size()) continue;
+                    inflated.resize(block->raw_size);
+                    uLongf size = block->raw_size;
+                    if (uncompress(reinterpret_cast<Bytef*>(inflated.data()), &size,
+                                   reinterpret_cast<const Bytef*>(data.data() + block->file_offset),
+                                   block->file_size) != Z_OK || size != block->raw_size) {
+                        inflated_block = nullptr;
+                        continue;
+                    }
+                    inflated_block = block;
+                }
+                std::uint64_t at = e.offset - block->raw_offset;
+                if (at + e.length > inflated.size()) continue;
+                record = std::string_view(inflated.data() + at, e.length - 1);
+#else
+                (void)blocks;
+                (void)block_count;
+                (void)inflated_block;
+                continue;
+#endif
+            }
+
+            // The hashes narrow the scan; the record itself decides.
+            if (query.target && json_field(record, "target") != escaped(*query.target)) continue;
+            if (query.command) {
+                auto command = json_field(record, "command");
+                if (!command) continue;
+                std::string wanted = escaped(*query.command);
+                if (command_is_path ? *command != wanted : base_name(*command) != wanted) continue;
+            }
+            out(record);
+            ++matches;
+        }
+    };
+
+    for (std::uint64_t seq : sealed_segments(dir.get())) {
+        // A concurrent seal may swap the index and remove the raw data in
+        // between our opens; the second pass sees the sealed result.
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            ScopedFd index_fd(openat(dir.get(), segment_name(seq, "idx").c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC));
+            Mapping index(index_fd.get());
+            const IndexHeader* header = index_header(index);
+            if (!header) break;
+            bool compressed = header->flags & k_flag_compressed;
+            ScopedFd data_fd(openat(dir.get(), segment_name(seq, compressed ? "seg" : "log").c_str(),
+                                    O_RDONLY | O_NOFOLLOW | O_CLOEXEC));
+            if (data_fd.get() == -1 && errno == ENOENT && attempt == 0) continue;
+            Mapping data(data_fd.get());
+            scan(index, data);
+            break;
+        }
+    }
+
+    // Hold the append lock only while opening the active pair, so a roll
+    // cannot separate the index from its data.
+    ScopedFd lock(openat(dir.get(), ".lock", O_RDONLY | O_NOFOLLOW | O_CLOEXEC));
+    if (lock.get() != -1) flock(lock.get(), LOCK_SH);
+    ScopedFd index_fd(openat(dir.get(), k_active_index, O_RDONLY | O_NOFOLLOW | O_CLOEXEC));
+    ScopedFd data_fd(openat(dir.get(), k_active_log, O_RDONLY | O_NOFOLLOW | O_CLOEXEC));
+    Mapping index(index_fd.get());
+    Mapping data(data_fd.get());
+    if (lock.get() != -1) flock(lock.get(), LOCK_UN);
+    scan(index, data);
+    return matches;
+}
+
+std::optional<AuditQuery> AuditStore::parse_query(std::string_view expression, std::int64_t now,
+                                                  std::string& error) {
+    AuditQuery query;
+    while (!expression.empty()) {
+        size_t start = expression.find_first_not_of(' ');
+        if (start == std::string_view::npos) break;
+        expression.remove_prefix(start);
+        size_t end = expression.find(' ');
+        std::string_view term = expression.substr(0, end);
+        expression.remove_prefix(end == std::string_view::npos ? expression.size() : end);
+
+        size_t eq = term.find('=');
+        if (eq == std::string_view::npos || eq + 1 == term.size()) {
+            error = std::format("expected key=value, got '{}'", term);
+            return std::nullopt;
+        }
+        std::string_view key = term.substr(0, eq);
+        std::string_view value = term.substr(eq + 1);
+        if (key == "since" || key == "until") {
+            auto t = parse_time(value, now);
+            if (!t) {
+                error = std::format("invalid time '{}'", value);
+                return std::nullopt;
+            }
+            (key == "since" ? query.since : query.until) = *t;
+        } else if (key == "user") {
+            uid_t uid = 0;
+            auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), uid);
+            if (ec == std::errc{} && ptr == value.data() + value.size()) {
+                query.caller_uid = uid;
+            } else if (auto pw = lookup_passwd_by_name(value)) {
+                query.caller_uid = pw->uid;
+            } else {
+                error = std::format("unknown user '{}'", value);
+                return std::nullopt;
+            }
+        } else if (key == "target") {
+            query.target = std::string(value);
+        } else if (key == "command") {
+            query.command = std::string(value);
+        } else {
+            error = std::format("unknown key '{}'", key);
+            return std::nullopt;
+        }
+    }
+    return query;
+}
+
+} // namespace Voix
@@ -10,10 +10,14 @@
 #include "security.hpp"
 #include "rule.hpp"
 #include "pam_utils.hpp"
+#include "probes.hpp"
 #include "logger.hpp"
+#include "timestamp_cache.hpp"
+#include "trace.hpp"
 #include <pwd.h>
 #include <grp.h>
 #include <unistd.h>
+#include <cstdlib>
 #include <cstring>
 #include <format>
 #include <print>
@@ -27,8 +31,10 @@
 namespace Voix {
 
 PamAuthenticator::PamAuthenticator(std::shared_ptr<Security> security,
-                             bool non_interactive)
-    : security_(std::move(security)), non_interactive_(non_interactive) {}
+                             bool non_interactive,
+                             std::shared_ptr<TimestampCache> timestamps)
+    : security_(std::move(security)), timestamps_(std::move(timestamps)),
+      non_interactive_(non_interactive) {}
 
 PamAuthenticator::~PamAuthenticator() {
     if (pamh_) {
@@ -36,18 +42,49 @@ PamAuthenticator::~PamAuthenticator() {
     }
 }
 
+namespace {
+
+// Fires auth_done on every return from PamAuthenticator::authenticate().
+struct AuthProbe {
+  std::uint64_t start = probes::start_clock(VOIX_PROBE_ENABLED(auth_done));
+  bool ok = false;
+  bool pam = false;
+
+  bool finish(bool result) {
+    ok = result;
+    return result;
+  }
+  ~AuthProbe() {
+    VOIX_PROBE4(auth_done, probes::current_request(), ok ? 1 : 0, pam ? 1 : 0, probes::elapsed(start));
+  }
+};
+
+} // namespace
+
 bool PamAuthenticator::authenticate(const std::optional<Rule>& rule) {
+  AuthProbe probe;
   if (rule && (rule->options & Rule::NOPASS)) {
-    return true;
+    method_ = "nopass";
+    return probe.finish(true);
   }
 
   std::string current_user = security_->getCurrentUser();
   if (current_user == "root") {
-    return true;
+    method_ = "root";
+    return probe.finish(true);
+  }
+
+  // Persist: a fresh timestamp for this user/tty/session/parent replaces the
+  // PAM conversation entirely, so it is checked before pam_start().
+  const bool persist = timestamps_ && rule && (rule->options & Rule::PERSIST);
+  const uid_t current_uid = security_->get_current_uid();
+  if (persist && timestamps_->is_valid(current_uid)) {
+    method_ = "persist";
+    return probe.finish(true);
   }
 
   if (non_interactive_) {
-    return false;
+    return probe.finish(false);
   }
 
   if (pamh_) {
@@ -60,21 +97,38 @@ bool PamAuthenticator::authenticate(const std::optional<Rule>& rule) {
       nullptr
   };
 
+  probe.pam = true;
+  Trace::Span start_span("pam_start");
+#ifdef VOIX_HARNESS
+  // voix_e2e builds only (VOIX_ENABLE_HARNESS, never installed): the harness
+  // points PAM at a throwaway service directory instead of /etc/pam.d.
+  const char* harness_pam_dir = getenv("VOIX_HARNESS_PAM_DIR");
+  int pam_result = harness_pam_dir
+      ? pam_start_confdir("voix", current_user.c_str(), &conv, harness_pam_dir, &pamh_)
+      : pam_start("voix", current_user.c_str(), &conv, &pamh_);
+#else
   int pam_result = pam_start("voix", current_user.c_str(), &conv, &pamh_);
+#endif
+  start_span.end();
   if (pam_result != PAM_SUCCESS) {
     std::println(stderr, "PAM initialization failed: {}",
                  pam_strerror(nullptr, pam_result));
-    return false;
+    return probe.finish(false);
   }
 
+  Trace::Span auth_span("pam_authenticate");
   pam_result = pam_authenticate(pamh_, 0);
+  auth_span.note(pam_strerror(pamh_, pam_result));
+  auth_span.end();
   bool auth_success = (pam_result == PAM_SUCCESS);
 
   if (!auth_success) {
     std::println(stderr, "Authentication failed: {}", pam_strerror(pamh_, pam_result));
-    security_->logEvent("PAM authentication failed", current_user);
   } else {
+    Trace::Span acct_span("pam_acct_mgmt");
     pam_result = pam_acct_mgmt(pamh_, 0);
+    acct_span.note(pam_strerror(pamh_, pam_result));
+    acct_span.end();
     auth_success = (pam_result == PAM_SUCCESS);
     if (!auth_success) {
       std::println(stderr, "Account validation failed: {}",
@@ -86,17 +140,23 @@ bool PamAuthenticator::authenticate(const std::optional<Rule>& rule) {
     pam_end(pamh_, pam_result);
     pamh_ = nullptr;
   } else {
-    security_->logEvent("PAM authentication successful", current_user);
+    method_ = "pam";
+    if (persist && !timestamps_->update(current_uid)) {
+      LOG_WARN("Failed to record persist timestamp");
+    }
   }
 
-  return auth_success;
+  return probe.finish(auth_success);
 }
 
 bool PamAuthenticator::openSession() {
     if (!pamh_) return true;
 
+    Trace::Span setcred_span("pam_setcred");
     int result = pam_setcred(pamh_, PAM_ESTABLISH_CRED);
+    setcred_span.end();
     if (result == PAM_SUCCESS) {
+        Trace::Span session_span("pam_open_session");
         result = pam_open_session(pamh_, 0);
         if (result != PAM_SUCCESS) {
             std::println(stderr, "Failed to open PAM session: {}", pam_strerror(pamh_, result));
@@ -111,6 +171,7 @@ bool PamAuthenticator::openSession() {
 
 void PamAuthenticator::closeSession() {
     if (pamh_) {
+        Trace::Span span("pam_close_session");
         int result = pam_close_session(pamh_, 0);
         if (result != PAM_SUCCESS) {
             LOG_WARN(std::format("Failed to close PAM session: {}",
@@ -126,4 +187,12 @@ void PamAuthenticator::closeSession() {
     }
 }
 
+bool PamAuthenticator::has_session() const {
+    return pamh_ != nullptr;
+}
+
+std::string_view PamAuthenticator::method() const {
+    return method_;
+}
+
 } // namespace Voix
@@ -0,0 +1,72 @@
+/**
+ * @file authorization.cpp
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#include "authorization.hpp"
+#include "command_resolver.hpp"
+#include "config.hpp"
+#include "permission_checker.hpp"
+#include "security.hpp"
+#include "trace.hpp"
+
+namespace Voix {
+
+AuthorizationDecision authorize(const Config& config, const Security& security,
+                                const PermissionChecker& checker, ICommandResolver& resolver,
+                                const AuthorizationRequest& request) {
+    AuthorizationDecision decision;
+    decision.persist_dir = config.get_persist_dir();
+    decision.persist_timeout = config.get_persist_timeout();
+    decision.audit_dir = config.get_audit_dir();
+    decision.audit_segment_size = config.get_audit_segment_size();
+    decision.audit_sinks = config.get_audit_sinks();
+    decision.suppress_stderr = config.should_suppress_stderr();
+    decision.login_shell_default = config.is_login_shell_default();
+
+    // An unresolvable command is still judged by name; executing it fails
+    // later with 127.
+    Trace::Span resolve_span("command resolve");
+    auto resolved = resolver.resolve(request.command, request.cwd);
+    if (resolved) resolve_span.note(resolved->path);
+    resolve_span.end();
+
+    Trace::Span catastrophic_span("catastrophic check");
+    bool catastrophic = security.isCatastrophicCommand(request.command, request.args, config, request.cwd);
+    if (!catastrophic && resolved) {
+        catastrophic = config.is_blocked_file(resolved->dev, resolved->ino) ||
+                       (resolved->path != request.command &&
+                        security.isCatastrophicCommand(resolved->path, request.args, config, request.cwd));
+    }
+    catastrophic_span.note(catastrophic ? "blocked" : "passed");
+    catastrophic_span.end();
+    if (catastrophic) {
+        decision.verdict = AuthorizationDecision::Verdict::CATASTROPHIC;
+        return decision;
+    }
+
+    auto target_uid = security.identity->get_uid_by_name(request.target_user);
+    if (!target_uid) {
+        decision.verdict = AuthorizationDecision::Verdict::INVALID_TARGET;
+        return decision;
+    }
+
+    auto rule = checker.permit(request.command, request.args, *target_uid,
+                               resolved ? std::string_view(resolved->path) : std::string_view{},
+                               &decision.rule_index);
+    if (!rule) {
+        decision.verdict = AuthorizationDecision::Verdict::DENY;
+        return decision;
+    }
+
+    decision.verdict = AuthorizationDecision::Verdict::PERMIT;
+    decision.context = Command::resolve_context(config, *rule, request.target_user);
+    if (resolved) decision.context.command = std::move(*resolved);
+    decision.rule = std::move(*rule);
+    return decision;
+}
+
+} // namespace Voix
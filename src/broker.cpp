@@ -0,0 +1,663 @@
+/**
+ * @file broker.cpp
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#include "broker.hpp"
+#include "command_resolver.hpp"
+#include "config.hpp"
+#include "logger.hpp"
+#include "permission_checker.hpp"
+#include "probes.hpp"
+#include "rule_stats.hpp"
+#include "security.hpp"
+#include "system_identity.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Voix {
+
+namespace {
+
+constexpr std::uint32_t k_request_magic = 0x56585251;   // "VXRQ"
+constexpr std::uint32_t k_decision_magic = 0x56584443;  // "VXDC"
+constexpr std::uint32_t k_max_frame = 1U << 20;
+constexpr time_t k_io_timeout_sec = 5;
+// Server side: a peer gets this long from accept to the last byte of the
+// reply, and at most this many peers are served at once.
+constexpr std::chrono::milliseconds k_request_deadline{1000};
+constexpr size_t k_max_connections = 256;
+
+class WireWriter {
+public:
+    WireWriter() { buf_.resize(sizeof(std::uint32_t)); }
+
+    void u8(std::uint8_t v) { buf_.push_back(static_cast<char>(v)); }
+    void u32(std::uint32_t v) { append(&v, sizeof(v)); }
+    void u64(std::uint64_t v) { append(&v, sizeof(v)); }
+    void str(std::string_view s) {
+        u32(static_cast<std::uint32_t>(s.size()));
+        append(s.data(), s.size());
+    }
+    void strings(const std::vector<std::string>& v) {
+        u32(static_cast<std::uint32_t>(v.size()));
+        for (const auto& s : v) str(s);
+    }
+
+    // Patches the length prefix and returns the complete frame.
+    std::string& frame() {
+        auto len = static_cast<std::uint32_t>(buf_.size() - sizeof(std::uint32_t));
+        std::memcpy(buf_.data(), &len, sizeof(len));
+        return buf_;
+    }
+
+private:
+    void append(const void* p, size_t n) { buf_.append(static_cast<const char*>(p), n); }
+    std::string buf_;
+};
+
+class WireReader {
+public:
+    explicit WireReader(std::string_view data) : data_(data) {}
+
+    std::uint8_t u8() {
+        std::uint8_t v = 0;
+        take(&v, sizeof(v));
+        return v;
+    }
+    std::uint32_t u32() {
+        std::uint32_t v = 0;
+        take(&v, sizeof(v));
+        return v;
+    }
+    std::uint64_t u64() {
+        std::uint64_t v = 0;
+        take(&v, sizeof(v));
+        return v;
+    }
+    std::string str() {
+        std::uint32_t n = u32();
+        if (!ok_ || n > data_.size()) {
+            ok_ = false;
+            return {};
+        }
+        std::string s(data_.substr(0, n));
+        data_.remove_prefix(n);
+        return s;
+    }
+    std::vector<std::string> strings() {
+        std::uint32_t n = u32();
+        std::vector<std::string> v;
+        // Every element needs at least its length prefix.
+        if (!ok_ || n > data_.size() / sizeof(std::uint32_t)) {
+            ok_ = false;
+            return v;
+        }
+        v.reserve(n);
+        for (std::uint32_t i = 0; i < n && ok_; ++i) v.push_back(str());
+        return v;
+    }
+
+    bool ok() const { return ok_ && data_.empty(); }
+
+private:
+    void take(void* p, size_t n) {
+        if (!ok_ || data_.size() < n) {
+            ok_ = false;
+            return;
+        }
+        std::memcpy(p, data_.data(), n);
+        data_.remove_prefix(n);
+    }
+
+    std::string_view data_;
+    bool ok_ = true;
+};
+
+bool write_all(int fd, const char* p, size_t n) {
+    while (n > 0) {
+        ssize_t w = send(fd, p, n, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return false;
+        p += w;
+        n -= static_cast<size_t>(w);
+    }
+    return true;
+}
+
+bool read_all(int fd, char* p, size_t n) {
+    while (n > 0) {
+        ssize_t r = recv(fd, p, n, 0);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        p += r;
+        n -= static_cast<size_t>(r);
+    }
+    return true;
+}
+
+std::optional<std::string> read_frame(int fd) {
+    std::uint32_t len = 0;
+    if (!read_all(fd, reinterpret_cast<char*>(&len), sizeof(len)) || len > k_max_frame) {
+        return std::nullopt;
+    }
+    std::string payload(len, '\0');
+    if (!read_all(fd, payload.data(), len)) return std::nullopt;
+    return payload;
+}
+
+void set_io_timeouts(int fd) {
+    struct timeval tv{k_io_timeout_sec, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+bool fill_address(struct sockaddr_un& addr, std::string_view path) {
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) return false;
+    addr = {};
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.data(), path.size());
+    return true;
+}
+
+void encode_request(WireWriter& w, const AuthorizationRequest& request) {
+    w.u32(k_request_magic);
+    w.str(request.target_user);
+    w.str(request.command);
+    w.strings(request.args);
+    w.str(request.cwd);
+}
+
+std::optional<AuthorizationRequest> decode_request(std::string_view payload) {
+    WireReader r(payload);
+    if (r.u32() != k_request_magic) return std::nullopt;
+    AuthorizationRequest request;
+    request.target_user = r.str();
+    request.command = r.str();
+    request.args = r.strings();
+    request.cwd = r.str();
+    if (!r.ok()) return std::nullopt;
+    return request;
+}
+
+void encode_decision(WireWriter& w, const AuthorizationDecision& d) {
+    w.u32(k_decision_magic);
+    w.u8(static_cast<std::uint8_t>(d.verdict));
+
+    const Rule& rule = d.rule;
+    w.str(rule.ident);
+    w.str(rule.target);
+    w.str(rule.cmd);
+    w.strings(rule.cmdargs);
+    w.strings(rule.envlist);
+    w.str(rule.profile);
+    w.u64(static_cast<std::uint64_t>(rule.timeout.count()));
+    w.u64(static_cast<std::uint64_t>(rule.kill_after.count()));
+    w.u8(static_cast<std::uint8_t>(rule.action));
+    w.u32(static_cast<std::uint32_t>(rule.options));
+
+    const SecurityProfile& p = d.context.profile;
+    w.u8(p.retain_full_capabilities);
+    w.u8(p.enable_seccomp);
+    w.u8(p.enable_resource_limits);
+    w.u8(p.scrub_environment);
+    w.u8(p.preserve_full_environment);
+    w.u8(static_cast<std::uint8_t>(p.exec_mode));
+    w.str(p.cgroup.path);
+    std::vector<std::string> cgroup_files, cgroup_values;
+    for (const auto& [file, value] : p.cgroup.controls) {
+        cgroup_files.push_back(file);
+        cgroup_values.push_back(value);
+    }
+    w.strings(cgroup_files);
+    w.strings(cgroup_values);
+    const ProcessTuning& t = p.tuning;
+    w.u8(t.nice.has_value());
+    w.u32(static_cast<std::uint32_t>(t.nice.value_or(0)));
+    w.u8(static_cast<std::uint8_t>(t.sched_policy));
+    w.u8(static_cast<std::uint8_t>(t.io_class));
+    w.u8(static_cast<std::uint8_t>(t.io_level));
+    w.u32(static_cast<std::uint32_t>(t.cpus.size()));
+    for (unsigned cpu : t.cpus) w.u32(cpu);
+    w.u8(t.numa_node.has_value());
+    w.u32(t.numa_node.value_or(0));
+    w.u32(static_cast<std::uint32_t>(t.rlimits.size()));
+    for (const auto& rl : t.rlimits) {
+        w.u32(static_cast<std::uint32_t>(rl.resource));
+        w.u64(rl.limit.rlim_cur);
+        w.u64(rl.limit.rlim_max);
+    }
+    w.str(d.context.path);
+    w.u8(d.context.seccomp_enabled);
+    const EnvPolicy& env_policy = d.context.env_policy ? *d.context.env_policy : EnvPolicy::defaults();
+    w.strings(env_policy.keep());
+    w.strings(env_policy.check());
+    w.strings(env_policy.deny());
+    w.str(d.context.command.path);
+    w.u64(static_cast<std::uint64_t>(d.context.command.dev));
+    w.u64(static_cast<std::uint64_t>(d.context.command.ino));
+
+    w.str(d.persist_dir);
+    w.u64(static_cast<std::uint64_t>(d.persist_timeout.count()));
+    w.str(d.audit_dir);
+    w.u64(d.audit_segment_size);
+    w.u8(static_cast<std::uint8_t>(d.audit_sinks));
+    w.u8(d.suppress_stderr);
+    w.u8(d.login_shell_default);
+    w.u64(d.rule_index ? *d.rule_index + 1 : 0);
+    w.str(d.rule_stats_path);
+    w.u64(d.rules_fingerprint);
+    w.u64(d.rule_count);
+}
+
+std::optional<AuthorizationDecision> decode_decision(std::string_view payload) {
+    WireReader r(payload);
+    if (r.u32() != k_decision_magic) return std::nullopt;
+
+    AuthorizationDecision d;
+    std::uint8_t verdict = r.u8();
+    if (verdict > static_cast<std::uint8_t>(AuthorizationDecision::Verdict::INVALID_TARGET)) {
+        return std::nullopt;
+    }
+    d.verdict = static_cast<AuthorizationDecision::Verdict>(verdict);
+
+    Rule& rule = d.rule;
+    rule.ident = r.str();
+    rule.target = r.str();
+    rule.cmd = r.str();
+    rule.cmdargs = r.strings();
+    rule.envlist = r.strings();
+    rule.profile = r.str();
+    rule.timeout = std::chrono::seconds(static_cast<std::int64_t>(r.u64()));
+    rule.kill_after = std::chrono::seconds(static_cast<std::int64_t>(r.u64()));
+    rule.action = r.u8() == 0 ? Rule::Action::PERMIT : Rule::Action::DENY;
+    rule.options = static_cast<int>(r.u32());
+
+    SecurityProfile& p = d.context.profile;
+    p.retain_full_capabilities = r.u8() != 0;
+    p.enable_seccomp = r.u8() != 0;
+    p.enable_resource_limits = r.u8() != 0;
+    p.scrub_environment = r.u8() != 0;
+    p.preserve_full_environment = r.u8() != 0;
+    p.exec_mode = r.u8() == static_cast<std::uint8_t>(ExecMode::FORK) ? ExecMode::FORK : ExecMode::AUTO;
+    p.cgroup.path = r.str();
+    std::vector<std::string> cgroup_files = r.strings();
+    std::vector<std::string> cgroup_values = r.strings();
+    if (cgroup_files.size() != cgroup_values.size()) return std::nullopt;
+    for (size_t i = 0; i < cgroup_files.size(); ++i) {
+        p.cgroup.controls.emplace_back(std::move(cgroup_files[i]), std::move(cgroup_values[i]));
+    }
+    ProcessTuning& t = p.tuning;
+    bool has_nice = r.u8() != 0;
+    auto nice = static_cast<std::int32_t>(r.u32());
+    if (has_nice) t.nice = nice;
+    std::uint8_t sched_policy = r.u8();
+    std::uint8_t io_class = r.u8();
+    if (sched_policy > static_cast<std::uint8_t>(SchedPolicy::IDLE) ||
+        io_class > static_cast<std::uint8_t>(IoClass::IDLE)) {
+        return std::nullopt;
+    }
+    t.sched_policy = static_cast<SchedPolicy>(sched_policy);
+    t.io_class = static_cast<IoClass>(io_class);
+    t.io_level = r.u8();
+    std::uint32_t cpu_count = r.u32();
+    for (std::uint32_t i = 0; i < cpu_count && r.ok(); ++i) {
+        std::uint32_t cpu = r.u32();
+        if (cpu >= CPU_SETSIZE) return std::nullopt;
+        t.cpus.push_back(cpu);
+    }
+    bool has_numa = r.u8() != 0;
+    std::uint32_t numa_node = r.u32();
+    if (has_numa) t.numa_node = numa_node;
+    std::uint32_t rlimit_count = r.u32();
+    for (std::uint32_t i = 0; i < rlimit_count && r.ok(); ++i) {
+        ResourceLimit rl{};
+        rl.resource = static_cast<decltype(rl.resource)>(r.u32());
+        rl.limit.rlim_cur = r.u64();
+        rl.limit.rlim_max = r.u64();
+        t.rlimits.push_back(rl);
+    }
+    d.context.path = r.str();
+    d.context.seccomp_enabled = r.u8() != 0;
+    std::vector<std::string> env_keep = r.strings();
+    std::vector<std::string> env_check = r.strings();
+    std::vector<std::string> env_deny = r.strings();
+    d.context.rule_env = rule.envlist;
+    d.context.command.path = r.str();
+    d.context.command.dev = static_cast<dev_t>(r.u64());
+    d.context.command.ino = static_cast<ino_t>(r.u64());
+
+    d.persist_dir = r.str();
+    d.persist_timeout = std::chrono::seconds(static_cast<std::int64_t>(r.u64()));
+    d.audit_dir = r.str();
+    d.audit_segment_size = r.u64();
+    d.audit_sinks = r.u8();
+    d.suppress_stderr = r.u8() != 0;
+    d.login_shell_default = r.u8() != 0;
+    if (std::uint64_t index = r.u64()) d.rule_index = static_cast<size_t>(index - 1);
+    d.rule_stats_path = r.str();
+    d.rules_fingerprint = r.u64();
+    d.rule_count = r.u64();
+    if (!r.ok() || (d.rule_index && *d.rule_index >= d.rule_count)) return std::nullopt;
+    d.context.env_policy = std::make_shared<const EnvPolicy>(
+        std::move(env_keep), std::move(env_check), std::move(env_deny));
+    return d;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// AuthorizationBroker
+// ---------------------------------------------------------------------------
+
+AuthorizationBroker::AuthorizationBroker(std::string config_path, bool verify_security)
+    : config_path_(std::move(config_path)),
+      verify_security_(verify_security),
+      identity_(std::make_shared<CachingIdentity>(std::make_shared<SystemIdentity>())) {}
+
+AuthorizationBroker::~AuthorizationBroker() {
+    if (listen_fd_ != -1) {
+        close(listen_fd_);
+        unlink(socket_path_.c_str());
+    }
+}
+
+bool AuthorizationBroker::reload() {
+    struct stat st;
+    if (stat(config_path_.c_str(), &st) != 0) {
+        LOG_ERROR(std::format("voixd: cannot stat {}: {}", config_path_, std::strerror(errno)));
+        return config_ != nullptr;
+    }
+    if (config_ && st.st_dev == config_dev_ && st.st_ino == config_ino_ &&
+        st.st_mtim.tv_sec == config_mtime_.tv_sec && st.st_mtim.tv_nsec == config_mtime_.tv_nsec) {
+        return true;
+    }
+
+    auto config = std::make_shared<Config>();
+    if (!config->load(config_path_, verify_security_)) {
+        // Keep serving the last good policy rather than denying everything
+        // because of a half-written edit.
+        LOG_ERROR(std::format("voixd: failed to load {}; keeping previous policy", config_path_));
+        return config_ != nullptr;
+    }
+
+    config_ = std::move(config);
+    resolver_ = std::make_unique<CommandResolver>(config_->getPath());
+    rules_fingerprint_ = RuleHitCounters::fingerprint(config_->getRules());
+    config_dev_ = st.st_dev;
+    config_ino_ = st.st_ino;
+    config_mtime_ = st.st_mtim;
+    identity_->clear();
+    LOG_INFO(std::format("voixd: loaded policy from {}", config_path_));
+    return true;
+}
+
+bool AuthorizationBroker::listen(std::string_view socket_path) {
+    struct sockaddr_un addr;
+    if (!fill_address(addr, socket_path)) return false;
+    socket_path_ = std::string(socket_path);
+
+    struct stat st;
+    if (lstat(socket_path_.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            LOG_ERROR(std::format("voixd: {} exists and is not a socket", socket_path_));
+            return false;
+        }
+        unlink(socket_path_.c_str());
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd == -1) return false;
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        chmod(socket_path_.c_str(), 0666) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+        LOG_ERROR(std::format("voixd: cannot listen on {}: {}", socket_path_, std::strerror(errno)));
+        close(fd);
+        return false;
+    }
+    listen_fd_ = fd;
+    return true;
+}
+
+namespace {
+
+// One in-flight request. The frame is buffered until complete so that a peer
+// that stalls mid-request only ever costs its own connection.
+struct Connection {
+    struct ucred cred{};
+    std::string in;
+    std::string out;
+    size_t sent = 0;
+    std::chrono::steady_clock::time_point deadline;
+};
+
+} // namespace
+
+void AuthorizationBroker::serve() {
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+    if (ep == -1) {
+        LOG_ERROR(std::format("voixd: epoll_create1 failed: {}", std::strerror(errno)));
+        return;
+    }
+    struct epoll_event lev{};
+    lev.events = EPOLLIN;
+    lev.data.fd = listen_fd_;
+    epoll_ctl(ep, EPOLL_CTL_ADD, listen_fd_, &lev);
+
+    std::unordered_map<int, Connection> conns;
+    auto drop = [&](int fd) {
+        epoll_ctl(ep, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        conns.erase(fd);
+    };
+
+    // Reads what is available; once the frame is complete, evaluates it and
+    // starts writing the reply. Returns false when the connection is done.
+    auto pump = [&](int fd, Connection& c) {
+        if (c.out.empty()) {
+            char buf[4096];
+            for (;;) {
+                ssize_t r = recv(fd, buf, sizeof(buf), 0);
+                if (r < 0 && errno == EINTR) continue;
+                if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+                if (r <= 0) return false;
+                c.in.append(buf, static_cast<size_t>(r));
+                if (c.in.size() < sizeof(std::uint32_t)) continue;
+                std::uint32_t len = 0;
+                std::memcpy(&len, c.in.data(), sizeof(len));
+                if (len > k_max_frame) return false;
+                if (c.in.size() < sizeof(len) + len) continue;
+                c.out = answer(c.cred, std::string_view(c.in).substr(sizeof(len), len));
+                if (c.out.empty()) return false;
+                break;
+            }
+        }
+        while (c.sent < c.out.size()) {
+            ssize_t w = send(fd, c.out.data() + c.sent, c.out.size() - c.sent, MSG_NOSIGNAL);
+            if (w < 0 && errno == EINTR) continue;
+            if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                struct epoll_event ev{};
+                ev.events = EPOLLOUT;
+                ev.data.fd = fd;
+                epoll_ctl(ep, EPOLL_CTL_MOD, fd, &ev);
+                return true;
+            }
+            if (w <= 0) return false;
+            c.sent += static_cast<size_t>(w);
+        }
+        return false;
+    };
+
+    struct epoll_event events[64];
+    while (!stopping_.load(std::memory_order_relaxed)) {
+        int timeout = -1;
+        if (!conns.empty()) {
+            auto next = std::min_element(conns.begin(), conns.end(), [](const auto& a, const auto& b) {
+                return a.second.deadline < b.second.deadline;
+            })->second.deadline;
+            auto wait = std::chrono::ceil<std::chrono::milliseconds>(next - std::chrono::steady_clock::now());
+            timeout = static_cast<int>(std::max<std::chrono::milliseconds::rep>(wait.count(), 0));
+        }
+
+        int n = epoll_wait(ep, events, 64, timeout);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            LOG_ERROR(std::format("voixd: epoll_wait failed: {}", std::strerror(errno)));
+            break;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd != listen_fd_) {
+                auto it = conns.find(fd);
+                if (it != conns.end() && !pump(fd, it->second)) drop(fd);
+                continue;
+            }
+            for (;;) {
+                int cfd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+                if (cfd == -1) {
+                    if (errno == EINTR || errno == ECONNABORTED) continue;
+                    if (errno != EAGAIN && errno != EWOULDBLOCK && !stopping_.load(std::memory_order_relaxed)) {
+                        LOG_ERROR(std::format("voixd: accept failed: {}", std::strerror(errno)));
+                    }
+                    break;
+                }
+                Connection c;
+                socklen_t len = sizeof(c.cred);
+                struct epoll_event ev{};
+                ev.events = EPOLLIN;
+                ev.data.fd = cfd;
+                if (conns.size() >= k_max_connections ||
+                    getsockopt(cfd, SOL_SOCKET, SO_PEERCRED, &c.cred, &len) != 0 ||
+                    epoll_ctl(ep, EPOLL_CTL_ADD, cfd, &ev) != 0) {
+                    close(cfd);
+                    continue;
+                }
+                c.deadline = std::chrono::steady_clock::now() + k_request_deadline;
+                conns.emplace(cfd, std::move(c));
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        std::vector<int> expired;
+        for (const auto& [fd, c] : conns) {
+            if (c.deadline <= now) expired.push_back(fd);
+        }
+        for (int fd : expired) drop(fd);
+    }
+
+    for (const auto& [fd, c] : conns) close(fd);
+    close(ep);
+}
+
+void AuthorizationBroker::stop() {
+    stopping_.store(true, std::memory_order_relaxed);
+    if (listen_fd_ != -1) shutdown(listen_fd_, SHUT_RDWR);
+}
+
+std::string AuthorizationBroker::answer(const struct ucred& cred, std::string_view payload) {
+    auto request = decode_request(payload);
+    if (!request) {
+        LOG_WARN(std::format("voixd: malformed request from uid {}", cred.uid));
+        return {};
+    }
+    // Resolving against a directory the peer names would probe it as root;
+    // the client evaluates relative commands itself.
+    if (is_relative_command(request->command)) return {};
+
+    // Closing without a reply makes the client fall back to standalone mode,
+    // which reports the configuration error itself.
+    if (!reload()) return {};
+
+    probes::begin_request();
+    auto security = std::make_shared<Security>(std::make_shared<PeerIdentity>(identity_, cred.uid));
+    PermissionChecker checker(security, config_);
+    AuthorizationDecision decision = authorize(*config_, *security, checker, *resolver_, *request);
+    // A query is not a run: the voix process counts the hit, so a peer
+    // talking to the socket directly cannot skew --rule-stats.
+    decision.rule_stats_path = config_->get_rule_stats_path();
+    decision.rules_fingerprint = rules_fingerprint_;
+    decision.rule_count = config_->getRules().size();
+
+    WireWriter w;
+    encode_decision(w, decision);
+    return std::move(w.frame());
+}
+
+// ---------------------------------------------------------------------------
+// BrokerClient
+// ---------------------------------------------------------------------------
+
+BrokerClient::BrokerClient(int fd) : fd_(fd) {}
+
+BrokerClient::~BrokerClient() {
+    if (fd_ != -1) close(fd_);
+}
+
+std::unique_ptr<BrokerClient> BrokerClient::connect(std::string_view socket_path, uid_t owner) {
+    struct sockaddr_un addr;
+    if (!fill_address(addr, socket_path)) return nullptr;
+
+    // Only talk to a socket the policy owner created; anybody else could
+    // answer PERMIT to everything.
+    struct stat st;
+    if (lstat(addr.sun_path, &st) != 0 || !S_ISSOCK(st.st_mode) || st.st_uid != owner) {
+        return nullptr;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) return nullptr;
+    set_io_timeouts(fd);
+
+    // SO_PEERCRED records the credentials at connect() time, so connect as
+    // the invoking user rather than as the setuid owner.
+    uid_t ruid = getuid();
+    uid_t euid = geteuid();
+    if (euid != ruid && seteuid(ruid) != 0) {
+        close(fd);
+        return nullptr;
+    }
+    int rc = ::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+    if (euid != ruid && seteuid(euid) != 0) {
+        // Without our privileges back we cannot continue either way.
+        close(fd);
+        throw std::runtime_error("Failed to restore effective UID");
+    }
+    if (rc != 0) {
+        close(fd);
+        return nullptr;
+    }
+    return std::unique_ptr<BrokerClient>(new BrokerClient(fd));
+}
+
+std::optional<AuthorizationDecision> BrokerClient::query(const AuthorizationRequest& request) {
+    if (fd_ == -1) return std::nullopt;
+
+    WireWriter w;
+    encode_request(w, request);
+    const std::string& frame = w.frame();
+    std::optional<std::string> payload;
+    if (write_all(fd_, frame.data(), frame.size())) payload = read_frame(fd_);
+
+    close(fd_);
+    fd_ = -1;
+    if (!payload) return std::nullopt;
+    return decode_decision(*payload);
+}
+
+} // namespace Voix
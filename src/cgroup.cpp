@@ -0,0 +1,118 @@
+/**
+ * @file cgroup.cpp
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#include "cgroup.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <linux/magic.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+
+namespace Voix {
+
+namespace {
+
+constexpr std::array<std::string_view, 8> k_cgroup_controls = {
+    "cpu.max", "cpu.weight", "memory.max", "memory.high", "memory.swap.max",
+    "io.max", "io.weight", "pids.max",
+};
+
+// Writes @p value to the interface file @p name below @p dir_fd. cgroupfs
+// parses each write(2) on its own, so the value goes out in one call.
+bool write_interface(int dir_fd, const char* name, std::string_view value) {
+    int fd = openat(dir_fd, name, O_WRONLY | O_CLOEXEC);
+    if (fd == -1) return false;
+    ssize_t n = write(fd, value.data(), value.size());
+    int saved_errno = errno;
+    close(fd);
+    errno = saved_errno;
+    return n == static_cast<ssize_t>(value.size());
+}
+
+// Opens @p path as a directory on a cgroup2 mount.
+int open_cgroup_dir(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd == -1) return -1;
+    struct statfs fs;
+    if (fstatfs(fd, &fs) != 0 || fs.f_type != CGROUP2_SUPER_MAGIC) {
+        close(fd);
+        errno = ENOTDIR;
+        return -1;
+    }
+    return fd;
+}
+
+} // namespace
+
+bool is_cgroup_control(std::string_view file) {
+    return std::ranges::find(k_cgroup_controls, file) != k_cgroup_controls.end();
+}
+
+SharedFd prepare_cgroup(const CgroupLimits& limits) {
+    size_t slash = limits.path.rfind('/');
+    if (slash == std::string::npos || slash == 0 || slash + 1 == limits.path.size()) {
+        LOG_ERROR(std::format("Invalid cgroup path: {}", limits.path));
+        return {};
+    }
+    std::string parent = limits.path.substr(0, slash);
+    std::string name = limits.path.substr(slash + 1);
+
+    if (mkdir(parent.c_str(), 0755) != 0 && errno != EEXIST) {
+        LOG_ERROR(std::format("Failed to create cgroup {}: {}", parent, std::strerror(errno)));
+        return {};
+    }
+    int parent_fd = open_cgroup_dir(parent);
+    if (parent_fd == -1) {
+        LOG_ERROR(std::format("{} is not a cgroup v2 directory: {}", parent, std::strerror(errno)));
+        return {};
+    }
+
+    if (mkdirat(parent_fd, name.c_str(), 0755) != 0 && errno != EEXIST) {
+        LOG_ERROR(std::format("Failed to create cgroup {}: {}", limits.path, std::strerror(errno)));
+        close(parent_fd);
+        return {};
+    }
+    int fd = openat(parent_fd, name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd == -1) {
+        LOG_ERROR(std::format("Failed to open cgroup {}: {}", limits.path, std::strerror(errno)));
+        close(parent_fd);
+        return {};
+    }
+    SharedFd cgroup(fd);
+
+    for (const auto& [file, value] : limits.controls) {
+        bool ok = write_interface(fd, file.c_str(), value);
+        if (!ok && errno == ENOENT) {
+            // The controller is not enabled for the profile cgroups yet.
+            std::string controller = "+" + file.substr(0, file.find('.'));
+            if (!write_interface(parent_fd, "cgroup.subtree_control", controller)) {
+                LOG_ERROR(std::format("Failed to enable the {} controller in {}: {}",
+                          controller.substr(1), parent, std::strerror(errno)));
+                close(parent_fd);
+                return {};
+            }
+            ok = write_interface(fd, file.c_str(), value);
+        }
+        if (!ok) {
+            LOG_ERROR(std::format("Failed to set {} to '{}' in {}: {}", file, value,
+                      limits.path, std::strerror(errno)));
+            close(parent_fd);
+            return {};
+        }
+    }
+    close(parent_fd);
+    return cgroup;
+}
+
+} // namespace Voix
@@ -7,11 +7,18 @@
  */
 
 #include "command.hpp"
+#include "cgroup.hpp"
 #include "logger.hpp"
+#include "probes.hpp"
 #include "file_utils.hpp"
 #include "security.hpp"
+#include "supervisor.hpp"
 #include "system_utils.hpp"
+#include "trace.hpp"
+#include <charconv>
+#include <cstdint>
 #include <csignal>
+#include <fcntl.h>
 #include <pwd.h>
 #include <grp.h>
 #include <cerrno>
@@ -19,17 +26,57 @@
 
 #include <format>
 #include <sys/wait.h>
-#include <sys/syscall.h>
-#include <sys/prctl.h>
 #include <unistd.h>
 #include <vector>
-#include <cstdlib>
+#include <algorithm>
+#include <array>
 #include <utility>
 #include <sys/resource.h>
-#include <ranges>
 
 namespace Voix {
 
+namespace {
+
+// Limits for restricted profiles: bounded descriptors, a process cap against
+// fork bombs, and no core dumps (they could write sensitive memory to disk).
+const std::vector<ResourceLimit> k_restricted_limits = {
+    {RLIMIT_NOFILE, {1024, 4096}},
+    {RLIMIT_NPROC, {512, 1024}},
+    {RLIMIT_CORE, {0, 0}},
+};
+
+// Signals the calling process ignores. The SigIgn mask in /proc/self/status
+// answers in one read what takes a sigaction() query per signal otherwise.
+std::vector<int> ignored_signals() {
+    std::vector<int> signals;
+    char buf[4096];
+    ssize_t n = -1;
+    int fd = open("/proc/self/status", O_RDONLY | O_CLOEXEC);
+    if (fd != -1) {
+        n = read(fd, buf, sizeof(buf));
+        close(fd);
+    }
+    const std::string_view status(buf, n > 0 ? static_cast<size_t>(n) : 0);
+    constexpr std::string_view k_field = "\nSigIgn:\t";
+    if (size_t pos = status.find(k_field); pos != std::string_view::npos) {
+        const char* first = status.data() + pos + k_field.size();
+        std::uint64_t mask = 0;
+        if (std::from_chars(first, status.data() + status.size(), mask, 16).ec == std::errc{}) {
+            for (int sig = 1; sig < NSIG && sig <= 64; ++sig) {
+                if (mask & (std::uint64_t{1} << (sig - 1))) signals.push_back(sig);
+            }
+            return signals;
+        }
+    }
+    for (int sig = 1; sig < NSIG; ++sig) {
+        struct sigaction sa;
+        if (sigaction(sig, nullptr, &sa) == 0 && sa.sa_handler == SIG_IGN) signals.push_back(sig);
+    }
+    return signals;
+}
+
+} // namespace
+
 SecurityProfile Command::resolve_profile(const Config& config, const Rule& rule,
                                        std::string_view target_user) {
     const bool target_unconfined = config.is_unconfined_target(target_user);
@@ -52,286 +99,268 @@ SecurityProfile Command::resolve_profile(const Config& config, const Rule& rule,
     return profile;
 }
 
-int Command::execute(std::string_view command, const std::vector<std::string>& args,
-                       const Config& config, const CommandOptions& options, const Rule& rule, std::string_view user) const {
-  sigset_t new_mask, old_mask;
-  sigfillset(&new_mask);
-  if (pthread_sigmask(SIG_BLOCK, &new_mask, &old_mask) != 0) {
-      LOG_ERROR("Failed to block signals");
-      return -1;
-  }
-
-  pid_t pid = fork();
+bool Command::use_exec_in_place(const SecurityProfile& profile, bool session_open,
+                                std::chrono::seconds timeout) {
+    return profile.exec_mode == ExecMode::AUTO && !session_open && timeout.count() == 0;
+}
 
-  if (pid == -1) {
-    LOG_ERROR(std::format("fork() failed: {}", std::strerror(errno)));
-    pthread_sigmask(SIG_SETMASK, &old_mask, nullptr);
-    return -1;
-  } else if (pid == 0) {
-    // Child process
-    if (pthread_sigmask(SIG_SETMASK, &old_mask, nullptr) != 0) {
-        LOG_ERROR("Child failed to restore signal mask");
-        _exit(1);
-    }
+ExecutionContext Command::resolve_context(const Config& config, const Rule& rule,
+                                          std::string_view target_user) {
+    return ExecutionContext{resolve_profile(config, rule, target_user), config.getPath(),
+                            config.is_seccomp_enabled(), config.get_env_policy(), rule.envlist, {}};
+}
 
-    // Reset all signal handlers to default
-    for (int i = 1; i < NSIG; ++i) {
-        signal(i, SIG_DFL);
+int Command::execute(std::string_view command, const std::vector<std::string>& args,
+                       const Config& config, const CommandOptions& options, const Rule& rule, std::string_view user) const {
+    // Without an authorize() decision, resolve here and apply the blocklist.
+    ExecutionContext context = resolve_context(config, rule, user.empty() ? "root" : user);
+    auto resolved = CommandResolver(config.getPath()).resolve(command);
+    if (resolved && !config.is_blocked_file(resolved->dev, resolved->ino)) {
+        context.command = std::move(*resolved);
     }
+    return execute(command, args, context, options, rule, user);
+}
 
+std::expected<ExecPlan, int> Command::build_exec_plan(std::string_view command,
+                                                     const std::vector<std::string>& args,
+                                                     const ExecutionContext& context,
+                                                     const CommandOptions& options,
+                                                     std::string_view user) const {
     // Resolve identity and profile
     auto pw_entry = Voix::lookup_passwd_by_name(user.empty() ? "root" : user);
     if (!pw_entry) {
       LOG_ERROR(std::format("Failed to resolve target user '{}': {}",
                user.empty() ? std::string_view{"root"} : user, std::strerror(errno)));
-      _exit(1);
+      return std::unexpected(1);
+    }
+
+    ExecPlan plan;
+    plan.uid = pw_entry->uid;
+    plan.gid = pw_entry->gid;
+
+    // Supplementary groups, as initgroups() would set them.
+    Trace::Span groups_span("getgrouplist");
+    groups_span.note(pw_entry->name);
+    int ngroups = 32;
+    plan.groups.resize(ngroups);
+    if (getgrouplist(pw_entry->name.c_str(), pw_entry->gid, plan.groups.data(), &ngroups) == -1) {
+        plan.groups.resize(ngroups);
+        if (getgrouplist(pw_entry->name.c_str(), pw_entry->gid, plan.groups.data(), &ngroups) == -1) {
+            LOG_ERROR(std::format("Failed to resolve groups for '{}'", pw_entry->name));
+            return std::unexpected(1);
+        }
     }
+    plan.groups.resize(ngroups);
+    groups_span.end();
 
-    // Profile resolution order (see Command::resolve_profile):
+    // The profile was resolved before the fork (see Command::resolve_profile):
     //   1. An explicit profile named on the rule (administrator's decision).
     //   2. The target is a configured unconfined system target (e.g. the
     //      package-manager user) -> full "system" treatment.
     //   3. Otherwise the safe restricted default.
-    SecurityProfile profile = resolve_profile(config, rule, user.empty() ? "root" : user);
-    const bool preserve_full_env = profile.preserve_full_environment;
+    const SecurityProfile& profile = context.profile;
     const bool is_privileged_tier = profile.retain_full_capabilities;
 
-    // Collect the environment to restore after clearenv(), based on the
-    // requested policy. Unconfined targets keep the entire inherited
-    // environment (required for package managers and AUR helpers); an
-    // explicit preserve_env keeps everything except known dangerous loader /
-    // interpreter variables; otherwise only a minimal safe whitelist is kept.
-    const std::vector<std::string> whitelist = {"TERM", "DISPLAY", "XAUTHORITY", "LANG", "PATH"};
-    const std::array<std::string_view, 7> dangerous_env_names = {
-        "BASH_ENV", "ENV", "IFS", "CDPATH",
-        "GCONV_PATH", "GETCONF_DIR", "HOSTALIASES"
-    };
-    const std::array<std::string_view, 7> dangerous_env_prefixes = {
-        "LD_", "CC", "CXX", "CMAKE_", "PERL", "PYTHON", "RUBY"
-    };
-
-    auto collect_environment = [&](bool keep_all, bool keep_sanitized) {
-        std::vector<std::pair<std::string, std::string>> env;
-        extern char **environ;
-        for (char **e = ::environ; *e != nullptr; ++e) {
-            std::string entry(*e);
-            const size_t pos = entry.find('=');
-            if (pos == std::string::npos) continue;
-            std::string key = entry.substr(0, pos);
-            if (!keep_all) {
-                const bool is_dangerous_name =
-                    std::ranges::find(dangerous_env_names, std::string_view{key}) != dangerous_env_names.end();
-                const bool is_dangerous_prefix =
-                    std::ranges::any_of(dangerous_env_prefixes, [&](std::string_view prefix) {
-                        return key.starts_with(prefix);
-                    });
-                if (keep_sanitized && (is_dangerous_name || is_dangerous_prefix)) continue;
-                if (!keep_sanitized && std::ranges::find(whitelist, key) == whitelist.end()) continue;
-            }
-            env.emplace_back(key, entry.substr(pos + 1));
-        }
-        return env;
-    };
-
-    std::vector<std::pair<std::string, std::string>> saved_env;
-    if (preserve_full_env) {
-        saved_env = collect_environment(/* keep_all */ true, /* keep_sanitized */ false);
+    // Unconfined targets keep the entire inherited environment (required for
+    // package managers and AUR helpers); an explicit preserve_env drops only
+    // the deny list; otherwise only the keep and check lists survive. The
+    // variables voix sets itself and the rule's env: entries override them.
+    EnvPolicy::Mode env_mode = EnvPolicy::Mode::SCRUB;
+    if (profile.preserve_full_environment) {
+        env_mode = EnvPolicy::Mode::FULL;
     } else if (options.preserve_env) {
-        saved_env = collect_environment(/* keep_all */ false, /* keep_sanitized */ true);
-    } else {
-        saved_env = collect_environment(/* keep_all */ false, /* keep_sanitized */ false);
+        env_mode = EnvPolicy::Mode::SANITIZE;
     }
 
-    // Drop privileges completely
-    if (initgroups(pw_entry->name.c_str(), pw_entry->gid) != 0) {
-        LOG_ERROR(std::format("initgroups() failed for '{}': {}", pw_entry->name, std::strerror(errno)));
-        _exit(1);
-    }
-    if (setgid(pw_entry->gid) != 0) {
-        LOG_ERROR(std::format("setgid({}) failed: {}", pw_entry->gid, std::strerror(errno)));
-        _exit(1);
-    }
-    if (setuid(pw_entry->uid) != 0) {
-        LOG_ERROR(std::format("setuid({}) failed: {}", pw_entry->uid, std::strerror(errno)));
-        _exit(1);
+    std::vector<std::string> assignments;
+    assignments.reserve(5);
+    assignments.push_back(std::format("PATH={}", context.path));
+    assignments.push_back(std::format("USER={}", pw_entry->name));
+    assignments.push_back(std::format("LOGNAME={}", pw_entry->name));
+    assignments.push_back(std::format("HOME={}", pw_entry->home_dir));
+    if (options.login_shell) {
+      assignments.push_back(std::format("SHELL={}", pw_entry->shell));
     }
 
-    Security sec;
+    const EnvPolicy& env_policy = context.env_policy ? *context.env_policy : EnvPolicy::defaults();
+    auto env = env_policy.apply(::environ, env_mode, assignments, context.rule_env);
+    plan.inherited_env = std::move(env.inherited);
+    plan.assigned_env = std::move(env.assigned);
 
     // Drop capabilities for targets not in a full-privilege profile.
-    #ifdef VOIX_WITH_CAP
-    if (!is_privileged_tier) {
-        sec.dropCapabilities({});
-    } else {
-        // Explicitly retain all capabilities for privileged targets
-        // by NOT dropping them, and ensuring they are not restricted
-        // by further security measures.
-    }
-    #endif
-
-
-    // Scrub environment to maintain security.
-    // Privileged users need a full environment to perform hooks and system
-    // operations without breaking D-Bus or other services, but we still clear
-    // the environment and restore only the sanitized variables to prevent privilege escalation.
-    clearenv();
-    // Restore only approved/sanitized environment variables
-    std::ranges::for_each(saved_env, [](const auto& env) {
-      setenv(env.first.c_str(), env.second.c_str(), 1);
-    });
-
-    setenv("PATH", config.getPath().c_str(), 1);
-    setenv("USER", pw_entry->name.c_str(), 1);
-    setenv("LOGNAME", pw_entry->name.c_str(), 1);
-    setenv("HOME", pw_entry->home_dir.c_str(), 1);
-
-    // Set shell
-    if (options.login_shell) {
-      setenv("SHELL", pw_entry->shell.c_str(), 1);
-    }
-
-    // Capture the original FD limit before any reduction, so the close loop
-    // covers all inherited descriptors.
-    struct rlimit original_rl;
-    bool have_original_rl = (getrlimit(RLIMIT_NOFILE, &original_rl) == 0);
+#ifdef VOIX_WITH_CAP
+    plan.drop_capabilities = !is_privileged_tier;
+#endif
 
     // Apply resource limits only to non-privileged targets. Privileged targets
     // may need high NPROC (pacman hooks spawn many processes) and NOFILE limits.
-    // Privileged targets also need unrestricted access to /proc/pid/root (snap-pac, etc.)
-    // which requires full capabilities and bypassing seccomp.
+    // The profile's rlimits replace the defaults for the same resource.
     if (profile.enable_resource_limits) {
-        setResourceLimits();
-    }
-
-// Close inherited FDs for all non-privileged executions (prevents voix
-// internal FD leakage into the executed command). Privileged targets may
-// rely on inherited FDs (e.g. D-Bus sockets for pacman hooks).
-if (!is_privileged_tier) {
-    bool closed = false;
-#ifdef SYS_close_range
-    if (syscall(SYS_close_range, 3, ~0U, 0) == 0) {
-        closed = true;
-    }
-#endif
-
-    if (!closed) {
-        constexpr rlim_t k_fallback_max_fd = 4096;
-        constexpr rlim_t k_close_loop_cap = 65536;
-        rlim_t max_fd_limit = k_fallback_max_fd;
-        if (have_original_rl) {
-            max_fd_limit = std::min(original_rl.rlim_cur, k_close_loop_cap);
-        }
-        int max_fd = static_cast<int>(max_fd_limit);
-        for (int i : std::views::iota(3, max_fd)) {
-            close(i);
+        plan.rlimits = k_restricted_limits;
+        for (const auto& override_limit : profile.tuning.rlimits) {
+            auto it = std::ranges::find(plan.rlimits, override_limit.resource, &ResourceLimit::resource);
+            if (it != plan.rlimits.end()) {
+                it->limit = override_limit.limit;
+            } else {
+                plan.rlimits.push_back(override_limit);
+            }
         }
     }
-}
 
-    auto escape = [](const std::string& s) {
-      std::string escaped = "'";
-      for (char c : s) {
-        if (c == '\'') escaped += "'\\''";
-        else escaped += c;
-      }
-      escaped += "'";
-      return escaped;
-    };
-
-    std::vector<const char *> argv;
-    std::string cmd_str{command};
-    LOG_INFO(std::format("executing command: {}, profile: {}", cmd_str, rule.profile));
-
-    // Resolve non-absolute paths
-    if (!cmd_str.empty() && cmd_str[0] != '/') {
-        FileUtils file_utils;
-        std::string resolved = file_utils.resolve_command({cmd_str, config.getPath()});
-        if (resolved.empty()) {
-            LOG_ERROR(std::format("Command not found: {}", cmd_str));
-            _exit(127);
+    auto tuning = compile_tuning(profile.tuning);
+    if (!tuning) {
+        LOG_ERROR(std::format("NUMA node {} is not available", profile.tuning.numa_node.value_or(0)));
+        return std::unexpected(1);
+    }
+    plan.tuning = std::move(*tuning);
+
+    // Start the command in the profile's cgroup. Running it unconstrained
+    // when the cgroup cannot be set up would defeat the limits, so that fails.
+    if (!profile.cgroup.empty()) {
+        plan.cgroup_fd = prepare_cgroup(profile.cgroup);
+        if (!plan.cgroup_fd) {
+            return std::unexpected(1);
         }
-        cmd_str = resolved;
     }
 
-    // Enforce absolute paths
-    if (cmd_str.empty() || cmd_str[0] != '/') {
-        LOG_ERROR(std::format("Command must be an absolute path: {}", cmd_str));
-        _exit(127);
+    // Close inherited FDs for all non-privileged executions (prevents voix
+    // internal FD leakage into the executed command). Privileged targets may
+    // rely on inherited FDs (e.g. D-Bus sockets for pacman hooks). The
+    // original FD limit bounds the fallback close loop.
+    plan.close_fds = !is_privileged_tier;
+    struct rlimit original_rl;
+    if (getrlimit(RLIMIT_NOFILE, &original_rl) == 0) {
+        constexpr rlim_t k_close_loop_cap = 65536;
+        plan.close_fds_fallback_max = static_cast<int>(std::min(original_rl.rlim_cur, k_close_loop_cap));
     }
 
-    argv.push_back(cmd_str.c_str());
-    for (const auto &arg : args) {
-      argv.push_back(arg.c_str());
+    // Execute the file that was authorized (see authorize()). A command
+    // decided by voixd arrives without a descriptor and is reopened and
+    // checked against the identity voixd saw. One that was never resolved is
+    // not looked up here: the blocklist and catastrophic checks on the
+    // resolved path would be skipped.
+    ResolvedCommand resolved = context.command;
+    if (!resolved.found()) {
+        LOG_ERROR(std::format("Command not found: {}", command));
+        return std::unexpected(127);
+    } else if (!resolved.fd && !CommandResolver::reopen(resolved)) {
+        LOG_ERROR(std::format("Command changed since authorization: {}", resolved.path));
+        return std::unexpected(1);
     }
-    argv.push_back(nullptr);
+    std::string cmd_str = resolved.path;
 
     // Apply seccomp only to targets with seccomp enabled in their profile. Privileged targets
     // need unrestricted syscall access.
-    if (config.is_seccomp_enabled() && profile.enable_seccomp) {
-        if (prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) != 0) {
-            LOG_ERROR("Failed to set PR_SET_NO_NEW_PRIVS");
-            _exit(1);
-        }
+    if (context.seccomp_enabled && profile.enable_seccomp) {
+        plan.no_new_privs = true;
 #ifdef VOIX_WITH_SECCOMP
-        sec.applySeccompBlacklist();
+        plan.seccomp_filter = Security().compileSeccompBlacklist();
+        if (plan.seccomp_filter.empty()) {
+            return std::unexpected(1);
+        }
 #endif
     }
 
     if (options.login_shell) {
-      // Execute command in a login shell
-      std::string login_shell_cmd = "-l";
-      std::string c_arg = "-c";
+      // Execute command in a login shell. The shell looks the command up by
+      // path again, so the verified descriptor is not used here.
+      auto escape = [](std::string_view s) {
+        std::string escaped = "'";
+        for (char c : s) {
+          if (c == '\'') escaped += "'\\''";
+          else escaped += c;
+        }
+        escaped += "'";
+        return escaped;
+      };
       std::string full_cmd = escape(cmd_str);
       for (const auto &arg : args) {
         full_cmd += " " + escape(arg);
       }
-
-      const char *args_exec[] = {pw_entry->shell.c_str(), login_shell_cmd.c_str(), c_arg.c_str(), full_cmd.c_str(), nullptr};
-      execv(pw_entry->shell.c_str(), const_cast<char *const *>(args_exec));
+      plan.path = pw_entry->shell;
+      plan.argv = {pw_entry->shell, "-l", "-c", std::move(full_cmd)};
     } else {
-      execv(cmd_str.c_str(), const_cast<char *const *>(argv.data()));
+      plan.path = cmd_str;
+      plan.exec_fd = resolved.fd;
+      plan.argv.reserve(args.size() + 1);
+      plan.argv.push_back(std::move(cmd_str));
+      plan.argv.insert(plan.argv.end(), args.begin(), args.end());
     }
-    _exit(127);
-  } else {
-    // Parent process
-    int status;
-    waitpid(pid, &status, 0);
 
-    if (pthread_sigmask(SIG_SETMASK, &old_mask, nullptr) != 0) {
-        LOG_ERROR("Parent failed to restore signal mask");
-        // Non-fatal, continue
-    }
+    // clone3(CLONE_CLEAR_SIGHAND) resets handled signals; ignored ones are
+    // left alone by the kernel and reset by the child.
+    plan.ignored_signals = ignored_signals();
 
-    if (WIFEXITED(status)) {
-      return WEXITSTATUS(status);
-    }
-    return -1;
-  }
+    return plan;
 }
 
-void Command::setResourceLimits() const {
-    struct rlimit rl;
+int Command::execute(std::string_view command, const std::vector<std::string>& args,
+                       const ExecutionContext& context, const CommandOptions& options, const Rule& rule, std::string_view user,
+                       std::optional<ChildReport>* report) const {
+  Trace::Span plan_span("exec plan");
+  auto plan = build_exec_plan(command, args, context, options, user);
+  plan_span.end();
+  if (!plan) {
+    return plan.error();
+  }
 
-    // Limit open file descriptors
-    rl.rlim_cur = 1024;
-    rl.rlim_max = 4096;
-    if (setrlimit(RLIMIT_NOFILE, &rl) != 0) {
-        LOG_ERROR("Failed to set RLIMIT_NOFILE");
-    }
+  if (options.exec_in_place) {
+    // Nothing runs after a successful exec, so the trace ends here.
+    Trace::mark("exec", plan->path);
+    Trace::flush();
+    VOIX_PROBE3(exec_start, probes::current_request(), plan->path.c_str(), 1);
+    ExecFailure failure = exec_plan_in_place(*plan);
+    LOG_ERROR(std::format("Failed to execute {}: {} failed: {}", plan->path,
+              exec_stage_name(failure.stage), std::strerror(failure.error)));
+    return failure.stage == ExecStage::EXEC ? 127 : 1;
+  }
 
-    // Limit number of processes to prevent fork bombs
-    rl.rlim_cur = 512;
-    rl.rlim_max = 1024;
-    if (setrlimit(RLIMIT_NPROC, &rl) != 0) {
-        LOG_ERROR("Failed to set RLIMIT_NPROC");
-    }
+  sigset_t new_mask, old_mask;
+  sigfillset(&new_mask);
+  if (pthread_sigmask(SIG_BLOCK, &new_mask, &old_mask) != 0) {
+      LOG_ERROR("Failed to block signals");
+      return -1;
+  }
 
-    // Limit core dump size (prevent sensitive memory from being written to disk)
-    rl.rlim_cur = 0;
-    rl.rlim_max = 0;
-    if (setrlimit(RLIMIT_CORE, &rl) != 0) {
-        LOG_ERROR("Failed to set RLIMIT_CORE");
-    }
+  ExecFailure failure;
+  int pidfd = -1;
+  // Returns once the child has exec'd or failed to (CLONE_VFORK).
+  Trace::Span spawn_span("fork+exec");
+  spawn_span.note(plan->path);
+  const std::uint64_t probe_start = probes::start_clock(VOIX_PROBE_ENABLED(exec_done));
+  VOIX_PROBE3(exec_start, probes::current_request(), plan->path.c_str(), 0);
+  pid_t pid = spawn_exec_plan(*plan, old_mask, failure, &pidfd);
+  spawn_span.end();
+  if (pid == -1) {
+    LOG_ERROR(std::format("Failed to start child: {}", std::strerror(errno)));
+    pthread_sigmask(SIG_SETMASK, &old_mask, nullptr);
+    return -1;
+  }
+  if (failure.stage != ExecStage::NONE) {
+    LOG_ERROR(std::format("Failed to execute {}: {} failed: {}", plan->path,
+              exec_stage_name(failure.stage), std::strerror(failure.error)));
+  }
+
+  // Signals stay blocked while supervising; the ones meant for the command
+  // are read from a signalfd and forwarded.
+  SupervisionLimits limits{rule.timeout, rule.kill_after};
+  Trace::Span wait_span("wait");
+  ChildReport child = supervise_child(pid, pidfd, limits);
+  if (Trace::enabled()) wait_span.note(std::format("exit code {}", child.exit_code()));
+  wait_span.end();
+  VOIX_PROBE3(exec_done, probes::current_request(), child.exit_code(), probes::elapsed(probe_start));
+  if (pidfd != -1) close(pidfd);
+
+  if (pthread_sigmask(SIG_SETMASK, &old_mask, nullptr) != 0) {
+      LOG_ERROR("Parent failed to restore signal mask");
+      // Non-fatal, continue
+  }
+
+  if (child.timed_out) {
+    LOG_WARN(std::format("{} exceeded its {}s timeout", plan->path, rule.timeout.count()));
+  }
+  if (report) *report = child;
+  return child.exit_code();
 }
 
 std::string Command::buildCommandString(std::string_view command,
@@ -0,0 +1,149 @@
+/**
+ * @file command_resolver.cpp
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#include "command_resolver.hpp"
+#include <fcntl.h>
+#include <filesystem>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Voix {
+
+namespace {
+
+// A regular file owned by root that nobody else can modify.
+bool is_trusted_file(const struct stat& st) {
+    return S_ISREG(st.st_mode) && st.st_uid == 0 && (st.st_mode & (S_IWOTH | S_IWGRP)) == 0;
+}
+
+bool same_time(const struct timespec& a, const struct timespec& b) {
+    return a.tv_sec == b.tv_sec && a.tv_nsec == b.tv_nsec;
+}
+
+// Opens @p name relative to @p dir_fd and verifies it; returns -1 otherwise.
+// An absolute path named by the caller only has to be a regular file, as
+// before; anything found through PATH or a relative path must be trusted.
+int open_trusted(int dir_fd, const char* name, struct stat& st, bool require_trusted = true) {
+    int fd = openat(dir_fd, name, O_PATH | O_CLOEXEC);
+    if (fd == -1) return -1;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (require_trusted && !is_trusted_file(st))) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+} // namespace
+
+CommandResolver::CommandResolver(std::string_view path_list) : path_list_(path_list) {
+    size_t start = 0;
+    while (start <= path_list.size()) {
+        size_t end = path_list.find(':', start);
+        if (end == std::string_view::npos) end = path_list.size();
+        std::string_view dir = path_list.substr(start, end - start);
+        if (!dir.empty()) {
+            Directory entry{std::string(dir), -1};
+            entry.fd = open(entry.path.c_str(), O_PATH | O_DIRECTORY | O_CLOEXEC);
+            dirs_.push_back(std::move(entry));
+        }
+        start = end + 1;
+    }
+}
+
+CommandResolver::~CommandResolver() {
+    for (const auto& dir : dirs_) {
+        if (dir.fd != -1) close(dir.fd);
+    }
+}
+
+std::optional<ResolvedCommand> CommandResolver::lookup_cached(const std::string& name) const {
+    auto it = cache_.find(name);
+    if (it == cache_.end()) return std::nullopt;
+    const CacheEntry& entry = it->second;
+
+    // An entry added to an earlier directory would now shadow the hit.
+    struct stat st;
+    for (size_t i = 0; i <= entry.dir_index; ++i) {
+        if (dirs_[i].fd == -1) continue;
+        if (fstat(dirs_[i].fd, &st) != 0 || !same_time(st.st_mtim, entry.dir_mtimes[i])) {
+            return std::nullopt;
+        }
+    }
+
+    const Directory& dir = dirs_[entry.dir_index];
+    int fd = open_trusted(dir.fd, name.c_str(), st);
+    if (fd == -1) return std::nullopt;
+    if (st.st_dev != entry.dev || st.st_ino != entry.ino || !same_time(st.st_mtim, entry.mtime)) {
+        close(fd);
+        return std::nullopt;
+    }
+    return ResolvedCommand{dir.path + "/" + name, st.st_dev, st.st_ino, SharedFd(fd)};
+}
+
+std::optional<ResolvedCommand> CommandResolver::resolve(std::string_view command,
+                                                        std::string_view cwd) {
+    if (command.empty()) return std::nullopt;
+
+    struct stat st;
+    if (command.find('/') != std::string_view::npos) {
+        std::filesystem::path path(command);
+        if (path.is_relative()) {
+            std::error_code ec;
+            path = cwd.empty() ? std::filesystem::absolute(path, ec)
+                               : (std::filesystem::path(cwd) / path).lexically_normal();
+            if (ec) return std::nullopt;
+        }
+        int fd = open_trusted(AT_FDCWD, path.c_str(), st, /* require_trusted */ command[0] != '/');
+        if (fd == -1) return std::nullopt;
+        return ResolvedCommand{path.string(), st.st_dev, st.st_ino, SharedFd(fd)};
+    }
+
+    std::string name(command);
+    if (auto cached = lookup_cached(name)) return cached;
+
+    CacheEntry entry{};
+    entry.dir_mtimes.reserve(dirs_.size());
+    for (size_t i = 0; i < dirs_.size(); ++i) {
+        const Directory& dir = dirs_[i];
+        struct stat dir_st{};
+        if (dir.fd == -1 || fstat(dir.fd, &dir_st) != 0) {
+            entry.dir_mtimes.push_back({});
+            continue;
+        }
+        // Snapshot the directory before probing it, so a change made during
+        // the walk invalidates the entry.
+        entry.dir_mtimes.push_back(dir_st.st_mtim);
+
+        int fd = open_trusted(dir.fd, name.c_str(), st);
+        if (fd == -1) continue;
+
+        entry.dir_index = i;
+        entry.dev = st.st_dev;
+        entry.ino = st.st_ino;
+        entry.mtime = st.st_mtim;
+        cache_.insert_or_assign(name, std::move(entry));
+        return ResolvedCommand{dir.path + "/" + name, st.st_dev, st.st_ino, SharedFd(fd)};
+    }
+    cache_.erase(name);
+    return std::nullopt;
+}
+
+bool CommandResolver::reopen(ResolvedCommand& command) {
+    if (!command.found() || command.path[0] != '/') return false;
+    struct stat st;
+    int fd = open_trusted(AT_FDCWD, command.path.c_str(), st, /* require_trusted */ false);
+    if (fd == -1) return false;
+    if (st.st_dev != command.dev || st.st_ino != command.ino) {
+        close(fd);
+        return false;
+    }
+    command.fd = SharedFd(fd);
+    return true;
+}
+
+} // namespace Voix
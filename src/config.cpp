@@ -8,11 +8,14 @@
  */
 
 #include "config.hpp"
+#include "audit_pipeline.hpp"
 #include "rule.hpp"
 #include "system_utils.hpp"
 #include "file_utils.hpp"
 #include "logger.hpp"
 #include <yaml-cpp/yaml.h>
+#include <algorithm>
+#include <charconv>
 #include <filesystem>
 #include <fstream>
 #include <functional>
@@ -20,10 +23,12 @@
 #include <format>
 #include <regex>
 #include <string_view>
+#include <sys/stat.h>
 
 namespace Voix {
 
-Config::Config() : sanctuary_("/tmp"), path_list_({"/bin", "/sbin", "/usr/bin", "/usr/sbin"}), unconfined_targets_({"root", "alpm"}) {}
+Config::Config() : sanctuary_("/tmp"), path_list_({"/bin", "/sbin", "/usr/bin", "/usr/sbin"}), unconfined_targets_({"root", "alpm"}),
+                   env_policy_(std::make_shared<const EnvPolicy>()) {}
 
 
 namespace {
@@ -41,6 +46,78 @@ std::string regex_escape(std::string_view s) {
     return result;
 }
 
+std::vector<std::string> read_name_list(const YAML::Node& node, const std::vector<std::string>& fallback) {
+    if (!node) return fallback;
+    std::vector<std::string> names;
+    for (auto entry : node) {
+        names.push_back(entry.as<std::string>());
+    }
+    return names;
+}
+
+// An environment entry needs a non-empty name without '='.
+bool is_valid_env_name(std::string_view name) {
+    return !name.empty() && name.find('=') == std::string_view::npos;
+}
+
+// Reads the scheduling, I/O priority, placement and rlimit keys of a security
+// profile. Returns an error message for the first invalid entry.
+std::optional<std::string> parse_tuning(const YAML::Node& node, Voix::ProcessTuning& tuning) {
+    if (node["nice"]) {
+        int nice = node["nice"].as<int>();
+        if (nice < -20 || nice > 19) return std::format("nice {} is outside -20..19", nice);
+        tuning.nice = nice;
+    }
+    if (node["sched_policy"]) {
+        std::string policy = node["sched_policy"].as<std::string>();
+        if (policy == "other") tuning.sched_policy = Voix::SchedPolicy::OTHER;
+        else if (policy == "batch") tuning.sched_policy = Voix::SchedPolicy::BATCH;
+        else if (policy == "idle") tuning.sched_policy = Voix::SchedPolicy::IDLE;
+        else return std::format("Invalid sched_policy '{}'", policy);
+    }
+    if (node["ioprio"]) {
+        const YAML::Node io = node["ioprio"];
+        std::string io_class = io["class"] ? io["class"].as<std::string>() : "best-effort";
+        if (io_class == "realtime") tuning.io_class = Voix::IoClass::REALTIME;
+        else if (io_class == "best-effort") tuning.io_class = Voix::IoClass::BEST_EFFORT;
+        else if (io_class == "idle") tuning.io_class = Voix::IoClass::IDLE;
+        else return std::format("Invalid ioprio class '{}'", io_class);
+        if (io["level"]) tuning.io_level = io["level"].as<int>();
+        if (tuning.io_level < 0 || tuning.io_level > 7) {
+            return std::format("ioprio level {} is outside 0..7", tuning.io_level);
+        }
+    }
+    if (node["cpu_affinity"]) {
+        std::string list = node["cpu_affinity"].as<std::string>();
+        auto cpus = Voix::parse_cpu_list(list);
+        if (!cpus || cpus->empty()) return std::format("Invalid cpu_affinity '{}'", list);
+        tuning.cpus = std::move(*cpus);
+    }
+    if (node["numa_node"]) {
+        tuning.numa_node = node["numa_node"].as<unsigned>();
+    }
+    if (node["rlimits"]) {
+        for (auto entry : node["rlimits"]) {
+            std::string name = entry.first.as<std::string>();
+            auto resource = Voix::parse_rlimit_resource(name);
+            if (!resource) return std::format("Unknown rlimit '{}'", name);
+            // A single value sets both limits; [soft, hard] sets them apart.
+            const YAML::Node value = entry.second;
+            if (value.IsSequence() && value.size() != 2) return std::format("Invalid rlimit {}", name);
+            std::string soft_str = value.IsSequence() ? value[0].as<std::string>() : value.as<std::string>();
+            std::string hard_str = value.IsSequence() ? value[1].as<std::string>() : soft_str;
+            auto soft = Voix::parse_rlimit_value(soft_str);
+            auto hard = Voix::parse_rlimit_value(hard_str);
+            if (!soft || !hard || *soft > *hard) {
+                return std::format("Invalid rlimit {}", name);
+            }
+            std::erase_if(tuning.rlimits, [&](const Voix::ResourceLimit& rl) { return rl.resource == *resource; });
+            tuning.rlimits.push_back({*resource, {*soft, *hard}});
+        }
+    }
+    return std::nullopt;
+}
+
 using IdentitySetter = std::function<void(Voix::Rule&, const std::string&)>;
 
     void parse_acl_section(const YAML::Node& section,
@@ -73,6 +150,13 @@ using IdentitySetter = std::function<void(Voix::Rule&, const std::string&)>;
             rule.profile = rule_node["profile"].as<std::string>();
         }
 
+        if (rule_node["timeout"]) {
+            rule.timeout = std::chrono::seconds(rule_node["timeout"].as<long>());
+        }
+        if (rule_node["kill_after"]) {
+            rule.kill_after = std::chrono::seconds(rule_node["kill_after"].as<long>());
+        }
+
         if (rule_node["env"]) {
             for (auto env_entry : rule_node["env"]) {
                 rule.envlist.push_back(env_entry.as<std::string>());
@@ -153,25 +237,30 @@ bool Config::load(std::string_view config_path, bool verify_security) {
         }
     }
 
-    try {
-        std::string config_content;
-        if (verify_security) {
-            auto result = file_utils.read_file_secure(path_str);
-            if (!result) {
-                logger.log("ERROR", std::format("Failed to securely read config file: {}", path_str));
-                return false;
-            }
-            config_content = std::move(*result);
-        } else {
-            auto result = file_utils.readFile(path_str);
-            if (!result) {
-                logger.log("ERROR", std::format("Failed to read config file: {}", path_str));
-                return false;
-            }
-            config_content = std::move(*result);
+    std::string config_content;
+    if (verify_security) {
+        auto result = file_utils.read_file_secure(path_str);
+        if (!result) {
+            logger.log("ERROR", std::format("Failed to securely read config file: {}", path_str));
+            return false;
+        }
+        config_content = std::move(*result);
+    } else {
+        auto result = file_utils.readFile(path_str);
+        if (!result) {
+            logger.log("ERROR", std::format("Failed to read config file: {}", path_str));
+            return false;
         }
+        config_content = std::move(*result);
+    }
 
-        YAML::Node config = YAML::Load(config_content);
+    return load_from_string(config_content);
+}
+
+bool Config::load_from_string(const std::string& content) {
+    Logger logger;
+    try {
+        YAML::Node config = YAML::Load(content);
 
         if (config["core"]) {
             if (config["core"]["sanctuary"]) {
@@ -189,6 +278,33 @@ bool Config::load(std::string_view config_path, bool verify_security) {
             if (config["core"]["suppress_stderr"]) {
                 suppress_stderr_ = config["core"]["suppress_stderr"].as<bool>();
             }
+            if (config["core"]["persist_dir"]) {
+                persist_dir_ = config["core"]["persist_dir"].as<std::string>();
+            }
+            if (config["core"]["persist_timeout"]) {
+                persist_timeout_ = std::chrono::seconds(config["core"]["persist_timeout"].as<long>());
+            }
+            if (config["core"]["cgroup_root"]) {
+                cgroup_root_ = config["core"]["cgroup_root"].as<std::string>();
+            }
+            if (config["core"]["audit_dir"]) {
+                audit_dir_ = config["core"]["audit_dir"].as<std::string>();
+            }
+            if (config["core"]["audit_segment_mb"]) {
+                audit_segment_size_ = config["core"]["audit_segment_mb"].as<std::uint64_t>() << 20;
+            }
+            if (config["core"]["audit_sinks"]) {
+                audit_sinks_ = 0;
+                for (auto sink_entry : config["core"]["audit_sinks"]) {
+                    std::string name = sink_entry.as<std::string>();
+                    auto sink = AuditPipeline::parse_sink(name);
+                    if (!sink) {
+                        logger.log("ERROR", std::format("Unknown audit sink '{}'", name));
+                        return false;
+                    }
+                    audit_sinks_ |= *sink;
+                }
+            }
             if (config["core"]["unconfined_targets"]) {
                 unconfined_targets_.clear();
                 for (auto user_entry : config["core"]["unconfined_targets"]) {
@@ -222,7 +338,16 @@ bool Config::load(std::string_view config_path, bool verify_security) {
                 parse_acl_section(config["acl"]["user"], profiles_,
                     [&logger](Rule& rule, const std::string& name) {
                         rule.ident = name;
-                        rule.ident_uid = SystemUtils::getUidByName(name);
+                        // A numeric entry is a UID (as PermissionChecker
+                        // already treats it); only names need NSS.
+                        uid_t uid = 0;
+                        const char* end = name.data() + name.size();
+                        auto [ptr, ec] = std::from_chars(name.data(), end, uid);
+                        if (!name.empty() && ec == std::errc{} && ptr == end) {
+                            rule.ident_uid = uid;
+                        } else {
+                            rule.ident_uid = SystemUtils::getUidByName(name);
+                        }
                         if (!rule.ident_uid.has_value()) {
                             logger.log("ERROR", std::format("ACL user '{}' not found", name));
                         }
@@ -251,6 +376,37 @@ bool Config::load(std::string_view config_path, bool verify_security) {
                     if (p_node["enable_resource_limits"]) profile.enable_resource_limits = p_node["enable_resource_limits"].as<bool>();
                     if (p_node["scrub_environment"]) profile.scrub_environment = p_node["scrub_environment"].as<bool>();
                     if (p_node["preserve_full_environment"]) profile.preserve_full_environment = p_node["preserve_full_environment"].as<bool>();
+                    if (p_node["exec_mode"]) {
+                        std::string mode = p_node["exec_mode"].as<std::string>();
+                        if (mode == "auto") {
+                            profile.exec_mode = ExecMode::AUTO;
+                        } else if (mode == "fork") {
+                            profile.exec_mode = ExecMode::FORK;
+                        } else {
+                            logger.log("ERROR", std::format("Invalid exec_mode '{}' in profile '{}'", mode, profile_name));
+                            return false;
+                        }
+                    }
+                    if (auto error = parse_tuning(p_node, profile.tuning)) {
+                        logger.log("ERROR", std::format("{} in profile '{}'", *error, profile_name));
+                        return false;
+                    }
+                    if (p_node["cgroup"]) {
+                        if (profile_name.empty() || profile_name == "." || profile_name == ".." ||
+                            profile_name.find('/') != std::string::npos) {
+                            logger.log("ERROR", std::format("Profile '{}' cannot name a cgroup", profile_name));
+                            return false;
+                        }
+                        profile.cgroup.path = cgroup_root_ + "/" + profile_name;
+                        for (auto control : p_node["cgroup"]) {
+                            std::string file = control.first.as<std::string>();
+                            if (!is_cgroup_control(file)) {
+                                logger.log("ERROR", std::format("Unsupported cgroup setting '{}' in profile '{}'", file, profile_name));
+                                return false;
+                            }
+                            profile.cgroup.controls.emplace_back(std::move(file), control.second.as<std::string>());
+                        }
+                    }
                     security_profiles_[profile_name] = profile;
                 }
             }
@@ -264,9 +420,27 @@ bool Config::load(std::string_view config_path, bool verify_security) {
                         std::string pattern = "^" + regex_escape(exact) + "$";
                         blocklist_.push_back(exact);
                         compiled_blocklist_.emplace_back(pattern, std::regex::optimize);
+                        struct stat st;
+                        if (exact.starts_with('/') && stat(exact.c_str(), &st) == 0) {
+                            blocked_files_.emplace_back(st.st_dev, st.st_ino);
+                        }
                     }
                 }
             }
+            if (config["security"]["environment"]) {
+                const YAML::Node env_node = config["security"]["environment"];
+                const EnvPolicy& defaults = EnvPolicy::defaults();
+                // A configured deny list adds to the loader and interpreter
+                // hooks; it never lets them through.
+                std::vector<std::string> deny = defaults.deny();
+                for (auto& name : read_name_list(env_node["deny"], {})) {
+                    if (std::ranges::find(deny, name) == deny.end()) deny.push_back(std::move(name));
+                }
+                env_policy_ = std::make_shared<const EnvPolicy>(
+                    read_name_list(env_node["keep"], defaults.keep()),
+                    read_name_list(env_node["check"], defaults.check()),
+                    std::move(deny));
+            }
         }
     } catch (const YAML::Exception& e) {
         logger.log("ERROR", std::format("Failed to parse YAML config: {}", e.what()));
@@ -308,6 +482,28 @@ bool Config::validate() const {
         return false;
     }
 
+    // Validate the persist timestamp directory is absolute and the lifetime sane
+    if (persist_dir_.empty() || persist_dir_[0] != '/' || persist_timeout_.count() < 0) {
+        return false;
+    }
+
+    // Validate the audit store directory is absolute (or empty: disabled)
+    if ((!audit_dir_.empty() && audit_dir_[0] != '/') || audit_segment_size_ == 0) {
+        return false;
+    }
+
+    // Validate the cgroup root is absolute and limit values are single lines
+    if (cgroup_root_.size() < 2 || cgroup_root_[0] != '/' || cgroup_root_.back() == '/') {
+        return false;
+    }
+    for (const auto& [name, profile] : security_profiles_) {
+        for (const auto& [file, value] : profile.cgroup.controls) {
+            if (value.empty() || value.find('\n') != std::string::npos) {
+                return false;
+            }
+        }
+    }
+
     // Validate path_list entries are absolute paths
     for (const auto& p : path_list_) {
         if (p.empty() || p[0] != '/') {
@@ -329,6 +525,29 @@ bool Config::validate() const {
                 }
             }
         }
+        if (rule.timeout.count() < 0 || rule.kill_after.count() < 0) {
+            return false;
+        }
+        // env entries are VAR, -VAR or VAR=value
+        for (const auto& entry : rule.envlist) {
+            std::string_view name = std::string_view(entry).substr(0, entry.find('='));
+            if (name.starts_with('-')) {
+                if (name.size() != entry.size()) return false;
+                name.remove_prefix(1);
+            }
+            if (!is_valid_env_name(name)) {
+                return false;
+            }
+        }
+    }
+
+    // Validate environment policy names (a trailing '*' marks a prefix)
+    for (const auto* list : {&env_policy_->keep(), &env_policy_->check(), &env_policy_->deny()}) {
+        for (const auto& name : *list) {
+            if (!is_valid_env_name(name)) {
+                return false;
+            }
+        }
     }
 
     // Validate blocklist entries are non-empty
@@ -341,6 +560,10 @@ bool Config::validate() const {
     return true;
 }
 
+bool Config::is_blocked_file(dev_t dev, ino_t ino) const {
+    return std::ranges::find(blocked_files_, std::pair{dev, ino}) != blocked_files_.end();
+}
+
 bool Config::is_unconfined_target(std::string_view user) const {
     return std::ranges::find(unconfined_targets_, user) != unconfined_targets_.end();
 }
@@ -0,0 +1,130 @@
+/**
+ * @file env_policy.cpp
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#include "env_policy.hpp"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace Voix {
+
+namespace {
+
+std::vector<std::string> default_keep() {
+    return {"TERM", "DISPLAY", "XAUTHORITY", "LANG", "PATH"};
+}
+
+// Loader and interpreter hooks that can run code inside the target.
+std::vector<std::string> default_deny() {
+    return {"BASH_ENV", "ENV", "IFS", "CDPATH", "GCONV_PATH", "GETCONF_DIR", "HOSTALIASES",
+            "LD_*", "CC*", "CXX*", "CMAKE_*", "PERL*", "PYTHON*", "RUBY*"};
+}
+
+// A check-listed value may not name a file or carry a format directive.
+bool value_is_safe(const char* value) {
+    return std::strpbrk(value, "/%") == nullptr;
+}
+
+std::string_view name_of(std::string_view entry) {
+    return entry.substr(0, entry.find('='));
+}
+
+} // namespace
+
+EnvPolicy::NameMatcher::NameMatcher(std::vector<std::string> patterns)
+    : patterns_(std::move(patterns)) {
+    for (const auto& pattern : patterns_) {
+        if (pattern.ends_with('*')) {
+            std::string prefix = pattern.substr(0, pattern.size() - 1);
+            if (prefix.empty()) {
+                match_all_ = true;
+            } else {
+                prefixes_[static_cast<unsigned char>(prefix[0])].push_back(std::move(prefix));
+            }
+        } else if (!pattern.empty()) {
+            exact_.insert(pattern);
+        }
+    }
+}
+
+bool EnvPolicy::NameMatcher::matches(std::string_view name) const {
+    if (match_all_) return true;
+    if (name.empty()) return false;
+    if (exact_.find(name) != exact_.end()) return true;
+    for (const auto& prefix : prefixes_[static_cast<unsigned char>(name[0])]) {
+        if (name.starts_with(prefix)) return true;
+    }
+    return false;
+}
+
+EnvPolicy::EnvPolicy() : EnvPolicy(default_keep(), {}, default_deny()) {}
+
+EnvPolicy::EnvPolicy(std::vector<std::string> keep, std::vector<std::string> check,
+                     std::vector<std::string> deny)
+    : keep_(std::move(keep)), check_(std::move(check)), deny_(std::move(deny)) {}
+
+const EnvPolicy& EnvPolicy::defaults() {
+    static const EnvPolicy policy;
+    return policy;
+}
+
+EnvPolicy::Result EnvPolicy::apply(const char* const* environ, Mode mode,
+                                   std::span<const std::string> assignments,
+                                   std::span<const std::string> rule_env) const {
+    Result result;
+    result.assigned.assign(assignments.begin(), assignments.end());
+
+    // Rule entries are few; classify them up front.
+    std::unordered_set<std::string_view> removed;
+    std::unordered_set<std::string_view> passed;
+    for (const auto& entry : rule_env) {
+        if (entry.starts_with('-')) {
+            removed.insert(std::string_view(entry).substr(1));
+        } else if (entry.find('=') == std::string::npos) {
+            passed.insert(entry);
+        } else {
+            std::string_view name = name_of(entry);
+            auto it = std::ranges::find_if(result.assigned, [&](const std::string& a) {
+                return name_of(a) == name;
+            });
+            if (it != result.assigned.end()) *it = entry;
+            else result.assigned.push_back(entry);
+        }
+    }
+
+    std::unordered_set<std::string_view> assigned_names;
+    for (const auto& entry : result.assigned) assigned_names.insert(name_of(entry));
+
+    for (const char* const* e = environ; *e != nullptr; ++e) {
+        const char* eq = std::strchr(*e, '=');
+        if (eq == nullptr) continue;
+        std::string_view name(*e, static_cast<size_t>(eq - *e));
+        if (assigned_names.contains(name) || removed.contains(name)) continue;
+
+        bool keep = false;
+        if (passed.contains(name)) {
+            keep = true;
+        } else {
+            switch (mode) {
+                case Mode::FULL:
+                    keep = true;
+                    break;
+                case Mode::SANITIZE:
+                    keep = !deny_.matches(name);
+                    break;
+                case Mode::SCRUB:
+                    keep = keep_.matches(name) || (check_.matches(name) && value_is_safe(eq + 1));
+                    break;
+            }
+        }
+        if (keep) result.inherited.push_back(*e);
+    }
+    return result;
+}
+
+} // namespace Voix
@@ -0,0 +1,312 @@
+/**
+ * @file exec_plan.cpp
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#include "exec_plan.hpp"
+#include <cerrno>
+#include <cstdint>
+#include <fcntl.h>
+#include <linux/capability.h>
+#include <linux/mempolicy.h>
+#include <linux/sched.h>
+#include <linux/seccomp.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef CLONE_PIDFD
+#define CLONE_PIDFD 0x00001000
+#endif
+#ifndef CLONE_CLEAR_SIGHAND
+#define CLONE_CLEAR_SIGHAND 0x100000000ULL
+#endif
+#ifndef CLONE_INTO_CGROUP
+#define CLONE_INTO_CGROUP 0x200000000ULL
+#endif
+#ifndef CLOSE_RANGE_CLOEXEC
+#define CLOSE_RANGE_CLOEXEC (1U << 2)
+#endif
+
+namespace Voix {
+
+namespace {
+
+// The 32-bit ID variants exist on the few ABIs where the plain ones are 16-bit.
+#ifdef SYS_setgroups32
+constexpr long k_sys_setgroups = SYS_setgroups32;
+constexpr long k_sys_setresgid = SYS_setresgid32;
+constexpr long k_sys_setresuid = SYS_setresuid32;
+#else
+constexpr long k_sys_setgroups = SYS_setgroups;
+constexpr long k_sys_setresgid = SYS_setresgid;
+constexpr long k_sys_setresuid = SYS_setresuid;
+#endif
+
+constexpr int k_ioprio_who_process = 1;
+
+struct ChildArgs {
+    const ExecPlan* plan;
+    const char* const* argv;
+    const char* const* envp;
+    const sigset_t* mask;     // nullptr: keep the current mask
+    int keep_fd;              // error pipe, survives the close step; or -1
+    bool reset_all_handlers;  // no CLONE_CLEAR_SIGHAND: reset every handler
+    bool join_cgroup;         // no CLONE_INTO_CGROUP: write ourselves to cgroup.procs
+    bool close_on_exec;       // in place: leave descriptors open until exec, so failures can be logged
+};
+
+// Closes every descriptor above stderr except @p keep_a and @p keep_b (-1 for none).
+void close_inherited_fds(int keep_a, int keep_b, int fallback_max) noexcept {
+    if (keep_a > keep_b) {
+        int tmp = keep_a;
+        keep_a = keep_b;
+        keep_b = tmp;
+    }
+#ifdef SYS_close_range
+    bool closed = true;
+    unsigned int low = 3;
+    for (int keep : {keep_a, keep_b}) {
+        if (keep < static_cast<int>(low)) continue;
+        if (static_cast<unsigned int>(keep) > low) {
+            closed = closed && syscall(SYS_close_range, low, keep - 1U, 0U) == 0;
+        }
+        low = keep + 1U;
+    }
+    closed = closed && syscall(SYS_close_range, low, ~0U, 0U) == 0;
+    if (closed) return;
+#endif
+    for (int fd = 3; fd < fallback_max; ++fd) {
+        if (fd != keep_a && fd != keep_b) close(fd);
+    }
+}
+
+// Marks every descriptor above stderr close-on-exec: they stay usable until
+// execve() succeeds and are gone after it.
+void cloexec_inherited_fds(int fallback_max) noexcept {
+#ifdef SYS_close_range
+    if (syscall(SYS_close_range, 3U, ~0U, CLOSE_RANGE_CLOEXEC) == 0) return;
+#endif
+    for (int fd = 3; fd < fallback_max; ++fd) {
+        int flags = fcntl(fd, F_GETFD);
+        if (flags != -1 && !(flags & FD_CLOEXEC)) fcntl(fd, F_SETFD, flags | FD_CLOEXEC);
+    }
+}
+
+// Applies the plan to the calling process and executes it; returns only on
+// failure. Only system calls from here on: in a clone child the address space
+// is a copy of a possibly multi-threaded parent, so anything that allocates,
+// locks or talks to other threads (glibc's set*id broadcast) is off limits.
+ExecFailure apply_and_exec(const ChildArgs& args) noexcept {
+    const ExecPlan& plan = *args.plan;
+
+    struct sigaction dfl{};
+    dfl.sa_handler = SIG_DFL;
+    if (args.reset_all_handlers) {
+        for (int sig = 1; sig < NSIG; ++sig) sigaction(sig, &dfl, nullptr);
+    } else {
+        for (int sig : plan.ignored_signals) sigaction(sig, &dfl, nullptr);
+    }
+    if (args.mask && sigprocmask(SIG_SETMASK, args.mask, nullptr) != 0) {
+        return {ExecStage::SIGNALS, errno};
+    }
+
+    // "0" names the writing process; this needs the privileges we still hold.
+    if (args.join_cgroup && plan.cgroup_fd) {
+        int procs_fd = openat(plan.cgroup_fd.get(), "cgroup.procs", O_WRONLY | O_CLOEXEC);
+        if (procs_fd == -1) return {ExecStage::CGROUP, errno};
+        bool joined = write(procs_fd, "0", 1) == 1;
+        int saved_errno = errno;
+        close(procs_fd);
+        if (!joined) return {ExecStage::CGROUP, saved_errno};
+    }
+
+    // Before the identity change: a negative nice value, the realtime I/O
+    // class and widening the affinity need privileges.
+    const KernelTuning& tuning = plan.tuning;
+    if (tuning.nice && setpriority(PRIO_PROCESS, 0, *tuning.nice) != 0) {
+        return {ExecStage::PRIORITY, errno};
+    }
+    if (tuning.sched_policy != -1) {
+        struct sched_param param{};
+        if (sched_setscheduler(0, tuning.sched_policy, &param) != 0) return {ExecStage::PRIORITY, errno};
+    }
+    if (tuning.ioprio != -1 && syscall(SYS_ioprio_set, k_ioprio_who_process, 0, tuning.ioprio) != 0) {
+        return {ExecStage::PRIORITY, errno};
+    }
+    if (tuning.affinity && sched_setaffinity(0, sizeof(cpu_set_t), &*tuning.affinity) != 0) {
+        return {ExecStage::AFFINITY, errno};
+    }
+    if (!tuning.nodemask.empty() &&
+        syscall(SYS_set_mempolicy, MPOL_BIND, tuning.nodemask.data(),
+                tuning.nodemask.size() * sizeof(unsigned long) * 8 + 1) != 0) {
+        return {ExecStage::AFFINITY, errno};
+    }
+
+    if (plan.change_identity) {
+        if (syscall(k_sys_setgroups, plan.groups.size(), plan.groups.data()) != 0) {
+            return {ExecStage::GROUPS, errno};
+        }
+        if (syscall(k_sys_setresgid, plan.gid, plan.gid, plan.gid) != 0) return {ExecStage::GID, errno};
+        if (syscall(k_sys_setresuid, plan.uid, plan.uid, plan.uid) != 0) return {ExecStage::UID, errno};
+    }
+
+    if (plan.drop_capabilities) {
+        struct __user_cap_header_struct header{_LINUX_CAPABILITY_VERSION_3, 0};
+        struct __user_cap_data_struct data[_LINUX_CAPABILITY_U32S_3]{};
+        if (syscall(SYS_capset, &header, data) != 0) return {ExecStage::CAPABILITIES, errno};
+    }
+
+    // Raising a hard limit fails once the UID is unprivileged; as before,
+    // that is not fatal.
+    for (const auto& rl : plan.rlimits) {
+        setrlimit(rl.resource, &rl.limit);
+    }
+
+    const int exec_fd = plan.exec_fd.get();
+    if (plan.close_fds && args.close_on_exec) {
+        cloexec_inherited_fds(plan.close_fds_fallback_max);
+    } else if (plan.close_fds) {
+        close_inherited_fds(args.keep_fd, exec_fd, plan.close_fds_fallback_max);
+    }
+
+    if (plan.no_new_privs && prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) != 0) {
+        return {ExecStage::NO_NEW_PRIVS, errno};
+    }
+    if (!plan.seccomp_filter.empty()) {
+        struct sock_fprog prog{static_cast<unsigned short>(plan.seccomp_filter.size()),
+                               const_cast<sock_filter*>(plan.seccomp_filter.data())};
+        if (syscall(SYS_seccomp, SECCOMP_SET_MODE_FILTER, 0, &prog) != 0) {
+            return {ExecStage::SECCOMP, errno};
+        }
+    }
+
+    // Execute the file the parent verified. A script's interpreter cannot
+    // reopen the close-on-exec descriptor (ENOENT), so scripts go by path.
+    if (exec_fd != -1) {
+        syscall(SYS_execveat, exec_fd, "", args.argv, args.envp, AT_EMPTY_PATH);
+        if (errno != ENOENT) return {ExecStage::EXEC, errno};
+    }
+    execve(plan.path.c_str(), const_cast<char* const*>(args.argv),
+           const_cast<char* const*>(args.envp));
+    return {ExecStage::EXEC, errno};
+}
+
+[[noreturn]] void run_child(const ChildArgs& args) noexcept {
+    ExecFailure failure = apply_and_exec(args);
+    ssize_t ignored = write(args.keep_fd, &failure, sizeof(failure));
+    (void)ignored;
+    _exit(failure.stage == ExecStage::EXEC ? 127 : 1);
+}
+
+// Null-terminated pointer arrays over the plan's strings.
+struct ExecVectors {
+    std::vector<const char*> argv;
+    std::vector<const char*> envp;
+
+    explicit ExecVectors(const ExecPlan& plan) {
+        argv.reserve(plan.argv.size() + 1);
+        for (const auto& arg : plan.argv) argv.push_back(arg.c_str());
+        argv.push_back(nullptr);
+        envp.reserve(plan.inherited_env.size() + plan.assigned_env.size() + 1);
+        envp.assign(plan.inherited_env.begin(), plan.inherited_env.end());
+        for (const auto& entry : plan.assigned_env) envp.push_back(entry.c_str());
+        envp.push_back(nullptr);
+    }
+};
+
+} // namespace
+
+std::string_view exec_stage_name(ExecStage stage) {
+    switch (stage) {
+        case ExecStage::NONE: return "none";
+        case ExecStage::SIGNALS: return "signal setup";
+        case ExecStage::CGROUP: return "cgroup placement";
+        case ExecStage::PRIORITY: return "priority setup";
+        case ExecStage::AFFINITY: return "CPU/NUMA binding";
+        case ExecStage::GROUPS: return "setgroups";
+        case ExecStage::GID: return "setresgid";
+        case ExecStage::UID: return "setresuid";
+        case ExecStage::CAPABILITIES: return "capability drop";
+        case ExecStage::NO_NEW_PRIVS: return "PR_SET_NO_NEW_PRIVS";
+        case ExecStage::SECCOMP: return "seccomp";
+        case ExecStage::EXEC: return "execve";
+    }
+    return "unknown";
+}
+
+pid_t spawn_exec_plan(const ExecPlan& plan, const sigset_t& child_mask, ExecFailure& failure,
+                      int* pidfd) {
+    failure = {};
+    if (pidfd) *pidfd = -1;
+    ExecVectors vectors(plan);
+
+    int pipe_fds[2];
+    if (pipe2(pipe_fds, O_CLOEXEC) != 0) return -1;
+
+    ChildArgs args{&plan, vectors.argv.data(), vectors.envp.data(), &child_mask, pipe_fds[1], false, false, false};
+
+    // CLONE_VFORK suspends us until the child has exec'd or exited, so the
+    // error pipe is ready to read as soon as clone3 returns.
+    pid_t pid = -1;
+#ifdef SYS_clone3
+    struct clone_args cl{};
+    cl.flags = CLONE_VFORK | CLONE_CLEAR_SIGHAND;
+    if (pidfd) {
+        cl.flags |= CLONE_PIDFD;
+        cl.pidfd = reinterpret_cast<std::uintptr_t>(pidfd);
+    }
+    if (plan.cgroup_fd) {
+        cl.flags |= CLONE_INTO_CGROUP;
+        cl.cgroup = static_cast<std::uint64_t>(plan.cgroup_fd.get());
+    }
+    cl.exit_signal = SIGCHLD;
+    pid = static_cast<pid_t>(syscall(SYS_clone3, &cl, sizeof(cl)));
+    if (pid == 0) run_child(args);
+#else
+    errno = ENOSYS;
+#endif
+    // Kernels before 5.5 (5.7 for CLONE_INTO_CGROUP) or container filters
+    // reject clone3 or the flags.
+    if (pid == -1 && (errno == ENOSYS || errno == EINVAL || errno == EPERM)) {
+        args.reset_all_handlers = true;
+        args.join_cgroup = true;
+        pid = fork();
+        if (pid == 0) run_child(args);
+#ifdef SYS_pidfd_open
+        // The child is ours and unreaped, so its pid cannot be reused here.
+        if (pid > 0 && pidfd) *pidfd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#endif
+    }
+
+    int saved_errno = errno;
+    close(pipe_fds[1]);
+    if (pid == -1) {
+        close(pipe_fds[0]);
+        errno = saved_errno;
+        return -1;
+    }
+
+    ExecFailure reported;
+    ssize_t n;
+    do {
+        n = read(pipe_fds[0], &reported, sizeof(reported));
+    } while (n == -1 && errno == EINTR);
+    close(pipe_fds[0]);
+    if (n == static_cast<ssize_t>(sizeof(reported))) failure = reported;
+    return pid;
+}
+
+ExecFailure exec_plan_in_place(const ExecPlan& plan) {
+    ExecVectors vectors(plan);
+    // execve() resets handled signals itself; only ignored ones survive it.
+    ChildArgs args{&plan, vectors.argv.data(), vectors.envp.data(), nullptr, -1, false, true, true};
+    return apply_and_exec(args);
+}
+
+} // namespace Voix
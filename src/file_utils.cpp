@@ -8,51 +8,23 @@
 
 #include "file_utils.hpp"
 #include "logger.hpp"
-#include <limits.h>
 #include <fstream>
 #include <system_error>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <format>
-#include <sstream>
 #include <fcntl.h>
 #include <fcntl.h>
 
 namespace Voix {
 
-// Helper to open a file safely without following symlinks
-static int open_no_follow(const char* path) {
-    return open(path, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
-}
-
-// Check if a file is safe (not a symlink, and proper permissions)
-static bool is_file_safe(int fd) {
-    struct stat st;
-    if (fstat(fd, &st) != 0) return false;
-    
-    // Must be a regular file
-    if (!S_ISREG(st.st_mode)) return false;
-    
-    // Must be owned by root
-    if (st.st_uid != 0) return false;
-    
-    // Should not be world or group writable
-    if (st.st_mode & (S_IWOTH | S_IWGRP)) return false;
-    
-    return true;
-}
-
-static bool check_path_safe(const fs::path& p) {
-    char resolved_path[PATH_MAX];
-    if (realpath(p.c_str(), resolved_path) == nullptr) {
-        return false;
+SharedFd::SharedFd(int fd) {
+    if (fd != -1) {
+        fd_ = std::shared_ptr<const int>(new int(fd), [](const int* p) {
+            close(*p);
+            delete p;
+        });
     }
-
-    int fd = open_no_follow(resolved_path);
-    if (fd == -1) return false;
-    bool safe = is_file_safe(fd);
-    close(fd);
-    return safe;
 }
 
 bool FileUtils::fileExists(const fs::path& path) const {
@@ -187,13 +159,7 @@ std::expected<std::string, FileError> FileUtils::read_file_secure(const fs::path
         return std::unexpected(FileError::PermissionDenied);
     }
 
-    off_t size = lseek(fd, 0, SEEK_END);
-    if (size < 0) {
-        close(fd);
-        return std::unexpected(FileError::ReadError);
-    }
-    lseek(fd, 0, SEEK_SET);
-
+    const off_t size = st.st_size;
     std::string content;
     content.resize(static_cast<size_t>(size));
     ssize_t bytes_read = read(fd, content.data(), size);
@@ -206,27 +172,4 @@ std::expected<std::string, FileError> FileUtils::read_file_secure(const fs::path
     return content;
 }
 
-std::string FileUtils::resolve_command(const ResolveCommandParams& params) const {
-    const std::string& cmd = params.command;
-    const std::string& paths = params.path_env;
-    if (cmd.empty()) return "";
-
-    // 1. If command contains '/', it's an explicit path.
-    if (cmd.find('/') != std::string::npos) {
-        fs::path p = fs::absolute(cmd);
-        return check_path_safe(p) ? p.string() : "";
-    }
-
-    // 2. Otherwise, look up in $PATH.
-    std::stringstream ss(paths);
-    std::string item;
-    while (std::getline(ss, item, ':')) {
-        fs::path p = fs::path(item) / cmd;
-        if (check_path_safe(p)) {
-            return p.string();
-        }
-    }
-    return "";
-}
-
 } // namespace Voix
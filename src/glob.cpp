@@ -0,0 +1,134 @@
+/**
+ * @file glob.cpp
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#include "glob.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace Voix {
+
+namespace {
+
+// Wildcards match any character but a line break, as std::regex's '.' did.
+bool wildcard_matches(char c) {
+    return c != '\n' && c != '\r';
+}
+
+} // namespace
+
+bool glob_match(std::string_view pattern, std::string_view text) {
+    // Greedy matching with backtracking to the most recent '*' only; a
+    // line break ends what that '*' may absorb.
+    size_t p = 0, t = 0;
+    size_t star = std::string_view::npos, resume = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            resume = t;
+        } else if (p < pattern.size() &&
+                   (pattern[p] == text[t] || (pattern[p] == '?' && wildcard_matches(text[t])))) {
+            ++p;
+            ++t;
+        } else if (star != std::string_view::npos && wildcard_matches(text[resume])) {
+            p = star + 1;
+            t = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return p == pattern.size();
+}
+
+namespace {
+
+bool is_wildcard(char c) {
+    return c == '*' || c == '?';
+}
+
+// Whether single-character pattern items @p x and @p y (neither '*') can
+// match the same character.
+bool items_compatible(char x, char y) {
+    if (x == '?') return wildcard_matches(y);
+    if (y == '?') return wildcard_matches(x);
+    return x == y;
+}
+
+// Compares the patterns from one end up to the first '*' of either.
+template <typename It>
+bool ends_compatible(It a, It a_end, It b, It b_end) {
+    for (; a != a_end && b != b_end; ++a, ++b) {
+        if (*a == '*' || *b == '*') return true;
+        if (!items_compatible(*a, *b)) return false;
+    }
+    // One pattern ended: the rest of the other must be able to match nothing.
+    return std::all_of(a, a_end, [](char c) { return c == '*'; }) &&
+           std::all_of(b, b_end, [](char c) { return c == '*'; });
+}
+
+} // namespace
+
+std::optional<std::string> glob_intersect(std::string_view a, std::string_view b) {
+    if (!ends_compatible(a.begin(), a.end(), b.begin(), b.end()) ||
+        !ends_compatible(a.rbegin(), a.rend(), b.rbegin(), b.rend())) {
+        return std::nullopt;
+    }
+
+    // State (i, j): a[0, i) and b[0, j) have matched the same prefix.
+    constexpr std::uint32_t k_unseen = UINT32_MAX;
+    constexpr int k_epsilon = -1;
+    const size_t width = b.size() + 1;
+    const size_t states = (a.size() + 1) * width;
+    std::vector<std::uint32_t> parent(states, k_unseen);
+    std::vector<int> consumed(states, k_epsilon);
+    std::vector<std::uint32_t> queue;
+    queue.reserve(states);
+    parent[0] = 0;
+    queue.push_back(0);
+
+    auto visit = [&](std::uint32_t from, size_t i, size_t j, int c) {
+        const auto to = static_cast<std::uint32_t>(i * width + j);
+        if (parent[to] != k_unseen) return;
+        parent[to] = from;
+        consumed[to] = c;
+        queue.push_back(to);
+    };
+
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const std::uint32_t state = queue[head];
+        const size_t i = state / width, j = state % width;
+        if (i == a.size() && j == b.size()) {
+            std::string witness;
+            for (std::uint32_t s = state; s != 0; s = parent[s]) {
+                if (consumed[s] != k_epsilon) witness.push_back(static_cast<char>(consumed[s]));
+            }
+            std::ranges::reverse(witness);
+            return witness;
+        }
+        // A '*' may match nothing more.
+        if (i < a.size() && a[i] == '*') visit(state, i + 1, j, k_epsilon);
+        if (j < b.size() && b[j] == '*') visit(state, i, j + 1, k_epsilon);
+        if (i == a.size() || j == b.size()) continue;
+
+        // Both consume one character. Two '*'s never need to: dropping a
+        // character both absorb leaves a string both still match.
+        const char x = a[i], y = b[j];
+        if (x == '*' && y == '*') continue;
+        char c = !is_wildcard(x) ? x : !is_wildcard(y) ? y : 'x';
+        if (x == '*' || y == '*') {
+            if (!wildcard_matches(c)) continue;
+        } else if (!items_compatible(x, y)) {
+            continue;
+        }
+        visit(state, x == '*' ? i : i + 1, y == '*' ? j : j + 1, static_cast<unsigned char>(c));
+    }
+    return std::nullopt;
+}
+
+} // namespace Voix
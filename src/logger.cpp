@@ -7,28 +7,107 @@
  */
 
 #include "logger.hpp"
-#include <chrono>
+#include <atomic>
+#include <ctime>
+#include <fcntl.h>
 #include <format>
-#include <fstream>
 #include <string_view>
 #include <print>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <syslog.h>
+#include <unistd.h>
 
 namespace Voix {
 
+namespace {
+
+constexpr const char* k_log_path = "/var/log/voix.log";
+constexpr int k_log_flags = O_WRONLY | O_APPEND | O_CREAT | O_NOFOLLOW | O_CLOEXEC;
+constexpr mode_t k_log_mode = 0640;
+
+std::atomic<int> g_log_fd{-1};
+
+const char* log_path() {
+#ifdef VOIX_HARNESS
+    // voix_stress builds only (VOIX_ENABLE_HARNESS, never installed): the
+    // harness checks the records of its own invocations in a private file.
+    if (const char* harness_log = getenv("VOIX_HARNESS_LOG")) return harness_log;
+#endif
+    return k_log_path;
+}
+
+// Opens the log once per process. A failed open (e.g. while running with the
+// caller's effective UID) is retried on the next record.
+int log_fd() {
+    int fd = g_log_fd.load(std::memory_order_acquire);
+    if (fd != -1) return fd;
+    fd = open(log_path(), k_log_flags, k_log_mode);
+    if (fd == -1) return -1;
+    int expected = -1;
+    if (!g_log_fd.compare_exchange_strong(expected, fd, std::memory_order_acq_rel)) {
+        close(fd);
+        return expected;
+    }
+    return fd;
+}
+
+// "YYYY-MM-DD HH:MM:SS" (UTC), reformatted only when the second changes.
+std::string_view cached_timestamp() {
+    thread_local time_t cached_second = -1;
+    thread_local char cached_text[32];
+    thread_local size_t cached_size = 0;
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME_COARSE, &now);
+    if (now.tv_sec != cached_second) {
+        struct tm tm;
+        gmtime_r(&now.tv_sec, &tm);
+        auto res = std::format_to_n(cached_text, sizeof(cached_text), "{:04}-{:02}-{:02} {:02}:{:02}:{:02}",
+                                    tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                                    tm.tm_hour, tm.tm_min, tm.tm_sec);
+        cached_size = static_cast<size_t>(res.out - cached_text);
+        cached_second = now.tv_sec;
+    }
+    return {cached_text, cached_size};
+}
+
+char* append(char* out, std::string_view s) {
+    std::memcpy(out, s.data(), s.size());
+    return out + s.size();
+}
+
+} // namespace
+
 bool Logger::suppress_stderr = false;
 
 std::string Logger::getTimestamp() const {
-  auto now = std::chrono::system_clock::now();
-  return std::format("{:%Y-%m-%d %H:%M:%S}", now);
+  return std::string(cached_timestamp());
 }
 
 void Logger::log(std::string_view level, std::string_view message) const {
-  std::ofstream log_file("/var/log/voix.log", std::ios::app);
-  if (log_file.is_open()) {
-    log_file << std::format("[{}] [{}] {}\n", getTimestamp(), level, message);
-    log_file.close();
+  int fd = log_fd();
+  if (fd != -1) {
+    // "[<timestamp>] [<level>] <message>\n"
+    std::string_view timestamp = cached_timestamp();
+    const size_t size = timestamp.size() + level.size() + message.size() + 6;
+    char stack_buf[1024];
+    std::string heap_buf;
+    char* record = stack_buf;
+    if (size > sizeof(stack_buf)) {
+      heap_buf.resize(size);
+      record = heap_buf.data();
+    }
+    char* out = append(record, "[");
+    out = append(out, timestamp);
+    out = append(out, "] [");
+    out = append(out, level);
+    out = append(out, "] ");
+    out = append(out, message);
+    out = append(out, "\n");
+    ssize_t ignored = write(fd, record, static_cast<size_t>(out - record));
+    (void)ignored;
   } else {
     int priority = LOG_AUTHPRIV | LOG_INFO;
     if (level == "ERROR") priority = LOG_AUTHPRIV | LOG_ERR;
@@ -42,4 +121,13 @@ void Logger::log(std::string_view level, std::string_view message) const {
   }
 }
 
+void Logger::reopen() {
+  int fd = g_log_fd.load(std::memory_order_acquire);
+  if (fd == -1) return;
+  int fresh = open(log_path(), k_log_flags, k_log_mode);
+  if (fresh == -1) return;
+  dup3(fresh, fd, O_CLOEXEC);
+  close(fresh);
+}
+
 } // namespace Voix
@@ -7,6 +7,7 @@
  * All code in this repository is licensed under OSL v3.
  */
 
+#include <format>
 #include <print>
 #include <string>
 #include <vector>
@@ -17,11 +18,19 @@
 #include <memory>
 #include <sys/capability.h>
 #include <getopt.h>
+#include <thread>
+#include <ctime>
+#include <optional>
 #include "voix.hpp"
+#include "audit_store.hpp"
 #include "config.hpp"
 #include "security.hpp"
 #include "system_utils.hpp"
 #include "policy_analyzer.hpp"
+#include "policy_diff.hpp"
+#include "rule_stats.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
 
 #if BUILD_TESTING
 #include "tests/test_main.hpp"
@@ -39,18 +48,25 @@ void printUsage() {
                "  -v, --version            Show the version of this artifact\n"
                "  -u USER                  Execute as target user (default: root)\n"
                "  -C, --config FILE        Use FILE as the configuration sanctuary\n"
-               "  -c, --check-config       Validate the configuration file\n"
+               "  -c, --check-config [FILE...]\n"
+               "                           Validate and analyze configuration files\n"
                "  -n                       Non-interactive mode (fail if proof is required)\n"
                "  -s                       Execute user's shell (ascend to shell)\n"
                "  -l, --list               List permitted commands for the current user\n"
                "  -E, --preserve-env       Preserve the environment\n"
                "  -i, --login              Execute in a login shell\n"
-               "  -k                       Invalidate timestamp (compatibility no-op)\n\n"
+               "  -k                       Invalidate the persist timestamp for this session\n"
+               "  --audit-query EXPR       Print matching audit records as JSON lines (root only)\n"
+               "  --diff-policy OLD NEW    Show the decisions that change from policy OLD to NEW\n"
+               "  --rule-stats             Show how often each rule matched (root only)\n"
+               "  --trace[=table|json]     Print how long each stage took to stderr\n\n"
                "Examples:\n"
                "  voix ls /root\n"
                "  voix -u admin systemctl restart nginx\n"
                "  voix -l                  # List permitted commands\n"
-               "  voix -s                  # Start interactive shell ascension\n");
+               "  voix -c hosts/*.conf     # Check many configurations in parallel\n"
+               "  voix -s                  # Start interactive shell ascension\n"
+               "  voix --audit-query 'since=24h user=alice command=rm'\n");
 }
 
 /**
@@ -79,6 +95,11 @@ int main(int argc, char* argv[]) noexcept {
         bool nflag = false;
         bool sflag = false;
         bool clear_timestamp = false;
+        bool custom_config = false;
+        std::optional<std::string> audit_query;
+        std::optional<std::string> diff_old;
+        bool rule_stats = false;
+        std::optional<Voix::Trace::Format> trace;
         Voix::CommandOptions options;
 
         // Note: short-only options 'n', 's', 'u', 'k' in the optstring have
@@ -103,6 +124,10 @@ int main(int argc, char* argv[]) noexcept {
             {"version", no_argument, nullptr, 'v'},
             {"check-config", no_argument, nullptr, 'c'},
             {"config", required_argument, nullptr, 'C'},
+            {"audit-query", required_argument, nullptr, 'A'},
+            {"diff-policy", required_argument, nullptr, 'D'},
+            {"rule-stats", no_argument, nullptr, 'R'},
+            {"trace", optional_argument, nullptr, 'T'},
             {nullptr, 0, nullptr, 0}
         };
 
@@ -110,6 +135,7 @@ int main(int argc, char* argv[]) noexcept {
             switch (ch) {
                 case 'C':
                     config_path = optarg;
+                    custom_config = true;
                     break;
                 case 'E':
                     options.preserve_env = true;
@@ -138,8 +164,27 @@ int main(int argc, char* argv[]) noexcept {
                 case 'c':
                     options.check_config = true;
                     break;
+                case 'A':
+                    audit_query = optarg;
+                    break;
+                case 'D':
+                    diff_old = optarg;
+                    break;
+                case 'R':
+                    rule_stats = true;
+                    break;
+                case 'T': {
+                    Voix::Trace::Format format;
+                    if (!Voix::Trace::parse_format(optarg ? optarg : "", format)) {
+                        std::println(stderr, "Error: --trace takes 'table' or 'json'");
+                        return 1;
+                    }
+                    trace = format;
+                    break;
+                }
                 case 'k':
-                    // sudo -k: invalidate timestamp. No-op for voix.
+                    // sudo/doas -k: invalidate the persist timestamp. May be
+                    // given alone or together with a command.
                     clear_timestamp = true;
                     break;
                 default:
@@ -151,6 +196,63 @@ int main(int argc, char* argv[]) noexcept {
         argc -= optind;
         argv += optind;
 
+        // VOIX_TRACE is the caller's to set; only root's is trusted, so a
+        // wrapper cannot make other users' invocations print traces.
+        if (const char* env = getenv("VOIX_TRACE"); !trace && env && getuid() == 0) {
+            Voix::Trace::Format format;
+            if (Voix::Trace::parse_format(env, format)) trace = format;
+        }
+        if (trace) Voix::Trace::enable(*trace);
+
+        if (diff_old) {
+            if (argc != 1) {
+                std::println(stderr, "Error: --diff-policy takes two configuration files");
+                return 2;
+            }
+            // Only policy text is read: drop root for good before parsing
+            // either file, so the saved IDs cannot be used to regain it.
+            const gid_t gid = getgid();
+            const uid_t uid = getuid();
+            if (setresgid(gid, gid, gid) != 0 || setresuid(uid, uid, uid) != 0) {
+                std::println(stderr, "Error: cannot drop privileges");
+                return 2;
+            }
+            // Generated policies are large; parse both at once.
+            Voix::Config before, after;
+            bool before_loaded = false;
+            std::jthread loader([&] { before_loaded = before.load(*diff_old, false); });
+            bool after_loaded = after.load(argv[0], false);
+            loader.join();
+            if (!before_loaded || !after_loaded) {
+                std::println(stderr, "Error: cannot load the configurations");
+                return 2;
+            }
+            auto changes = Voix::diff_policies(before, after);
+            for (const auto& c : changes) {
+                const char* note = c.approximate ? "  [approximate: pattern arguments]" : "";
+                switch (c.kind) {
+                    case Voix::PolicyChange::Kind::ADDED_GRANT:
+                        std::println("+ grant    {} -> {}: {} {} ({}){}", c.principal, c.target, c.command,
+                                     c.args, c.after, note);
+                        break;
+                    case Voix::PolicyChange::Kind::REMOVED_GRANT:
+                        std::println("- grant    {} -> {}: {} {} ({}){}", c.principal, c.target, c.command,
+                                     c.args, c.before, note);
+                        break;
+                    case Voix::PolicyChange::Kind::AUTH_CHANGED:
+                        std::println("~ auth     {} -> {}: {} {}: {} => {}{}", c.principal, c.target, c.command,
+                                     c.args, c.before, c.after, note);
+                        break;
+                    case Voix::PolicyChange::Kind::PROFILE_CHANGED:
+                        std::println("~ profile  {} -> {}: {} {}: {} => {}{}", c.principal, c.target, c.command,
+                                     c.args, c.before, c.after, note);
+                        break;
+                }
+            }
+            std::println("{} decision change{}", changes.size(), changes.size() == 1 ? "" : "s");
+            return changes.empty() ? 0 : 1;
+        }
+
         // Handle shell mode
         if (sflag) {
             char* shell_var = getenv("SHELL");
@@ -162,7 +264,8 @@ int main(int argc, char* argv[]) noexcept {
                 shell = shell_var;
             }
             command_args.push_back(shell);
-        } else if (argc < 1 && !options.list_commands && !options.check_config) {
+        } else if (argc < 1 && !options.list_commands && !options.check_config && !clear_timestamp &&
+                   !audit_query && !rule_stats) {
             std::println(stderr, "Error: No command specified");
             printUsage();
             return 1;
@@ -173,21 +276,108 @@ int main(int argc, char* argv[]) noexcept {
         }
         
         if (options.check_config) {
+            // `voix -c [FILE...]`: every file given, or the active configuration.
+            std::vector<std::string> paths;
+            if (argc > 0) {
+                paths.assign(argv, argv + argc);
+            } else {
+                paths.push_back(config_path);
+            }
+            Voix::ThreadPool pool;
+            auto reports = Voix::check_configs(paths, pool);
+            const bool many = reports.size() > 1;
+            bool all_valid = true;
+            for (const auto& report : reports) {
+                std::string prefix = many ? report.path + ": " : "";
+                if (!report.valid) {
+                    std::println(stderr, "Error: {}Invalid configuration schema or permissions.", prefix);
+                    all_valid = false;
+                    continue;
+                }
+                std::println("{}Configuration is valid.", prefix);
+                if (!report.findings.empty()) {
+                    std::println("\nPolicy analysis:");
+                    for (const auto& f : report.findings) {
+                        const char* severity = (f.severity == Voix::PolicyFinding::Severity::ERROR)
+                            ? "error" : "warning";
+                        std::println("  [{}] {}", severity, f.message);
+                    }
+                    if (many) std::println("");
+                }
+            }
+            return all_valid ? 0 : 1;
+        }
+
+        if (audit_query) {
+            // Audit records name every caller and command; like the log
+            // files they are for root only.
+            if (getuid() != 0) {
+                std::println(stderr, "Error: --audit-query requires root");
+                return 1;
+            }
             Voix::Config config;
-            if (!config.load(config_path, true) || !config.validate()) {
+            if (!config.load(config_path) || !config.validate()) {
                 std::println(stderr, "Error: Invalid configuration schema or permissions.");
                 return 1;
             }
-            std::println("Configuration is valid.");
+            if (config.get_audit_dir().empty()) {
+                std::println(stderr, "Error: the audit store is disabled (core.audit_dir)");
+                return 1;
+            }
+            std::string error;
+            auto query = Voix::AuditStore::parse_query(*audit_query, std::time(nullptr), error);
+            if (!query) {
+                std::println(stderr, "Error: {}", error);
+                return 1;
+            }
+            Voix::AuditStore store(config.get_audit_dir(), config.get_audit_segment_size());
+            store.seal_pending();
+            auto count = store.query(*query, [](std::string_view record) {
+                std::println("{}", record);
+            });
+            if (!count) {
+                std::println(stderr, "Error: cannot read the audit store in {}", config.get_audit_dir());
+                return 1;
+            }
+            return 0;
+        }
 
-            Voix::PolicyAnalyzer analyzer(config);
-            auto findings = analyzer.analyze();
-            if (!findings.empty()) {
-                std::println("\nPolicy analysis:");
-                for (const auto& f : findings) {
-                    const char* severity = (f.severity == Voix::PolicyFinding::Severity::ERROR)
-                        ? "error" : "warning";
-                    std::println("  [{}] {}", severity, f.message);
+        if (rule_stats) {
+            // The counts describe what every user runs.
+            if (getuid() != 0) {
+                std::println(stderr, "Error: --rule-stats requires root");
+                return 1;
+            }
+            Voix::Config config;
+            if (!config.load(config_path) || !config.validate()) {
+                std::println(stderr, "Error: Invalid configuration schema or permissions.");
+                return 1;
+            }
+            const auto& rules = config.getRules();
+            auto counters = Voix::RuleHitCounters::open(config.get_rule_stats_path(), rules, false);
+            if (!counters) {
+                std::println(stderr, "No hit counts recorded for this policy ({})", config.get_rule_stats_path());
+                return 1;
+            }
+            auto hits = counters->counts();
+            std::println("{:>5}  {:>12}  rule", "#", "hits");
+            for (size_t i = 0; i < rules.size(); ++i) {
+                const auto& rule = rules[i];
+                std::string line = std::format("{} {} as {}", rule.action == Voix::Rule::Action::PERMIT
+                                                                  ? "permit" : "deny",
+                                               rule.ident.empty() ? "*" : rule.ident,
+                                               rule.target.empty() ? "root" : rule.target);
+                line += rule.cmd.empty() ? " *" : " " + rule.cmd;
+                for (const auto& arg : rule.cmdargs) line += " " + arg;
+                std::println("{:>5}  {:>12}  {}", i + 1, hits[i], line);
+            }
+
+            auto moves = Voix::PolicyAnalyzer(config).suggest_reorderings(hits);
+            if (!moves.empty()) {
+                std::println("\nReorderings that keep every decision:");
+                for (const auto& m : moves) {
+                    std::println("  move rule {} before rule {} (saves {} rule evaluations)", m.rule + 1,
+                                 m.move_before + 1, m.saved);
                 }
             }
             return 0;
@@ -199,8 +389,10 @@ int main(int argc, char* argv[]) noexcept {
 #ifdef VOIX_WITH_CAP
             security.raiseCapabilities();
 #endif
-            // Initialize Voix with enhanced configuration
-            Voix::Voix voix(config_path, nflag, clear_timestamp);
+            // Initialize Voix with enhanced configuration. voixd only serves
+            // the system policy, so an explicit -C always evaluates locally.
+            bool use_broker = !custom_config && !options.list_commands && !clear_timestamp;
+            Voix::Voix voix(config_path, nflag, clear_timestamp, use_broker);
 
             std::string command = "";
             std::vector<std::string> args;
@@ -213,19 +405,21 @@ int main(int argc, char* argv[]) noexcept {
             int result = 0;
             if (options.list_commands) {
                 result = voix.list_commands();
+            } else if (command.empty() && clear_timestamp) {
+                // `voix -k` alone: the timestamp was cleared on construction.
+                result = 0;
             } else {
+                // Voix::execute() reports every stage to the audit sinks.
                 result = voix.execute(command, args, options, target_user);
-
-                // Log successful execution
-                syslog(LOG_AUTHPRIV | LOG_INFO, "Command executed: %s as %s",
-                      command.c_str(), target_user.c_str());
             }
 
 #ifdef VOIX_WITH_CAP
             security.dropCapabilities();
 #endif
+            Voix::Trace::flush();
             return result;
         } catch (const std::exception& e) {
+            Voix::Trace::flush();
             std::println(stderr, "Error: {}", e.what());
             syslog(LOG_AUTHPRIV | LOG_ERR, "Voix error: %s", e.what());
 #ifdef VOIX_WITH_CAP
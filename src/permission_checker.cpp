@@ -9,15 +9,19 @@
 #include "permission_checker.hpp"
 #include "security.hpp"
 #include "config.hpp"
+#include "glob.hpp"
+#include "probes.hpp"
+#include "rule_stats.hpp"
+#include "trace.hpp"
 #include <pwd.h>
 #include <grp.h>
 #include <unistd.h>
 #include <cstring>
+#include <format>
 #include <utility>
 #include <vector>
 #include <algorithm>
 #include <ranges>
-#include <regex>
 #include <span>
 
 #ifndef NGROUPS_MAX
@@ -44,24 +48,12 @@ bool PermissionChecker::isAllowed() const {
   });
 }
 bool PermissionChecker::match_pattern(const MatchPatternParams& params) const {
-  const std::string& pattern = params.pattern;
-  const std::string& text = params.text;
-  std::string regex_pattern = "^";
-  for (char c : pattern) {
-    if (c == '*') regex_pattern += ".*";
-    else if (c == '?') regex_pattern += ".";
-    else if (std::string(".+^$|()[]{}").find(c) != std::string::npos) {
-      regex_pattern += "\\";
-      regex_pattern += c;
-    } else {
-      regex_pattern += c;
-    }
-  }
-  regex_pattern += "$";
-  return std::regex_match(text, std::regex(regex_pattern));
+  return glob_match(params.pattern, params.text);
 }
 
 std::string PermissionChecker::resolve_variables(const std::string& text) const {
+  // Most rules carry no variables; skip the identity lookup for them.
+  if (text.find("%u") == std::string::npos) return text;
   std::string resolved = text;
   std::string user = security_->getCurrentUser();
   size_t pos = 0;
@@ -72,9 +64,15 @@ std::string PermissionChecker::resolve_variables(const std::string& text) const
   return resolved;
 }
 
+bool PermissionChecker::equals_resolved(const std::string& text, std::string_view value) const {
+  if (text.find("%u") == std::string::npos) return text == value;
+  return resolve_variables(text) == value;
+}
+
 bool PermissionChecker::matchRule(const Rule &rule, uid_t uid, gid_t *groups, int ngroups,
                                     std::string_view command, uid_t target_uid,
-                                    const std::vector<std::string> &args) const {
+                                    const std::vector<std::string> &args,
+                                    std::string_view resolved_path) const {
   if (rule.ident_uid.has_value()) {
       if (rule.ident_uid.value() != uid) {
           return false;
@@ -126,8 +124,8 @@ bool PermissionChecker::matchRule(const Rule &rule, uid_t uid, gid_t *groups, in
   }
 
   if (!rule.cmd.empty()) {
-    std::string resolved_cmd = resolve_variables(rule.cmd);
-    if (resolved_cmd != command)
+    if (!equals_resolved(rule.cmd, command) &&
+        (resolved_path.empty() || !equals_resolved(rule.cmd, resolved_path)))
       return false;
 
     if (!rule.cmdargs.empty()) {
@@ -141,7 +139,7 @@ bool PermissionChecker::matchRule(const Rule &rule, uid_t uid, gid_t *groups, in
         }
       } else {
         for (size_t i = 0; i < args.size(); ++i) {
-          if (resolve_variables(rule.cmdargs[i]) != args[i])
+          if (!equals_resolved(rule.cmdargs[i], args[i]))
             return false;
         }
       }
@@ -153,7 +151,9 @@ bool PermissionChecker::matchRule(const Rule &rule, uid_t uid, gid_t *groups, in
 
 std::optional<Rule> PermissionChecker::permit(std::string_view command,
                                   const std::vector<std::string> &args,
-                                  uid_t target_uid) const {
+                                  uid_t target_uid,
+                                  std::string_view resolved_path,
+                                  std::optional<size_t>* matched) const {
   std::string current_user = security_->getCurrentUser();
     auto identity = security_->identity->get_user_by_name(current_user);
   if (!identity) return std::nullopt;
@@ -163,19 +163,34 @@ std::optional<Rule> PermissionChecker::permit(std::string_view command,
   groups.push_back(identity->gid);
   int ngroups = static_cast<int>(groups.size());
   
-  auto rules = config_->getRules();
+  const auto& rules = config_->getRules();
   
-  for (const auto &rule : rules) {
-    if (matchRule(rule, uid, groups.data(), ngroups, command, target_uid, args)) {
-      if (rule.action == Rule::Action::PERMIT) {
-        return rule;
-      } else {
-        return std::nullopt;
-      }
+  Trace::Span span("rule scan");
+  const std::uint64_t probe_start = probes::start_clock(VOIX_PROBE_ENABLED(permit_done));
+  std::optional<size_t> match;
+  for (size_t i = 0; i < rules.size(); ++i) {
+    if (matchRule(rules[i], uid, groups.data(), ngroups, command, target_uid, args, resolved_path)) {
+      match = i;
+      break;
     }
   }
-  
-  return std::nullopt;
+  const bool permitted = match && rules[*match].action == Rule::Action::PERMIT;
+  if (matched) *matched = match;
+  VOIX_PROBE4(permit_done, probes::current_request(), match ? static_cast<long long>(*match) : -1LL,
+              permitted ? 1 : 0, probes::elapsed(probe_start));
+
+  // Rule indices and counts describe the policy itself, which only root may read.
+  const bool note_rules = Trace::enabled() && getuid() == 0;
+  if (!match) {
+    if (note_rules) span.note(std::format("no match among {} rules", rules.size()));
+    return std::nullopt;
+  }
+  if (hits_) hits_->hit(*match);
+  if (note_rules) {
+    span.note(std::format("rule {} of {} ({})", *match + 1, rules.size(), permitted ? "permit" : "deny"));
+  }
+  if (!permitted) return std::nullopt;
+  return rules[*match];
 }
 
 
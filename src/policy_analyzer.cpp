@@ -1,91 +1,601 @@
 #include "policy_analyzer.hpp"
+#include "glob.hpp"
+#include "thread_pool.hpp"
 #include <algorithm>
+#include <charconv>
+#include <cstdint>
 #include <format>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
 
 namespace Voix {
 
+namespace {
+
+// Shadowing is decided within partitions of (target, identity, command);
+// command 0 stands for "any", like identity 0.
+constexpr std::uint64_t k_any = 0;
+constexpr std::uint64_t k_uid_tag = 1ULL << 32;
+constexpr std::uint64_t k_gid_tag = 2ULL << 32;
+
+std::optional<std::uint64_t> parse_uid(std::string_view name) {
+    uid_t uid = 0;
+    auto [ptr, ec] = std::from_chars(name.data(), name.data() + name.size(), uid);
+    if (ec != std::errc{} || ptr != name.data() + name.size()) return std::nullopt;
+    return uid;
+}
+
+struct Partition {
+    std::uint64_t target;
+    std::uint64_t identity;
+    std::uint64_t command;
+    bool operator==(const Partition&) const = default;
+};
+
+struct PartitionHash {
+    size_t operator()(const Partition& p) const {
+        std::uint64_t h = p.target * 0x9e3779b97f4a7c15ULL;
+        h = (h ^ p.identity) * 0xff51afd7ed558ccdULL;
+        h = (h ^ p.command) * 0xc4ceb9fe1a85ec53ULL;
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+};
+
+// Rules whose arguments are all literal (wildcards only count under PATTERN).
+bool has_literal_args(const Rule& rule) {
+    return !(rule.options & Rule::PATTERN) ||
+           std::ranges::none_of(rule.cmdargs, [](const auto& arg) { return has_wildcards(arg); });
+}
+
+// FNV-1a over the argument list, seeded with the partition's bucket.
+std::uint64_t args_hash(size_t bucket, const std::vector<std::string>& args) {
+    std::uint64_t h = 14695981039346656037ULL ^ bucket;
+    for (const auto& arg : args) {
+        for (unsigned char c : arg) h = (h ^ c) * 1099511628211ULL;
+        h = (h ^ 0xff) * 1099511628211ULL;  // separator: ["ab"] != ["a", "b"]
+    }
+    return h;
+}
+
+// Whether pattern argument @p a matches every string argument @p b matches.
+// %u is substituted per caller, so arguments carrying it must be equal.
+bool arg_covers(const std::string& a, const std::string& b, bool b_literal) {
+    if (a == b) return true;
+    if (a.contains("%u") || b.contains("%u")) return false;
+    if (b_literal) return glob_match(a, b);
+    return a.find_first_not_of('*') == std::string::npos && !b.contains('\n');
+}
+
+bool is_literal_arg(const Rule& rule, const std::string& arg) {
+    return !(rule.options & Rule::PATTERN) || !has_wildcards(arg);
+}
+
+// A request matches a command rule when the rule names the command as typed
+// or the path it resolved to. An absolute command resolves to itself and a
+// bare name to a path ending in that name, so two different absolute paths,
+// or two different bare names, never match the same request.
+bool commands_disjoint(const std::string& a, const std::string& b) {
+    if (a.empty() || b.empty() || a == b) return false;
+    if (a.contains("%u") || b.contains("%u")) return false;
+    const bool a_abs = a.starts_with('/'), b_abs = b.starts_with('/');
+    const bool a_bare = !a.contains('/'), b_bare = !b.contains('/');
+    if ((a_abs && b_abs) || (a_bare && b_bare)) return true;
+    if (a_abs && b_bare) return !a.ends_with("/" + b);
+    if (b_abs && a_bare) return !b.ends_with("/" + a);
+    return false;
+}
+
+bool args_disjoint(const Rule& a, const Rule& b) {
+    if (a.cmd.empty() || b.cmd.empty() || a.cmdargs.empty() || b.cmdargs.empty()) return false;
+    if (a.cmdargs.size() != b.cmdargs.size()) return true;
+    for (size_t k = 0; k < a.cmdargs.size(); ++k) {
+        const auto& x = a.cmdargs[k];
+        const auto& y = b.cmdargs[k];
+        if (x.contains("%u") || y.contains("%u")) continue;
+        const bool x_literal = is_literal_arg(a, x), y_literal = is_literal_arg(b, y);
+        if (x_literal && y_literal && x != y) return true;
+        if (x_literal && !y_literal && !glob_match(y, x)) return true;
+        if (y_literal && !x_literal && !glob_match(x, y)) return true;
+    }
+    return false;
+}
+
+// Whether no request can match both rules. Conservative: false means "not
+// proven", and wildcard patterns are only compared against literals.
+bool rules_disjoint(const Rule& a, const Rule& b) {
+    auto a_identity = rule_identity_key(a), b_identity = rule_identity_key(b);
+    auto a_target = rule_target_key(a), b_target = rule_target_key(b);
+    // A rule that never matches shares nothing with anything.
+    if (!a_identity || !b_identity || !a_target || !b_target) return true;
+    if (*a_target != *b_target) return true;
+    if ((*a_identity & k_uid_tag) && (*b_identity & k_uid_tag) && *a_identity != *b_identity) return true;
+    return commands_disjoint(a.cmd, b.cmd) || args_disjoint(a, b);
+}
+
+bool commands_overlap(const std::string& a, const std::string& b) {
+    if (a.empty() || b.empty() || a == b) return true;
+    if (a.starts_with('/') && !b.contains('/')) return a.ends_with("/" + b);
+    if (b.starts_with('/') && !a.contains('/')) return b.ends_with("/" + a);
+    return false;
+}
+
+// The name a command is partitioned by: "ls" for both ls and /bin/ls.
+std::string_view command_name(std::string_view cmd) {
+    auto slash = cmd.rfind('/');
+    return slash == std::string_view::npos ? cmd : cmd.substr(slash + 1);
+}
+
+// Whether the rule restricts the argument list at all.
+bool restricts_args(const Rule& rule) {
+    return !rule.cmd.empty() && !rule.cmdargs.empty();
+}
+
+// Shortest argument matching @p arg of @p rule.
+std::string sample_arg(const Rule& rule, const std::string& arg) {
+    if (is_literal_arg(rule, arg)) return arg;
+    std::string out;
+    for (char c : arg) {
+        if (c != '*') out.push_back(c == '?' ? 'x' : c);
+    }
+    return out;
+}
+
+// An argument list both rules accept, if there is one.
+std::optional<std::vector<std::string>> common_args(const Rule& a, const Rule& b) {
+    std::vector<std::string> out;
+    if (!restricts_args(a) && !restricts_args(b)) return out;
+    if (!restricts_args(b)) {
+        for (const auto& arg : a.cmdargs) out.push_back(sample_arg(a, arg));
+        return out;
+    }
+    if (!restricts_args(a)) return common_args(b, a);
+    if (a.cmdargs.size() != b.cmdargs.size()) return std::nullopt;
+    for (size_t k = 0; k < a.cmdargs.size(); ++k) {
+        const auto& x = a.cmdargs[k];
+        const auto& y = b.cmdargs[k];
+        const bool x_literal = is_literal_arg(a, x), y_literal = is_literal_arg(b, y);
+        if (x_literal && y_literal) {
+            if (x != y) return std::nullopt;
+            out.push_back(x);
+        } else if (x_literal || y_literal) {
+            const auto& literal = x_literal ? x : y;
+            if (!glob_match(x_literal ? y : x, literal)) return std::nullopt;
+            out.push_back(literal);
+        } else {
+            auto both = glob_intersect(x, y);
+            if (!both) return std::nullopt;
+            out.push_back(std::move(*both));
+        }
+    }
+    return out;
+}
+
+bool has_variables(const Rule& rule) {
+    return rule.cmd.contains("%u") ||
+           std::ranges::any_of(rule.cmdargs, [](const auto& arg) { return arg.contains("%u"); });
+}
+
+std::string quote_arg(const std::string& arg) {
+    if (!arg.empty() && arg.find_first_of(" \t\n'\"") == std::string::npos) return arg;
+    std::string out = "'";
+    for (char c : arg) {
+        if (c == '\n') {
+            out += "\\n";
+        } else {
+            out.push_back(c);
+        }
+    }
+    return out + "'";
+}
+
+std::string describe_request(const Rule& a, const Rule& b, const std::vector<std::string>& args) {
+    const std::string& ident = a.ident.empty() ? b.ident : a.ident;
+    const std::string& target = a.target.empty() ? b.target : a.target;
+    // An absolute command is what both rules see after resolution.
+    const std::string& cmd = a.cmd.starts_with('/') || b.cmd.empty() ? a.cmd : b.cmd;
+    std::string out = std::format("{} as {}: {}", ident.empty() ? "any user" : ident,
+                                  target.empty() ? "root" : target, cmd.empty() ? "any command" : cmd);
+    for (const auto& arg : args) out += " " + quote_arg(arg);
+    return out;
+}
+
+struct Bucket {
+    std::optional<size_t> any_args;  // First rule matching any arguments.
+    std::vector<size_t> patterns;    // PATTERN rules with wildcards, in order.
+};
+
+} // namespace
+
+std::optional<std::uint64_t> rule_identity_key(const Rule& rule) {
+    if (rule.ident_uid) return k_uid_tag | *rule.ident_uid;
+    if (rule.ident_gid) return k_gid_tag | *rule.ident_gid;
+    if (rule.ident.empty()) return k_any;
+    auto uid = parse_uid(rule.ident);
+    if (!uid) return std::nullopt;
+    return k_uid_tag | *uid;
+}
+
+std::optional<std::uint64_t> rule_target_key(const Rule& rule) {
+    if (rule.target_uid) return *rule.target_uid;
+    if (rule.target.empty()) return 0;
+    return parse_uid(rule.target);
+}
+
 PolicyAnalyzer::PolicyAnalyzer(const Config& config) : config_(config) {}
 
 std::vector<PolicyFinding> PolicyAnalyzer::analyze() const {
     std::vector<PolicyFinding> findings;
-    check_empty_acl(findings);
-    check_unconfined_targets(findings);
-    check_redundant_rules(findings);
-    check_open_permissions(findings);
-    check_referenced_profiles(findings);
-    check_blocklist_coverage(findings);
+    for (const auto& check : policy_checks()) check->run(config_, findings);
     return findings;
 }
 
-void PolicyAnalyzer::check_empty_acl(std::vector<PolicyFinding>& findings) const {
-    if (config_.getRules().empty()) {
-        findings.push_back({
-            PolicyFinding::Severity::WARNING,
-            "No ACL rules defined. All commands will be denied."
-        });
+std::vector<ShadowedRule> PolicyAnalyzer::find_shadowed_rules() const {
+    const auto& rules = config_.getRules();
+    std::vector<ShadowedRule> shadowed;
+
+    // Commands are interned; the strings live as long as the rules do.
+    std::unordered_map<std::string_view, std::uint64_t> commands;
+    std::unordered_map<Partition, size_t, PartitionHash> partitions;
+    std::vector<Bucket> buckets;
+    // Literal argument lists, by args_hash(); candidates are compared in full.
+    std::unordered_multimap<std::uint64_t, size_t> literal_args;
+    commands.reserve(rules.size());
+    partitions.reserve(rules.size());
+    literal_args.reserve(rules.size());
+
+    for (size_t j = 0; j < rules.size(); ++j) {
+        const Rule& rule = rules[j];
+        auto identity = rule_identity_key(rule);
+        auto target = rule_target_key(rule);
+        if (!identity || !target) continue;
+        std::uint64_t command = k_any;
+        if (!rule.cmd.empty()) {
+            command = commands.try_emplace(rule.cmd, commands.size() + 1).first->second;
+        }
+
+        // Without a command the arguments are not checked at all.
+        const bool any_args = rule.cmd.empty() || rule.cmdargs.empty();
+        const bool literal = has_literal_args(rule);
+
+        std::optional<size_t> first;
+        auto consider = [&](size_t i) {
+            if (!first || i < *first) first = i;
+        };
+        const std::uint64_t identities[] = {*identity, k_any};
+        const std::uint64_t command_keys[] = {command, k_any};
+        for (size_t a = 0; a < (*identity == k_any ? 1u : 2u); ++a) {
+            for (size_t c = 0; c < (command == k_any ? 1u : 2u); ++c) {
+                auto it = partitions.find({*target, identities[a], command_keys[c]});
+                if (it == partitions.end()) continue;
+                const Bucket& bucket = buckets[it->second];
+                if (bucket.any_args) consider(*bucket.any_args);
+                if (any_args) continue;
+                if (literal) {
+                    auto [lo, hi] = literal_args.equal_range(args_hash(it->second, rule.cmdargs));
+                    for (auto hit = lo; hit != hi; ++hit) {
+                        if (rules[hit->second].cmdargs == rule.cmdargs) consider(hit->second);
+                    }
+                }
+                for (size_t i : bucket.patterns) {
+                    if (first && *first < i) break;
+                    const auto& args = rules[i].cmdargs;
+                    if (args.size() != rule.cmdargs.size()) continue;
+                    bool covers = true;
+                    for (size_t k = 0; covers && k < args.size(); ++k) {
+                        covers = arg_covers(args[k], rule.cmdargs[k], literal);
+                    }
+                    if (covers) consider(i);
+                }
+            }
+        }
+
+        if (first) {
+            const Rule& earlier = rules[*first];
+            bool redundant = earlier.action == rule.action &&
+                             rule_identity_key(earlier) == identity && earlier.cmd == rule.cmd &&
+                             earlier.cmdargs == rule.cmdargs &&
+                             (any_args || has_literal_args(earlier) == literal);
+            shadowed.push_back({j, *first, redundant});
+            // Everything this rule covers, the earlier one covers first.
+            continue;
+        }
+
+        auto [it, added] = partitions.try_emplace({*target, *identity, command}, buckets.size());
+        if (added) buckets.emplace_back();
+        Bucket& bucket = buckets[it->second];
+        if (any_args) {
+            if (!bucket.any_args) bucket.any_args = j;
+        } else if (literal) {
+            literal_args.emplace(args_hash(it->second, rule.cmdargs), j);
+        } else {
+            bucket.patterns.push_back(j);
+        }
+    }
+    return shadowed;
+}
+
+std::vector<RuleConflict> PolicyAnalyzer::find_conflicting_rules() const {
+    const auto& rules = config_.getRules();
+    std::vector<RuleConflict> conflicts;
+
+    // Rules that never match conflict with nothing; full shadowing is
+    // reported by find_shadowed_rules() already.
+    std::vector<bool> live(rules.size(), true);
+    for (const auto& s : find_shadowed_rules()) live[s.rule] = false;
+
+    struct Candidate {
+        size_t rule;
+        std::uint64_t identity;
+    };
+    // Per target: rules naming each command, and rules for any command.
+    struct TargetRules {
+        std::unordered_map<std::string_view, std::vector<Candidate>> by_command;
+        std::vector<Candidate> any_command;
+    };
+    std::unordered_map<std::uint64_t, TargetRules> targets;
+    for (size_t i = 0; i < rules.size(); ++i) {
+        const Rule& rule = rules[i];
+        auto identity = rule_identity_key(rule);
+        auto target = rule_target_key(rule);
+        // %u is substituted per caller; such rules have no single witness.
+        if (!live[i] || !identity || !target || has_variables(rule)) continue;
+        TargetRules& t = targets[*target];
+        if (rule.cmd.empty()) {
+            t.any_command.push_back({i, *identity});
+        } else {
+            t.by_command[command_name(rule.cmd)].push_back({i, *identity});
+        }
     }
+
+    auto compare = [&](const Candidate& earlier, const Candidate& later) {
+        const Rule& a = rules[earlier.rule];
+        const Rule& b = rules[later.rule];
+        if (a.action == b.action) return;
+        if (earlier.identity != later.identity && earlier.identity != k_any && later.identity != k_any) return;
+        if (!commands_overlap(a.cmd, b.cmd)) return;
+        auto args = common_args(a, b);
+        if (!args) return;
+        conflicts.push_back({earlier.rule, later.rule, describe_request(a, b, *args)});
+    };
+
+    for (const auto& [target, t] : targets) {
+        for (const auto& [name, named] : t.by_command) {
+            // Named rules against each other and against earlier any-command
+            // rules; any-command rules among themselves are compared once below.
+            for (size_t n = 0; n < named.size(); ++n) {
+                for (size_t m = 0; m < n; ++m) compare(named[m], named[n]);
+            }
+            for (const auto& rule : named) {
+                for (const auto& any : t.any_command) {
+                    if (any.rule < rule.rule) {
+                        compare(any, rule);
+                    } else {
+                        compare(rule, any);
+                    }
+                }
+            }
+        }
+        for (size_t n = 0; n < t.any_command.size(); ++n) {
+            for (size_t m = 0; m < n; ++m) compare(t.any_command[m], t.any_command[n]);
+        }
+    }
+
+    std::ranges::sort(conflicts, {}, [](const RuleConflict& c) { return std::pair(c.later, c.earlier); });
+    return conflicts;
 }
 
-void PolicyAnalyzer::check_unconfined_targets(std::vector<PolicyFinding>& findings) const {
-    const auto& targets = config_.get_unconfined_targets();
-    for (const auto& target : targets) {
-        if (target == "root") {
+std::vector<RuleReordering> PolicyAnalyzer::suggest_reorderings(const std::vector<std::uint64_t>& hits) const {
+    const auto& rules = config_.getRules();
+    std::vector<RuleReordering> out;
+    if (hits.size() != rules.size()) return out;
+
+    for (size_t j = 1; j < rules.size(); ++j) {
+        if (hits[j] == 0) continue;
+        // Moving rule j before rule i costs every request matching i..j-1 one
+        // more evaluation and saves j - i for every request matching j.
+        std::int64_t gain = 0, best_gain = 0;
+        size_t best = j;
+        for (size_t i = j; i-- > 0;) {
+            if (!rules_disjoint(rules[i], rules[j])) break;
+            gain += static_cast<std::int64_t>(hits[j]) - static_cast<std::int64_t>(hits[i]);
+            if (gain > best_gain) {
+                best_gain = gain;
+                best = i;
+            }
+        }
+        if (best != j) out.push_back({j, best, static_cast<std::uint64_t>(best_gain)});
+    }
+    std::ranges::stable_sort(out, std::ranges::greater{}, &RuleReordering::saved);
+    return out;
+}
+
+namespace {
+
+class EmptyAclCheck final : public IPolicyCheck {
+public:
+    std::string_view name() const override { return "empty-acl"; }
+    void run(const Config& config, std::vector<PolicyFinding>& findings) const override {
+        if (config.getRules().empty()) {
             findings.push_back({
                 PolicyFinding::Severity::WARNING,
-                "root is an unconfined target — retains full capabilities, "
-                "no seccomp, no FD scrubbing, full environment. Remove root "
-                "from unconfined_targets to confine generic root commands."
+                "No ACL rules defined. All commands will be denied."
             });
         }
     }
-}
+};
 
-void PolicyAnalyzer::check_redundant_rules(std::vector<PolicyFinding>& findings) const {
-    const auto& rules = config_.getRules();
-    for (size_t i = 0; i < rules.size(); ++i) {
-        for (size_t j = i + 1; j < rules.size(); ++j) {
-            if (rules[i].ident == rules[j].ident &&
-                rules[i].cmd == rules[j].cmd &&
-                rules[i].action == rules[j].action &&
-                rules[i].target == rules[j].target) {
+class UnconfinedTargetsCheck final : public IPolicyCheck {
+public:
+    std::string_view name() const override { return "unconfined-targets"; }
+    void run(const Config& config, std::vector<PolicyFinding>& findings) const override {
+        for (const auto& target : config.get_unconfined_targets()) {
+            if (target == "root") {
+                findings.push_back({
+                    PolicyFinding::Severity::WARNING,
+                    "root is an unconfined target — retains full capabilities, "
+                    "no seccomp, no FD scrubbing, full environment. Remove root "
+                    "from unconfined_targets to confine generic root commands."
+                });
+            }
+        }
+    }
+};
+
+class RedundantRulesCheck final : public IPolicyCheck {
+public:
+    std::string_view name() const override { return "redundant-rules"; }
+    void run(const Config& config, std::vector<PolicyFinding>& findings) const override {
+        const auto& rules = config.getRules();
+        for (const auto& s : PolicyAnalyzer(config).find_shadowed_rules()) {
+            const Rule& rule = rules[s.rule];
+            const Rule& earlier = rules[s.shadowed_by];
+            if (s.redundant) {
                 findings.push_back({
                     PolicyFinding::Severity::WARNING,
                     std::format("Redundant rules at positions {} and {} "
-                                "(same identity, command, action, target)",
-                                i + 1, j + 1)
+                                "(same identity, target, command, arguments and action)",
+                                s.shadowed_by + 1, s.rule + 1)
+                });
+            } else if (rule.action == Rule::Action::DENY && earlier.action == Rule::Action::PERMIT) {
+                findings.push_back({
+                    PolicyFinding::Severity::ERROR,
+                    std::format("Deny rule at position {} never takes effect: the permit rule at "
+                                "position {} matches every request it does first",
+                                s.rule + 1, s.shadowed_by + 1)
+                });
+            } else {
+                findings.push_back({
+                    PolicyFinding::Severity::WARNING,
+                    std::format("Rule at position {} is shadowed by the rule at position {} "
+                                "and never matches",
+                                s.rule + 1, s.shadowed_by + 1)
                 });
             }
         }
     }
-}
+};
 
-void PolicyAnalyzer::check_open_permissions(std::vector<PolicyFinding>& findings) const {
-    const auto& rules = config_.getRules();
-    for (const auto& rule : rules) {
-        if (rule.action == Rule::Action::PERMIT && rule.cmd.empty()) {
+class ConflictingRulesCheck final : public IPolicyCheck {
+public:
+    std::string_view name() const override { return "conflicting-rules"; }
+    void run(const Config& config, std::vector<PolicyFinding>& findings) const override {
+        const auto& rules = config.getRules();
+        for (const auto& c : PolicyAnalyzer(config).find_conflicting_rules()) {
+            if (rules[c.earlier].action == Rule::Action::PERMIT) {
+                findings.push_back({
+                    PolicyFinding::Severity::ERROR,
+                    std::format("Deny rule at position {} is bypassed by the earlier permit rule at "
+                                "position {} for some requests, e.g. {}",
+                                c.later + 1, c.earlier + 1, c.witness)
+                });
+            } else {
+                findings.push_back({
+                    PolicyFinding::Severity::WARNING,
+                    std::format("Permit rule at position {} is overridden by the earlier deny rule at "
+                                "position {} for some requests, e.g. {}",
+                                c.later + 1, c.earlier + 1, c.witness)
+                });
+            }
+        }
+    }
+};
+
+class OpenPermissionsCheck final : public IPolicyCheck {
+public:
+    std::string_view name() const override { return "open-permissions"; }
+    void run(const Config& config, std::vector<PolicyFinding>& findings) const override {
+        for (const auto& rule : config.getRules()) {
+            if (rule.action == Rule::Action::PERMIT && rule.cmd.empty()) {
+                findings.push_back({
+                    PolicyFinding::Severity::WARNING,
+                    std::format("Rule for '{}' permits ALL commands without restriction. "
+                                "Consider specifying allowed commands.",
+                                rule.ident)
+                });
+            }
+        }
+    }
+};
+
+class BlocklistCoverageCheck final : public IPolicyCheck {
+public:
+    std::string_view name() const override { return "blocklist-coverage"; }
+    void run(const Config& config, std::vector<PolicyFinding>& findings) const override {
+        if (config.get_blocklist().empty()) {
             findings.push_back({
                 PolicyFinding::Severity::WARNING,
-                std::format("Rule for '{}' permits ALL commands without restriction. "
-                            "Consider specifying allowed commands.",
-                            rule.ident)
+                "No blocklist defined. Consider adding entries for dangerous "
+                "commands (e.g., /bin/sh, /bin/bash)."
             });
         }
     }
+};
+
+// Registration happens at startup; analysis takes a snapshot.
+std::mutex g_checks_mutex;
+
+std::vector<std::shared_ptr<const IPolicyCheck>>& registered_checks() {
+    static std::vector<std::shared_ptr<const IPolicyCheck>> checks = {
+        std::make_shared<EmptyAclCheck>(),
+        std::make_shared<UnconfinedTargetsCheck>(),
+        std::make_shared<RedundantRulesCheck>(),
+        std::make_shared<ConflictingRulesCheck>(),
+        std::make_shared<OpenPermissionsCheck>(),
+        std::make_shared<BlocklistCoverageCheck>(),
+    };
+    return checks;
 }
 
-void PolicyAnalyzer::check_referenced_profiles(std::vector<PolicyFinding>& /* findings */) const {
-    // Reserved for future use: detect rules referencing non-existent profiles.
+} // namespace
+
+void register_policy_check(std::shared_ptr<const IPolicyCheck> check) {
+    std::lock_guard lock(g_checks_mutex);
+    registered_checks().push_back(std::move(check));
+}
+
+std::vector<std::shared_ptr<const IPolicyCheck>> policy_checks() {
+    std::lock_guard lock(g_checks_mutex);
+    return registered_checks();
 }
 
-void PolicyAnalyzer::check_blocklist_coverage(std::vector<PolicyFinding>& findings) const {
-    const auto& blocklist = config_.get_blocklist();
-    if (blocklist.empty()) {
-        findings.push_back({
-            PolicyFinding::Severity::WARNING,
-            "No blocklist defined. Consider adding entries for dangerous "
-            "commands (e.g., /bin/sh, /bin/bash)."
-        });
+std::vector<ConfigReport> check_configs(const std::vector<std::string>& paths, ThreadPool& pool,
+                                        bool verify_security) {
+    using CheckResult = std::future<std::vector<PolicyFinding>>;
+    const auto checks = policy_checks();
+
+    std::vector<std::future<std::optional<std::vector<CheckResult>>>> loads;
+    loads.reserve(paths.size());
+    for (const auto& path : paths) {
+        loads.push_back(pool.submit([&pool, &checks, path, verify_security]()
+                                        -> std::optional<std::vector<CheckResult>> {
+            auto config = std::make_shared<Config>();
+            if (!config->load(path, verify_security) || !config->validate()) return std::nullopt;
+            std::vector<CheckResult> results;
+            results.reserve(checks.size());
+            for (const auto& check : checks) {
+                results.push_back(pool.submit([config, check] {
+                    std::vector<PolicyFinding> findings;
+                    check->run(*config, findings);
+                    return findings;
+                }));
+            }
+            return results;
+        }));
+    }
+
+    std::vector<ConfigReport> reports;
+    reports.reserve(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        auto results = loads[i].get();
+        ConfigReport report{paths[i], results.has_value(), {}};
+        if (results) {
+            for (auto& result : *results) std::ranges::move(result.get(), std::back_inserter(report.findings));
+        }
+        reports.push_back(std::move(report));
     }
+    return reports;
 }
 
 } // namespace Voix
@@ -0,0 +1,270 @@
+/**
+ * @file policy_diff.cpp
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#include "policy_diff.hpp"
+#include "config.hpp"
+#include "glob.hpp"
+#include "policy_analyzer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <optional>
+#include <set>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+namespace Voix {
+
+namespace {
+
+constexpr std::uint64_t k_any_identity = 0;
+
+// The rules of one policy that apply to a (target, principal) partition,
+// indexed by command_key(). Indices are positions in the policy's rule list.
+struct PartitionRules {
+    std::unordered_map<std::string_view, std::vector<size_t>> by_command;
+    std::vector<size_t> any_command;
+};
+
+struct Partition {
+    std::uint64_t target;
+    std::uint64_t principal;
+    std::string target_name;
+    std::string principal_name;
+    PartitionRules rules[2];
+};
+
+// Rules of one policy grouped by target key, in policy order.
+struct IndexedPolicy {
+    const std::vector<Rule>* rules;
+    std::map<std::uint64_t, std::vector<size_t>> by_target;
+    std::vector<std::optional<std::uint64_t>> identity;
+};
+
+IndexedPolicy index_policy(const Config& config) {
+    IndexedPolicy policy{&config.getRules(), {}, {}};
+    policy.identity.reserve(policy.rules->size());
+    for (size_t i = 0; i < policy.rules->size(); ++i) {
+        const Rule& rule = (*policy.rules)[i];
+        auto identity = rule_identity_key(rule);
+        auto target = rule_target_key(rule);
+        policy.identity.push_back(identity);
+        if (identity && target) policy.by_target[*target].push_back(i);
+    }
+    return policy;
+}
+
+// Rules naming "rm" and "/usr/bin/rm" share a key: a bare name matches the
+// path it resolves to, so they are one command, as in commands_overlap().
+std::string_view command_key(std::string_view cmd) {
+    if (!cmd.starts_with('/')) return cmd;
+    return cmd.substr(cmd.rfind('/') + 1);
+}
+
+// Whether @p rule, filed under @p command's key, matches requests for
+// @p command: the same path, or the bare name it resolves from.
+bool names_command(const Rule& rule, const std::string& command) {
+    return rule.cmd == command || !rule.cmd.contains('/');
+}
+
+bool args_match(const Rule& rule, const std::vector<std::string>& args) {
+    if (args.size() != rule.cmdargs.size()) return false;
+    for (size_t i = 0; i < args.size(); ++i) {
+        bool match = (rule.options & Rule::PATTERN) ? glob_match(rule.cmdargs[i], args[i])
+                                                    : rule.cmdargs[i] == args[i];
+        if (!match) return false;
+    }
+    return true;
+}
+
+// First rule matching the request class, or nullptr for the default deny.
+// @p command is null for commands no rule names, @p args null for argument
+// lists no rule names.
+const Rule* first_match(const std::vector<Rule>& rules, const PartitionRules& partition,
+                        const std::string* command, const std::vector<std::string>* args) {
+    static const std::vector<size_t> k_none;
+    const std::vector<size_t>* named = &k_none;
+    if (command) {
+        auto it = partition.by_command.find(command_key(*command));
+        if (it != partition.by_command.end()) named = &it->second;
+    }
+    auto a = named->begin();
+    auto b = partition.any_command.begin();
+    while (a != named->end() || b != partition.any_command.end()) {
+        if (b == partition.any_command.end() || (a != named->end() && *a < *b)) {
+            const Rule& rule = rules[*a++];
+            if (!names_command(rule, *command)) continue;
+            if (rule.cmdargs.empty() || (args && args_match(rule, *args))) return &rule;
+        } else {
+            return &rules[*b];
+        }
+    }
+    return nullptr;
+}
+
+std::string auth_of(const Rule& rule) {
+    if (rule.options & Rule::NOPASS) return "nopass";
+    if (rule.options & Rule::PERSIST) return "persist";
+    return "password";
+}
+
+std::string profile_of(const Rule& rule) {
+    return rule.profile.empty() ? "default" : rule.profile;
+}
+
+std::string describe_args(const std::vector<std::string>* args) {
+    if (!args) return "<other>";
+    std::string out;
+    for (const auto& arg : *args) {
+        if (!out.empty()) out += ' ';
+        out += arg;
+    }
+    return out;
+}
+
+void compare(const Partition& partition, const std::vector<Rule>* policies[2], const std::string* command,
+             const std::vector<std::string>* args, bool any_args, bool approximate,
+             std::vector<PolicyChange>& out) {
+    const Rule* before = first_match(*policies[0], partition.rules[0], command, args);
+    const Rule* after = first_match(*policies[1], partition.rules[1], command, args);
+    const bool was_permitted = before && before->action == Rule::Action::PERMIT;
+    const bool is_permitted = after && after->action == Rule::Action::PERMIT;
+    if (!was_permitted && !is_permitted) return;
+
+    auto change = [&](PolicyChange::Kind kind, std::string from, std::string to) {
+        out.push_back({kind, partition.principal_name, partition.target_name, command ? *command : "*",
+                       any_args ? "*" : describe_args(args), std::move(from), std::move(to), approximate});
+    };
+    if (!was_permitted) {
+        change(PolicyChange::Kind::ADDED_GRANT, {}, auth_of(*after) + ", profile " + profile_of(*after));
+    } else if (!is_permitted) {
+        change(PolicyChange::Kind::REMOVED_GRANT, auth_of(*before) + ", profile " + profile_of(*before), {});
+    } else {
+        if (auth_of(*before) != auth_of(*after)) {
+            change(PolicyChange::Kind::AUTH_CHANGED, auth_of(*before), auth_of(*after));
+        }
+        if (before->profile != after->profile) {
+            change(PolicyChange::Kind::PROFILE_CHANGED, profile_of(*before), profile_of(*after));
+        }
+    }
+}
+
+// Enumerates the request classes of one partition and compares them.
+std::vector<PolicyChange> diff_partition(const Partition& partition, const std::vector<Rule>* policies[2]) {
+    // Each path named under a key is one command, and so is the bare name
+    // when no rule names a path for it.
+    std::map<std::string_view, std::set<std::string_view>> commands;
+    for (int p = 0; p < 2; ++p) {
+        for (const auto& [key, indices] : partition.rules[p].by_command) {
+            auto& paths = commands[key];
+            for (size_t i : indices) {
+                const std::string& cmd = (*policies[p])[i].cmd;
+                if (cmd.starts_with('/')) paths.insert(cmd);
+            }
+        }
+    }
+
+    std::vector<PolicyChange> out;
+    for (auto& [key, paths] : commands) {
+        if (paths.empty()) paths.insert(key);
+        for (std::string_view path : paths) {
+            const std::string command(path);
+            std::set<std::vector<std::string>> lists;
+            bool patterns = false;
+            for (int p = 0; p < 2; ++p) {
+                auto it = partition.rules[p].by_command.find(key);
+                if (it == partition.rules[p].by_command.end()) continue;
+                for (size_t i : it->second) {
+                    const Rule& rule = (*policies[p])[i];
+                    if (!names_command(rule, command) || rule.cmdargs.empty()) continue;
+                    lists.insert(rule.cmdargs);
+                    if (rule.options & Rule::PATTERN) patterns = true;
+                }
+            }
+            // Patterns are compared by their text, not the arguments they
+            // match, so a class may stand for arguments another rule decides.
+            for (const auto& args : lists) compare(partition, policies, &command, &args, false, patterns, out);
+            // Argument lists no rule names; "any" when no rule restricts them.
+            compare(partition, policies, &command, nullptr, lists.empty(), patterns, out);
+        }
+    }
+    compare(partition, policies, nullptr, nullptr, true, false, out);
+    return out;
+}
+
+} // namespace
+
+std::vector<PolicyChange> diff_policies(const Config& before, const Config& after, unsigned threads) {
+    const IndexedPolicy indexed[2] = {index_policy(before), index_policy(after)};
+    const std::vector<Rule>* policies[2] = {indexed[0].rules, indexed[1].rules};
+
+    // Partitions: every (target, principal) named by either policy, plus
+    // (target, any user) for users no rule names.
+    std::map<std::pair<std::uint64_t, std::uint64_t>, Partition> partitions;
+    for (int p = 0; p < 2; ++p) {
+        for (const auto& [target, indices] : indexed[p].by_target) {
+            for (size_t i : indices) {
+                const Rule& rule = (*policies[p])[i];
+                std::uint64_t identity = *indexed[p].identity[i];
+                for (std::uint64_t principal : {identity, k_any_identity}) {
+                    auto [it, added] = partitions.try_emplace({target, principal});
+                    if (!added) continue;
+                    it->second.target = target;
+                    it->second.principal = principal;
+                    it->second.target_name = rule.target.empty() ? "root" : rule.target;
+                    it->second.principal_name = principal == k_any_identity ? "*" : rule.ident;
+                }
+            }
+        }
+    }
+
+    for (auto& [key, partition] : partitions) {
+        for (int p = 0; p < 2; ++p) {
+            auto it = indexed[p].by_target.find(partition.target);
+            if (it == indexed[p].by_target.end()) continue;
+            for (size_t i : it->second) {
+                std::uint64_t identity = *indexed[p].identity[i];
+                if (identity != k_any_identity && identity != partition.principal) continue;
+                const Rule& rule = (*policies[p])[i];
+                if (rule.cmd.empty()) {
+                    partition.rules[p].any_command.push_back(i);
+                } else {
+                    partition.rules[p].by_command[command_key(rule.cmd)].push_back(i);
+                }
+            }
+        }
+    }
+
+    std::vector<const Partition*> work;
+    work.reserve(partitions.size());
+    for (const auto& [key, partition] : partitions) work.push_back(&partition);
+    std::vector<std::vector<PolicyChange>> results(work.size());
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, work.size()));
+    std::atomic<size_t> next{0};
+    auto worker = [&] {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < work.size();) {
+            results[i] = diff_partition(*work[i], policies);
+        }
+    };
+    {
+        std::vector<std::jthread> pool;
+        for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+        worker();
+    }
+
+    std::vector<PolicyChange> changes;
+    for (auto& part : results) {
+        std::ranges::move(part, std::back_inserter(changes));
+    }
+    return changes;
+}
+
+} // namespace Voix
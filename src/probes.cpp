@@ -0,0 +1,61 @@
+/**
+ * @file probes.cpp
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#include "probes.hpp"
+#include <atomic>
+#include <ctime>
+#include <unistd.h>
+
+#ifdef VOIX_WITH_USDT
+// The tracer finds each semaphore through the probe notes and increments it
+// while attached; `used` keeps LTO from dropping them.
+#define VOIX_DEFINE_SEMAPHORE(name) \
+    __attribute__((used, section(".probes"))) volatile unsigned short VOIX_PROBE_SEMAPHORE(name) = 0;
+
+extern "C" {
+VOIX_DEFINE_SEMAPHORE(request_start)
+VOIX_DEFINE_SEMAPHORE(request_done)
+VOIX_DEFINE_SEMAPHORE(permit_done)
+VOIX_DEFINE_SEMAPHORE(auth_done)
+VOIX_DEFINE_SEMAPHORE(exec_start)
+VOIX_DEFINE_SEMAPHORE(exec_done)
+}
+#endif
+
+namespace Voix::probes {
+
+namespace {
+
+std::atomic<std::uint32_t> g_next_request{0};
+thread_local std::uint64_t t_request = 0;
+
+} // namespace
+
+std::uint64_t begin_request() noexcept {
+    const std::uint32_t n = g_next_request.fetch_add(1, std::memory_order_relaxed) + 1;
+    t_request = (static_cast<std::uint64_t>(getpid()) << 32) | n;
+    return t_request;
+}
+
+std::uint64_t current_request() noexcept {
+    return t_request;
+}
+
+std::uint64_t start_clock(bool enabled) noexcept {
+    if (!enabled) return 0;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1'000'000'000ULL + static_cast<std::uint64_t>(ts.tv_nsec);
+}
+
+std::uint64_t elapsed(std::uint64_t start) noexcept {
+    if (start == 0) return 0;
+    return start_clock(true) - start;
+}
+
+} // namespace Voix::probes
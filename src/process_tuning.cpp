@@ -0,0 +1,131 @@
+/**
+ * @file process_tuning.cpp
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#include "process_tuning.hpp"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <fcntl.h>
+#include <format>
+#include <limits>
+#include <unistd.h>
+#include <utility>
+
+namespace Voix {
+
+namespace {
+
+constexpr int k_ioprio_class_shift = 13;
+
+constexpr std::array<std::pair<std::string_view, decltype(RLIMIT_NOFILE)>, 16> k_rlimit_names = {{
+    {"as", RLIMIT_AS}, {"core", RLIMIT_CORE}, {"cpu", RLIMIT_CPU}, {"data", RLIMIT_DATA},
+    {"fsize", RLIMIT_FSIZE}, {"locks", RLIMIT_LOCKS}, {"memlock", RLIMIT_MEMLOCK},
+    {"msgqueue", RLIMIT_MSGQUEUE}, {"nice", RLIMIT_NICE}, {"nofile", RLIMIT_NOFILE},
+    {"nproc", RLIMIT_NPROC}, {"rss", RLIMIT_RSS}, {"rtprio", RLIMIT_RTPRIO},
+    {"rttime", RLIMIT_RTTIME}, {"sigpending", RLIMIT_SIGPENDING}, {"stack", RLIMIT_STACK},
+}};
+
+template <typename T>
+bool parse_number(std::string_view s, T& out) {
+    auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+    return ec == std::errc{} && ptr == s.data() + s.size();
+}
+
+// Reads the CPUs of a NUMA node; std::nullopt if the node does not exist.
+std::optional<std::vector<unsigned>> read_node_cpus(unsigned node) {
+    char path[64];
+    auto res = std::format_to_n(path, sizeof(path) - 1, "/sys/devices/system/node/node{}/cpulist", node);
+    *res.out = '\0';
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return std::nullopt;
+    char buf[4096];
+    ssize_t n = read(fd, buf, sizeof(buf));
+    close(fd);
+    if (n < 0) return std::nullopt;
+    return parse_cpu_list(std::string_view(buf, static_cast<size_t>(n)));
+}
+
+} // namespace
+
+std::optional<std::vector<unsigned>> parse_cpu_list(std::string_view list) {
+    while (!list.empty() && (list.back() == '\n' || list.back() == ' ')) list.remove_suffix(1);
+
+    std::vector<unsigned> cpus;
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view range = list.substr(0, comma);
+        list.remove_prefix(comma == std::string_view::npos ? list.size() : comma + 1);
+
+        size_t dash = range.find('-');
+        unsigned first = 0, last = 0;
+        if (!parse_number(range.substr(0, dash), first)) return std::nullopt;
+        last = first;
+        if (dash != std::string_view::npos && !parse_number(range.substr(dash + 1), last)) {
+            return std::nullopt;
+        }
+        if (last < first || last >= CPU_SETSIZE) return std::nullopt;
+        for (unsigned cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+    std::ranges::sort(cpus);
+    auto dup = std::ranges::unique(cpus);
+    cpus.erase(dup.begin(), dup.end());
+    return cpus;
+}
+
+std::optional<decltype(RLIMIT_NOFILE)> parse_rlimit_resource(std::string_view name) {
+    for (const auto& [key, resource] : k_rlimit_names) {
+        if (key == name) return resource;
+    }
+    return std::nullopt;
+}
+
+std::optional<rlim_t> parse_rlimit_value(std::string_view value) {
+    if (value == "unlimited" || value == "infinity") return RLIM_INFINITY;
+    rlim_t limit = 0;
+    if (!parse_number(value, limit) || limit == RLIM_INFINITY) return std::nullopt;
+    return limit;
+}
+
+std::optional<KernelTuning> compile_tuning(const ProcessTuning& tuning) {
+    KernelTuning kernel;
+    kernel.nice = tuning.nice;
+
+    switch (tuning.sched_policy) {
+        case SchedPolicy::INHERIT: break;
+        case SchedPolicy::OTHER: kernel.sched_policy = SCHED_OTHER; break;
+        case SchedPolicy::BATCH: kernel.sched_policy = SCHED_BATCH; break;
+        case SchedPolicy::IDLE: kernel.sched_policy = SCHED_IDLE; break;
+    }
+
+    if (tuning.io_class != IoClass::INHERIT) {
+        int level = tuning.io_class == IoClass::IDLE ? 0 : tuning.io_level;
+        kernel.ioprio = (static_cast<int>(tuning.io_class) << k_ioprio_class_shift) | level;
+    }
+
+    std::vector<unsigned> cpus = tuning.cpus;
+    if (tuning.numa_node) {
+        auto node_cpus = read_node_cpus(*tuning.numa_node);
+        if (!node_cpus) return std::nullopt;
+        if (cpus.empty()) cpus = std::move(*node_cpus);
+
+        constexpr unsigned k_word_bits = std::numeric_limits<unsigned long>::digits;
+        kernel.nodemask.assign(*tuning.numa_node / k_word_bits + 1, 0);
+        kernel.nodemask.back() |= 1UL << (*tuning.numa_node % k_word_bits);
+    }
+
+    if (!cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (unsigned cpu : cpus) CPU_SET(cpu, &set);
+        kernel.affinity = set;
+    }
+    return kernel;
+}
+
+} // namespace Voix
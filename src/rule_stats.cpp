@@ -0,0 +1,181 @@
+/**
+ * @file rule_stats.cpp
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#include "rule_stats.hpp"
+#include "logger.hpp"
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <string_view>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Voix {
+
+namespace {
+
+constexpr char k_magic[8] = {'V', 'O', 'I', 'X', 'H', 'I', 'T', '1'};
+
+struct Header {
+    char magic[8];
+    std::uint64_t fingerprint;
+    std::uint64_t count;
+    std::uint64_t reserved;
+};
+static_assert(sizeof(Header) == 32);
+
+class Fnv {
+public:
+    void add(std::string_view s) {
+        for (unsigned char c : s) mix(c);
+        mix(0xff);  // field separator
+    }
+    void add(std::uint64_t v) {
+        for (int i = 0; i < 8; ++i) mix(static_cast<unsigned char>(v >> (8 * i)));
+    }
+    std::uint64_t value() const { return h_; }
+
+private:
+    void mix(unsigned char c) { h_ = (h_ ^ c) * 1099511628211ULL; }
+    std::uint64_t h_ = 14695981039346656037ULL;
+};
+
+bool is_private_file(const struct stat& st, uid_t owner) {
+    return S_ISREG(st.st_mode) && st.st_uid == owner && st.st_nlink == 1 &&
+           (st.st_mode & (S_IRWXG | S_IRWXO)) == 0;
+}
+
+// Whether @p path still names the file @p st describes.
+bool still_at(const std::string& path, const struct stat& st) {
+    struct stat now;
+    return stat(path.c_str(), &now) == 0 && now.st_dev == st.st_dev && now.st_ino == st.st_ino;
+}
+
+// Writes a zeroed counter file for the policy next to @p path and renames it
+// into place. Processes still mapping the previous file keep a valid mapping
+// of the old inode instead of faulting on a truncated one. Unless @p replace
+// is set an existing file wins: of several processes creating the file at
+// once, only the first one's lands, so no counts go to a file that is then
+// renamed over.
+bool replace_counter_file(const std::string& path, std::uint64_t fingerprint, size_t count, bool replace) {
+    std::string tmp = std::format("{}.{}.tmp", path, getpid());
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (fd == -1) return false;
+
+    Header header{};
+    std::memcpy(header.magic, k_magic, sizeof(k_magic));
+    header.fingerprint = fingerprint;
+    header.count = count;
+    bool ok = ftruncate(fd, static_cast<off_t>(sizeof(Header) + count * sizeof(std::uint64_t))) == 0 &&
+              pwrite(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+              fdatasync(fd) == 0;
+    close(fd);
+    if (ok) {
+        ok = replace ? rename(tmp.c_str(), path.c_str()) == 0
+                     : renameat2(AT_FDCWD, tmp.c_str(), AT_FDCWD, path.c_str(), RENAME_NOREPLACE) == 0 ||
+                           errno == EEXIST;
+    }
+    unlink(tmp.c_str());
+    return ok;
+}
+
+} // namespace
+
+RuleHitCounters::RuleHitCounters(void* map, size_t map_size, size_t count)
+    : map_(map),
+      map_size_(map_size),
+      counters_(reinterpret_cast<std::uint64_t*>(static_cast<char*>(map) + sizeof(Header))),
+      count_(count) {}
+
+RuleHitCounters::~RuleHitCounters() {
+    munmap(map_, map_size_);
+}
+
+std::unique_ptr<RuleHitCounters> RuleHitCounters::open(const std::string& path, const std::vector<Rule>& rules,
+                                                       bool create, uid_t owner) {
+    return open(path, fingerprint(rules), rules.size(), create, owner);
+}
+
+std::unique_ptr<RuleHitCounters> RuleHitCounters::open(const std::string& path, std::uint64_t fp, size_t count,
+                                                       bool create, uid_t owner) {
+    const size_t size = sizeof(Header) + count * sizeof(std::uint64_t);
+
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        int fd = ::open(path.c_str(), O_RDWR | O_NOFOLLOW | O_CLOEXEC);
+        if (fd == -1) {
+            if (errno != ENOENT || !create || !replace_counter_file(path, fp, count, false)) return nullptr;
+            continue;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !is_private_file(st, owner)) {
+            LOG_WARN(std::format("Rule hit counter file {} is not private; counting disabled", path));
+            close(fd);
+            return nullptr;
+        }
+
+        Header header{};
+        bool current = static_cast<size_t>(st.st_size) == size &&
+                       pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                       std::memcmp(header.magic, k_magic, sizeof(k_magic)) == 0 &&
+                       header.fingerprint == fp && header.count == count;
+        if (!current) {
+            // The counts belong to another policy. Of the processes finding
+            // the stale file, the one holding its lock replaces it; the
+            // others then find the new file.
+            if (create && flock(fd, LOCK_EX) == 0 && still_at(path, st)) {
+                replace_counter_file(path, fp, count, true);
+            }
+            close(fd);
+            if (!create) return nullptr;
+            continue;
+        }
+
+        void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) return nullptr;
+        return std::unique_ptr<RuleHitCounters>(new RuleHitCounters(map, size, count));
+    }
+    return nullptr;
+}
+
+void RuleHitCounters::hit(size_t rule) noexcept {
+    if (rule >= count_) return;
+    std::atomic_ref<std::uint64_t>(counters_[rule]).fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<std::uint64_t> RuleHitCounters::counts() const {
+    std::vector<std::uint64_t> out(count_);
+    for (size_t i = 0; i < count_; ++i) {
+        out[i] = std::atomic_ref<std::uint64_t>(counters_[i]).load(std::memory_order_relaxed);
+    }
+    return out;
+}
+
+std::uint64_t RuleHitCounters::fingerprint(const std::vector<Rule>& rules) {
+    Fnv fnv;
+    fnv.add(rules.size());
+    for (const auto& rule : rules) {
+        fnv.add(rule.ident);
+        fnv.add(rule.target);
+        fnv.add(rule.cmd);
+        fnv.add(rule.cmdargs.size());
+        for (const auto& arg : rule.cmdargs) fnv.add(arg);
+        fnv.add(rule.profile);
+        fnv.add(static_cast<std::uint64_t>(rule.action));
+        fnv.add(static_cast<std::uint64_t>(rule.options));
+    }
+    return fnv.value();
+}
+
+} // namespace Voix
@@ -26,6 +26,9 @@
 #include <seccomp.h>
 #endif
 #include <memory>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
 #include <sys/stat.h>
 
 namespace Voix {
@@ -108,11 +111,6 @@ bool Security::isSafePath(std::string_view path) const {
     }
 }
 
-void Security::logEvent(std::string_view event, std::string_view user) const {
-    Logger logger;
-    logger.log("SECURITY", std::format("[{}] {}", user, event));
-}
-
 std::string Security::getCurrentUser() const {
     return identity->get_current_username();
 }
@@ -156,23 +154,30 @@ std::string Security::get_root_device() const {
     return "";
 }
 
-bool Security::isCatastrophicCommand(std::string_view command, const std::vector<std::string>& args, const Config& config) const {
+bool Security::isCatastrophicCommand(std::string_view command, const std::vector<std::string>& args,
+                                     const Config& config, std::string_view cwd) const {
     std::string full_command = std::string(command);
     std::string normalized_command = std::string(command);
 
     for (const auto& arg : args) {
-        full_command += " " + arg;
+        full_command += ' ';
+        full_command += arg;
+        normalized_command += ' ';
 
         // Attempt to normalize path arguments for better matching
         try {
-            if (arg.starts_with("/") || arg.starts_with(".")) {
-                normalized_command += " " + std::filesystem::absolute(arg).string();
+            if (arg.starts_with("/") || (arg.starts_with(".") && cwd.empty())) {
+                normalized_command += std::filesystem::absolute(arg).native();
+            } else if (arg.starts_with(".")) {
+                // Evaluated on behalf of another process (voixd): resolve
+                // against the caller's directory, not ours.
+                normalized_command += (std::filesystem::path(cwd) / arg).lexically_normal().native();
             } else {
-                normalized_command += " " + arg;
+                normalized_command += arg;
             }
         } catch (const std::exception& e) {
             LOG_WARN(std::format("Path normalization failed for arg '{}': {}", arg, e.what()));
-            normalized_command += " " + arg;
+            normalized_command += arg;
         }
     }
 
@@ -212,7 +217,7 @@ bool Security::isCatastrophicCommand(std::string_view command, const std::vector
             }
         }
     } else {
-        static const std::vector<std::string> catastrophic_exact = {
+        static constexpr std::string_view catastrophic_exact[] = {
             "fdisk", "/sbin/fdisk", "/usr/bin/fdisk",
             "parted", "/sbin/parted", "/usr/bin/parted",
             "wipe", "/sbin/wipe", "/usr/bin/wipe",
@@ -227,7 +232,7 @@ bool Security::isCatastrophicCommand(std::string_view command, const std::vector
             "mkfs.ntfs", "/sbin/mkfs.ntfs", "/usr/bin/mkfs.ntfs",
             "mkswap", "/sbin/mkswap", "/usr/bin/mkswap"
         };
-        if (std::ranges::find(catastrophic_exact, command) != catastrophic_exact.end()) {
+        if (std::ranges::find(catastrophic_exact, command) != std::end(catastrophic_exact)) {
             return true;
         }
     }
@@ -291,11 +296,14 @@ void Security::dropCapabilities(const std::vector<cap_value_t>& keep_caps) {
 #endif
 
 #ifdef VOIX_WITH_SECCOMP
-void Security::applySeccompBlacklist() const {
+namespace {
+
+// Builds the libseccomp context for the blacklist, or nullptr on failure.
+UniqueSeccomp make_blacklist_filter() {
     UniqueSeccomp ctx(seccomp_init(SCMP_ACT_ALLOW));
     if (!ctx) {
         LOG_WARN("Failed to init seccomp");
-        _exit(1);
+        return nullptr;
     }
 
     if (seccomp_rule_add(ctx.get(), SCMP_ACT_KILL, SCMP_SYS(kexec_load), 0) < 0 ||
@@ -308,6 +316,16 @@ void Security::applySeccompBlacklist() const {
         seccomp_rule_add(ctx.get(), SCMP_ACT_KILL, SCMP_SYS(ptrace), 0) < 0 ||
         seccomp_rule_add(ctx.get(), SCMP_ACT_KILL, SCMP_SYS(bpf), 0) < 0) {
         LOG_WARN("Failed to add seccomp rules");
+        return nullptr;
+    }
+    return ctx;
+}
+
+} // namespace
+
+void Security::applySeccompBlacklist() const {
+    UniqueSeccomp ctx = make_blacklist_filter();
+    if (!ctx) {
         _exit(1);
     }
 
@@ -316,6 +334,31 @@ void Security::applySeccompBlacklist() const {
         _exit(1);
     }
 }
+
+std::vector<sock_filter> Security::compileSeccompBlacklist() const {
+    UniqueSeccomp ctx = make_blacklist_filter();
+    if (!ctx) return {};
+
+    // libseccomp can only export to a file descriptor.
+    int fd = memfd_create("voix-seccomp", MFD_CLOEXEC);
+    if (fd == -1) {
+        LOG_ERROR(std::format("memfd_create failed: {}", std::strerror(errno)));
+        return {};
+    }
+
+    std::vector<sock_filter> program;
+    struct stat st;
+    if (seccomp_export_bpf(ctx.get(), fd) == 0 && fstat(fd, &st) == 0 &&
+        st.st_size > 0 && st.st_size % sizeof(sock_filter) == 0) {
+        program.resize(static_cast<size_t>(st.st_size) / sizeof(sock_filter));
+        if (pread(fd, program.data(), static_cast<size_t>(st.st_size), 0) != st.st_size) {
+            program.clear();
+        }
+    }
+    close(fd);
+    if (program.empty()) LOG_ERROR("Failed to export seccomp program");
+    return program;
+}
 #endif
 
 } // namespace Voix
@@ -0,0 +1,135 @@
+/**
+ * @file supervisor.cpp
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#include "supervisor.hpp"
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <format>
+#include <limits>
+#include <poll.h>
+#include <sys/signalfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace Voix {
+
+namespace {
+
+// Signals a user or service manager sends to stop or notify a job.
+constexpr std::array k_forwarded_signals = {SIGHUP, SIGINT, SIGQUIT, SIGTERM, SIGUSR1,
+                                            SIGUSR2, SIGWINCH, SIGCONT, SIGTSTP};
+
+void send_signal(pid_t pid, int pidfd, int sig) {
+#ifdef SYS_pidfd_send_signal
+    if (pidfd != -1 && syscall(SYS_pidfd_send_signal, pidfd, sig, nullptr, 0) == 0) return;
+#endif
+    kill(pid, sig);
+}
+
+double seconds(const struct timeval& tv) {
+    return static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec) / 1e6;
+}
+
+} // namespace
+
+int ChildReport::exit_code() const {
+    if (timed_out) return 124;
+    if (WIFEXITED(status)) return WEXITSTATUS(status);
+    return -1;
+}
+
+std::string ChildReport::describe() const {
+    std::string outcome;
+    if (WIFEXITED(status)) {
+        outcome = std::format("exit={}", WEXITSTATUS(status));
+    } else if (WIFSIGNALED(status)) {
+        outcome = std::format("signal={}", WTERMSIG(status));
+    }
+    return std::format("{}{} wall={:.3f}s user={:.3f}s sys={:.3f}s maxrss={}KiB inblock={} oublock={}",
+                       outcome, timed_out ? " timeout" : "",
+                       static_cast<double>(wall_time.count()) / 1e3,
+                       seconds(usage.ru_utime), seconds(usage.ru_stime),
+                       usage.ru_maxrss, usage.ru_inblock, usage.ru_oublock);
+}
+
+ChildReport supervise_child(pid_t pid, int pidfd, const SupervisionLimits& limits) {
+    using clock = std::chrono::steady_clock;
+    ChildReport report;
+
+    sigset_t set;
+    sigemptyset(&set);
+    for (int sig : k_forwarded_signals) sigaddset(&set, sig);
+    if (pidfd == -1) sigaddset(&set, SIGCHLD);
+    int sig_fd = signalfd(-1, &set, SFD_CLOEXEC | SFD_NONBLOCK);
+
+    const auto start = clock::now();
+    auto deadline = limits.timeout.count() > 0 ? start + limits.timeout : clock::time_point::max();
+    int kill_stage = 0;  // 0: running, 1: SIGTERM sent, 2: SIGKILL sent
+
+    for (;;) {
+        pid_t reaped = wait4(pid, &report.status, WNOHANG, &report.usage);
+        if (reaped == pid) break;
+        if (reaped == -1 && errno != EINTR) {
+            report.status = -1;
+            break;
+        }
+
+        auto now = clock::now();
+        if (now >= deadline) {
+            if (kill_stage == 0) {
+                report.timed_out = true;
+                send_signal(pid, pidfd, SIGTERM);
+                kill_stage = 1;
+                deadline = now + limits.kill_after;
+            } else {
+                send_signal(pid, pidfd, SIGKILL);
+                kill_stage = 2;
+                deadline = clock::time_point::max();
+            }
+            continue;
+        }
+
+        struct pollfd fds[2];
+        nfds_t nfds = 0;
+        if (pidfd != -1) fds[nfds++] = {pidfd, POLLIN, 0};
+        if (sig_fd != -1) fds[nfds++] = {sig_fd, POLLIN, 0};
+
+        int timeout_ms = -1;
+        if (deadline != clock::time_point::max()) {
+            auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count();
+            timeout_ms = static_cast<int>(std::min<long long>(left, std::numeric_limits<int>::max()));
+        }
+        // Nothing to wait on: fall back to short sleeps between reap attempts.
+        if (nfds == 0 && (timeout_ms == -1 || timeout_ms > 100)) timeout_ms = 100;
+        if (poll(fds, nfds, timeout_ms) == -1 && errno != EINTR) {
+            // Cannot supervise any more, but the child must still be reaped.
+            pid_t r;
+            while ((r = wait4(pid, &report.status, 0, &report.usage)) == -1 && errno == EINTR) {}
+            if (r != pid) report.status = -1;
+            break;
+        }
+
+        if (sig_fd == -1) continue;
+        struct signalfd_siginfo info;
+        while (read(sig_fd, &info, sizeof(info)) == static_cast<ssize_t>(sizeof(info))) {
+            if (info.ssi_signo == SIGCHLD) continue;
+            // Terminal-generated signals (SI_KERNEL) already reached the
+            // child's process group; the child signalling us is not forwarded.
+            if (info.ssi_code == SI_KERNEL || static_cast<pid_t>(info.ssi_pid) == pid) continue;
+            send_signal(pid, pidfd, static_cast<int>(info.ssi_signo));
+        }
+    }
+
+    report.wall_time = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start);
+    if (sig_fd != -1) close(sig_fd);
+    return report;
+}
+
+} // namespace Voix
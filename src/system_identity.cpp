@@ -9,8 +9,10 @@
 
 #include "system_identity.hpp"
 #include "system_utils.hpp"
+#include "trace.hpp"
 #include <grp.h>
 #include <unistd.h>
+#include <utility>
 #include <vector>
 
 namespace Voix {
@@ -21,6 +23,8 @@ std::optional<UserIdentity> SystemIdentity::get_user_by_name(const std::string&
 
     // Use getgrouplist() to resolve the target user's supplementary groups
     // (not the calling process's groups, which getgroups() would return)
+    Trace::Span span("getgrouplist");
+    span.note(username);
     std::vector<gid_t> groups;
     int ngroups = 32;
     groups.resize(ngroups);
@@ -51,6 +55,12 @@ std::optional<UserIdentity> SystemIdentity::get_user_by_uid(uid_t uid) const {
     };
 }
 
+std::optional<uid_t> SystemIdentity::get_uid_by_name(const std::string& username) const {
+    auto entry = lookup_passwd_by_name(username);
+    if (!entry) return std::nullopt;
+    return entry->uid;
+}
+
 std::string SystemIdentity::get_current_username() const {
     auto entry = lookup_passwd_by_uid(getuid());
     return entry ? entry->name : "unknown";
@@ -70,4 +80,84 @@ std::vector<gid_t> SystemIdentity::get_current_groups() const {
     return groups;
 }
 
+CachingIdentity::CachingIdentity(std::shared_ptr<IIdentity> base, std::chrono::seconds ttl)
+    : base_(std::move(base)), ttl_(ttl) {}
+
+std::optional<UserIdentity> CachingIdentity::get_user_by_name(const std::string& username) const {
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard lock(mutex_);
+        auto it = by_name_.find(username);
+        if (it != by_name_.end() && it->second.expires > now) return it->second.identity;
+    }
+
+    auto identity = base_->get_user_by_name(username);
+    if (identity) {
+        std::lock_guard lock(mutex_);
+        by_name_.insert_or_assign(username, Entry{*identity, now + ttl_});
+    }
+    return identity;
+}
+
+std::optional<UserIdentity> CachingIdentity::get_user_by_uid(uid_t uid) const {
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard lock(mutex_);
+        auto it = by_uid_.find(uid);
+        if (it != by_uid_.end() && it->second.expires > now) return it->second.identity;
+    }
+
+    auto identity = base_->get_user_by_uid(uid);
+    if (identity) {
+        std::lock_guard lock(mutex_);
+        by_uid_.insert_or_assign(uid, Entry{*identity, now + ttl_});
+    }
+    return identity;
+}
+
+std::string CachingIdentity::get_current_username() const {
+    return base_->get_current_username();
+}
+
+uid_t CachingIdentity::get_current_uid() const {
+    return base_->get_current_uid();
+}
+
+std::vector<gid_t> CachingIdentity::get_current_groups() const {
+    return base_->get_current_groups();
+}
+
+void CachingIdentity::clear() {
+    std::lock_guard lock(mutex_);
+    by_name_.clear();
+    by_uid_.clear();
+}
+
+PeerIdentity::PeerIdentity(std::shared_ptr<IIdentity> base, uid_t uid)
+    : base_(std::move(base)), uid_(uid) {}
+
+std::optional<UserIdentity> PeerIdentity::get_user_by_name(const std::string& username) const {
+    return base_->get_user_by_name(username);
+}
+
+std::optional<UserIdentity> PeerIdentity::get_user_by_uid(uid_t uid) const {
+    return base_->get_user_by_uid(uid);
+}
+
+std::string PeerIdentity::get_current_username() const {
+    auto identity = base_->get_user_by_uid(uid_);
+    return identity ? identity->username : "unknown";
+}
+
+uid_t PeerIdentity::get_current_uid() const {
+    return uid_;
+}
+
+std::vector<gid_t> PeerIdentity::get_current_groups() const {
+    auto identity = base_->get_user_by_uid(uid_);
+    if (!identity) return {};
+    auto full = base_->get_user_by_name(identity->username);
+    return full ? full->groups : std::vector<gid_t>{};
+}
+
 } // namespace Voix
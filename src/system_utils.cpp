@@ -7,6 +7,7 @@
  */
 
 #include "system_utils.hpp"
+#include "trace.hpp"
 #include <string>
 #include <string_view>
 #include <unistd.h>
@@ -75,6 +76,8 @@ namespace {
 }
 
 std::optional<PasswdEntry> lookup_passwd_by_name(std::string_view name) {
+    Trace::Span span("getpwnam");
+    span.note(name);
     struct passwd pwd;
     struct passwd *result = nullptr;
     auto buf = make_passwd_buffer();
@@ -95,6 +98,8 @@ std::optional<PasswdEntry> lookup_passwd_by_name(std::string_view name) {
 }
 
 std::optional<PasswdEntry> lookup_passwd_by_uid(uid_t uid) {
+    Trace::Span span("getpwuid");
+    if (Trace::enabled()) span.note(std::to_string(uid));
     struct passwd pwd;
     struct passwd *result = nullptr;
     auto buf = make_passwd_buffer();
@@ -0,0 +1,95 @@
+/**
+ * @file thread_pool.cpp
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#include "thread_pool.hpp"
+#include <algorithm>
+
+namespace Voix {
+
+namespace {
+
+// The pool and deque the calling thread works for, if it is a worker.
+thread_local const ThreadPool* t_pool = nullptr;
+thread_local size_t t_worker = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    queues_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) queues_.push_back(std::make_unique<Queue>());
+    workers_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) workers_.emplace_back([this, i] { run(i); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    workers_.clear();
+}
+
+void ThreadPool::push(Task task) {
+    size_t target = t_pool == this ? t_worker
+                                   : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    {
+        // Counted before it is queued, so a worker that takes it at once
+        // never drives the count below zero, and under the sleep lock so a
+        // worker about to wait sees it.
+        std::lock_guard lock(sleep_mutex_);
+        pending_.fetch_add(1, std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard lock(queues_[target]->mutex);
+        queues_[target]->tasks.push_back(std::move(task));
+    }
+    wake_.notify_one();
+}
+
+bool ThreadPool::take(size_t worker, Task& task) {
+    {
+        Queue& own = *queues_[worker];
+        std::lock_guard lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t n = 1; n < queues_.size(); ++n) {
+        Queue& victim = *queues_[(worker + n) % queues_.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(size_t worker) {
+    t_pool = this;
+    t_worker = worker;
+    for (;;) {
+        Task task;
+        if (take(worker, task)) {
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            task();
+            continue;
+        }
+        std::unique_lock lock(sleep_mutex_);
+        wake_.wait(lock, [this] { return stopping_ || pending_.load(std::memory_order_relaxed) > 0; });
+        // Queued work still runs after the destructor starts.
+        if (stopping_ && pending_.load(std::memory_order_relaxed) == 0) return;
+    }
+}
+
+} // namespace Voix
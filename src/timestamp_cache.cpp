@@ -0,0 +1,198 @@
+/**
+ * @file timestamp_cache.cpp
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#include "timestamp_cache.hpp"
+#include "logger.hpp"
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <format>
+#include <string_view>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace Voix {
+
+namespace {
+
+struct ParentInfo {
+    long long tty;
+    long long sid;
+    unsigned long long start_time;
+};
+
+// Reads tty_nr, session and starttime of the parent from /proc/<ppid>/stat.
+// The comm field may contain spaces and parentheses, so parsing starts after
+// the last ')'.
+std::optional<ParentInfo> read_parent_info(pid_t ppid) {
+    char path[32];
+    auto res = std::format_to_n(path, sizeof(path) - 1, "/proc/{}/stat", ppid);
+    *res.out = '\0';
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return std::nullopt;
+    char buf[1024];
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) return std::nullopt;
+
+    std::string_view stat(buf, static_cast<size_t>(n));
+    size_t paren = stat.rfind(')');
+    if (paren == std::string_view::npos) return std::nullopt;
+    stat.remove_prefix(paren + 1);
+
+    // Fields after ')': state(3) ppid(4) pgrp(5) session(6) tty_nr(7) ... starttime(22)
+    constexpr int k_session_field = 3;
+    constexpr int k_tty_field = 4;
+    constexpr int k_start_time_field = 19;
+
+    ParentInfo info{};
+    int field = -1;
+    bool have_start = false;
+    while (!stat.empty() && field < k_start_time_field) {
+        size_t begin = stat.find_first_not_of(' ');
+        if (begin == std::string_view::npos) break;
+        stat.remove_prefix(begin);
+        size_t end = stat.find(' ');
+        std::string_view token = stat.substr(0, end);
+        ++field;
+        const char* first = token.data();
+        const char* last = token.data() + token.size();
+        if (field == k_session_field) {
+            if (std::from_chars(first, last, info.sid).ec != std::errc{}) return std::nullopt;
+        } else if (field == k_tty_field) {
+            if (std::from_chars(first, last, info.tty).ec != std::errc{}) return std::nullopt;
+        } else if (field == k_start_time_field) {
+            if (std::from_chars(first, last, info.start_time).ec != std::errc{}) return std::nullopt;
+            have_start = true;
+        }
+        stat.remove_prefix(end == std::string_view::npos ? stat.size() : end);
+    }
+    if (!have_start) return std::nullopt;
+    return info;
+}
+
+bool elapsed_within(const struct timespec& now, const struct timespec& then,
+                    std::chrono::seconds lifetime) {
+    auto elapsed = std::chrono::seconds(now.tv_sec - then.tv_sec) +
+                   std::chrono::nanoseconds(now.tv_nsec - then.tv_nsec);
+    return elapsed >= std::chrono::nanoseconds::zero() && elapsed < lifetime;
+}
+
+// A record must be a plain, single-link file owned by the cache owner that
+// nobody else can touch.
+bool is_private_file(const struct stat& st, uid_t owner) {
+    return S_ISREG(st.st_mode) && st.st_uid == owner &&
+           (st.st_mode & (S_IRWXG | S_IRWXO)) == 0 && st.st_nlink == 1;
+}
+
+} // namespace
+
+TimestampCache::TimestampCache(std::string directory, std::chrono::seconds lifetime,
+                               uid_t owner)
+    : directory_(std::move(directory)), lifetime_(lifetime), owner_(owner) {}
+
+std::optional<std::string> TimestampCache::session_key(uid_t uid) {
+    pid_t ppid = getppid();
+    auto info = read_parent_info(ppid);
+    if (!info) return std::nullopt;
+    return std::format("{}-{}-{}-{}-{}", uid, info->tty, info->sid, ppid, info->start_time);
+}
+
+int TimestampCache::open_directory(bool create) const {
+    if (directory_.empty() || directory_[0] != '/') return -1;
+
+    if (create && mkdir(directory_.c_str(), 0700) != 0 && errno != EEXIST) {
+        LOG_WARN(std::format("Failed to create timestamp directory {}: {}",
+                 directory_, std::strerror(errno)));
+        return -1;
+    }
+
+    int dir_fd = open(directory_.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (dir_fd == -1) return -1;
+
+    struct stat st;
+    if (fstat(dir_fd, &st) != 0 || st.st_uid != owner_ ||
+        (st.st_mode & (S_IRWXG | S_IRWXO)) != 0) {
+        LOG_WARN(std::format("Timestamp directory {} is not private; persist disabled",
+                 directory_));
+        close(dir_fd);
+        return -1;
+    }
+    return dir_fd;
+}
+
+bool TimestampCache::is_valid(uid_t uid) const {
+    if (lifetime_ <= std::chrono::seconds::zero()) return false;
+
+    auto key = session_key(uid);
+    if (!key) return false;
+
+    int dir_fd = open_directory(/* create */ false);
+    if (dir_fd == -1) return false;
+
+    int fd = openat(dir_fd, key->c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    close(dir_fd);
+    if (fd == -1) return false;
+
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0 && is_private_file(st, owner_);
+    close(fd);
+    if (!ok) return false;
+
+    struct timespec boot_now, real_now;
+    if (clock_gettime(CLOCK_BOOTTIME, &boot_now) != 0 ||
+        clock_gettime(CLOCK_REALTIME, &real_now) != 0) {
+        return false;
+    }
+    return elapsed_within(boot_now, st.st_mtim, lifetime_) &&
+           elapsed_within(real_now, st.st_atim, lifetime_);
+}
+
+bool TimestampCache::update(uid_t uid) const {
+    if (lifetime_ <= std::chrono::seconds::zero()) return false;
+
+    auto key = session_key(uid);
+    if (!key) return false;
+
+    int dir_fd = open_directory(/* create */ true);
+    if (dir_fd == -1) return false;
+
+    int fd = openat(dir_fd, key->c_str(), O_WRONLY | O_CREAT | O_NOFOLLOW | O_CLOEXEC, 0600);
+    close(dir_fd);
+    if (fd == -1) {
+        LOG_WARN(std::format("Failed to write timestamp record: {}", std::strerror(errno)));
+        return false;
+    }
+
+    struct stat st;
+    struct timespec times[2];
+    bool ok = fstat(fd, &st) == 0 && is_private_file(st, owner_) &&
+              clock_gettime(CLOCK_REALTIME, &times[0]) == 0 &&
+              clock_gettime(CLOCK_BOOTTIME, &times[1]) == 0 &&
+              futimens(fd, times) == 0;
+    close(fd);
+    return ok;
+}
+
+bool TimestampCache::clear(uid_t uid) const {
+    auto key = session_key(uid);
+    if (!key) return false;
+
+    int dir_fd = open_directory(/* create */ false);
+    if (dir_fd == -1) return errno == ENOENT;
+
+    bool ok = unlinkat(dir_fd, key->c_str(), 0) == 0 || errno == ENOENT;
+    close(dir_fd);
+    return ok;
+}
+
+} // namespace Voix
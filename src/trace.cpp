@@ -0,0 +1,169 @@
+/**
+ * @file trace.cpp
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#include "trace.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+#include <format>
+#include <unistd.h>
+#include <vector>
+
+namespace Voix {
+
+bool Trace::enabled_ = false;
+
+namespace {
+
+struct Event {
+    std::string_view stage;
+    std::string detail;
+    std::uint64_t start;
+    std::uint64_t end;
+    bool instant;
+};
+
+Trace::Format g_format = Trace::Format::TABLE;
+std::uint64_t g_origin = 0;
+std::vector<Event> g_events;
+
+std::uint64_t now_ns() noexcept {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1'000'000'000ULL + static_cast<std::uint64_t>(ts.tv_nsec);
+}
+
+void append_json_string(std::string& out, std::string_view s) {
+    out += '"';
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            out += std::format("\\u{:04x}", c);
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    out += '"';
+}
+
+double ms(std::uint64_t ns) {
+    return static_cast<double>(ns) / 1e6;
+}
+
+std::string format_table(const std::vector<Event>& events) {
+    std::string out = std::format("voix trace (pid {})\n{:>10}  {:>9}  {:<20} {}\n", getpid(), "start ms",
+                                  "took ms", "stage", "detail");
+    std::uint64_t last = g_origin;
+    for (const auto& e : events) {
+        const std::uint64_t start = std::max(e.start, g_origin);
+        if (e.instant) {
+            out += std::format("{:>10.3f}  {:>9}  {:<20} {}\n", ms(start - g_origin), "", e.stage, e.detail);
+        } else {
+            out += std::format("{:>10.3f}  {:>9.3f}  {:<20} {}\n", ms(start - g_origin), ms(e.end - e.start),
+                               e.stage, e.detail);
+        }
+        last = std::max(last, e.end);
+    }
+    out += std::format("{:>10.3f}  {:>9}  {:<20}\n", ms(last - g_origin), "", "total");
+    return out;
+}
+
+// Trace-event "complete" (X) and "instant" (i) events; ts and dur are in
+// microseconds of CLOCK_MONOTONIC, so traces from several runs line up.
+std::string format_json(const std::vector<Event>& events) {
+    const pid_t pid = getpid();
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); ++i) {
+        const auto& e = events[i];
+        if (i > 0) out += ',';
+        out += "\n{\"name\":";
+        append_json_string(out, e.stage);
+        out += std::format(",\"cat\":\"voix\",\"ph\":\"{}\",\"ts\":{:.3f},", e.instant ? "i" : "X",
+                           static_cast<double>(e.start) / 1e3);
+        out += e.instant ? std::string("\"s\":\"p\",")
+                         : std::format("\"dur\":{:.3f},", static_cast<double>(e.end - e.start) / 1e3);
+        out += std::format("\"pid\":{},\"tid\":{}", pid, pid);
+        if (!e.detail.empty()) {
+            out += ",\"args\":{\"detail\":";
+            append_json_string(out, e.detail);
+            out += '}';
+        }
+        out += '}';
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+} // namespace
+
+Trace::Span::Span(std::string_view stage) noexcept : stage_(stage) {
+    if (enabled_) start_ = now_ns();
+}
+
+Trace::Span::~Span() {
+    end();
+}
+
+void Trace::Span::end() {
+    if (enabled_ && start_ != 0) record(stage_, start_, now_ns(), std::move(detail_));
+    start_ = 0;
+}
+
+void Trace::Span::note(std::string_view detail) {
+    if (enabled_) detail_ = detail;
+}
+
+void Trace::enable(Format format) {
+    g_format = format;
+    g_origin = now_ns();
+    g_events.reserve(32);
+    enabled_ = true;
+}
+
+void Trace::mark(std::string_view stage, std::string detail) {
+    if (!enabled_) return;
+    const std::uint64_t t = now_ns();
+    g_events.push_back({stage, std::move(detail), t, t, true});
+}
+
+void Trace::record(std::string_view stage, std::uint64_t start, std::uint64_t end, std::string detail) {
+    g_events.push_back({stage, std::move(detail), start, end, false});
+}
+
+void Trace::flush() {
+    if (!enabled_) return;
+    enabled_ = false;
+    // Spans are recorded when they end; show them in the order they began.
+    std::ranges::stable_sort(g_events, {}, &Event::start);
+    const std::string out = g_format == Format::JSON ? format_json(g_events) : format_table(g_events);
+    g_events.clear();
+    const char* p = out.data();
+    size_t left = out.size();
+    while (left > 0) {
+        ssize_t n = write(STDERR_FILENO, p, left);
+        if (n == -1 && errno == EINTR) continue;
+        if (n <= 0) break;
+        p += n;
+        left -= static_cast<size_t>(n);
+    }
+}
+
+bool Trace::parse_format(std::string_view value, Format& format) {
+    if (value.empty() || value == "1" || value == "table") {
+        format = Format::TABLE;
+    } else if (value == "json") {
+        format = Format::JSON;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace Voix
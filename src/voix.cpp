@@ -8,14 +8,20 @@
  */
 
 #include "voix.hpp"
+#include "audit_pipeline.hpp"
 #include "authenticator.hpp"
+#include "authorization.hpp"
+#include "broker.hpp"
 #include "permission_checker.hpp"
+#include "probes.hpp"
+#include "rule_stats.hpp"
 #include "command.hpp"
 #include "security.hpp"
 #include "config.hpp"
 #include "logger.hpp"
 #include "system_utils.hpp"
-#include <syslog.h>
+#include "timestamp_cache.hpp"
+#include "trace.hpp"
 #include <stdexcept>
 
 #include <security/pam_appl.h>
@@ -23,6 +29,7 @@
 #include <unistd.h>
 
 #include <cstring>
+#include <filesystem>
 #include <print>
 #include <vector>
 #include <format>
@@ -30,88 +37,194 @@
 
 namespace Voix {
 
+namespace {
+
+// Fires request_done on every return from Voix::execute().
+struct RequestProbe {
+  std::uint64_t id = probes::begin_request();
+  std::uint64_t start = probes::start_clock(VOIX_PROBE_ENABLED(request_done));
+  int status = -1;
+
+  int finish(int result) {
+    status = result;
+    return result;
+  }
+  ~RequestProbe() { VOIX_PROBE3(request_done, id, status, probes::elapsed(start)); }
+};
+
+} // namespace
+
 Voix::Voix(std::string_view config_path, bool non_interactive,
-           bool clear_timestamp)
-    : config_(std::make_shared<Config>()),
+           bool clear_timestamp, bool use_broker)
+    : config_path_(config_path),
       security_(std::make_shared<Security>()),
-      authenticator_(std::make_unique<PamAuthenticator>(security_, non_interactive)),
-      permission_checker_(std::make_unique<PermissionChecker>(security_, config_)),
-      command_(std::make_unique<Command>()),
+      executor_(std::make_unique<Command>()),
+      non_interactive_(non_interactive),
       clear_timestamp_(clear_timestamp) {
 
-  if (!config_->load(config_path)) {
-    throw std::runtime_error("Failed to load configuration");
+  if (use_broker) {
+    broker_ = BrokerClient::connect();
+  }
+  if (!broker_ || clear_timestamp_) {
+    load_config();
   }
 
   if (clear_timestamp_) {
-    security_->logEvent("Timestamp cleared (persist authentication reset)",
-                        "system");
+    if (timestamps_->clear(security_->get_current_uid())) {
+      AuditEvent event;
+      event.stage = AuditStage::TIMESTAMP_CLEARED;
+      event.caller_uid = security_->get_current_uid();
+      event.caller = security_->getCurrentUser();
+      AuditPipeline(config_->get_audit_sinks(), {}, 0).emit(event);
+    } else {
+      LOG_WARN("Failed to clear persist timestamp");
+    }
   }
+}
+
+Voix::Voix(VoixBackends backends)
+    : config_(std::move(backends.config)),
+      security_(std::make_shared<Security>(std::move(backends.identity))),
+      authenticator_(std::move(backends.authenticator)),
+      permission_checker_(std::make_unique<PermissionChecker>(security_, config_)),
+      resolver_(std::move(backends.resolver)),
+      executor_(std::move(backends.executor)),
+      non_interactive_(true),
+      clear_timestamp_(false) {}
+
+Voix::~Voix() = default;
 
+void Voix::load_config() {
+  Trace::Span span("config load");
+  span.note(config_path_);
+  config_ = std::make_shared<Config>();
+  if (!config_->load(config_path_)) {
+    throw std::runtime_error("Failed to load configuration");
+  }
+  permission_checker_ = std::make_unique<PermissionChecker>(security_, config_);
+  permission_checker_->set_hit_counters(
+      RuleHitCounters::open(config_->get_rule_stats_path(), config_->getRules()));
+  resolver_ = std::make_unique<CommandResolver>(config_->getPath());
+  init_authenticator(config_->get_persist_dir(), config_->get_persist_timeout());
   ::Voix::Logger::suppress_stderr = config_->should_suppress_stderr();
 }
 
-Voix::~Voix() = default;
+void Voix::init_authenticator(const std::string& persist_dir,
+                              std::chrono::seconds persist_timeout) {
+  if (authenticator_) return;
+  timestamps_ = std::make_shared<TimestampCache>(persist_dir, persist_timeout);
+  authenticator_ = std::make_unique<PamAuthenticator>(security_, non_interactive_, timestamps_);
+}
 
 int Voix::execute(std::string_view command,
                   const std::vector<std::string> &args,
                   const CommandOptions& options,
                   std::string_view user) {
 
-  std::string current_user = security_->getCurrentUser();
-
-  // Security logging
   std::string command_str{command};
   std::string user_str{user};
 
-  if (security_->isCatastrophicCommand(command_str, args, *config_)) {
-    std::println(stderr, "voix: command blocked: catastrophic command forbidden.");
-    security_->logEvent(std::format("Catastrophic command blocked: {}", command_str), current_user);
-    syslog(LOG_AUTHPRIV | LOG_ALERT, "Catastrophic command blocked: %s", command_str.c_str());
-    return 1;
+  RequestProbe probe;
+  VOIX_PROBE3(request_start, probe.id, security_->get_current_uid(), command_str.c_str());
+
+  AuthorizationRequest request{user_str, command_str, args, {}};
+  std::optional<AuthorizationDecision> decision;
+  if (broker_ && is_relative_command(command_str)) broker_.reset();
+  if (broker_) {
+    std::error_code ec;
+    request.cwd = std::filesystem::current_path(ec).string();
+    {
+      Trace::Span span("broker query");
+      decision = broker_->query(request);
+      span.note(decision ? "answered" : "no answer");
+    }
+    broker_.reset();
+    // voixd judges a command it cannot see (e.g. in another mount namespace)
+    // by name only; decide such a permit here, with the resolved-path checks.
+    if (decision && decision->verdict == AuthorizationDecision::Verdict::PERMIT &&
+        !decision->context.command.found()) {
+      LOG_WARN("voixd could not resolve the command; evaluating policy locally");
+      decision.reset();
+      request.cwd.clear();
+    } else if (decision) {
+      ::Voix::Logger::suppress_stderr = decision->suppress_stderr;
+      init_authenticator(decision->persist_dir, decision->persist_timeout);
+      // voixd only answered; the hit is this request's to count.
+      if (decision->rule_index) {
+        if (auto hits = RuleHitCounters::open(decision->rule_stats_path, decision->rules_fingerprint,
+                                              decision->rule_count)) {
+          hits->hit(*decision->rule_index);
+        }
+      }
+    } else {
+      LOG_WARN("voixd did not answer; evaluating policy locally");
+      request.cwd.clear();
+    }
+  }
+  if (!decision) {
+    if (!config_) load_config();
+    decision = authorize(*config_, *security_, *permission_checker_, *resolver_, request);
   }
 
-  security_->logEvent(std::format("Command execution requested: {}", command_str), current_user);
-  syslog(LOG_AUTHPRIV | LOG_INFO, "Command execution requested: %s as %s",
-         command_str.c_str(), user_str.c_str());
+  // One event per request stage, formatted once and routed to the sinks.
+  AuditPipeline pipeline(decision->audit_sinks, decision->audit_dir, decision->audit_segment_size);
+  AuditEvent event;
+  event.caller_uid = security_->get_current_uid();
+  event.caller = security_->getCurrentUser();
+  event.target = user_str;
+  event.command = decision->context.command.path.empty() ? command_str : decision->context.command.path;
+  event.args = args;
+  event.cwd = request.cwd;
+  if (event.cwd.empty()) {
+    std::error_code ec;
+    event.cwd = std::filesystem::current_path(ec).string();
+  }
+  auto audit = [&](AuditStage stage, std::string_view outcome, std::string detail = {}) {
+    event.stage = stage;
+    event.outcome = outcome;
+    event.detail = std::move(detail);
+    pipeline.emit(event);
+  };
 
-  // Validate command using enhanced rules
-  auto pw_entry = lookup_passwd_by_name(user_str);
-  if (!pw_entry) {
-    syslog(LOG_AUTHPRIV | LOG_ERR, "Invalid target user: %s", user_str.c_str());
-    return 1;
+  if (decision->verdict == AuthorizationDecision::Verdict::CATASTROPHIC) {
+    std::println(stderr, "voix: command blocked: catastrophic command forbidden.");
+    audit(AuditStage::DECISION, "catastrophic");
+    return probe.finish(1);
   }
-  uid_t target_uid = pw_entry->uid;
 
-  auto rule = permission_checker_->permit(command_str, args, target_uid);
+  if (decision->verdict == AuthorizationDecision::Verdict::INVALID_TARGET) {
+    audit(AuditStage::DECISION, "invalid-target");
+    return probe.finish(1);
+  }
 
-  if (!rule) {
+  if (decision->verdict != AuthorizationDecision::Verdict::PERMIT) {
     std::println(stderr, "voix: command not permitted");
-    security_->logEvent(std::format("Command not permitted: {}", command_str), current_user);
-    syslog(LOG_AUTHPRIV | LOG_NOTICE, "Command not permitted: %s as %s",
-           command_str.c_str(), user_str.c_str());
-    return 1;
+    audit(AuditStage::DECISION, "deny");
+    return probe.finish(1);
   }
 
+  std::optional<Rule> rule = decision->rule;
   if (!authenticator_->authenticate(rule)) {
-    security_->logEvent(std::format("Authentication failed for user: {}", current_user),
-                        current_user);
-    syslog(LOG_AUTHPRIV | LOG_NOTICE, "Authentication failed for user: %s",
-           current_user.c_str());
-    return 1;
+    audit(AuditStage::AUTHENTICATION, "auth-failed");
+    return probe.finish(1);
+  }
+  const bool logged = !(rule->options & Rule::NOLOG);
+  // The one record of a permit: how it was authenticated and the profile
+  // it runs under go with it rather than into lines of their own.
+  if (logged) {
+    audit(AuditStage::DECISION, "permit",
+          std::format("auth={} profile={}", authenticator_->method(),
+                      rule->profile.empty() ? "default" : rule->profile));
   }
 
   if (!authenticator_->openSession()) {
     std::println(stderr, "voix: failed to open session");
-    security_->logEvent(std::format("Failed to open PAM session for command: {}", command_str),
-                        current_user);
-    syslog(LOG_AUTHPRIV | LOG_ERR, "Failed to open PAM session for user: %s",
-           current_user.c_str());
-    return 1;
+    audit(AuditStage::SESSION, "session-failed");
+    return probe.finish(1);
   }
 
   CommandOptions merged_options = options;
-  if (!merged_options.login_shell && config_->is_login_shell_default()) {
+  if (!merged_options.login_shell && decision->login_shell_default) {
       merged_options.login_shell = true;
   }
   
@@ -119,13 +232,30 @@ int Voix::execute(std::string_view command,
   if (rule->options & Rule::KEEPENV) {
       merged_options.preserve_env = true;
   }
-  
-  int res = command_->execute(command_str, args, *config_, merged_options, *rule, user_str);
+
+  // Without a session to close or a timeout to enforce there is nothing
+  // left for voix to do once the command runs, so it replaces itself (like
+  // doas) instead of waiting.
+  merged_options.exec_in_place = Command::use_exec_in_place(
+      decision->context.profile, authenticator_->has_session(), rule->timeout);
+
+  std::optional<ChildReport> report;
+  int res = executor_->execute(command_str, args, decision->context, merged_options, *rule,
+                              user_str, &report);
   authenticator_->closeSession();
-  return res;
+
+  // Resource accounting for the audit trail (only a supervised child has one).
+  if (report && logged) {
+    audit(AuditStage::FINISHED, "finished", report->describe());
+  }
+  return probe.finish(res);
 }
 
 int Voix::list_commands() const {
+    if (!permission_checker_) {
+        LOG_ERROR("list_commands requires a locally loaded configuration");
+        return 1;
+    }
     auto rules = permission_checker_->list_permitted_rules();
     if (rules.empty()) {
         std::println("No permitted commands for the current user.");
@@ -0,0 +1,112 @@
+/**
+ * @file voixd.cpp
+ * @brief voixd entry point: resident authorization broker for voix
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ */
+
+#include <csignal>
+#include <format>
+#include <print>
+#include <string>
+#include <unistd.h>
+#include <getopt.h>
+#include "broker.hpp"
+#include "logger.hpp"
+
+namespace {
+
+Voix::AuthorizationBroker* g_broker = nullptr;
+
+void handle_stop(int) {
+    if (g_broker) g_broker->stop();
+}
+
+void handle_reopen(int) {
+    Voix::Logger::reopen();
+}
+
+/**
+ * @brief Prints the usage information for the voixd command.
+ * @param None No parameters.
+ * @return void
+ */
+void printUsage() {
+    std::print("Usage: voixd [options]\n\n"
+               "Options:\n"
+               "  -h, --help               Show this help message\n"
+               "  -C, --config FILE        Serve the policy in FILE (default: /etc/voix.conf)\n"
+               "  -s, --socket PATH        Listen on PATH (default: {})\n\n"
+               "SIGHUP reopens /var/log/voix.log after rotation.\n",
+               Voix::k_broker_socket_path);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) noexcept {
+    try {
+        std::string config_path = "/etc/voix.conf";
+        std::string socket_path{Voix::k_broker_socket_path};
+
+        static struct option long_options[] = {
+            {"help", no_argument, nullptr, 'h'},
+            {"config", required_argument, nullptr, 'C'},
+            {"socket", required_argument, nullptr, 's'},
+            {nullptr, 0, nullptr, 0}
+        };
+
+        int ch;
+        while ((ch = getopt_long(argc, argv, "C:s:h", long_options, nullptr)) != -1) {
+            switch (ch) {
+                case 'C':
+                    config_path = optarg;
+                    break;
+                case 's':
+                    socket_path = optarg;
+                    break;
+                case 'h':
+                    printUsage();
+                    return 0;
+                default:
+                    printUsage();
+                    return 1;
+            }
+        }
+
+        if (geteuid() != 0) {
+            std::println(stderr, "voixd: must be started as root");
+            return 1;
+        }
+
+        Voix::AuthorizationBroker broker(config_path);
+        if (!broker.reload()) {
+            std::println(stderr, "voixd: failed to load configuration {}", config_path);
+            return 1;
+        }
+        if (!broker.listen(socket_path)) {
+            std::println(stderr, "voixd: failed to listen on {}", socket_path);
+            return 1;
+        }
+
+        g_broker = &broker;
+        struct sigaction sa{};
+        sa.sa_handler = handle_stop;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGTERM, &sa, nullptr);
+        sigaction(SIGINT, &sa, nullptr);
+        sa.sa_handler = handle_reopen;
+        sa.sa_flags = SA_RESTART;
+        sigaction(SIGHUP, &sa, nullptr);
+        signal(SIGPIPE, SIG_IGN);
+
+        LOG_INFO(std::format("voixd: serving {} on {}", config_path, socket_path));
+        broker.serve();
+        g_broker = nullptr;
+        return 0;
+    } catch (const std::exception& e) {
+        std::println(stderr, "voixd: {}", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+
+// Counting replacement of the global operator new/delete, linked into the
+// test and benchmark executables only (tests/alloc_counter.cpp). Counts are
+// per thread, so concurrent work elsewhere does not disturb a measurement.
+
+namespace alloc_counter {
+
+struct Counts {
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+};
+
+// Allocations made by the calling thread so far.
+Counts thread_counts() noexcept;
+
+// Counts the calling thread's allocations from construction to now().
+class Phase {
+public:
+    Phase() noexcept : start_(thread_counts()) {}
+
+    Counts now() const noexcept {
+        Counts c = thread_counts();
+        return {c.allocations - start_.allocations, c.bytes - start_.bytes};
+    }
+
+private:
+    Counts start_;
+};
+
+} // namespace alloc_counter
@@ -0,0 +1,150 @@
+#pragma once
+#include <algorithm>
+#include <csignal>
+#include <cstdint>
+#include <fcntl.h>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <grp.h>
+#include <optional>
+#include <pwd.h>
+#include <string>
+#include <string_view>
+#include <sys/ptrace.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// Shared by the tools that run the voix binary of a VOIX_ENABLE_HARNESS build
+// (bench/voix_e2e, bench/voix_stress, tests/voix_syscalls). They run as root
+// and start voix the way exec of the setuid binary would leave it: real IDs
+// the caller's, effective UID 0.
+
+namespace harness {
+
+// Exit status for "could not run here" (ctest SKIP_RETURN_CODE).
+inline constexpr int k_exit_skip = 77;
+
+struct Caller {
+    std::string name;
+    uid_t uid;
+    gid_t gid;
+    std::vector<gid_t> groups;
+};
+
+// The user @p name with its supplementary groups; an empty name is the real UID.
+inline std::optional<Caller> lookup_caller(const std::string& name) {
+    struct passwd* pw = name.empty() ? getpwuid(getuid()) : getpwnam(name.c_str());
+    if (!pw) return std::nullopt;
+    Caller caller{pw->pw_name, pw->pw_uid, pw->pw_gid, {}};
+    int count = 0;
+    getgrouplist(pw->pw_name, pw->pw_gid, nullptr, &count);
+    caller.groups.resize(static_cast<size_t>(count));
+    getgrouplist(pw->pw_name, pw->pw_gid, caller.groups.data(), &count);
+    caller.groups.resize(static_cast<size_t>(std::max(count, 0)));
+    return caller;
+}
+
+inline std::string find_program(std::string_view name) {
+    for (const char* dir : {"/usr/bin", "/bin", "/usr/sbin", "/sbin", "/usr/local/bin"}) {
+        auto path = std::format("{}/{}", dir, name);
+        if (access(path.c_str(), X_OK) == 0) return path;
+    }
+    return {};
+}
+
+// Writes <dir>/pam.d/voix, a PAM service that always authenticates, and
+// returns the environment entry that points a harness build of voix at it.
+inline std::string write_pam_service(const std::filesystem::path& dir) {
+    std::filesystem::create_directory(dir / "pam.d");
+    std::ofstream(dir / "pam.d" / "voix") << "auth     sufficient pam_permit.so\n"
+                                            "account  sufficient pam_permit.so\n"
+                                            "session  sufficient pam_permit.so\n"
+                                            "password required   pam_deny.so\n";
+    return std::format("VOIX_HARNESS_PAM_DIR={}", (dir / "pam.d").string());
+}
+
+// Null-terminated pointers into @p strings, for execve().
+inline std::vector<char*> c_strings(std::vector<std::string>& strings) {
+    std::vector<char*> out;
+    for (auto& s : strings) out.push_back(s.data());
+    out.push_back(nullptr);
+    return out;
+}
+
+// Child side of every run: undo the parent's signal mask, silence output,
+// become the caller as a setuid exec would leave it, optionally stop for a
+// tracer, exec.
+[[noreturn]] inline void exec_as_caller(const Caller& caller, const std::vector<char*>& argv,
+                                        const std::vector<char*>& envp, bool trace = false) {
+    sigset_t none;
+    sigemptyset(&none);
+    sigprocmask(SIG_SETMASK, &none, nullptr);
+    int null = open("/dev/null", O_RDWR | O_CLOEXEC);
+    if (null != -1) {
+        dup2(null, STDIN_FILENO);
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+    }
+    if (geteuid() == 0 && caller.uid != 0) {
+        if (setgroups(caller.groups.size(), caller.groups.data()) != 0 ||
+            setresgid(caller.gid, caller.gid, caller.gid) != 0 || setresuid(caller.uid, 0, 0) != 0) {
+            _exit(126);
+        }
+    }
+    if (trace) {
+        ptrace(PTRACE_TRACEME, 0, nullptr, nullptr);
+        raise(SIGSTOP);
+    }
+    execve(argv[0], argv.data(), envp.data());
+    _exit(127);
+}
+
+// Runs argv as the caller under ptrace, following every process it starts.
+// @p on_stop sees each syscall entry and exit stop (event 0) and each
+// PTRACE_EVENT_* stop; @p on_exit sees each traced process end. Signals are
+// passed on to the tracee. Returns the wait status of the first process, or
+// std::nullopt if tracing failed.
+inline std::optional<int> trace_tree(const Caller& caller, const std::vector<char*>& argv,
+                                     const std::vector<char*>& envp,
+                                     const std::function<void(pid_t pid, unsigned event)>& on_stop,
+                                     const std::function<void(pid_t pid)>& on_exit) {
+    pid_t root = fork();
+    if (root == 0) exec_as_caller(caller, argv, envp, true);
+    int status = 0;
+    if (root == -1 || waitpid(root, &status, 0) != root || !WIFSTOPPED(status)) return std::nullopt;
+    if (ptrace(PTRACE_SETOPTIONS, root, nullptr,
+               PTRACE_O_TRACESYSGOOD | PTRACE_O_TRACEFORK | PTRACE_O_TRACEVFORK | PTRACE_O_TRACECLONE |
+                   PTRACE_O_TRACEEXEC | PTRACE_O_EXITKILL) != 0) {
+        kill(root, SIGKILL);
+        waitpid(root, &status, 0);
+        return std::nullopt;
+    }
+    ptrace(PTRACE_SYSCALL, root, nullptr, nullptr);
+
+    std::optional<int> root_status;
+    while (true) {
+        pid_t pid = waitpid(-1, &status, __WALL);
+        if (pid == -1) break;
+        if (WIFEXITED(status) || WIFSIGNALED(status)) {
+            if (pid == root) root_status = status;
+            on_exit(pid);
+            continue;
+        }
+        if (!WIFSTOPPED(status)) continue;
+        int signal = 0;
+        const int stop = WSTOPSIG(status);
+        const unsigned event = static_cast<unsigned>(status) >> 16;
+        if (stop == (SIGTRAP | 0x80) || event != 0) {
+            on_stop(pid, event);
+        } else if (stop != SIGTRAP && stop != SIGSTOP) {
+            signal = stop;
+        }
+        ptrace(PTRACE_SYSCALL, pid, nullptr, signal);
+    }
+    return root_status;
+}
+
+} // namespace harness
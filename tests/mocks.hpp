@@ -0,0 +1,129 @@
+#pragma once
+#include "../include/authenticator.hpp"
+#include "../include/command.hpp"
+#include "../include/command_resolver.hpp"
+#include "../include/rule.hpp"
+#include "../include/system_identity.hpp"
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// In-memory stand-ins for the system behind the request pipeline: users,
+// PAM, the filesystem seen by command resolution, and exec. Together with
+// Config::load_from_string() they let Voix::Voix(VoixBackends) run every
+// stage of a request in-process and deterministically.
+
+class MockIdentity : public Voix::IIdentity {
+public:
+    struct MockUser {
+        std::string name;
+        uid_t uid;
+        gid_t gid;
+        std::vector<gid_t> groups;
+    };
+    std::vector<MockUser> users;
+    std::string current_user;
+    uid_t current_uid;
+    std::vector<gid_t> current_groups;
+
+    std::optional<Voix::UserIdentity> get_user_by_name(const std::string& username) const override {
+        for (const auto& u : users) {
+            if (u.name == username) return Voix::UserIdentity{u.name, u.uid, u.gid, u.groups, "/home/" + u.name, "/bin/bash"};
+        }
+        return std::nullopt;
+    }
+    std::optional<Voix::UserIdentity> get_user_by_uid(uid_t uid) const override {
+        for (const auto& u : users) {
+            if (u.uid == uid) return Voix::UserIdentity{u.name, u.uid, u.gid, u.groups, "/home/" + u.name, "/bin/bash"};
+        }
+        return std::nullopt;
+    }
+    std::string get_current_username() const override { return current_user; }
+    uid_t get_current_uid() const override { return current_uid; }
+    std::vector<gid_t> get_current_groups() const override { return current_groups; }
+};
+
+// Accepts every `nopass` rule, and the others while `accept` is set.
+class MockAuthenticator : public Voix::IAuthenticator {
+public:
+    bool accept = true;
+    bool sessions = false;  // Whether openSession() leaves a session to close.
+    int prompts = 0;        // Authentications that would have asked for a password.
+    int sessions_closed = 0;
+
+    bool authenticate(const std::optional<Voix::Rule>& rule) override {
+        method_ = "nopass";
+        if (rule && (rule->options & Voix::Rule::NOPASS)) return true;
+        method_ = "pam";
+        ++prompts;
+        return accept;
+    }
+    bool openSession() override {
+        open_ = sessions;
+        return true;
+    }
+    void closeSession() override {
+        if (open_) ++sessions_closed;
+        open_ = false;
+    }
+    bool has_session() const override { return open_; }
+    std::string_view method() const override { return method_; }
+
+private:
+    bool open_ = false;
+    std::string_view method_;
+};
+
+// Resolves against a fixed list of files. Bare names are searched in `path`
+// as CommandResolver searches PATH; identities are the files' positions, on
+// device 0, which no real file has.
+class MockResolver : public Voix::ICommandResolver {
+public:
+    std::vector<std::string> path;
+    std::vector<std::string> files;
+
+    std::optional<Voix::ResolvedCommand> resolve(std::string_view command, std::string_view = {}) override {
+        if (command.find('/') != std::string_view::npos) return lookup(command);
+        for (const auto& dir : path) {
+            std::string candidate = dir;
+            candidate += '/';
+            candidate += command;
+            if (auto found = lookup(candidate)) return found;
+        }
+        return std::nullopt;
+    }
+
+private:
+    std::optional<Voix::ResolvedCommand> lookup(std::string_view candidate) const {
+        auto it = std::ranges::find(files, candidate);
+        if (it == files.end()) return std::nullopt;
+        Voix::ResolvedCommand resolved;
+        resolved.path = *it;
+        resolved.ino = static_cast<ino_t>(it - files.begin()) + 1;
+        return resolved;
+    }
+};
+
+// Records what would have been executed and returns `exit_status`.
+class MockExecutor : public Voix::IExecutor {
+public:
+    int exit_status = 0;
+    mutable int runs = 0;
+    mutable std::string path;  // The resolved command of the last run.
+    mutable std::vector<std::string> args;
+    mutable std::string user;
+    mutable bool in_place = false;
+
+    int execute(std::string_view command, const std::vector<std::string>& command_args,
+                const Voix::ExecutionContext& context, const Voix::CommandOptions& options, const Voix::Rule&,
+                std::string_view target, std::optional<Voix::ChildReport>*) const override {
+        ++runs;
+        path = context.command.found() ? context.command.path : std::string(command);
+        args = command_args;
+        user = target;
+        in_place = options.exec_in_place;
+        return exit_status;
+    }
+};
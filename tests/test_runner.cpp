@@ -1,4 +1,6 @@
 #include "test_assert.hpp"
+#include "alloc_counter.hpp"
+#include "mocks.hpp"
 #include "../include/file_utils.hpp"
 #include "../include/logger.hpp"
 #include "../include/security.hpp"
@@ -7,12 +9,39 @@
 #include "../include/system_identity.hpp"
 #include "../include/command.hpp"
 #include "../include/system_utils.hpp"
+#include "../include/timestamp_cache.hpp"
+#include "../include/authorization.hpp"
+#include "../include/broker.hpp"
+#include "../include/exec_plan.hpp"
+#include "../include/env_policy.hpp"
+#include "../include/command_resolver.hpp"
+#include "../include/supervisor.hpp"
+#include "../include/cgroup.hpp"
+#include "../include/process_tuning.hpp"
+#include "../include/audit_store.hpp"
+#include "../include/audit_pipeline.hpp"
+#include "../include/glob.hpp"
+#include "../include/policy_analyzer.hpp"
+#include "../include/policy_diff.hpp"
+#include "../include/probes.hpp"
+#include "../include/rule_stats.hpp"
+#include "../include/thread_pool.hpp"
+#include "../include/trace.hpp"
+#include "../include/voix.hpp"
+#include <format>
 #include <fstream>
 #include <filesystem>
 #include <memory>
 #include <cstdlib>
 #include <chrono>
 #include <regex>
+#include <thread>
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <cstring>
 
 class ScopedTempFile {
 public:
@@ -26,36 +55,6 @@ private:
     std::filesystem::path path_;
 };
 
-class MockIdentity : public Voix::IIdentity {
-public:
-    struct MockUser {
-        std::string name;
-        uid_t uid;
-        gid_t gid;
-        std::vector<gid_t> groups;
-    };
-    std::vector<MockUser> users;
-    std::string current_user;
-    uid_t current_uid;
-    std::vector<gid_t> current_groups;
-
-    std::optional<Voix::UserIdentity> get_user_by_name(const std::string& username) const override {
-        for (const auto& u : users) {
-            if (u.name == username) return Voix::UserIdentity{u.name, u.uid, u.gid, u.groups, "/home/" + u.name, "/bin/bash"};
-        }
-        return std::nullopt;
-    }
-    std::optional<Voix::UserIdentity> get_user_by_uid(uid_t uid) const override {
-        for (const auto& u : users) {
-            if (u.uid == uid) return Voix::UserIdentity{u.name, u.uid, u.gid, u.groups, "/home/" + u.name, "/bin/bash"};
-        }
-        return std::nullopt;
-    }
-    std::string get_current_username() const override { return current_user; }
-    uid_t get_current_uid() const override { return current_uid; }
-    std::vector<gid_t> get_current_groups() const override { return current_groups; }
-};
-
 bool test_permission_checker_permit_allowed() {
     auto mock_id = std::make_shared<MockIdentity>();
     mock_id->users = {{"alice", 1000, 1000, {1000, 4}}};
@@ -362,6 +361,24 @@ bool test_logger_log_empty_message() {
     return true;
 }
 
+bool test_logger_long_record_is_one_line() {
+    // Records longer than the stack buffer take the heap path; either way a
+    // record is a single line.
+    std::string message = "long-record-" + std::string(4000, 'x');
+    Voix::Logger logger;
+    logger.log("INFO", message);
+
+    std::ifstream log_file("/var/log/voix.log");
+    if (!log_file.is_open()) return true;  // not writable here: went to syslog
+    std::string line, last;
+    while (std::getline(log_file, line)) {
+        if (line.find("long-record-") != std::string::npos) last = line;
+    }
+    ASSERT_TRUE(last.ends_with("] [INFO] " + message));
+    ASSERT_EQUAL(last[0], '[');
+    return true;
+}
+
 // ============================================================
 // FileUtils tests - readFile / writeFile
 // ============================================================
@@ -455,31 +472,6 @@ bool test_file_utils_write_file_invalid_path() {
     return true;
 }
 
-// ============================================================
-// FileUtils tests - resolve_command
-// ============================================================
-
-bool test_file_utils_resolve_command_empty() {
-    Voix::FileUtils file_utils;
-    std::string result = file_utils.resolve_command({"", "/usr/bin:/bin"});
-    ASSERT_EQUAL(result, std::string(""));
-    return true;
-}
-
-bool test_file_utils_resolve_command_absolute_nonexistent() {
-    Voix::FileUtils file_utils;
-    std::string result = file_utils.resolve_command({"/nonexistent/binary", "/usr/bin"});
-    ASSERT_EQUAL(result, std::string(""));
-    return true;
-}
-
-bool test_file_utils_resolve_command_not_in_path() {
-    Voix::FileUtils file_utils;
-    std::string result = file_utils.resolve_command({"totally_fake_command_xyz123", "/usr/bin:/bin"});
-    ASSERT_EQUAL(result, std::string(""));
-    return true;
-}
-
 // ============================================================
 // SystemUtils tests
 // ============================================================
@@ -1011,6 +1003,1715 @@ bool test_config_unconfined_targets() {
     return true;
 }
 
+// ============================================================
+// TimestampCache tests (persist)
+// ============================================================
+
+// Creates a private (0700) scratch directory for timestamp records.
+static std::filesystem::path make_private_dir(const std::string& name) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::filesystem::permissions(dir, std::filesystem::perms::owner_all,
+                                 std::filesystem::perm_options::replace);
+    return dir;
+}
+
+bool test_timestamp_cache_update_and_validate() {
+    auto dir = make_private_dir("voix_test_ts_valid");
+    Voix::TimestampCache cache(dir.string(), std::chrono::seconds(300), getuid());
+    uid_t uid = getuid();
+
+    ASSERT_TRUE(!cache.is_valid(uid));
+    ASSERT_TRUE(cache.update(uid));
+    ASSERT_TRUE(cache.is_valid(uid));
+    // A record for another user never satisfies this caller.
+    ASSERT_TRUE(!cache.is_valid(uid + 1));
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_timestamp_cache_clear() {
+    auto dir = make_private_dir("voix_test_ts_clear");
+    Voix::TimestampCache cache(dir.string(), std::chrono::seconds(300), getuid());
+    uid_t uid = getuid();
+
+    ASSERT_TRUE(cache.update(uid));
+    ASSERT_TRUE(cache.clear(uid));
+    ASSERT_TRUE(!cache.is_valid(uid));
+    // Clearing a missing record is not an error.
+    ASSERT_TRUE(cache.clear(uid));
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_timestamp_cache_zero_lifetime_disabled() {
+    auto dir = make_private_dir("voix_test_ts_disabled");
+    Voix::TimestampCache cache(dir.string(), std::chrono::seconds(0), getuid());
+    uid_t uid = getuid();
+
+    ASSERT_TRUE(!cache.update(uid));
+    ASSERT_TRUE(!cache.is_valid(uid));
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_timestamp_cache_rejects_shared_directory() {
+    auto dir = make_private_dir("voix_test_ts_shared");
+    std::filesystem::permissions(dir, std::filesystem::perms::all,
+                                 std::filesystem::perm_options::replace);
+    Voix::TimestampCache cache(dir.string(), std::chrono::seconds(300), getuid());
+    uid_t uid = getuid();
+
+    ASSERT_TRUE(!cache.update(uid));
+    ASSERT_TRUE(!cache.is_valid(uid));
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_timestamp_cache_session_key_scoped() {
+    auto key = Voix::TimestampCache::session_key(1000);
+    ASSERT_TRUE(key.has_value());
+    ASSERT_TRUE(key->starts_with("1000-"));
+    ASSERT_TRUE(key->find('/') == std::string::npos);
+    ASSERT_TRUE(Voix::TimestampCache::session_key(1001) != key);
+    return true;
+}
+
+bool test_config_persist_settings() {
+    Voix::Config config;
+    ASSERT_EQUAL(config.get_persist_dir(), std::string("/run/voix"));
+    ASSERT_EQUAL(config.get_persist_timeout().count(), 300);
+
+    std::filesystem::path config_path = std::filesystem::temp_directory_path() / "test_persist.conf";
+    ScopedTempFile cleanup(config_path);
+    {
+        std::ofstream out(config_path);
+        out << "core:\n  persist_dir: /run/voix-test\n  persist_timeout: 60\n";
+    }
+    ASSERT_TRUE(config.load(config_path.string(), false));
+    ASSERT_EQUAL(config.get_persist_dir(), std::string("/run/voix-test"));
+    ASSERT_EQUAL(config.get_persist_timeout().count(), 60);
+    return true;
+}
+
+// ============================================================
+// Authorization / voixd broker tests
+// ============================================================
+
+// Writes a policy permitting `ls` for the given user identifier.
+static void write_ls_policy(const std::filesystem::path& path, const std::string& ident) {
+    std::ofstream out(path);
+    out << "core:\n  paths: [/bin, /usr/bin]\n"
+        << "acl:\n  user:\n    " << ident << ":\n      - action: permit\n        command: ls\n";
+}
+
+bool test_authorize_verdicts() {
+    auto mock_id = std::make_shared<MockIdentity>();
+    mock_id->users = {{"alice", 1000, 1000, {1000}}, {"root", 0, 0, {0}}};
+    mock_id->current_user = "alice";
+    mock_id->current_uid = 1000;
+
+    std::filesystem::path config_path = std::filesystem::temp_directory_path() / "test_authorize.conf";
+    ScopedTempFile cleanup_guard(config_path);
+    write_ls_policy(config_path, "1000");
+    auto config = std::make_shared<Voix::Config>();
+    ASSERT_TRUE(config->load(config_path.string(), false));
+
+    auto security = std::make_shared<Voix::Security>(mock_id);
+    Voix::PermissionChecker checker(security, config);
+    Voix::CommandResolver resolver(config->getPath());
+    using Verdict = Voix::AuthorizationDecision::Verdict;
+
+    auto permit = Voix::authorize(*config, *security, checker, resolver, {"root", "ls", {}, {}});
+    ASSERT_TRUE(permit.verdict == Verdict::PERMIT);
+    ASSERT_EQUAL(permit.rule.cmd, "ls");
+    ASSERT_EQUAL(permit.context.path, "/bin:/usr/bin");
+
+    auto deny = Voix::authorize(*config, *security, checker, resolver, {"root", "cat", {}, {}});
+    ASSERT_TRUE(deny.verdict == Verdict::DENY);
+
+    auto target = Voix::authorize(*config, *security, checker, resolver,
+                                  {"voix_no_such_user_xyz", "ls", {}, {}});
+    ASSERT_TRUE(target.verdict == Verdict::INVALID_TARGET);
+
+    auto blocked = Voix::authorize(*config, *security, checker, resolver, {"root", "rm", {"-rf", "/"}, {}});
+    ASSERT_TRUE(blocked.verdict == Verdict::CATASTROPHIC);
+    return true;
+}
+
+bool test_broker_round_trip() {
+    auto dir = std::filesystem::temp_directory_path();
+    std::filesystem::path config_path = dir / "test_broker.conf";
+    std::filesystem::path socket_path = dir / "test_voixd.sock";
+    ScopedTempFile config_guard(config_path);
+    write_ls_policy(config_path, std::to_string(getuid()));
+
+    Voix::AuthorizationBroker broker(config_path.string(), false);
+    ASSERT_TRUE(broker.reload());
+    ASSERT_TRUE(broker.listen(socket_path.string()));
+    std::thread server([&broker] { broker.serve(); });
+
+    auto client = Voix::BrokerClient::connect(socket_path.string(), getuid());
+    bool connected = client != nullptr;
+    std::optional<Voix::AuthorizationDecision> permit;
+    if (client) permit = client->query({"root", "ls", {}, "/"});
+
+    auto second = Voix::BrokerClient::connect(socket_path.string(), getuid());
+    std::optional<Voix::AuthorizationDecision> deny;
+    if (second) deny = second->query({"root", "cat", {}, "/"});
+
+    // A relative command would be looked up in a directory the peer names.
+    auto third = Voix::BrokerClient::connect(socket_path.string(), getuid());
+    std::optional<Voix::AuthorizationDecision> relative;
+    if (third) relative = third->query({"root", "./ls", {}, "/bin"});
+
+    broker.stop();
+    server.join();
+
+    ASSERT_TRUE(connected);
+    ASSERT_TRUE(permit.has_value());
+    ASSERT_TRUE(permit->verdict == Voix::AuthorizationDecision::Verdict::PERMIT);
+    ASSERT_EQUAL(permit->rule.cmd, "ls");
+    ASSERT_EQUAL(permit->context.path, "/bin:/usr/bin");
+    // The client counts the hit; the decision says which rule and policy.
+    ASSERT_TRUE(permit->rule_index == std::optional<size_t>(0));
+    ASSERT_EQUAL(permit->rule_count, 1u);
+    ASSERT_TRUE(permit->rules_fingerprint != 0);
+    ASSERT_TRUE(!permit->rule_stats_path.empty());
+    ASSERT_TRUE(deny.has_value());
+    ASSERT_TRUE(deny->verdict == Voix::AuthorizationDecision::Verdict::DENY);
+    ASSERT_TRUE(!deny->rule_index.has_value());
+    ASSERT_TRUE(!relative.has_value());
+    return true;
+}
+
+bool test_broker_stalled_peer_does_not_block() {
+    auto dir = std::filesystem::temp_directory_path();
+    std::filesystem::path config_path = dir / "test_broker_stall.conf";
+    std::filesystem::path socket_path = dir / "test_voixd_stall.sock";
+    ScopedTempFile config_guard(config_path);
+    write_ls_policy(config_path, std::to_string(getuid()));
+
+    Voix::AuthorizationBroker broker(config_path.string(), false);
+    ASSERT_TRUE(broker.reload());
+    ASSERT_TRUE(broker.listen(socket_path.string()));
+    std::thread server([&broker] { broker.serve(); });
+
+    // One peer sends nothing, another stops halfway through its length prefix.
+    struct sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    int silent = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int partial = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    bool stalled = connect(silent, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0 &&
+                   connect(partial, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0 &&
+                   send(partial, "\x10\x00", 2, MSG_NOSIGNAL) == 2;
+
+    auto client = Voix::BrokerClient::connect(socket_path.string(), getuid());
+    std::optional<Voix::AuthorizationDecision> permit;
+    if (client) permit = client->query({"root", "ls", {}, "/"});
+
+    // The answer arrived while both stalled peers were still connected...
+    char byte;
+    bool still_open = recv(silent, &byte, 1, MSG_DONTWAIT) == -1 && errno == EAGAIN;
+    // ...and the broker drops them once their deadline passes.
+    struct timeval tv{3, 0};
+    setsockopt(partial, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    bool dropped = recv(partial, &byte, 1, 0) == 0;
+
+    broker.stop();
+    server.join();
+    close(silent);
+    close(partial);
+
+    ASSERT_TRUE(stalled);
+    ASSERT_TRUE(permit.has_value());
+    ASSERT_TRUE(permit->verdict == Voix::AuthorizationDecision::Verdict::PERMIT);
+    ASSERT_TRUE(still_open);
+    ASSERT_TRUE(dropped);
+    return true;
+}
+
+bool test_broker_client_rejects_untrusted_socket() {
+    auto dir = std::filesystem::temp_directory_path();
+    ASSERT_TRUE(Voix::BrokerClient::connect((dir / "voix_no_such.sock").string(), getuid()) == nullptr);
+
+    // A regular file is never a broker.
+    std::filesystem::path file_path = dir / "test_voixd_not_a_socket";
+    ScopedTempFile file_guard(file_path);
+    std::ofstream(file_path) << "x";
+    ASSERT_TRUE(Voix::BrokerClient::connect(file_path.string(), getuid()) == nullptr);
+
+    // A socket owned by somebody other than the expected owner is ignored.
+    std::filesystem::path config_path = dir / "test_broker_owner.conf";
+    ScopedTempFile config_guard(config_path);
+    write_ls_policy(config_path, "root");
+    Voix::AuthorizationBroker broker(config_path.string(), false);
+    std::filesystem::path socket_path = dir / "test_voixd_owner.sock";
+    ASSERT_TRUE(broker.listen(socket_path.string()));
+    ASSERT_TRUE(Voix::BrokerClient::connect(socket_path.string(), getuid() + 1) == nullptr);
+    return true;
+}
+
+// ============================================================
+// Exec plan tests
+// ============================================================
+
+static std::string current_user_name() {
+    auto self = Voix::lookup_passwd_by_uid(getuid());
+    return self ? self->name : "root";
+}
+
+static bool env_has(const Voix::ExecPlan& plan, std::string_view prefix) {
+    return std::ranges::any_of(plan.inherited_env, [&](std::string_view e) { return e.starts_with(prefix); }) ||
+           std::ranges::any_of(plan.assigned_env, [&](const std::string& e) { return e.starts_with(prefix); });
+}
+
+bool test_exec_plan_scrubs_environment() {
+    setenv("LD_PRELOAD", "/tmp/voix_test_preload.so", 1);
+    setenv("VOIX_TEST_VAR", "1", 1);
+
+    Voix::Command cmd;
+    Voix::ExecutionContext context{Voix::SecurityProfile{}, "/bin:/usr/bin", false, nullptr, {}, {}};
+    context.command = *Voix::CommandResolver(context.path).resolve("/bin/true");
+    auto plan = cmd.build_exec_plan("/bin/true", {"x"}, context, {}, current_user_name());
+    Voix::CommandOptions keep;
+    keep.preserve_env = true;
+    auto kept = cmd.build_exec_plan("/bin/true", {}, context, keep, current_user_name());
+
+    // Inherited entries point into environ, so inspect them before unsetting.
+    const bool kept_var = kept.has_value() && env_has(*kept, "VOIX_TEST_VAR=1");
+    const bool kept_preload = kept.has_value() && env_has(*kept, "LD_PRELOAD=");
+    const bool scrubbed_var = plan.has_value() && env_has(*plan, "VOIX_TEST_VAR=");
+    const bool scrubbed_preload = plan.has_value() && env_has(*plan, "LD_PRELOAD=");
+    unsetenv("LD_PRELOAD");
+    unsetenv("VOIX_TEST_VAR");
+
+    ASSERT_TRUE(plan.has_value());
+    ASSERT_EQUAL(plan->path, "/bin/true");
+    ASSERT_EQUAL(plan->argv.size(), 2u);
+    ASSERT_TRUE(env_has(*plan, "PATH=/bin:/usr/bin"));
+    ASSERT_TRUE(env_has(*plan, "USER=" + current_user_name()));
+    ASSERT_TRUE(!scrubbed_var);
+    ASSERT_TRUE(!scrubbed_preload);
+    ASSERT_TRUE(plan->close_fds);
+    ASSERT_EQUAL(plan->rlimits.size(), 3u);
+
+    ASSERT_TRUE(kept.has_value());
+    ASSERT_TRUE(kept_var);
+    ASSERT_TRUE(!kept_preload);
+    return true;
+}
+
+bool test_exec_plan_login_shell_and_missing_command() {
+    Voix::Command cmd;
+    Voix::ExecutionContext context{Voix::SecurityProfile{}, "/bin:/usr/bin", false, nullptr, {}, {}};
+    Voix::CommandOptions login;
+    login.login_shell = true;
+    context.command = *Voix::CommandResolver(context.path).resolve("/bin/echo");
+    auto plan = cmd.build_exec_plan("/bin/echo", {"a'b"}, context, login, current_user_name());
+    ASSERT_TRUE(plan.has_value());
+    ASSERT_EQUAL(plan->argv.size(), 4u);
+    ASSERT_EQUAL(plan->argv[1], "-l");
+    ASSERT_EQUAL(plan->argv[3], "'/bin/echo' 'a'\\''b'");
+
+    context.command = {};
+    auto missing = cmd.build_exec_plan("voix-no-such-command", {}, context, {}, current_user_name());
+    ASSERT_TRUE(!missing.has_value());
+    ASSERT_EQUAL(missing.error(), 127);
+
+    // A command that was never resolved is not looked up at exec time, even
+    // when it exists.
+    auto unresolved = cmd.build_exec_plan("/bin/true", {}, context, {}, current_user_name());
+    ASSERT_TRUE(!unresolved.has_value());
+    ASSERT_EQUAL(unresolved.error(), 127);
+    return true;
+}
+
+// Runs a plan without changing identity and returns the child's exit status.
+static int run_plan(const Voix::ExecPlan& plan, Voix::ExecFailure& failure) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    pid_t pid = Voix::spawn_exec_plan(plan, mask, failure);
+    if (pid == -1) return -1;
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+bool test_spawn_exec_plan_reports_failures() {
+    Voix::ExecPlan plan;
+    plan.change_identity = false;
+    plan.path = "/bin/sh";
+    plan.argv = {"/bin/sh", "-c", "exit 7"};
+    plan.assigned_env = {"PATH=/bin:/usr/bin"};
+
+    Voix::ExecFailure failure;
+    ASSERT_EQUAL(run_plan(plan, failure), 7);
+    ASSERT_TRUE(failure.stage == Voix::ExecStage::NONE);
+
+    plan.path = "/nonexistent/voix-missing";
+    ASSERT_EQUAL(run_plan(plan, failure), 127);
+    ASSERT_TRUE(failure.stage == Voix::ExecStage::EXEC);
+    ASSERT_EQUAL(failure.error, ENOENT);
+    return true;
+}
+
+bool test_use_exec_in_place() {
+    Voix::SecurityProfile profile;
+    ASSERT_TRUE(Voix::Command::use_exec_in_place(profile, false));
+    ASSERT_TRUE(!Voix::Command::use_exec_in_place(profile, true));
+    profile.exec_mode = Voix::ExecMode::FORK;
+    ASSERT_TRUE(!Voix::Command::use_exec_in_place(profile, false));
+    return true;
+}
+
+bool test_config_exec_mode() {
+    std::filesystem::path config_path = std::filesystem::temp_directory_path() / "test_exec_mode.conf";
+    ScopedTempFile cleanup_guard(config_path);
+    {
+        std::ofstream out(config_path);
+        out << "security:\n  profiles:\n    waited:\n      exec_mode: fork\n    direct:\n      exec_mode: auto\n";
+    }
+    Voix::Config config;
+    ASSERT_TRUE(config.load(config_path.string(), false));
+    ASSERT_TRUE(config.get_profile("waited").exec_mode == Voix::ExecMode::FORK);
+    ASSERT_TRUE(config.get_profile("direct").exec_mode == Voix::ExecMode::AUTO);
+    ASSERT_TRUE(config.get_profile("missing").exec_mode == Voix::ExecMode::AUTO);
+
+    {
+        std::ofstream out(config_path);
+        out << "security:\n  profiles:\n    bad:\n      exec_mode: sometimes\n";
+    }
+    Voix::Config invalid;
+    ASSERT_TRUE(!invalid.load(config_path.string(), false));
+    return true;
+}
+
+bool test_exec_plan_in_place() {
+    Voix::ExecPlan plan;
+    plan.change_identity = false;
+    plan.path = "/bin/sh";
+    plan.argv = {"/bin/sh", "-c", "exit 9"};
+    plan.assigned_env = {"PATH=/bin:/usr/bin"};
+
+    // exec_plan_in_place replaces the calling process, so run it in a child.
+    auto run = [](const Voix::ExecPlan& p) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            Voix::ExecFailure failure = Voix::exec_plan_in_place(p);
+            _exit(failure.stage == Voix::ExecStage::EXEC && failure.error == ENOENT ? 42 : 43);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    };
+
+    ASSERT_EQUAL(run(plan), 9);
+    plan.path = "/nonexistent/voix-missing";
+    ASSERT_EQUAL(run(plan), 42);
+
+    // Inherited descriptors are closed by the exec, not before it: a failure
+    // can still be reported through them.
+    plan.close_fds = true;
+    plan.argv = {"/bin/sh", "-c", "[ -e /proc/self/fd/5 ] && exit 1; exit 9"};
+    int fds[2];
+    ASSERT_TRUE(pipe(fds) == 0);
+    auto run_with_fd = [&](const Voix::ExecPlan& p) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            dup2(fds[1], 5);
+            Voix::ExecFailure failure = Voix::exec_plan_in_place(p);
+            _exit(write(5, &failure.stage, sizeof(failure.stage)) == sizeof(failure.stage) ? 42 : 43);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    };
+    ASSERT_EQUAL(run_with_fd(plan), 42);
+    plan.path = "/bin/sh";
+    const int closed = run_with_fd(plan);
+    close(fds[0]);
+    close(fds[1]);
+    ASSERT_EQUAL(closed, 9);
+    return true;
+}
+
+// ============================================================
+// Environment policy tests
+// ============================================================
+
+static bool has_entry(const std::vector<const char*>& entries, std::string_view entry) {
+    return std::ranges::any_of(entries, [&](std::string_view e) { return e == entry; });
+}
+
+bool test_env_policy_modes() {
+    Voix::EnvPolicy policy({"TERM", "LC_*"}, {"TZ"}, {"LD_*", "BASH_ENV"});
+    const char* environ_in[] = {"TERM=xterm", "LC_ALL=C", "TZ=UTC", "TZDIR=/x", "LD_PRELOAD=/x.so",
+                                "BASH_ENV=/x", "FOO=1", "NOEQUALS", nullptr};
+
+    auto scrubbed = policy.apply(environ_in, Voix::EnvPolicy::Mode::SCRUB, {}, {});
+    ASSERT_EQUAL(scrubbed.inherited.size(), 3u);
+    ASSERT_TRUE(has_entry(scrubbed.inherited, "TERM=xterm"));
+    ASSERT_TRUE(has_entry(scrubbed.inherited, "LC_ALL=C"));
+    ASSERT_TRUE(has_entry(scrubbed.inherited, "TZ=UTC"));
+
+    // A check-listed value naming a path is dropped.
+    const char* unsafe_tz[] = {"TZ=/etc/localtime", "TZ2=UTC", nullptr};
+    ASSERT_TRUE(policy.apply(unsafe_tz, Voix::EnvPolicy::Mode::SCRUB, {}, {}).inherited.empty());
+
+    auto sanitized = policy.apply(environ_in, Voix::EnvPolicy::Mode::SANITIZE, {}, {});
+    ASSERT_EQUAL(sanitized.inherited.size(), 5u);
+    ASSERT_TRUE(has_entry(sanitized.inherited, "FOO=1"));
+    ASSERT_TRUE(!has_entry(sanitized.inherited, "LD_PRELOAD=/x.so"));
+    ASSERT_TRUE(!has_entry(sanitized.inherited, "BASH_ENV=/x"));
+
+    auto full = policy.apply(environ_in, Voix::EnvPolicy::Mode::FULL, {}, {});
+    ASSERT_EQUAL(full.inherited.size(), 7u);
+
+    // Built-in defaults reproduce the historical whitelist and deny list.
+    const Voix::EnvPolicy& defaults = Voix::EnvPolicy::defaults();
+    auto default_scrub = defaults.apply(environ_in, Voix::EnvPolicy::Mode::SCRUB, {}, {});
+    ASSERT_EQUAL(default_scrub.inherited.size(), 1u);
+    auto default_sanitize = defaults.apply(environ_in, Voix::EnvPolicy::Mode::SANITIZE, {}, {});
+    ASSERT_TRUE(!has_entry(default_sanitize.inherited, "LD_PRELOAD=/x.so"));
+    ASSERT_TRUE(has_entry(default_sanitize.inherited, "TZDIR=/x"));
+    return true;
+}
+
+bool test_env_policy_rule_entries() {
+    const Voix::EnvPolicy& policy = Voix::EnvPolicy::defaults();
+    const char* environ_in[] = {"TERM=xterm", "FOO=1", "PATH=/evil", "HOME=/evil", nullptr};
+    const std::vector<std::string> assignments = {"PATH=/bin", "HOME=/root"};
+    const std::vector<std::string> rule_env = {"HOME=/srv", "-TERM", "FOO", "BAR=2"};
+
+    auto env = policy.apply(environ_in, Voix::EnvPolicy::Mode::SCRUB, assignments, rule_env);
+    ASSERT_EQUAL(env.inherited.size(), 1u);
+    ASSERT_TRUE(has_entry(env.inherited, "FOO=1"));
+    ASSERT_EQUAL(env.assigned.size(), 3u);
+    ASSERT_EQUAL(env.assigned[0], "PATH=/bin");
+    ASSERT_EQUAL(env.assigned[1], "HOME=/srv");
+    ASSERT_EQUAL(env.assigned[2], "BAR=2");
+    return true;
+}
+
+bool test_config_environment_policy() {
+    std::filesystem::path config_path = std::filesystem::temp_directory_path() / "test_env_policy.conf";
+    ScopedTempFile cleanup_guard(config_path);
+    {
+        std::ofstream out(config_path);
+        out << "security:\n  environment:\n    keep: [TERM, \"XDG_*\"]\n    check: [TZ]\n";
+    }
+    Voix::Config config;
+    ASSERT_TRUE(config.load(config_path.string(), false));
+    const auto& policy = *config.get_env_policy();
+    ASSERT_EQUAL(policy.keep().size(), 2u);
+    ASSERT_EQUAL(policy.check().size(), 1u);
+    ASSERT_TRUE(policy.deny() == Voix::EnvPolicy::defaults().deny());
+    ASSERT_TRUE(config.validate());
+
+    // A configured deny list extends the built-in one instead of replacing it.
+    {
+        std::ofstream out(config_path);
+        out << "security:\n  environment:\n    deny: [SSH_AUTH_SOCK, \"LD_*\"]\n";
+    }
+    Voix::Config extra_deny;
+    ASSERT_TRUE(extra_deny.load(config_path.string(), false));
+    const auto& denied = extra_deny.get_env_policy()->deny();
+    ASSERT_EQUAL(denied.size(), Voix::EnvPolicy::defaults().deny().size() + 1);
+    const char* environ_in[] = {"LD_PRELOAD=/x.so", "BASH_ENV=/x", "SSH_AUTH_SOCK=/s", "HOME=/h", nullptr};
+    auto sanitized = extra_deny.get_env_policy()->apply(environ_in, Voix::EnvPolicy::Mode::SANITIZE, {}, {});
+    ASSERT_EQUAL(sanitized.inherited.size(), 1u);
+    ASSERT_EQUAL(std::string(sanitized.inherited[0]), "HOME=/h");
+
+    {
+        std::ofstream out(config_path);
+        out << "security:\n  environment:\n    keep: [\"A=B\"]\n";
+    }
+    Voix::Config bad_policy;
+    ASSERT_TRUE(bad_policy.load(config_path.string(), false));
+    ASSERT_TRUE(!bad_policy.validate());
+
+    {
+        std::ofstream out(config_path);
+        out << "acl:\n  user:\n    root:\n      - action: permit\n        env: [\"-FOO=1\"]\n";
+    }
+    Voix::Config bad_rule;
+    ASSERT_TRUE(bad_rule.load(config_path.string(), false));
+    ASSERT_TRUE(!bad_rule.validate());
+    return true;
+}
+
+// ============================================================
+// Command resolution tests
+// ============================================================
+
+bool test_command_resolver_lookup() {
+    Voix::CommandResolver resolver("/bin:/usr/bin");
+    auto first = resolver.resolve("sh");
+    ASSERT_TRUE(first.has_value());
+    ASSERT_TRUE(first->path == "/bin/sh" || first->path == "/usr/bin/sh");
+    ASSERT_TRUE(first->fd.get() != -1);
+    auto cached = resolver.resolve("sh");
+    ASSERT_TRUE(cached.has_value());
+    ASSERT_EQUAL(cached->path, first->path);
+    ASSERT_TRUE(cached->ino == first->ino);
+    ASSERT_TRUE(!resolver.resolve("voix-no-such-command").has_value());
+    ASSERT_TRUE(!resolver.resolve("").has_value());
+    ASSERT_TRUE(!resolver.resolve("/nonexistent/binary").has_value());
+
+    // A writable file is never taken from PATH or a relative path, but an
+    // explicit absolute path only has to be a regular file.
+    auto dir = make_private_dir("voix_test_resolver");
+    { std::ofstream(dir / "tool") << "#!/bin/sh\n"; }
+    std::filesystem::permissions(dir / "tool", std::filesystem::perms::all);
+    Voix::CommandResolver untrusted(dir.string());
+    const bool from_path = untrusted.resolve("tool").has_value();
+    const bool relative = untrusted.resolve("./tool", dir.string()).has_value();
+    const bool absolute = untrusted.resolve((dir / "tool").string()).has_value();
+    std::filesystem::remove_all(dir);
+    ASSERT_TRUE(!from_path);
+    ASSERT_TRUE(!relative);
+    ASSERT_TRUE(absolute);
+
+    // A command resolved by voixd is reopened only if it is the same file.
+    Voix::ResolvedCommand remote{first->path, first->dev, first->ino, {}};
+    ASSERT_TRUE(Voix::CommandResolver::reopen(remote));
+    ASSERT_TRUE(remote.fd.get() != -1);
+    Voix::ResolvedCommand replaced{first->path, first->dev, first->ino + 1, {}};
+    ASSERT_TRUE(!Voix::CommandResolver::reopen(replaced));
+    return true;
+}
+
+bool test_authorize_uses_resolved_command() {
+    auto mock_id = std::make_shared<MockIdentity>();
+    mock_id->users = {{"alice", 1000, 1000, {1000}}, {"root", 0, 0, {0}}};
+    mock_id->current_user = "alice";
+    mock_id->current_uid = 1000;
+
+    std::filesystem::path config_path = std::filesystem::temp_directory_path() / "test_resolved.conf";
+    ScopedTempFile cleanup_guard(config_path);
+    {
+        std::ofstream out(config_path);
+        out << "core:\n  paths: [/bin, /usr/bin]\n"
+            << "acl:\n  user:\n    1000:\n      - action: permit\n        command: /bin/true\n"
+            << "security:\n  blocklist:\n    - /bin/sh\n";
+    }
+    auto config = std::make_shared<Voix::Config>();
+    ASSERT_TRUE(config->load(config_path.string(), false));
+    auto security = std::make_shared<Voix::Security>(mock_id);
+    Voix::PermissionChecker checker(security, config);
+    Voix::CommandResolver resolver(config->getPath());
+    using Verdict = Voix::AuthorizationDecision::Verdict;
+
+    // The rule names the path; the caller typed the name.
+    auto permit = Voix::authorize(*config, *security, checker, resolver, {"root", "true", {}, {}});
+    ASSERT_TRUE(permit.verdict == Verdict::PERMIT);
+    ASSERT_EQUAL(permit.context.command.path, "/bin/true");
+    ASSERT_TRUE(permit.context.command.fd.get() != -1);
+
+    // The blocklist applies to the file, whatever it is called.
+    auto by_name = Voix::authorize(*config, *security, checker, resolver, {"root", "sh", {}, {}});
+    ASSERT_TRUE(by_name.verdict == Verdict::CATASTROPHIC);
+    auto by_alias = Voix::authorize(*config, *security, checker, resolver,
+                                    {"root", "/bin/../bin/sh", {}, {}});
+    ASSERT_TRUE(by_alias.verdict == Verdict::CATASTROPHIC);
+
+    // The plan executes the authorized descriptor.
+    Voix::Command cmd;
+    auto plan = cmd.build_exec_plan("true", {}, permit.context, {}, "root");
+    ASSERT_TRUE(plan.has_value());
+    ASSERT_EQUAL(plan->path, "/bin/true");
+    ASSERT_TRUE(plan->exec_fd.get() == permit.context.command.fd.get());
+    return true;
+}
+
+// ============================================================
+// Child supervision tests
+// ============================================================
+
+// Spawns `sh -c script` with signals blocked and supervises it.
+static Voix::ChildReport supervise_script(const std::string& script, Voix::SupervisionLimits limits) {
+    Voix::ExecPlan plan;
+    plan.change_identity = false;
+    plan.path = "/bin/sh";
+    plan.argv = {"/bin/sh", "-c", script};
+    plan.assigned_env = {"PATH=/bin:/usr/bin"};
+
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    Voix::ExecFailure failure;
+    int pidfd = -1;
+    pid_t pid = Voix::spawn_exec_plan(plan, old, failure, &pidfd);
+    Voix::ChildReport report;
+    report.status = -1;
+    if (pid != -1) report = Voix::supervise_child(pid, pidfd, limits);
+    if (pidfd != -1) close(pidfd);
+    pthread_sigmask(SIG_SETMASK, &old, nullptr);
+    return report;
+}
+
+bool test_supervise_child_reports_usage() {
+    auto report = supervise_script("i=0; while [ $i -lt 20000 ]; do i=$((i+1)); done; exit 5", {});
+    ASSERT_EQUAL(report.exit_code(), 5);
+    ASSERT_TRUE(!report.timed_out);
+    ASSERT_TRUE(report.usage.ru_maxrss > 0);
+    ASSERT_TRUE(report.usage.ru_utime.tv_sec > 0 || report.usage.ru_utime.tv_usec > 0);
+    ASSERT_TRUE(report.describe().starts_with("exit=5 wall="));
+    return true;
+}
+
+bool test_supervise_child_enforces_timeout() {
+    using namespace std::chrono_literals;
+    auto start = std::chrono::steady_clock::now();
+    // The shell ignores SIGTERM, so only the SIGKILL after kill_after ends it.
+    auto report = supervise_script("trap '' TERM; while :; do :; done", {200ms, 200ms});
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_TRUE(report.timed_out);
+    ASSERT_EQUAL(report.exit_code(), 124);
+    ASSERT_TRUE(WIFSIGNALED(report.status) && WTERMSIG(report.status) == SIGKILL);
+    ASSERT_TRUE(elapsed >= 400ms && elapsed < 5s);
+    return true;
+}
+
+bool test_config_rule_timeout() {
+    std::filesystem::path config_path = std::filesystem::temp_directory_path() / "test_rule_timeout.conf";
+    ScopedTempFile cleanup_guard(config_path);
+    {
+        std::ofstream out(config_path);
+        out << "acl:\n  user:\n    root:\n      - action: permit\n        command: make\n"
+               "        timeout: 3600\n        kill_after: 30\n"
+               "      - action: permit\n        command: ls\n";
+    }
+    Voix::Config config;
+    ASSERT_TRUE(config.load(config_path.string(), false));
+    ASSERT_EQUAL(config.getRules().size(), 2u);
+    ASSERT_EQUAL(config.getRules()[0].timeout.count(), 3600);
+    ASSERT_EQUAL(config.getRules()[0].kill_after.count(), 30);
+    ASSERT_EQUAL(config.getRules()[1].timeout.count(), 0);
+    ASSERT_TRUE(config.validate());
+    ASSERT_TRUE(!Voix::Command::use_exec_in_place({}, false, config.getRules()[0].timeout));
+
+    {
+        std::ofstream out(config_path);
+        out << "acl:\n  user:\n    root:\n      - action: permit\n        timeout: -1\n";
+    }
+    Voix::Config negative;
+    ASSERT_TRUE(negative.load(config_path.string(), false));
+    ASSERT_TRUE(!negative.validate());
+    return true;
+}
+
+bool test_config_profile_cgroup() {
+    std::filesystem::path config_path = std::filesystem::temp_directory_path() / "test_profile_cgroup.conf";
+    ScopedTempFile cleanup_guard(config_path);
+    {
+        std::ofstream out(config_path);
+        out << "core:\n  cgroup_root: /sys/fs/cgroup/jobs\n"
+               "security:\n  profiles:\n    batch:\n      cgroup:\n"
+               "        cpu.max: \"50000 100000\"\n        memory.max: 2G\n        pids.max: 256\n";
+    }
+    Voix::Config config;
+    ASSERT_TRUE(config.load(config_path.string(), false));
+    ASSERT_TRUE(config.validate());
+    Voix::SecurityProfile batch = config.get_profile("batch");
+    ASSERT_EQUAL(batch.cgroup.path, std::string("/sys/fs/cgroup/jobs/batch"));
+    ASSERT_EQUAL(batch.cgroup.controls.size(), 3u);
+    ASSERT_EQUAL(batch.cgroup.controls[0].first, std::string("cpu.max"));
+    ASSERT_EQUAL(batch.cgroup.controls[0].second, std::string("50000 100000"));
+    ASSERT_EQUAL(batch.cgroup.controls[2].second, std::string("256"));
+    ASSERT_TRUE(config.get_profile("restricted").cgroup.empty());
+
+    // Only the accepted limits may be written
+    {
+        std::ofstream out(config_path);
+        out << "security:\n  profiles:\n    batch:\n      cgroup:\n        cgroup.procs: 1\n";
+    }
+    Voix::Config negative;
+    ASSERT_TRUE(!negative.load(config_path.string(), false));
+    return true;
+}
+
+bool test_prepare_cgroup_requires_cgroup2() {
+    auto dir = make_private_dir("voix_test_cgroup");
+    Voix::CgroupLimits limits{(dir / "batch").string(), {{"pids.max", "16"}}};
+    ASSERT_TRUE(!Voix::prepare_cgroup(limits));
+    ASSERT_TRUE(!std::filesystem::exists(dir / "batch"));
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_process_tuning_parsing() {
+    auto cpus = Voix::parse_cpu_list("8,0-2\n");
+    ASSERT_TRUE(cpus.has_value());
+    ASSERT_EQUAL(cpus->size(), 4u);
+    ASSERT_EQUAL((*cpus)[0], 0u);
+    ASSERT_EQUAL((*cpus)[3], 8u);
+    ASSERT_TRUE(Voix::parse_cpu_list("").has_value());
+    ASSERT_TRUE(!Voix::parse_cpu_list("3-1").has_value());
+    ASSERT_TRUE(!Voix::parse_cpu_list("0,x").has_value());
+    ASSERT_TRUE(!Voix::parse_cpu_list("99999").has_value());
+
+    ASSERT_TRUE(Voix::parse_rlimit_resource("nofile") == RLIMIT_NOFILE);
+    ASSERT_TRUE(!Voix::parse_rlimit_resource("files").has_value());
+    ASSERT_TRUE(Voix::parse_rlimit_value("unlimited") == RLIM_INFINITY);
+    ASSERT_TRUE(Voix::parse_rlimit_value("4096") == rlim_t{4096});
+    ASSERT_TRUE(!Voix::parse_rlimit_value("-1").has_value());
+
+    Voix::ProcessTuning tuning;
+    tuning.sched_policy = Voix::SchedPolicy::BATCH;
+    tuning.io_class = Voix::IoClass::BEST_EFFORT;
+    tuning.io_level = 7;
+    tuning.cpus = {0};
+    auto kernel = Voix::compile_tuning(tuning);
+    ASSERT_TRUE(kernel.has_value());
+    ASSERT_EQUAL(kernel->sched_policy, SCHED_BATCH);
+    ASSERT_EQUAL(kernel->ioprio, (2 << 13) | 7);
+    ASSERT_TRUE(kernel->affinity.has_value() && CPU_ISSET(0, &*kernel->affinity));
+    ASSERT_TRUE(kernel->nodemask.empty());
+
+    tuning.numa_node = 4095;
+    ASSERT_TRUE(!Voix::compile_tuning(tuning).has_value());
+    return true;
+}
+
+bool test_config_profile_tuning() {
+    std::filesystem::path config_path = std::filesystem::temp_directory_path() / "test_profile_tuning.conf";
+    ScopedTempFile cleanup_guard(config_path);
+    {
+        std::ofstream out(config_path);
+        out << "security:\n  profiles:\n    batch:\n      nice: 10\n      sched_policy: idle\n"
+               "      ioprio:\n        class: idle\n      cpu_affinity: \"0\"\n"
+               "      rlimits:\n        nofile: [256, 512]\n        as: unlimited\n";
+    }
+    Voix::Config config;
+    ASSERT_TRUE(config.load(config_path.string(), false));
+    const Voix::ProcessTuning tuning = config.get_profile("batch").tuning;
+    ASSERT_TRUE(tuning.nice == 10);
+    ASSERT_TRUE(tuning.sched_policy == Voix::SchedPolicy::IDLE);
+    ASSERT_TRUE(tuning.io_class == Voix::IoClass::IDLE);
+    ASSERT_EQUAL(tuning.cpus.size(), 1u);
+    ASSERT_EQUAL(tuning.rlimits.size(), 2u);
+    ASSERT_TRUE(tuning.rlimits[0].resource == RLIMIT_NOFILE);
+    ASSERT_EQUAL(tuning.rlimits[0].limit.rlim_cur, rlim_t{256});
+    ASSERT_EQUAL(tuning.rlimits[0].limit.rlim_max, rlim_t{512});
+    ASSERT_TRUE(tuning.rlimits[1].limit.rlim_max == RLIM_INFINITY);
+    ASSERT_TRUE(!config.get_profile("restricted").tuning.nice.has_value());
+
+    for (const char* bad : {"      nice: 30\n", "      sched_policy: fifo\n",
+                            "      rlimits:\n        nofile: [512, 256]\n"}) {
+        {
+            std::ofstream out(config_path);
+            out << "security:\n  profiles:\n    batch:\n" << bad;
+        }
+        Voix::Config negative;
+        ASSERT_TRUE(!negative.load(config_path.string(), false));
+    }
+    return true;
+}
+
+bool test_spawn_exec_plan_applies_tuning() {
+    Voix::ExecPlan plan;
+    plan.change_identity = false;
+    plan.path = "/bin/sh";
+    // Field 19 of /proc/<pid>/stat is the nice value, field 41 the policy.
+    plan.argv = {"/bin/sh", "-c",
+                 "set -- $(cat /proc/self/stat); [ \"${19}\" = 7 ] && [ \"${41}\" = 3 ] && "
+                 "grep -q '^Cpus_allowed_list:[[:space:]]*0$' /proc/self/status"};
+    plan.assigned_env = {"PATH=/bin:/usr/bin"};
+    Voix::ProcessTuning tuning;
+    tuning.nice = 7;
+    tuning.sched_policy = Voix::SchedPolicy::BATCH;
+    tuning.io_class = Voix::IoClass::BEST_EFFORT;
+    tuning.cpus = {0};
+    plan.tuning = *Voix::compile_tuning(tuning);
+
+    Voix::ExecFailure failure;
+    ASSERT_EQUAL(run_plan(plan, failure), 0);
+    ASSERT_TRUE(failure.stage == Voix::ExecStage::NONE);
+    return true;
+}
+
+bool test_audit_store_append_and_query() {
+    auto dir = make_private_dir("voix_test_audit");
+    // A tiny segment size rolls a segment over every few records
+    Voix::AuditStore store(dir.string(), 512, getuid());
+
+    const char* commands[] = {"/usr/bin/ls", "/usr/bin/rm", "/usr/bin/systemctl"};
+    for (int i = 0; i < 30; ++i) {
+        Voix::AuditRecord record;
+        record.time = 1'000'000 + i * 60;
+        record.caller_uid = 1000 + static_cast<uid_t>(i % 2);
+        record.caller = i % 2 ? "bob" : "alice";
+        record.target = i % 3 ? "root" : "www-data";
+        record.command = commands[i % 3];
+        record.args = {"-x", "say \"hi\"\n"};
+        record.verdict = i % 5 ? "permit" : "deny";
+        record.cwd = "/home";
+        ASSERT_TRUE(store.append(record));
+    }
+    auto has_file = [&](std::string_view extension) {
+        return std::ranges::any_of(std::filesystem::directory_iterator(dir), [&](const auto& entry) {
+            return entry.path().stem() != "current" && entry.path().extension() == extension;
+        });
+    };
+    ASSERT_TRUE(has_file(".idx"));
+    // Appending only rolls segments over; sealing is left to the query side.
+    ASSERT_TRUE(!has_file(".seg"));
+
+    auto count = [&](const std::string& expr) -> size_t {
+        std::string error;
+        auto query = Voix::AuditStore::parse_query(expr, 1'000'000 + 30 * 60, error);
+        if (!query) return SIZE_MAX;
+        std::vector<std::string> lines;
+        auto n = store.query(*query, [&](std::string_view line) { lines.emplace_back(line); });
+        return n && *n == lines.size() ? *n : SIZE_MAX;
+    };
+    ASSERT_EQUAL(count("target=www-data"), 10u);
+    ASSERT_TRUE(store.seal_pending() > 0);
+    ASSERT_EQUAL(store.seal_pending(), 0u);
+#ifdef VOIX_WITH_ZLIB
+    ASSERT_TRUE(has_file(".seg"));
+#endif
+    ASSERT_EQUAL(count(""), 30u);
+    ASSERT_EQUAL(count("user=1001"), 15u);
+    ASSERT_EQUAL(count("target=www-data"), 10u);
+    ASSERT_EQUAL(count("command=rm"), 10u);
+    ASSERT_EQUAL(count("command=/usr/bin/rm user=1000"), 5u);
+    ASSERT_EQUAL(count("since=@1000600 until=@1001200"), 10u);
+    ASSERT_EQUAL(count("since=5m"), 5u);
+    ASSERT_EQUAL(count("command=/bin/rm"), 0u);
+
+    // Records round-trip as JSON lines with escaped arguments
+    std::string first;
+    Voix::AuditQuery query;
+    query.until = 1'000'001;
+    store.query(query, [&](std::string_view line) { first = line; });
+    ASSERT_TRUE(first.find("\"command\":\"/usr/bin/ls\"") != std::string::npos);
+    ASSERT_TRUE(first.find("\"say \\\"hi\\\"\\u000a\"") != std::string::npos);
+    ASSERT_TRUE(first.find("\"verdict\":\"deny\"") != std::string::npos);
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_audit_store_rollover_skips_orphans() {
+    auto dir = make_private_dir("voix_test_audit_orphans");
+    Voix::AuditStore store(dir.string(), 512, getuid());
+    // A segment whose index never made it must not be renamed over.
+    { std::ofstream(dir / "0000000000000007.log") << "orphan\n"; }
+
+    Voix::AuditRecord record;
+    record.time = 1'000'000;
+    record.caller = "alice";
+    record.target = "root";
+    record.command = "/usr/bin/ls";
+    record.verdict = "permit";
+    bool appended = true;
+    for (int i = 0; i < 8; ++i) appended = appended && store.append(record);
+
+    std::string orphan;
+    std::getline(std::ifstream(dir / "0000000000000007.log"), orphan);
+    const bool next_sealed = std::filesystem::exists(dir / "0000000000000008.idx");
+
+    // Rolling over without an active index still moves the log aside.
+    std::filesystem::remove(dir / "current.idx");
+    for (int i = 0; i < 8; ++i) appended = appended && store.append(record);
+    const bool unindexed_sealed = std::filesystem::exists(dir / "0000000000000009.log") ||
+                                  std::filesystem::exists(dir / "0000000000000009.idx");
+    std::filesystem::remove_all(dir);
+
+    ASSERT_TRUE(appended);
+    ASSERT_EQUAL(orphan, std::string("orphan"));
+    ASSERT_TRUE(next_sealed);
+    ASSERT_TRUE(unindexed_sealed);
+    return true;
+}
+
+bool test_audit_store_torn_index_header() {
+    auto dir = make_private_dir("voix_test_audit_torn");
+    Voix::AuditStore store(dir.string(), 1 << 20, getuid());
+    // A crash while the header was being written leaves fewer bytes than it.
+    { std::ofstream(dir / "current.idx") << "VOIX"; }
+
+    Voix::AuditRecord record;
+    record.time = 1'000'000;
+    record.caller = "alice";
+    record.target = "root";
+    record.command = "/usr/bin/ls";
+    record.verdict = "permit";
+    const bool appended = store.append(record) && store.append(record);
+    auto matches = store.query({}, [](std::string_view) {});
+    std::filesystem::remove_all(dir);
+
+    ASSERT_TRUE(appended);
+    ASSERT_TRUE(matches == std::optional<size_t>(2));
+    return true;
+}
+
+bool test_audit_query_parsing() {
+    std::string error;
+    auto q = Voix::AuditStore::parse_query("since=2026-01-02 until=2026-01-02T12:00:00 user=0 target=root",
+                                           0, error);
+    ASSERT_TRUE(q.has_value());
+    ASSERT_EQUAL(*q->since, static_cast<std::int64_t>(1767312000));
+    ASSERT_EQUAL(*q->until, static_cast<std::int64_t>(1767312000 + 12 * 3600));
+    ASSERT_EQUAL(*q->caller_uid, 0u);
+    ASSERT_EQUAL(*q->target, std::string("root"));
+
+    q = Voix::AuditStore::parse_query("since=7d", 1'000'000, error);
+    ASSERT_TRUE(q.has_value());
+    ASSERT_EQUAL(*q->since, static_cast<std::int64_t>(1'000'000 - 7 * 86400));
+
+    ASSERT_TRUE(!Voix::AuditStore::parse_query("since=yesterday", 0, error));
+    ASSERT_TRUE(!Voix::AuditStore::parse_query("colour=red", 0, error));
+    ASSERT_TRUE(!Voix::AuditStore::parse_query("user=no-such-user-voix", 0, error));
+    return true;
+}
+
+bool test_config_audit_store() {
+    std::filesystem::path config_path = std::filesystem::temp_directory_path() / "test_audit_store.conf";
+    ScopedTempFile cleanup_guard(config_path);
+    {
+        std::ofstream out(config_path);
+        out << "core:\n  audit_dir: /var/lib/voix/audit\n  audit_segment_mb: 8\n";
+    }
+    Voix::Config config;
+    ASSERT_TRUE(config.load(config_path.string(), false));
+    ASSERT_TRUE(config.validate());
+    ASSERT_EQUAL(config.get_audit_dir(), std::string("/var/lib/voix/audit"));
+    ASSERT_EQUAL(config.get_audit_segment_size(), static_cast<std::uint64_t>(8) << 20);
+    ASSERT_EQUAL(config.get_audit_sinks(), static_cast<unsigned>(Voix::AuditPipeline::SINK_FILE |
+                                                                Voix::AuditPipeline::SINK_SYSLOG));
+
+    // A relative directory is rejected; an empty one disables the store
+    {
+        std::ofstream out(config_path);
+        out << "core:\n  audit_dir: audit\n";
+    }
+    Voix::Config relative;
+    ASSERT_TRUE(relative.load(config_path.string(), false));
+    ASSERT_TRUE(!relative.validate());
+
+    {
+        std::ofstream out(config_path);
+        out << "core:\n  audit_sinks: [journald, file]\n";
+    }
+    Voix::Config sinks;
+    ASSERT_TRUE(sinks.load(config_path.string(), false));
+    ASSERT_EQUAL(sinks.get_audit_sinks(), static_cast<unsigned>(Voix::AuditPipeline::SINK_JOURNALD |
+                                                               Voix::AuditPipeline::SINK_FILE));
+    {
+        std::ofstream out(config_path);
+        out << "core:\n  audit_sinks: [kafka]\n";
+    }
+    Voix::Config unknown;
+    ASSERT_TRUE(!unknown.load(config_path.string(), false));
+    return true;
+}
+
+bool test_audit_pipeline_journald_sink() {
+    auto dir = make_private_dir("voix_test_journal");
+    std::string socket_path = (dir / "socket").string();
+    int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    ASSERT_TRUE(fd != -1);
+    struct sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    ASSERT_TRUE(bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0);
+
+    Voix::AuditEvent event;
+    event.outcome = "deny";
+    event.caller_uid = 1000;
+    event.caller = "alice";
+    event.target = "root";
+    event.command = "/usr/bin/rm";
+    event.args = {"-rf", "two\nlines"};
+    Voix::AuditPipeline(Voix::AuditPipeline::SINK_JOURNALD, {}, 0, socket_path).emit(event);
+
+    char buf[4096];
+    ssize_t n = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+    close(fd);
+    std::filesystem::remove_all(dir);
+    ASSERT_TRUE(n > 0);
+    std::string entry(buf, static_cast<size_t>(n));
+    ASSERT_EQUAL(entry, Voix::AuditPipeline::journal_entry(event, Voix::AuditPipeline::message(event)));
+    ASSERT_TRUE(entry.find("MESSAGE=[alice] Command not permitted: /usr/bin/rm as root\n") != std::string::npos);
+    ASSERT_TRUE(entry.find("PRIORITY=5\n") != std::string::npos);
+    ASSERT_TRUE(entry.find("VOIX_OUTCOME=deny\n") != std::string::npos);
+    ASSERT_TRUE(entry.find("VOIX_ARG=-rf\n") != std::string::npos);
+    // Values containing newlines use the length-prefixed binary form
+    ASSERT_TRUE(entry.find(std::string("VOIX_ARG\n\x09\0\0\0\0\0\0\0two\nlines\n", 23)) != std::string::npos);
+
+    // A permit carries its authentication and profile in the one record
+    event.outcome = "permit";
+    event.detail = "auth=pam profile=default";
+    ASSERT_EQUAL(Voix::AuditPipeline::message(event),
+                 std::string("[alice] Command permitted: /usr/bin/rm as root (auth=pam profile=default)"));
+    return true;
+}
+
+bool test_glob_match() {
+    ASSERT_TRUE(Voix::glob_match("*", ""));
+    ASSERT_TRUE(Voix::glob_match("*.log", "/var/log/app.log"));
+    ASSERT_TRUE(Voix::glob_match("a?c*z", "abcxyz"));
+    ASSERT_TRUE(Voix::glob_match("*a*b", "xxaxxab"));
+    ASSERT_TRUE(!Voix::glob_match("*a*b", "xxaxxa"));
+    ASSERT_TRUE(!Voix::glob_match("a?", "a"));
+    ASSERT_TRUE(!Voix::glob_match("[ab]", "a"));
+    ASSERT_TRUE(Voix::glob_match("[ab]", "[ab]"));
+    // Wildcards do not cross a line break; a backslash is an ordinary character
+    ASSERT_TRUE(!Voix::glob_match("*", "a\nb"));
+    ASSERT_TRUE(!Voix::glob_match("a?b", "a\rb"));
+    ASSERT_TRUE(Voix::glob_match("a\n*", "a\nb"));
+    ASSERT_TRUE(Voix::glob_match("\\d*", "\\dir"));
+    ASSERT_TRUE(!Voix::glob_match("\\d", "7"));
+    ASSERT_TRUE(!Voix::glob_intersect("a?", "a\r").has_value());
+    return true;
+}
+
+bool test_policy_analyzer_shadowed_rules() {
+    std::filesystem::path config_path = std::filesystem::temp_directory_path() / "test_shadowed_rules.conf";
+    ScopedTempFile cleanup_guard(config_path);
+    {
+        std::ofstream out(config_path);
+        out << "acl:\n  user:\n    root:\n"
+               "      - {action: permit, command: ls}\n"                              // 1
+               "      - {action: permit, command: ls, args: [-l]}\n"                  // 2: by 1
+               "      - {action: permit, command: cp, args: ['*', /tmp/x]}\n"         // 3
+               "      - {action: permit, command: cp, args: [a.txt, /tmp/x]}\n"       // 4: by 3
+               "      - {action: deny, command: cp, args: [b, /tmp/y]}\n"             // 5
+               "      - {action: deny, command: ls, target: nobody}\n"                // 6
+               "      - {action: permit, command: vim}\n"                             // 7
+               "      - {action: permit, command: vim}\n"                             // 8: duplicate of 7
+               "      - {action: deny, command: vim}\n"                               // 9: by 7
+               "      - {action: permit, target: nobody}\n"                           // 10
+               "      - {action: permit, command: id, target: nobody}\n";             // 11: by 10
+    }
+    Voix::Config config;
+    ASSERT_TRUE(config.load(config_path.string(), false));
+    Voix::PolicyAnalyzer analyzer(config);
+    auto shadowed = analyzer.find_shadowed_rules();
+    ASSERT_EQUAL(shadowed.size(), 5u);
+    const size_t expected[][2] = {{1, 0}, {3, 2}, {7, 6}, {8, 6}, {10, 9}};
+    for (size_t i = 0; i < shadowed.size(); ++i) {
+        ASSERT_EQUAL(shadowed[i].rule, expected[i][0]);
+        ASSERT_EQUAL(shadowed[i].shadowed_by, expected[i][1]);
+        ASSERT_EQUAL(shadowed[i].redundant, shadowed[i].rule == 7);
+    }
+
+    auto findings = analyzer.analyze();
+    bool deny_error = std::ranges::any_of(findings, [](const auto& f) {
+        return f.severity == Voix::PolicyFinding::Severity::ERROR &&
+               f.message.contains("position 9 never takes effect");
+    });
+    ASSERT_TRUE(deny_error);
+    return true;
+}
+
+bool test_policy_diff() {
+    std::filesystem::path old_path = std::filesystem::temp_directory_path() / "test_policy_diff_old.conf";
+    std::filesystem::path new_path = std::filesystem::temp_directory_path() / "test_policy_diff_new.conf";
+    ScopedTempFile old_guard(old_path);
+    ScopedTempFile new_guard(new_path);
+    {
+        std::ofstream out(old_path);
+        out << "profiles:\n  jobs:\n    - {action: permit, command: make, profile: batch}\n"
+               "acl:\n  user:\n    root:\n"
+               "      - {action: permit, command: ls}\n"
+               "      - {action: permit, command: vim, options: [nopass]}\n"
+               "      - {action: permit, command: cp, args: [a, b]}\n"
+               "      - profile: jobs\n";
+    }
+    {
+        std::ofstream out(new_path);
+        out << "profiles:\n  jobs:\n    - {action: permit, command: make}\n"
+               "acl:\n  user:\n    root:\n"
+               "      - {action: deny, command: ls, args: [/root]}\n"
+               "      - {action: permit, command: ls}\n"
+               "      - {action: permit, command: vim, options: [persist]}\n"
+               "      - {action: permit, command: cp, args: ['*', b]}\n"
+               "      - profile: jobs\n"
+               "      - {action: permit, command: id, target: nobody}\n";
+    }
+    Voix::Config before, after;
+    ASSERT_TRUE(before.load(old_path.string(), false));
+    ASSERT_TRUE(after.load(new_path.string(), false));
+
+    ASSERT_TRUE(Voix::diff_policies(before, before).empty());
+    auto changes = Voix::diff_policies(before, after, 2);
+    ASSERT_EQUAL(changes.size(), 5u);
+    using Kind = Voix::PolicyChange::Kind;
+    auto has = [&](Kind kind, std::string_view target, std::string_view command, std::string_view args) {
+        return std::ranges::any_of(changes, [&](const auto& c) {
+            return c.kind == kind && c.principal == "root" && c.target == target && c.command == command &&
+                   c.args == args;
+        });
+    };
+    ASSERT_TRUE(has(Kind::REMOVED_GRANT, "root", "ls", "/root"));
+    ASSERT_TRUE(has(Kind::ADDED_GRANT, "root", "cp", "* b"));
+    ASSERT_TRUE(has(Kind::AUTH_CHANGED, "root", "vim", "*"));
+    ASSERT_TRUE(has(Kind::PROFILE_CHANGED, "root", "make", "*"));
+    ASSERT_TRUE(has(Kind::ADDED_GRANT, "nobody", "id", "*"));
+    for (const auto& c : changes) ASSERT_EQUAL(c.approximate, c.command == "cp");
+
+    // A bare name and the path it resolves to are one command.
+    {
+        std::ofstream(old_path) << "acl:\n  user:\n    root:\n"
+                                   "      - {action: deny, command: rm}\n"
+                                   "      - {action: permit}\n";
+        std::ofstream(new_path) << "acl:\n  user:\n    root:\n"
+                                   "      - {action: deny, command: /usr/bin/rm}\n"
+                                   "      - {action: permit}\n";
+    }
+    Voix::Config bare, path;
+    ASSERT_TRUE(bare.load(old_path.string(), false));
+    ASSERT_TRUE(path.load(new_path.string(), false));
+    ASSERT_TRUE(Voix::diff_policies(bare, path).empty());
+    return true;
+}
+
+static const char* k_reorder_policy =
+    "acl:\n  user:\n    root:\n"
+    "      - {action: permit, command: ls}\n"
+    "      - {action: permit, command: cp, args: [a, b]}\n"
+    "      - {action: deny, command: cp, args: ['*', c]}\n"
+    "      - {action: permit, command: /usr/bin/id}\n"
+    "      - {action: permit, command: cp, args: [x, c]}\n"
+    "      - {action: permit, command: /bin/ls}\n";
+
+bool test_rule_hit_counters() {
+    auto dir = make_private_dir("voix_test_rule_hits");
+    std::filesystem::path config_path = dir / "voix.conf";
+    {
+        std::ofstream out(config_path);
+        out << k_reorder_policy;
+    }
+    auto config = std::make_shared<Voix::Config>();
+    ASSERT_TRUE(config->load(config_path.string(), false));
+    const auto path = (dir / "voix-rule-hits").string();
+
+    ASSERT_TRUE(!Voix::RuleHitCounters::open(path, config->getRules(), false, getuid()));
+    std::shared_ptr<Voix::RuleHitCounters> counters =
+        Voix::RuleHitCounters::open(path, config->getRules(), true, getuid());
+    ASSERT_TRUE(counters != nullptr);
+
+    auto mock_id = std::make_shared<MockIdentity>();
+    mock_id->users = {{"root", 0, 0, {0}}};
+    mock_id->current_user = "root";
+    mock_id->current_uid = 0;
+    mock_id->current_groups = {0};
+    Voix::PermissionChecker checker(std::make_shared<Voix::Security>(mock_id), config);
+    checker.set_hit_counters(counters);
+    ASSERT_TRUE(checker.permit("/usr/bin/id", {}, 0).has_value());
+    ASSERT_TRUE(checker.permit("/usr/bin/id", {}, 0).has_value());
+    ASSERT_TRUE(!checker.permit("cp", {"z", "c"}, 0).has_value());  // first match is the deny
+    ASSERT_TRUE(!checker.permit("rm", {}, 0).has_value());           // no match, not counted
+
+    // Another process mapping the same file sees the same counters.
+    auto again = Voix::RuleHitCounters::open(path, config->getRules(), false, getuid());
+    ASSERT_TRUE(again != nullptr);
+    ASSERT_TRUE(again->counts() == (std::vector<std::uint64_t>{0, 0, 1, 2, 0, 0}));
+
+    // A changed policy starts from zero.
+    auto rules = config->getRules();
+    rules.pop_back();
+    ASSERT_TRUE(!Voix::RuleHitCounters::open(path, rules, false, getuid()));
+    auto fresh = Voix::RuleHitCounters::open(path, rules, true, getuid());
+    ASSERT_TRUE(fresh != nullptr);
+    ASSERT_TRUE(fresh->counts() == std::vector<std::uint64_t>(5, 0));
+    // The old mapping stays valid.
+    counters->hit(3);
+    ASSERT_EQUAL(counters->counts()[3], 3u);
+
+    std::filesystem::permissions(path, std::filesystem::perms::group_read, std::filesystem::perm_options::add);
+    ASSERT_TRUE(!Voix::RuleHitCounters::open(path, rules, true, getuid()));
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_policy_analyzer_reorderings() {
+    std::filesystem::path config_path = std::filesystem::temp_directory_path() / "test_reorderings.conf";
+    ScopedTempFile cleanup_guard(config_path);
+    {
+        std::ofstream out(config_path);
+        out << k_reorder_policy;
+    }
+    Voix::Config config;
+    ASSERT_TRUE(config.load(config_path.string(), false));
+    Voix::PolicyAnalyzer analyzer(config);
+
+    // Rule 4 (cp x c) is hot but rule 2 (cp * c) matches its requests first;
+    // rule 5 (/bin/ls) cannot pass rule 0 (ls), which may resolve to it.
+    auto moves = analyzer.suggest_reorderings({1, 0, 2, 50, 40, 30});
+    ASSERT_EQUAL(moves.size(), 3u);
+    ASSERT_EQUAL(moves[0].rule, 3u);
+    ASSERT_EQUAL(moves[0].move_before, 0u);
+    ASSERT_EQUAL(moves[0].saved, 147u);
+    ASSERT_EQUAL(moves[1].rule, 5u);
+    ASSERT_EQUAL(moves[1].move_before, 1u);
+    ASSERT_EQUAL(moves[1].saved, 28u);
+    ASSERT_EQUAL(moves[2].rule, 2u);  // cp * c never matches what cp a b does
+    ASSERT_EQUAL(moves[2].move_before, 0u);
+    ASSERT_EQUAL(moves[2].saved, 3u);
+
+    ASSERT_TRUE(analyzer.suggest_reorderings({1, 2, 3}).empty());  // counts for another policy
+    return true;
+}
+
+bool test_thread_pool() {
+    Voix::ThreadPool pool(4);
+    ASSERT_EQUAL(pool.size(), 4u);
+
+    // Tasks fanning out from workers land on their own deques and get stolen.
+    std::atomic<int> sum{0};
+    std::vector<std::future<std::vector<std::future<void>>>> parents;
+    for (int i = 0; i < 16; ++i) {
+        parents.push_back(pool.submit([&pool, &sum, i] {
+            std::vector<std::future<void>> children;
+            for (int j = 0; j < 64; ++j) {
+                children.push_back(pool.submit([&sum, i, j] { sum += i * 64 + j; }));
+            }
+            return children;
+        }));
+    }
+    for (auto& parent : parents) {
+        for (auto& child : parent.get()) child.get();
+    }
+    ASSERT_EQUAL(sum.load(), 1024 * 1023 / 2);
+
+    auto failing = pool.submit([]() -> int { throw std::runtime_error("task failed"); });
+    bool thrown = false;
+    try {
+        failing.get();
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    ASSERT_TRUE(thrown);
+
+    // Queued work still runs when the pool is destroyed.
+    std::atomic<int> ran{0};
+    {
+        Voix::ThreadPool small(1);
+        for (int i = 0; i < 100; ++i) small.submit([&ran] { ++ran; });
+    }
+    ASSERT_EQUAL(ran.load(), 100);
+    return true;
+}
+
+class MarkerCheck final : public Voix::IPolicyCheck {
+public:
+    std::string_view name() const override { return "test-marker"; }
+    void run(const Voix::Config& config, std::vector<Voix::PolicyFinding>& findings) const override {
+        for (const auto& rule : config.getRules()) {
+            if (rule.cmd == "voix-test-marker") {
+                findings.push_back({Voix::PolicyFinding::Severity::ERROR, "marker rule found"});
+            }
+        }
+    }
+};
+
+bool test_check_configs() {
+    auto dir = make_private_dir("voix_test_check_configs");
+    std::vector<std::string> paths;
+    for (int i = 0; i < 6; ++i) {
+        auto path = dir / std::format("host{}.conf", i);
+        std::ofstream out(path);
+        if (i == 3) {
+            out << "acl: [unterminated\n";
+        } else {
+            out << "acl:\n  user:\n    root:\n      - {action: permit, command: ls}\n";
+            if (i % 2) out << "      - {action: permit, command: ls}\n";
+            if (i == 4) out << "      - {action: permit, command: voix-test-marker}\n";
+        }
+        paths.push_back(path.string());
+    }
+    Voix::register_policy_check(std::make_shared<MarkerCheck>());
+    ASSERT_EQUAL(Voix::policy_checks().back()->name(), std::string_view("test-marker"));
+
+    Voix::ThreadPool pool(3);
+    auto reports = Voix::check_configs(paths, pool, false);
+    ASSERT_EQUAL(reports.size(), paths.size());
+    for (size_t i = 0; i < reports.size(); ++i) {
+        ASSERT_EQUAL(reports[i].path, paths[i]);
+        ASSERT_EQUAL(reports[i].valid, i != 3);
+        if (!reports[i].valid) continue;
+        // Same findings, in the same order, as the serial analysis.
+        Voix::Config config;
+        ASSERT_TRUE(config.load(paths[i], false));
+        auto serial = Voix::PolicyAnalyzer(config).analyze();
+        ASSERT_EQUAL(reports[i].findings.size(), serial.size());
+        for (size_t k = 0; k < serial.size(); ++k) {
+            ASSERT_EQUAL(reports[i].findings[k].message, serial[k].message);
+        }
+    }
+    ASSERT_EQUAL(reports[4].findings.back().message, std::string("marker rule found"));
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_glob_intersect() {
+    const std::pair<std::string_view, std::string_view> overlapping[] = {
+        {"/etc/*", "/etc/ssh/*"}, {"a*b", "*c*"}, {"*x*y*", "*y*x*"}, {"??", "*"}, {"a?c", "abc"},
+    };
+    for (const auto& [a, b] : overlapping) {
+        auto witness = Voix::glob_intersect(a, b);
+        ASSERT_TRUE(witness.has_value());
+        ASSERT_TRUE(Voix::glob_match(a, *witness));
+        ASSERT_TRUE(Voix::glob_match(b, *witness));
+    }
+    ASSERT_EQUAL(*Voix::glob_intersect("/etc/*", "/etc/ssh/*"), std::string("/etc/ssh/"));
+    ASSERT_EQUAL(*Voix::glob_intersect("??", "*"), std::string("xx"));
+
+    const std::pair<std::string_view, std::string_view> disjoint[] = {
+        {"*.conf", "*.txt"}, {"abc*", "ab"}, {"a?c", "a\nc"}, {"a*", "a\n"}, {"/srv/*", "/tmp/*"},
+        {"*a*b", "*c"},
+    };
+    for (const auto& [a, b] : disjoint) {
+        ASSERT_TRUE(!Voix::glob_intersect(a, b).has_value());
+    }
+    return true;
+}
+
+bool test_policy_analyzer_conflicting_rules() {
+    std::filesystem::path config_path = std::filesystem::temp_directory_path() / "test_conflicting_rules.conf";
+    ScopedTempFile cleanup_guard(config_path);
+    {
+        std::ofstream out(config_path);
+        out << "acl:\n  user:\n    root:\n"
+               "      - {action: deny, command: cat, args: ['/etc/*']}\n"               // 1
+               "      - {action: permit, command: /usr/bin/cat, args: ['/etc/ssh/*']}\n" // 2: partly by 1
+               "      - {action: permit, command: cp, args: ['*', '/tmp/*']}\n"          // 3
+               "      - {action: deny, command: cp, args: ['/etc/*', '*']}\n"            // 4: partly by 3
+               "      - {action: deny, command: cp, args: ['*.key', '/srv/*']}\n"        // 5: disjoint from 3
+               "      - {action: permit, command: id, target: nobody}\n"                 // 6
+               "      - {action: deny, target: nobody}\n"                                // 7: partly by 6
+               "      - {action: permit, command: ls, args: [-l]}\n"                     // 8
+               "      - {action: deny, command: ls, args: [-a]}\n";                      // 9
+    }
+    Voix::Config config;
+    ASSERT_TRUE(config.load(config_path.string(), false));
+    Voix::PolicyAnalyzer analyzer(config);
+    auto conflicts = analyzer.find_conflicting_rules();
+    ASSERT_EQUAL(conflicts.size(), 3u);
+    ASSERT_EQUAL(conflicts[0].earlier, 0u);
+    ASSERT_EQUAL(conflicts[0].later, 1u);
+    ASSERT_EQUAL(conflicts[0].witness, std::string("root as root: /usr/bin/cat /etc/ssh/"));
+    ASSERT_EQUAL(conflicts[1].earlier, 2u);
+    ASSERT_EQUAL(conflicts[1].later, 3u);
+    ASSERT_EQUAL(conflicts[1].witness, std::string("root as root: cp /etc/ /tmp/"));
+    ASSERT_EQUAL(conflicts[2].earlier, 5u);
+    ASSERT_EQUAL(conflicts[2].later, 6u);
+    ASSERT_EQUAL(conflicts[2].witness, std::string("root as nobody: id"));
+
+    auto findings = analyzer.analyze();
+    bool bypassed = std::ranges::any_of(findings, [](const auto& f) {
+        return f.severity == Voix::PolicyFinding::Severity::ERROR &&
+               f.message.contains("Deny rule at position 4 is bypassed") && f.message.contains("cp /etc/ /tmp/");
+    });
+    ASSERT_TRUE(bypassed);
+    return true;
+}
+
+// Runs Trace::flush() with stderr sent to a file and returns what it wrote.
+std::string flushed_trace() {
+    ScopedTempFile out(std::filesystem::temp_directory_path() / std::format("voix_trace_{}", getpid()));
+    int fd = open(out.path().c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    int saved = dup(STDERR_FILENO);
+    dup2(fd, STDERR_FILENO);
+    Voix::Trace::flush();
+    dup2(saved, STDERR_FILENO);
+    close(saved);
+    close(fd);
+    std::ifstream in(out.path());
+    return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+bool test_trace() {
+    Voix::Trace::Format format;
+    ASSERT_TRUE(Voix::Trace::parse_format("", format) && format == Voix::Trace::Format::TABLE);
+    ASSERT_TRUE(Voix::Trace::parse_format("json", format) && format == Voix::Trace::Format::JSON);
+    ASSERT_TRUE(!Voix::Trace::parse_format("xml", format));
+
+    // Disabled: nothing is recorded or written.
+    ASSERT_TRUE(!Voix::Trace::enabled());
+    { Voix::Trace::Span span("ignored"); }
+    ASSERT_TRUE(flushed_trace().empty());
+
+    Voix::Trace::enable(Voix::Trace::Format::TABLE);
+    {
+        Voix::Trace::Span outer("outer stage");
+        Voix::Trace::Span inner("inner stage");
+        inner.note("rule 2 of 9 (permit)");
+    }
+    Voix::Trace::mark("exec", "/usr/bin/true");
+    std::string table = flushed_trace();
+    ASSERT_TRUE(!Voix::Trace::enabled());
+    // Stages appear in the order they started, not the order they ended.
+    ASSERT_TRUE(table.find("outer stage") < table.find("inner stage"));
+    ASSERT_TRUE(table.find("rule 2 of 9 (permit)") != std::string::npos);
+    ASSERT_TRUE(table.find("exec") != std::string::npos);
+    ASSERT_TRUE(table.find("total") != std::string::npos);
+    ASSERT_TRUE(flushed_trace().empty());
+
+    Voix::Trace::enable(Voix::Trace::Format::JSON);
+    {
+        Voix::Trace::Span span("config load");
+        span.note("/etc/\"voix\".conf");
+    }
+    std::string json = flushed_trace();
+    ASSERT_TRUE(json.starts_with("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    ASSERT_TRUE(json.find("{\"name\":\"config load\",\"cat\":\"voix\",\"ph\":\"X\"") != std::string::npos);
+    ASSERT_TRUE(json.find("\"args\":{\"detail\":\"/etc/\\\"voix\\\".conf\"}") != std::string::npos);
+    return true;
+}
+
+bool test_probe_request_ids() {
+    const std::uint64_t first = Voix::probes::begin_request();
+    ASSERT_EQUAL(first >> 32, static_cast<std::uint64_t>(getpid()));
+    ASSERT_EQUAL(Voix::probes::current_request(), first);
+    const std::uint64_t second = Voix::probes::begin_request();
+    ASSERT_TRUE(second != first);
+    ASSERT_EQUAL(second >> 32, first >> 32);
+
+    // Each thread has its own current request.
+    std::uint64_t other = 0;
+    std::thread([&] { other = Voix::probes::current_request(); }).join();
+    ASSERT_EQUAL(other, 0u);
+    ASSERT_EQUAL(Voix::probes::current_request(), second);
+
+    // Durations are only measured while a probe is attached.
+    ASSERT_EQUAL(Voix::probes::start_clock(false), 0u);
+    ASSERT_EQUAL(Voix::probes::elapsed(0), 0u);
+    ASSERT_TRUE(Voix::probes::start_clock(true) != 0);
+    return true;
+}
+
+// Per-phase heap allocation budgets. Counts come from the replacement
+// operator new in alloc_counter.cpp; each phase is measured after a warm-up
+// call so first-use statics and caches do not count. The budgets leave
+// headroom over libstdc++'s counts for other standard libraries: a failure
+// means a phase started allocating per rule or per argument again.
+bool test_allocation_budgets() {
+    auto mock_id = std::make_shared<MockIdentity>();
+    mock_id->users = {{"root", 0, 0, {0}}};
+    mock_id->current_user = "root";
+    mock_id->current_uid = 0;
+    mock_id->current_groups = {0};
+
+    std::filesystem::path config_path = std::filesystem::temp_directory_path() / "test_alloc_budgets.conf";
+    ScopedTempFile cleanup(config_path);
+    {
+        std::ofstream out(config_path);
+        out << "core:\n  paths: [/bin, /usr/bin]\n"
+               "acl:\n  user:\n    root:\n";
+        for (int i = 0; i < 40; ++i) {
+            out << "      - {action: permit, command: /usr/bin/tool-" << i << ", args: [--job, '" << i << "']}\n";
+        }
+        out << "      - {action: deny, command: /usr/bin/passwd}\n"
+               "      - {action: permit, command: /usr/bin/systemctl, args: [restart, nginx], options: [nopass]}\n"
+               "      - {action: permit, command: /usr/bin/tail, args: ['/var/log/*.log']}\n"
+               "      - {action: permit, command: /home/%u/bin/deploy}\n"
+               "  group:\n    root:\n      - {action: permit, options: [persist]}\n"
+               "security:\n  blocklist: [/bin/sh, /bin/bash, /usr/bin/env]\n";
+    }
+
+    auto within = [](const char* phase, const alloc_counter::Phase& p, std::uint64_t budget) {
+        const auto used = p.now().allocations;
+        if (used > budget) {
+            std::cerr << phase << ": " << used << " allocations, budget " << budget << std::endl;
+            return false;
+        }
+        return true;
+    };
+
+    auto config = std::make_shared<Voix::Config>();
+    {
+        alloc_counter::Phase p;
+        ASSERT_TRUE(config->load(config_path.string(), false));
+        ASSERT_TRUE(within("config load", p, 8000));
+    }
+
+    auto security = std::make_shared<Voix::Security>(mock_id);
+    Voix::PermissionChecker checker(security, config);
+    Voix::CommandResolver resolver(config->getPath());
+    const std::vector<std::string> restart{"restart", "nginx"};
+    const std::vector<std::string> tail{"/var/log/syslog.log"};
+    const std::vector<std::string> wipe{"-rf", "/"};
+    const std::vector<std::string> listing{"-l", "/srv"};
+    const std::vector<std::string> none;
+
+    auto measure = [&](const char* phase, std::uint64_t budget, auto&& run) {
+        run();
+        alloc_counter::Phase p;
+        run();
+        return within(phase, p, budget);
+    };
+
+    ASSERT_TRUE(measure("catastrophic check", 32, [&] {
+        return security->isCatastrophicCommand("/usr/bin/ls", listing, *config, "/srv");
+    }));
+    ASSERT_TRUE(measure("catastrophic check (rm -rf /)", 4, [&] {
+        return security->isCatastrophicCommand("/usr/bin/rm", wipe, *config, "/srv");
+    }));
+    ASSERT_TRUE(measure("permit (literal args)", 8, [&] { return checker.permit("/usr/bin/systemctl", restart, 0); }));
+    ASSERT_TRUE(measure("permit (%u)", 10, [&] { return checker.permit("/home/root/bin/deploy", none, 0); }));
+    ASSERT_TRUE(measure("permit (pattern args)", 32, [&] { return checker.permit("/usr/bin/tail", tail, 0); }));
+    ASSERT_TRUE(measure("permit (no match)", 6, [&] { return checker.permit("/usr/bin/nope", none, 1234); }));
+    ASSERT_TRUE(measure("command resolve", 4, [&] { return resolver.resolve("true"); }));
+
+    Voix::AuthorizationRequest request{"root", "systemctl", restart, "/srv"};
+    ASSERT_TRUE(measure("authorize", 80, [&] {
+        return Voix::authorize(*config, *security, checker, resolver, request);
+    }));
+
+    const char* env[] = {"HOME=/home/alice", "TERM=xterm", "LANG=C", "PATH=/usr/bin:/bin", "DISPLAY=:0", nullptr};
+    const std::vector<std::string> assignments{"HOME=/root", "USER=root", "LOGNAME=root", "SHELL=/bin/sh",
+                                               "PATH=/usr/bin:/bin"};
+    ASSERT_TRUE(measure("env scrub", 16, [&] {
+        return Voix::EnvPolicy::defaults().apply(env, Voix::EnvPolicy::Mode::SCRUB, assignments, {});
+    }));
+
+    // Records are assembled on the stack.
+    ASSERT_TRUE(measure("log", 0, [] { Voix::Logger().log("INFO", "allocation budget probe"); }));
+    return true;
+}
+
+// Builds a Voix over mocks only: alice (uid 1000) asking for commands under
+// /usr/bin, with `true` and `id` installed.
+struct SimulatedVoix {
+    MockAuthenticator* auth = nullptr;
+    MockExecutor* exec = nullptr;
+    std::unique_ptr<Voix::Voix> voix;
+};
+
+static std::optional<SimulatedVoix> simulated_voix(const std::string& policy) {
+    auto config = std::make_shared<Voix::Config>();
+    if (!config->load_from_string(policy)) return std::nullopt;
+    auto identity = std::make_shared<MockIdentity>();
+    identity->users = {{"alice", 1000, 1000, {1000}}, {"root", 0, 0, {0}}};
+    identity->current_user = "alice";
+    identity->current_uid = 1000;
+    identity->current_groups = {1000};
+    auto resolver = std::make_unique<MockResolver>();
+    resolver->path = {"/usr/bin"};
+    resolver->files = {"/usr/bin/true", "/usr/bin/id", "/usr/bin/rm"};
+
+    SimulatedVoix sim;
+    auto auth = std::make_unique<MockAuthenticator>();
+    auto exec = std::make_unique<MockExecutor>();
+    sim.auth = auth.get();
+    sim.exec = exec.get();
+    sim.voix = std::make_unique<Voix::Voix>(Voix::VoixBackends{
+        config, identity, std::move(auth), std::move(resolver), std::move(exec)});
+    return sim;
+}
+
+bool test_simulated_pipeline() {
+    const std::string policy =
+        "core:\n  paths: [/usr/bin]\n  audit_sinks: []\n  audit_dir: \"\"\n"
+        "acl:\n  user:\n    1000:\n"
+        "      - {action: permit, command: /usr/bin/true, options: [nopass]}\n"
+        "      - {action: permit, command: id}\n"
+        "      - {action: permit, command: rm}\n";
+    auto sim = simulated_voix(policy);
+    ASSERT_TRUE(sim.has_value());
+    Voix::CommandOptions options;
+
+    // Permitted without a password: the resolved file runs in place.
+    ASSERT_EQUAL(sim->voix->execute("true", {}, options), 0);
+    ASSERT_EQUAL(sim->exec->runs, 1);
+    ASSERT_EQUAL(sim->exec->path, "/usr/bin/true");
+    ASSERT_EQUAL(sim->exec->user, "root");
+    ASSERT_TRUE(sim->exec->in_place);
+    ASSERT_EQUAL(sim->auth->prompts, 0);
+
+    // Identical requests give identical outcomes, however many there are.
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQUAL(sim->voix->execute("true", {}, options), 0);
+    }
+    ASSERT_EQUAL(sim->exec->runs, 1001);
+
+    // A password rule authenticates; a session keeps voix around to close it.
+    sim->auth->sessions = true;
+    sim->exec->exit_status = 3;
+    ASSERT_EQUAL(sim->voix->execute("id", {"-u"}, options), 3);
+    ASSERT_EQUAL(sim->exec->path, "/usr/bin/id");
+    ASSERT_EQUAL(sim->exec->args.size(), 1u);
+    ASSERT_TRUE(!sim->exec->in_place);
+    ASSERT_EQUAL(sim->auth->prompts, 1);
+    ASSERT_EQUAL(sim->auth->sessions_closed, 1);
+
+    // Nothing runs after a refused password, a denial, an unknown target or
+    // a catastrophic command.
+    sim->auth->accept = false;
+    ASSERT_EQUAL(sim->voix->execute("id", {}, options), 1);
+    sim->auth->accept = true;
+    ASSERT_EQUAL(sim->voix->execute("cat", {}, options), 1);
+    ASSERT_EQUAL(sim->voix->execute("true", {}, options, "voix_no_such_user_xyz"), 1);
+    ASSERT_EQUAL(sim->voix->execute("rm", {"-rf", "/"}, options), 1);
+    ASSERT_EQUAL(sim->exec->runs, 1002);
+    return true;
+}
+
+// Processes that open the counter file at the same moment, while it is
+// missing or belongs to another policy, must all end up counting in the same
+// file.
+bool test_rule_hit_counters_concurrent_open() {
+    auto dir = make_private_dir("voix_test_rule_hits_race");
+    const auto path = (dir / "voix-rule-hits").string();
+    std::vector<Voix::Rule> rules(2);
+    rules[0].cmd = "/usr/bin/id";
+    rules[1].cmd = "/usr/bin/true";
+    constexpr int k_processes = 16;
+
+    auto hit_together = [&] {
+        int gate[2];
+        if (pipe(gate) != 0) return false;
+        std::vector<pid_t> children;
+        for (int i = 0; i < k_processes; ++i) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                close(gate[1]);
+                char c;
+                (void)!read(gate[0], &c, 1);
+                auto counters = Voix::RuleHitCounters::open(path, rules, true, getuid());
+                if (!counters) _exit(1);
+                counters->hit(0);
+                _exit(0);
+            }
+            children.push_back(pid);
+        }
+        close(gate[0]);
+        close(gate[1]);  // Releases every child at once.
+        bool ok = true;
+        for (pid_t pid : children) {
+            int status = 0;
+            ok = waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0 && ok;
+        }
+        return ok;
+    };
+
+    ASSERT_TRUE(hit_together());
+    auto counters = Voix::RuleHitCounters::open(path, rules, false, getuid());
+    ASSERT_TRUE(counters != nullptr);
+    ASSERT_EQUAL(counters->counts()[0], static_cast<std::uint64_t>(k_processes));
+
+    rules.pop_back();
+    ASSERT_TRUE(hit_together());
+    auto replaced = Voix::RuleHitCounters::open(path, rules, false, getuid());
+    ASSERT_TRUE(replaced != nullptr);
+    ASSERT_EQUAL(replaced->counts()[0], static_cast<std::uint64_t>(k_processes));
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
 // ============================================================
 // Negative Security Tests — attempt to bypass Voix defenses
 // ============================================================
@@ -1358,6 +3059,7 @@ int main() {
     runner.add_test("test_logger_timestamp_current_year", test_logger_timestamp_current_year);
     runner.add_test("test_logger_log_does_not_crash", test_logger_log_does_not_crash);
     runner.add_test("test_logger_log_empty_message", test_logger_log_empty_message);
+    runner.add_test("test_logger_long_record_is_one_line", test_logger_long_record_is_one_line);
 
     // New FileUtils tests - readFile/writeFile
     runner.add_test("test_file_utils_read_file_success", test_file_utils_read_file_success);
@@ -1367,10 +3069,6 @@ int main() {
     runner.add_test("test_file_utils_write_file_overwrite", test_file_utils_write_file_overwrite);
     runner.add_test("test_file_utils_write_file_invalid_path", test_file_utils_write_file_invalid_path);
 
-    // New FileUtils tests - resolve_command
-    runner.add_test("test_file_utils_resolve_command_empty", test_file_utils_resolve_command_empty);
-    runner.add_test("test_file_utils_resolve_command_absolute_nonexistent", test_file_utils_resolve_command_absolute_nonexistent);
-    runner.add_test("test_file_utils_resolve_command_not_in_path", test_file_utils_resolve_command_not_in_path);
 
     // New SystemUtils tests
     runner.add_test("test_system_utils_get_uid_by_name_root", test_system_utils_get_uid_by_name_root);
@@ -1438,5 +3136,82 @@ int main() {
     runner.add_test("test_neg_environment_injection", test_neg_environment_injection);
     runner.add_test("test_neg_validate_user_injection", test_neg_validate_user_injection);
 
+    // TimestampCache (persist) tests
+    runner.add_test("test_timestamp_cache_update_and_validate", test_timestamp_cache_update_and_validate);
+    runner.add_test("test_timestamp_cache_clear", test_timestamp_cache_clear);
+    runner.add_test("test_timestamp_cache_zero_lifetime_disabled", test_timestamp_cache_zero_lifetime_disabled);
+    runner.add_test("test_timestamp_cache_rejects_shared_directory", test_timestamp_cache_rejects_shared_directory);
+    runner.add_test("test_timestamp_cache_session_key_scoped", test_timestamp_cache_session_key_scoped);
+    runner.add_test("test_config_persist_settings", test_config_persist_settings);
+
+
+    // Authorization / voixd broker tests
+    runner.add_test("authorize_verdicts", test_authorize_verdicts);
+    runner.add_test("broker_round_trip", test_broker_round_trip);
+    runner.add_test("broker_stalled_peer_does_not_block", test_broker_stalled_peer_does_not_block);
+    runner.add_test("broker_client_rejects_untrusted_socket", test_broker_client_rejects_untrusted_socket);
+
+
+    // Exec plan tests
+    runner.add_test("exec_plan_scrubs_environment", test_exec_plan_scrubs_environment);
+    runner.add_test("exec_plan_login_shell_and_missing_command", test_exec_plan_login_shell_and_missing_command);
+    runner.add_test("spawn_exec_plan_reports_failures", test_spawn_exec_plan_reports_failures);
+
+    runner.add_test("use_exec_in_place", test_use_exec_in_place);
+    runner.add_test("config_exec_mode", test_config_exec_mode);
+    runner.add_test("exec_plan_in_place", test_exec_plan_in_place);
+
+    runner.add_test("env_policy_modes", test_env_policy_modes);
+    runner.add_test("env_policy_rule_entries", test_env_policy_rule_entries);
+    runner.add_test("config_environment_policy", test_config_environment_policy);
+
+    runner.add_test("command_resolver_lookup", test_command_resolver_lookup);
+    runner.add_test("authorize_uses_resolved_command", test_authorize_uses_resolved_command);
+
+    runner.add_test("supervise_child_reports_usage", test_supervise_child_reports_usage);
+    runner.add_test("supervise_child_enforces_timeout", test_supervise_child_enforces_timeout);
+
+    runner.add_test("config_rule_timeout", test_config_rule_timeout);
+
+    runner.add_test("config_profile_cgroup", test_config_profile_cgroup);
+    runner.add_test("prepare_cgroup_requires_cgroup2", test_prepare_cgroup_requires_cgroup2);
+
+    runner.add_test("process_tuning_parsing", test_process_tuning_parsing);
+    runner.add_test("config_profile_tuning", test_config_profile_tuning);
+    runner.add_test("spawn_exec_plan_applies_tuning", test_spawn_exec_plan_applies_tuning);
+
+    runner.add_test("audit_store_append_and_query", test_audit_store_append_and_query);
+    runner.add_test("audit_store_rollover_skips_orphans", test_audit_store_rollover_skips_orphans);
+    runner.add_test("audit_store_torn_index_header", test_audit_store_torn_index_header);
+    runner.add_test("audit_query_parsing", test_audit_query_parsing);
+
+    runner.add_test("config_audit_store", test_config_audit_store);
+
+    runner.add_test("audit_pipeline_journald_sink", test_audit_pipeline_journald_sink);
+
+    runner.add_test("glob_match", test_glob_match);
+    runner.add_test("policy_analyzer_shadowed_rules", test_policy_analyzer_shadowed_rules);
+
+    runner.add_test("policy_diff", test_policy_diff);
+
+    runner.add_test("rule_hit_counters", test_rule_hit_counters);
+    runner.add_test("policy_analyzer_reorderings", test_policy_analyzer_reorderings);
+
+    runner.add_test("thread_pool", test_thread_pool);
+    runner.add_test("check_configs", test_check_configs);
+
+    runner.add_test("glob_intersect", test_glob_intersect);
+    runner.add_test("policy_analyzer_conflicting_rules", test_policy_analyzer_conflicting_rules);
+
+    runner.add_test("trace", test_trace);
+
+    runner.add_test("probe_request_ids", test_probe_request_ids);
+
+    runner.add_test("allocation_budgets", test_allocation_budgets);
+
+    runner.add_test("simulated_pipeline", test_simulated_pipeline);
+
+    runner.add_test("rule_hit_counters_concurrent_open", test_rule_hit_counters_concurrent_open);
+
     return runner.run();
 }
@@ -0,0 +1,478 @@
+/**
+ * @file voix_syscalls.cpp
+ * @copyright Copyright (C) 2026 Veridian Zenith
+ * @author Dae Euhwa <daedaevibin@ik.me>
+ *
+ * All code in this repository is licensed under OSL v3.
+ *
+ * Syscall budgets for whole invocations of the voix binary of a
+ * VOIX_ENABLE_HARNESS build. Like voix_e2e, it runs as root and starts voix
+ * the way exec of the setuid binary would (real IDs the caller's, effective
+ * UID 0), here under ptrace, and records every syscall voix makes for a few
+ * reference scenarios. Each syscall is charged to a phase:
+ *
+ *   startup   from exec of voix to the first syscall naming the policy file
+ *   config    from there until the policy file is closed
+ *   decide    the rest of voix up to the exec of the command, or its exit
+ *   finish    voix itself after the command was started (supervised runs)
+ *
+ * The command's own syscalls are not counted. The lowest count over --runs
+ * runs is compared with the budget checked in next to this file; any phase
+ * over budget fails. Exit status 77 means the check could not run here.
+ *
+ *   voix_syscalls --budgets tests/syscall_budgets.txt
+ *   voix_syscalls --scenario denied --sequence
+ */
+
+#include "harness.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <getopt.h>
+#include <map>
+#include <optional>
+#include <print>
+#include <sstream>
+#include <string>
+#include <sys/ptrace.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#ifndef VOIX_BINARY
+#define VOIX_BINARY "voix"
+#endif
+
+namespace {
+
+using harness::Caller;
+using harness::k_exit_skip;
+
+enum Phase { STARTUP, CONFIG, DECIDE, FINISH, PHASE_COUNT };
+constexpr std::array<const char*, PHASE_COUNT> k_phase_names{"startup", "config", "decide", "finish"};
+
+struct Scenario {
+    std::string name;
+    std::vector<std::string> args;  // After `voix -C <policy>`.
+    bool permitted;
+};
+
+struct Syscall {
+    std::uint64_t nr;
+    Phase phase;
+    std::string path;
+};
+
+struct Recording {
+    std::array<unsigned, PHASE_COUNT> counts{};
+    std::vector<Syscall> sequence;
+    bool permitted = false;  // The command was executed.
+};
+
+struct Options {
+    std::string voix = VOIX_BINARY;
+    std::string budgets;
+    std::string caller = "nobody";
+    std::string scenario;
+    unsigned runs = 3;
+    bool sequence = false;
+};
+
+const char* syscall_name(std::uint64_t nr) {
+    static const std::map<std::uint64_t, const char*> names = [] {
+        std::map<std::uint64_t, const char*> m;
+#define VOIX_SYSCALL(name) m[SYS_##name] = #name
+#ifdef SYS_open
+        VOIX_SYSCALL(open);
+#endif
+#ifdef SYS_stat
+        VOIX_SYSCALL(stat);
+#endif
+#ifdef SYS_lstat
+        VOIX_SYSCALL(lstat);
+#endif
+#ifdef SYS_access
+        VOIX_SYSCALL(access);
+#endif
+#ifdef SYS_readlink
+        VOIX_SYSCALL(readlink);
+#endif
+#ifdef SYS_arch_prctl
+        VOIX_SYSCALL(arch_prctl);
+#endif
+#ifdef SYS_newfstatat
+        VOIX_SYSCALL(newfstatat);
+#endif
+#ifdef SYS_rename
+        VOIX_SYSCALL(rename);
+#endif
+        VOIX_SYSCALL(read);
+        VOIX_SYSCALL(write);
+        VOIX_SYSCALL(openat);
+        VOIX_SYSCALL(close);
+        VOIX_SYSCALL(fstat);
+        VOIX_SYSCALL(statx);
+        VOIX_SYSCALL(lseek);
+        VOIX_SYSCALL(mmap);
+        VOIX_SYSCALL(mprotect);
+        VOIX_SYSCALL(munmap);
+        VOIX_SYSCALL(brk);
+        VOIX_SYSCALL(rt_sigaction);
+        VOIX_SYSCALL(rt_sigprocmask);
+        VOIX_SYSCALL(ioctl);
+        VOIX_SYSCALL(pread64);
+        VOIX_SYSCALL(pwrite64);
+        VOIX_SYSCALL(ftruncate);
+        VOIX_SYSCALL(fdatasync);
+        VOIX_SYSCALL(statfs);
+        VOIX_SYSCALL(fstatfs);
+        VOIX_SYSCALL(faccessat);
+        VOIX_SYSCALL(faccessat2);
+        VOIX_SYSCALL(readlinkat);
+        VOIX_SYSCALL(socket);
+        VOIX_SYSCALL(connect);
+        VOIX_SYSCALL(sendto);
+        VOIX_SYSCALL(recvfrom);
+        VOIX_SYSCALL(clone);
+        VOIX_SYSCALL(clone3);
+        VOIX_SYSCALL(execve);
+        VOIX_SYSCALL(execveat);
+        VOIX_SYSCALL(exit_group);
+        VOIX_SYSCALL(wait4);
+        VOIX_SYSCALL(waitid);
+        VOIX_SYSCALL(kill);
+        VOIX_SYSCALL(uname);
+        VOIX_SYSCALL(fcntl);
+        VOIX_SYSCALL(flock);
+        VOIX_SYSCALL(fsync);
+        VOIX_SYSCALL(getdents64);
+        VOIX_SYSCALL(getcwd);
+        VOIX_SYSCALL(chdir);
+        VOIX_SYSCALL(umask);
+        VOIX_SYSCALL(getrlimit);
+        VOIX_SYSCALL(setrlimit);
+        VOIX_SYSCALL(prlimit64);
+        VOIX_SYSCALL(getuid);
+        VOIX_SYSCALL(geteuid);
+        VOIX_SYSCALL(getgid);
+        VOIX_SYSCALL(getegid);
+        VOIX_SYSCALL(getpid);
+        VOIX_SYSCALL(getppid);
+        VOIX_SYSCALL(gettid);
+        VOIX_SYSCALL(setuid);
+        VOIX_SYSCALL(setgid);
+        VOIX_SYSCALL(setresuid);
+        VOIX_SYSCALL(setresgid);
+        VOIX_SYSCALL(getresuid);
+        VOIX_SYSCALL(getresgid);
+        VOIX_SYSCALL(setgroups);
+        VOIX_SYSCALL(getgroups);
+        VOIX_SYSCALL(setsid);
+        VOIX_SYSCALL(capget);
+        VOIX_SYSCALL(capset);
+        VOIX_SYSCALL(prctl);
+        VOIX_SYSCALL(seccomp);
+        VOIX_SYSCALL(set_tid_address);
+        VOIX_SYSCALL(set_robust_list);
+        VOIX_SYSCALL(rseq);
+        VOIX_SYSCALL(futex);
+        VOIX_SYSCALL(getrandom);
+        VOIX_SYSCALL(clock_gettime);
+        VOIX_SYSCALL(pidfd_open);
+        VOIX_SYSCALL(pidfd_send_signal);
+        VOIX_SYSCALL(ppoll);
+        VOIX_SYSCALL(dup3);
+        VOIX_SYSCALL(pipe2);
+        VOIX_SYSCALL(mkdirat);
+        VOIX_SYSCALL(unlinkat);
+        VOIX_SYSCALL(renameat2);
+        VOIX_SYSCALL(fchownat);
+        VOIX_SYSCALL(fchmodat);
+        VOIX_SYSCALL(utimensat);
+#undef VOIX_SYSCALL
+        return m;
+    }();
+    auto it = names.find(nr);
+    return it == names.end() ? nullptr : it->second;
+}
+
+// Index of the argument naming a path, or -1.
+int path_argument(std::uint64_t nr) {
+    switch (nr) {
+#ifdef SYS_open
+        case SYS_open:
+#endif
+#ifdef SYS_stat
+        case SYS_stat:
+#endif
+#ifdef SYS_lstat
+        case SYS_lstat:
+#endif
+#ifdef SYS_access
+        case SYS_access:
+#endif
+#ifdef SYS_readlink
+        case SYS_readlink:
+#endif
+        case SYS_execve:
+            return 0;
+#ifdef SYS_newfstatat
+        case SYS_newfstatat:
+#endif
+        case SYS_openat:
+        case SYS_statx:
+        case SYS_faccessat:
+        case SYS_faccessat2:
+        case SYS_readlinkat:
+            return 1;
+        default:
+            return -1;
+    }
+}
+
+std::string read_string(pid_t pid, std::uint64_t address) {
+    std::string out;
+    char buffer[256];
+    while (out.size() < 4096) {
+        struct iovec local{buffer, sizeof(buffer)};
+        struct iovec remote{reinterpret_cast<void*>(address + out.size()), sizeof(buffer)};
+        ssize_t n = process_vm_readv(pid, &local, 1, &remote, 1, 0);
+        if (n <= 0) break;
+        const char* end = static_cast<const char*>(std::memchr(buffer, '\0', static_cast<size_t>(n)));
+        out.append(buffer, end ? static_cast<size_t>(end - buffer) : static_cast<size_t>(n));
+        if (end) break;
+    }
+    return out;
+}
+
+// Budgets are `scenario phase syscalls` lines; # starts a comment.
+std::optional<std::map<std::string, unsigned>> load_budgets(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) return std::nullopt;
+    std::map<std::string, unsigned> budgets;
+    std::string line;
+    while (std::getline(in, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string scenario, phase;
+        unsigned budget;
+        if (fields >> scenario >> phase >> budget) budgets[scenario + " " + phase] = budget;
+    }
+    return budgets;
+}
+
+std::optional<Recording> record(const std::vector<std::string>& args, const std::string& policy,
+                                const Caller& caller, const std::vector<char*>& envp) {
+    std::vector<std::string> storage = args;
+    auto argv = harness::c_strings(storage);
+
+    Recording rec;
+    Phase phase = STARTUP;
+    unsigned execs = 0;
+    int policy_fd = -1;
+    std::vector<pid_t> command_pids;  // The command and anything it starts.
+    std::map<pid_t, std::uint64_t> pending;  // Syscall in progress per thread.
+
+    auto on_stop = [&](pid_t pid, unsigned event) {
+        const bool command = std::ranges::find(command_pids, pid) != command_pids.end();
+        if (event == 0) {
+            struct __ptrace_syscall_info info{};
+            ptrace(PTRACE_GET_SYSCALL_INFO, pid, reinterpret_cast<void*>(sizeof(info)), &info);
+            if (info.op == PTRACE_SYSCALL_INFO_ENTRY && !command) {
+                const std::uint64_t nr = info.entry.nr;
+                pending[pid] = nr;
+                std::string path;
+                if (int arg = path_argument(nr); arg >= 0) path = read_string(pid, info.entry.args[arg]);
+                if (phase == STARTUP && path == policy) phase = CONFIG;
+                if (nr == SYS_close && policy_fd != -1 && info.entry.args[0] == static_cast<std::uint64_t>(policy_fd)) {
+                    policy_fd = -1;
+                    ++rec.counts[phase];
+                    rec.sequence.push_back({nr, phase, {}});
+                    phase = DECIDE;
+                } else {
+                    ++rec.counts[phase];
+                    rec.sequence.push_back({nr, phase, std::move(path)});
+                }
+            } else if (info.op == PTRACE_SYSCALL_INFO_EXIT && !command) {
+                auto it = pending.find(pid);
+                if (it != pending.end() && it->second == SYS_openat && phase == CONFIG && policy_fd == -1 &&
+                    !info.exit.is_error && !rec.sequence.empty() && rec.sequence.back().path == policy) {
+                    policy_fd = static_cast<int>(info.exit.rval);
+                }
+                pending.erase(pid);
+            }
+        } else if (event == PTRACE_EVENT_EXEC) {
+            // The first exec is voix itself, the next one the command.
+            if (++execs == 2) {
+                command_pids.push_back(pid);
+                rec.permitted = true;
+                phase = FINISH;
+            }
+            pending.erase(pid);
+        } else if (event == PTRACE_EVENT_FORK || event == PTRACE_EVENT_VFORK || event == PTRACE_EVENT_CLONE) {
+            unsigned long child = 0;
+            ptrace(PTRACE_GETEVENTMSG, pid, nullptr, &child);
+            if (command) command_pids.push_back(static_cast<pid_t>(child));
+        }
+    };
+    auto root_status = harness::trace_tree(caller, argv, envp, on_stop, [&](pid_t pid) { pending.erase(pid); });
+    if (!root_status) return std::nullopt;
+    // In-place exec leaves the command in the root process; its exit status
+    // says nothing about voix.
+    if (!rec.permitted && !(WIFEXITED(*root_status) && WEXITSTATUS(*root_status) != 0)) return std::nullopt;
+    return rec;
+}
+
+void print_sequence(const std::string& scenario, const Recording& rec) {
+    std::println("{}:", scenario);
+    for (const auto& call : rec.sequence) {
+        const char* name = syscall_name(call.nr);
+        std::println("  {:<8} {:<18} {}", k_phase_names[call.phase],
+                     name ? std::string(name) : std::format("syscall_{}", call.nr), call.path);
+    }
+}
+
+void usage() {
+    std::print("Usage: voix_syscalls [options]\n\n"
+               "  --voix PATH          voix binary built with VOIX_ENABLE_HARNESS (default: this build's)\n"
+               "  --budgets FILE       Fail when a phase needs more syscalls than FILE allows\n"
+               "  --caller USER        Invoke voix as USER (default: nobody)\n"
+               "  --scenario NAME      Only run NAME (nopass-root, pattern, denied)\n"
+               "  --runs N             Record each scenario N times, keep the lowest counts (default 3)\n"
+               "  --sequence           Print every recorded syscall with its phase\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    static struct option long_options[] = {
+        {"voix", required_argument, nullptr, 'v'},
+        {"budgets", required_argument, nullptr, 'b'},
+        {"caller", required_argument, nullptr, 'u'},
+        {"scenario", required_argument, nullptr, 's'},
+        {"runs", required_argument, nullptr, 'r'},
+        {"sequence", no_argument, nullptr, 'q'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int ch;
+    while ((ch = getopt_long(argc, argv, "h", long_options, nullptr)) != -1) {
+        switch (ch) {
+            case 'v': options.voix = optarg; break;
+            case 'b': options.budgets = optarg; break;
+            case 'u': options.caller = optarg; break;
+            case 's': options.scenario = optarg; break;
+            case 'r': options.runs = std::max(1u, static_cast<unsigned>(std::strtoul(optarg, nullptr, 10))); break;
+            case 'q': options.sequence = true; break;
+            case 'h': usage(); return 0;
+            default: usage(); return 2;
+        }
+    }
+
+    if (getuid() != 0) {
+        std::println(stderr, "voix_syscalls: skipped, must run as root to start voix as a setuid binary would run");
+        return k_exit_skip;
+    }
+    auto caller = harness::lookup_caller(options.caller);
+    if (!caller) {
+        std::println(stderr, "voix_syscalls: unknown caller '{}'", options.caller);
+        return 2;
+    }
+    std::map<std::string, unsigned> budgets;
+    if (!options.budgets.empty()) {
+        auto loaded = load_budgets(options.budgets);
+        if (!loaded) {
+            std::println(stderr, "voix_syscalls: cannot read {}", options.budgets);
+            return 2;
+        }
+        budgets = std::move(*loaded);
+    }
+    const std::string true_path = harness::find_program("true");
+    const std::string voix_path = std::filesystem::absolute(options.voix).string();
+
+    char dir_template[] = "/tmp/voix-syscalls-XXXXXX";
+    if (!mkdtemp(dir_template)) {
+        std::println(stderr, "voix_syscalls: mkdtemp: {}", std::strerror(errno));
+        return 2;
+    }
+    const std::filesystem::path dir = dir_template;
+    const std::string policy = (dir / "voix.conf").string();
+    const std::string pam_env = harness::write_pam_service(dir);
+    {
+        std::ofstream(policy) << std::format("core:\n"
+                                             "  paths: [{2}]\n"
+                                             "  sanctuary: {0}\n"
+                                             "  persist_dir: {0}/persist\n"
+                                             "  audit_dir: \"\"\n"
+                                             "  audit_sinks: []\n"
+                                             "acl:\n  user:\n    {1}:\n"
+                                             "      - {{action: permit, command: {3}, args: ['/srv/*.log'], "
+                                             "options: [nopass]}}\n"
+                                             "      - {{action: permit, command: {3}, options: [nopass]}}\n",
+                                             dir.string(), caller->name,
+                                             std::filesystem::path(true_path).parent_path().string(), true_path);
+    }
+    chmod(policy.c_str(), 0600);
+
+    std::vector<std::string> env_storage{"PATH=/usr/bin:/bin", "HOME=/", "LANG=C", pam_env};
+    const auto envp = harness::c_strings(env_storage);
+
+    // The pattern rule comes first, so the plain rule is the second match
+    // candidate and `false` scans both before it is denied.
+    const std::vector<Scenario> scenarios{
+        {"nopass-root", {"-n", "true"}, true},
+        {"pattern", {"-n", "true", "/srv/app.log"}, true},
+        {"denied", {"-n", "false"}, false},
+    };
+
+    int result = 0;
+    std::println("{:<12} {:<8} {:>8} {:>7}", "scenario", "phase", "syscalls", "budget");
+    for (const auto& scenario : scenarios) {
+        if (!options.scenario.empty() && scenario.name != options.scenario) continue;
+        std::vector<std::string> args{voix_path, "-C", policy};
+        args.insert(args.end(), scenario.args.begin(), scenario.args.end());
+
+        std::optional<Recording> best;
+        for (unsigned i = 0; i < options.runs; ++i) {
+            auto rec = record(args, policy, *caller, envp);
+            if (!rec || rec->permitted != scenario.permitted) {
+                std::println(stderr, "voix_syscalls: {}: voix did not {} the command; is {} a VOIX_ENABLE_HARNESS build?",
+                             scenario.name, scenario.permitted ? "run" : "deny", voix_path);
+                std::filesystem::remove_all(dir);
+                return 1;
+            }
+            if (!best) {
+                best = std::move(rec);
+                continue;
+            }
+            for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+                best->counts[phase] = std::min(best->counts[phase], rec->counts[phase]);
+            }
+        }
+
+        for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+            auto it = budgets.find(scenario.name + " " + k_phase_names[phase]);
+            const unsigned count = best->counts[phase];
+            std::string verdict;
+            if (it != budgets.end() && count > it->second) {
+                verdict = "  over budget";
+                result = 1;
+            }
+            std::println("{:<12} {:<8} {:>8} {:>7}{}", scenario.name, k_phase_names[phase], count,
+                         it != budgets.end() ? std::to_string(it->second) : std::string("-"), verdict);
+        }
+        if (options.sequence) print_sequence(scenario.name, *best);
+    }
+    std::filesystem::remove_all(dir);
+    return result;
+}